@@ -7,22 +7,30 @@ in vec3 FragPos; // Received from vertex shader
 uniform sampler2D texture1;
 uniform vec4 objectColor; // Use for untextured objects if needed
 uniform bool useTexture;
-uniform vec3 cameraPos; // Needed for fog calculation
 
-// Fog parameters
-uniform vec3 fogColor = vec3(0.5, 0.6, 0.7);
-uniform float fogDensity = 0.015; // Adjust for desired fog thickness
+// Per-frame data, written once per frame by Graphics::setFrameData (layout must match FrameData.h)
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    mat4 screen_projection;
+    vec4 camera_position;
+    vec4 sun_direction;
+    vec4 fog_color;   // rgb, a = exponential-squared density
+    vec4 fog_range;   // x = start, y = end (linear terrain fog)
+    vec4 viewport;    // width, height, 1/width, 1/height
+} frame;
 
 void main() {
     vec4 texColor = texture(texture1, TexCoord);
     vec4 baseColor = useTexture ? texColor : objectColor;
 
     // Basic distance fog calculation
-    float dist = length(FragPos - cameraPos);
-    float fogFactor = exp(-pow(dist * fogDensity, 2.0)); // Exponential fog
+    float dist = length(FragPos - frame.camera_position.xyz);
+    float fogFactor = exp(-pow(dist * frame.fog_color.a, 2.0)); // Exponential fog
     fogFactor = clamp(fogFactor, 0.0, 1.0);
 
-    FragColor = mix(vec4(fogColor, 1.0), baseColor, fogFactor);
+    FragColor = mix(vec4(frame.fog_color.rgb, 1.0), baseColor, fogFactor);
 
     // Discard transparent pixels if necessary (e.g., for alpha masking)
     // if (baseColor.a < 0.1) discard;
@@ -5,12 +5,23 @@ layout (location = 1) in vec2 aTexCoord; // Added texture coordinates
 out vec2 TexCoord;
 out vec3 FragPos; // Pass position to fragment shader for fog
 
+// Per-frame data, written once per frame by Graphics::setFrameData (layout must match FrameData.h)
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    mat4 screen_projection;
+    vec4 camera_position;
+    vec4 sun_direction;
+    vec4 fog_color;   // rgb, a = exponential-squared density
+    vec4 fog_range;   // x = start, y = end (linear terrain fog)
+    vec4 viewport;    // width, height, 1/width, 1/height
+} frame;
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main() {
     FragPos = vec3(model * vec4(aPos, 1.0));
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = frame.view_projection * vec4(FragPos, 1.0);
     TexCoord = aTexCoord;
 }
@@ -1,9 +1,21 @@
 #version 330 core
 layout (location = 0) in vec2 aPos; // 2D positions
 
+// Per-frame data, written once per frame by Graphics::setFrameData (layout must match FrameData.h)
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    mat4 screen_projection;
+    vec4 camera_position;
+    vec4 sun_direction;
+    vec4 fog_color;   // rgb, a = exponential-squared density
+    vec4 fog_range;   // x = start, y = end (linear terrain fog)
+    vec4 viewport;    // width, height, 1/width, 1/height
+} frame;
+
 uniform mat4 model; // For positioning/scaling/rotating elements
-uniform mat4 projection; // Orthographic projection
 
 void main() {
-    gl_Position = projection * model * vec4(aPos.xy, 0.0, 1.0);
+    gl_Position = frame.screen_projection * model * vec4(aPos.xy, 0.0, 1.0);
 }
@@ -6,9 +6,20 @@ in vec3 FragPosWorld;
 in vec2 TexCoord;    // <-- Receive UVs
 in vec3 NormalWorld; // <-- Receive World Normal
 
+// Per-frame data, written once per frame by Graphics::setFrameData (layout must match FrameData.h)
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    mat4 screen_projection;
+    vec4 camera_position;
+    vec4 sun_direction;
+    vec4 fog_color;   // rgb, a = exponential-squared density
+    vec4 fog_range;   // x = start, y = end (linear terrain fog)
+    vec4 viewport;    // width, height, 1/width, 1/height
+} frame;
+
 // Uniforms
-uniform vec3 u_CameraPos;
-uniform vec3 u_SunDirection; // <-- Need sun direction for lighting
 uniform sampler2D u_Texture; // <-- Need detail texture
 
 // Simple directional light calculation
@@ -37,13 +48,13 @@ void main()
     vec3 baseColor = texture(u_Texture, TexCoord).rgb;
 
     // Calculate lighting using the interpolated world normal
-    vec3 litColor = calculateDirLight(u_SunDirection, NormalWorld, baseColor);
+    vec3 litColor = calculateDirLight(frame.sun_direction.xyz, NormalWorld, baseColor);
 
-    // Basic Fog calculation (same as before)
-    float fogMaxdist = 60000.0;
-    float fogMindist = 1000.0;
-    vec4 fogColor = vec4(0.5, 0.6, 0.7, 1.0); // Sky blueish
-    float dist = length(FragPosWorld - u_CameraPos);
+    // Linear fog over the frame's fog range
+    float fogMaxdist = frame.fog_range.y;
+    float fogMindist = frame.fog_range.x;
+    vec4 fogColor = vec4(frame.fog_color.rgb, 1.0);
+    float dist = length(FragPosWorld - frame.camera_position.xyz);
     float fogFactor = clamp((fogMaxdist - dist) / (fogMaxdist - fogMindist), 0.0, 1.0);
 
     // Mix final color with fog
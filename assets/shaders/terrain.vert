@@ -1,17 +1,26 @@
 #version 330 core
 layout (location = 0) in vec3 a_Pos; // Input vertex position (flat grid, local space)
+layout (location = 1) in vec3 a_Instance; // Per block: xy = world XZ of the block centre, z = level scale
 
-// Matrices
-uniform mat4 u_View;
-uniform mat4 u_Model; // Transforms local grid vertex to world position (XZ plane)
-uniform mat4 u_Projection;
+// Per-frame data, written once per frame by Graphics::setFrameData (layout must match FrameData.h)
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    mat4 screen_projection;
+    vec4 camera_position;
+    vec4 sun_direction;
+    vec4 fog_color;   // rgb, a = exponential-squared density
+    vec4 fog_range;   // x = start, y = end (linear terrain fog)
+    vec4 viewport;    // width, height, 1/width, 1/height
+} frame;
 
 // Textures
 uniform sampler2D u_Heightmap;
 uniform sampler2D u_Normalmap; // <-- Add Normalmap
 
-// Parameters
-uniform float u_TerrainSize;
+// Parameters (per texture set: the default heightmap square or a streamed tile)
+uniform vec4 u_TileRect; // xy = world XZ of uv (0,0), zw = 1 / world size
 uniform float u_MaxHeight;
 
 // Outputs
@@ -19,10 +28,9 @@ out vec3 FragPosWorld;
 out vec2 TexCoord;      // <-- Add TexCoord output
 out vec3 NormalWorld;   // <-- Add Normal output (in world space)
 
-// UV Calculation (same as before)
+// UV Calculation
 vec2 getWorldXZToUV(vec2 worldXZ) {
-    vec2 normalizedPos = worldXZ / u_TerrainSize;
-    return normalizedPos + 0.5;
+    return (worldXZ - u_TileRect.xy) * u_TileRect.zw;
 }
 
 // Height Sampling (same as before)
@@ -43,8 +51,8 @@ vec3 getNormal(vec2 uv) {
 
 void main()
 {
-    // 1. Calculate initial world position on the XZ plane
-    vec3 worldPosXZ = vec3(u_Model * vec4(a_Pos, 1.0));
+    // 1. Calculate initial world position on the XZ plane (block model = translate * uniform scale)
+    vec3 worldPosXZ = vec3(a_Pos.x * a_Instance.z + a_Instance.x, 0.0, a_Pos.z * a_Instance.z + a_Instance.y);
 
     // 2. Calculate UV coordinates
     TexCoord = getWorldXZToUV(worldPosXZ.xz); // Pass UVs to fragment shader
@@ -62,8 +70,8 @@ void main()
     // This requires a TBN matrix (Tangent, Bitangent, Normal)
     // For a flat grid on XZ plane (before height applied), Tangent=X, Bitangent=Z, Normal=Y
     // We need the orientation of the final surface in world space.
-    // Approximate TBN from model matrix orientation:
-    mat3 normalMatrix = transpose(inverse(mat3(u_Model))); // Matrix to transform normals
+    // Blocks are only translated and uniformly scaled, so the normal matrix
+    // transpose(inverse(mat3(model))) is a uniform scale that normalize() removes.
     vec3 world_up = vec3(0.0, 1.0, 0.0); // Assuming initial grid normal is world Y up
     // A simpler approach for now: Assume the sampled normal is already world-space oriented
     // OR just pass the tangent space normal and calculate TBN in frag shader (more complex)
@@ -71,8 +79,8 @@ void main()
     // OR just use a fixed UP normal for now to test lighting.
     // NormalWorld = normalize(vec3(0.0, 1.0, 0.0)); // Fixed UP normal debug
     // Let's try using the normal map value, assuming it's somewhat world-oriented (might look wrong)
-    NormalWorld = normalize(normalMatrix * normal_tangent); // Transform sampled normal by model matrix
+    NormalWorld = normalize(normal_tangent);
 
     // 7. Calculate final screen position
-     gl_Position = u_Projection * u_View * vec4(FragPosWorld, 1.0); 
+     gl_Position = frame.view_projection * vec4(FragPosWorld, 1.0); 
 }
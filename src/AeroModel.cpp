@@ -0,0 +1,152 @@
+#include "AeroModel.h"
+#include "PhysicsConfig.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+void AeroModel::compile(const std::vector<std::unique_ptr<Wing>>& wings, const std::vector<float>& max_deflection_deg) {
+    auto reset = [](auto&... arrays) { (arrays.clear(), ...); };
+    reset(wing_index, airfoil, cop_x, cop_y, cop_z, span_x, span_y, span_z, normal_x, normal_y, normal_z,
+          axn_x, axn_y, axn_z, ann_x, ann_y, ann_z, area, chord, induced_factor, flap_gain, max_deflection_rad);
+
+    for (size_t i = 0; i < wings.size(); ++i) {
+        const Wing& wing = *wings[i];
+        if (wing.area < 1e-6f) continue; // Wing::applyForces skips these too
+
+        glm::vec3 normal = wing.base_normal_body;
+        glm::vec3 span = wing.getSpanAxisBody();
+        glm::vec3 hinge = wing.getDeflectionAxisBody();
+        glm::vec3 axn = glm::cross(hinge, normal);
+        glm::vec3 ann = hinge * glm::dot(hinge, normal);
+
+        wing_index.push_back(i);
+        airfoil.push_back(wing.airfoil);
+        cop_x.push_back(wing.center_of_pressure_body.x);
+        cop_y.push_back(wing.center_of_pressure_body.y);
+        cop_z.push_back(wing.center_of_pressure_body.z);
+        span_x.push_back(span.x); span_y.push_back(span.y); span_z.push_back(span.z);
+        normal_x.push_back(normal.x); normal_y.push_back(normal.y); normal_z.push_back(normal.z);
+        axn_x.push_back(axn.x); axn_y.push_back(axn.y); axn_z.push_back(axn.z);
+        ann_x.push_back(ann.x); ann_y.push_back(ann.y); ann_z.push_back(ann.z);
+        area.push_back(wing.area);
+        chord.push_back(wing.chord);
+
+        bool induced_defined = wing.aspect_ratio > 1e-3f && wing.efficiency_factor > 1e-3f;
+        induced_factor.push_back(induced_defined ? 1.0f / (PhysicsConfig::PI * wing.aspect_ratio * wing.efficiency_factor) : 0.0f);
+
+        bool has_flap = wing.flap_ratio > 0.0f;
+        flap_gain.push_back(has_flap ? std::sqrt(wing.flap_ratio) * wing.airfoil->getMaxCl() : 0.0f);
+        float max_deg = i < max_deflection_deg.size() ? max_deflection_deg[i] : 20.0f;
+        max_deflection_rad.push_back(has_flap ? glm::radians(max_deg) : 0.0f);
+    }
+
+    count = wing_index.size();
+    control.assign(count, 0.0f);
+    eff_normal_x = normal_x;
+    eff_normal_y = normal_y;
+    eff_normal_z = normal_z;
+    for (auto* scratch : {&vdir_x, &vdir_y, &vdir_z, &speed_sq, &aoa_deg, &cl, &cd}) scratch->assign(count, 0.0f);
+}
+
+void AeroModel::updateControls(const std::vector<std::unique_ptr<Wing>>& wings) {
+    for (size_t s = 0; s < count; ++s) {
+        float input = wings[wing_index[s]]->control_input;
+        control[s] = input;
+
+        float angle = input * max_deflection_rad[s];
+        if (angle == 0.0f) {
+            eff_normal_x[s] = normal_x[s];
+            eff_normal_y[s] = normal_y[s];
+            eff_normal_z[s] = normal_z[s];
+            continue;
+        }
+
+        // Rodrigues rotation of the normal about the hinge axis
+        float c = std::cos(angle), sn = std::sin(angle), k = 1.0f - c;
+        float nx = normal_x[s] * c + axn_x[s] * sn + ann_x[s] * k;
+        float ny = normal_y[s] * c + axn_y[s] * sn + ann_y[s] * k;
+        float nz = normal_z[s] * c + axn_z[s] * sn + ann_z[s] * k;
+        float inv_len = 1.0f / std::sqrt(nx * nx + ny * ny + nz * nz);
+        eff_normal_x[s] = nx * inv_len;
+        eff_normal_y[s] = ny * inv_len;
+        eff_normal_z[s] = nz * inv_len;
+    }
+}
+
+AeroModel::Loads AeroModel::evaluate(const RigidBody& body, const AtmosphereState& air) const {
+    // One zone for all surfaces: the passes below are per-surface loops (what
+    // Wing::applyForces did per wing) and a zone per surface would cost more than the surface
+    FS_TRACE_ZONE_VALUE("AeroModel::evaluate", count);
+    Loads loads;
+    if (count == 0) return loads;
+
+    // Everything is evaluated in body space: one rotation in, one rotation out
+    const glm::vec3 v = body.worldToBodyDir(body.velocity_world);
+    const glm::vec3 w = body.angular_velocity_body;
+    const float half_rho = 0.5f * air.density;
+    const float rad_to_deg = 180.0f / PhysicsConfig::PI;
+
+    // --- Pass 1: relative wind and angle of attack per surface ---
+    for (size_t s = 0; s < count; ++s) {
+        // Point velocity = v + w x r
+        float px = v.x + (w.y * cop_z[s] - w.z * cop_y[s]);
+        float py = v.y + (w.z * cop_x[s] - w.x * cop_z[s]);
+        float pz = v.z + (w.x * cop_y[s] - w.y * cop_x[s]);
+        float ssq = px * px + py * py + pz * pz;
+        float inv_speed = ssq >= 0.1f ? 1.0f / std::sqrt(ssq) : 0.0f; // Below 0.1 the surface is skipped
+        float dx = px * inv_speed, dy = py * inv_speed, dz = pz * inv_speed;
+        float dot_vn = std::clamp(dx * eff_normal_x[s] + dy * eff_normal_y[s] + dz * eff_normal_z[s], -1.0f, 1.0f);
+
+        vdir_x[s] = dx; vdir_y[s] = dy; vdir_z[s] = dz;
+        speed_sq[s] = inv_speed > 0.0f ? ssq : 0.0f;
+        // AoA = 90 degrees - angle between velocity and normal
+        aoa_deg[s] = (PhysicsConfig::PI / 2.0f - std::acos(dot_vn)) * rad_to_deg;
+    }
+
+    // --- Pass 2: airfoil tables (gather) ---
+    const float inv_viscosity = 1.0f / air.dynamic_viscosity;
+    const float inv_speed_of_sound = 1.0f / air.speed_of_sound;
+    for (size_t s = 0; s < count; ++s) {
+        float lift_coeff, drag_coeff;
+        if (airfoil[s]->hasReynoldsMach()) {
+            float speed = std::sqrt(speed_sq[s]);
+            float reynolds = air.density * speed * chord[s] * inv_viscosity;
+            std::tie(lift_coeff, drag_coeff) = airfoil[s]->sample(aoa_deg[s], reynolds, speed * inv_speed_of_sound);
+        } else {
+            std::tie(lift_coeff, drag_coeff) = airfoil[s]->sample(aoa_deg[s]);
+        }
+        cl[s] = lift_coeff + flap_gain[s] * control[s];
+        cd[s] = drag_coeff;
+    }
+
+    // --- Pass 3: forces and moments, summed ---
+    float fx = 0.0f, fy = 0.0f, fz = 0.0f;
+    float tx = 0.0f, ty = 0.0f, tz = 0.0f;
+    for (size_t s = 0; s < count; ++s) {
+        float q_area = half_rho * speed_sq[s] * area[s];
+        float lift = cl[s] * q_area;
+        float drag = (cd[s] + cl[s] * cl[s] * induced_factor[s]) * q_area;
+
+        // Lift direction = normalize(cross(-vdir, span))
+        float lx = -(vdir_y[s] * span_z[s] - vdir_z[s] * span_y[s]);
+        float ly = -(vdir_z[s] * span_x[s] - vdir_x[s] * span_z[s]);
+        float lz = -(vdir_x[s] * span_y[s] - vdir_y[s] * span_x[s]);
+        float inv_len = 1.0f / std::sqrt(std::max(lx * lx + ly * ly + lz * lz, 1e-20f));
+        lift *= inv_len;
+
+        float Fx = lx * lift - vdir_x[s] * drag;
+        float Fy = ly * lift - vdir_y[s] * drag;
+        float Fz = lz * lift - vdir_z[s] * drag;
+
+        fx += Fx; fy += Fy; fz += Fz;
+        // Moment about the CG = r x F
+        tx += cop_y[s] * Fz - cop_z[s] * Fy;
+        ty += cop_z[s] * Fx - cop_x[s] * Fz;
+        tz += cop_x[s] * Fy - cop_y[s] * Fx;
+    }
+
+    loads.force_world = body.bodyToWorldDir(glm::vec3(fx, fy, fz));
+    loads.torque_body = glm::vec3(tx, ty, tz);
+    return loads;
+}
@@ -0,0 +1,62 @@
+#ifndef AERO_MODEL_H
+#define AERO_MODEL_H
+
+#include "Atmosphere.h"
+#include "RigidBody.h"
+#include "Wing.h"
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+// "Compiled" form of an aircraft's wing list.
+// compile() bakes every per-surface constant that Wing::applyForces re-derives each
+// step (span/hinge axes, max deflection, induced drag factor, flap lift gain) into
+// flat arrays; evaluate() then runs all surfaces through one loop and returns the
+// summed aerodynamic load. The Wing objects stay the configuration API - recompile
+// after changing their geometry.
+class AeroModel {
+public:
+    struct Loads {
+        glm::vec3 force_world{0.0f};  // Sum of lift + drag (N)
+        glm::vec3 torque_body{0.0f};  // Sum of moments about the CG (N*m)
+    };
+
+    // max_deflection_deg[i] is the full-scale deflection of wings[i]
+    void compile(const std::vector<std::unique_ptr<Wing>>& wings, const std::vector<float>& max_deflection_deg);
+
+    // Pull the current control_input of each wing and update the deflected normals.
+    // Only needs to run when controls change (once per step at most).
+    void updateControls(const std::vector<std::unique_ptr<Wing>>& wings);
+
+    // Aerodynamic load on the body for its current state and the last updateControls().
+    // `air` is sampled once per body per step by the caller and shared by every surface.
+    Loads evaluate(const RigidBody& body, const AtmosphereState& air) const;
+
+    size_t size() const { return count; }
+
+private:
+    size_t count = 0;
+
+    // --- Per-surface constants (body space) ---
+    std::vector<size_t> wing_index;                 // Source wing (surfaces with zero area are skipped)
+    std::vector<const Airfoil*> airfoil;
+    std::vector<float> cop_x, cop_y, cop_z;         // Center of pressure
+    std::vector<float> span_x, span_y, span_z;      // Span axis
+    std::vector<float> normal_x, normal_y, normal_z;// Undeflected normal
+    std::vector<float> axn_x, axn_y, axn_z;         // hinge x normal   (Rodrigues terms for deflecting
+    std::vector<float> ann_x, ann_y, ann_z;         // hinge (hinge.n)   the normal without a quaternion)
+    std::vector<float> area;
+    std::vector<float> chord;                       // Reynolds number length scale
+    std::vector<float> induced_factor;              // 1 / (pi * AR * e), 0 if undefined
+    std::vector<float> flap_gain;                   // sqrt(flap_ratio) * max Cl, 0 without a flap
+    std::vector<float> max_deflection_rad;          // 0 without a flap
+
+    // --- Per-surface control state (updateControls) ---
+    std::vector<float> control;
+    std::vector<float> eff_normal_x, eff_normal_y, eff_normal_z;
+
+    // --- Scratch (evaluate) ---
+    mutable std::vector<float> vdir_x, vdir_y, vdir_z, speed_sq, aoa_deg, cl, cd;
+};
+
+#endif // AERO_MODEL_H
@@ -1,14 +1,18 @@
 #include "Aircraft.h"
-#include "Graphics.h"
-#include "Input.h"
-#include "Shader.h"
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtx/quaternion.hpp>
+#include "Trace.h"
 #include <iostream>
 
-// Define the static Airfoil objects (linked against PhysicsConfig.cpp data)
-Airfoil Aircraft::airfoil_naca0012(PhysicsConfig::NACA_0012_DATA);
-Airfoil Aircraft::airfoil_naca2412(PhysicsConfig::NACA_2412_DATA);
+// Function-local statics: constructed on first call, after PhysicsConfig's data vectors
+// exist (namespace-scope statics in different files have no defined init order)
+const Airfoil& Aircraft::airfoilNACA0012() {
+    static const Airfoil airfoil(PhysicsConfig::NACA_0012_DATA);
+    return airfoil;
+}
+
+const Airfoil& Aircraft::airfoilNACA2412() {
+    static const Airfoil airfoil(PhysicsConfig::NACA_2412_DATA);
+    return airfoil;
+}
 
 
 // Constructor - Initializes RigidBody and Aircraft components
@@ -32,9 +36,25 @@ Aircraft::Aircraft(float aircraft_mass,
 
     // Find control surfaces pointers based on names given during wing creation
     findControlSurfaces();
+    compileAeroModel();
+    atmosphere = Atmosphere::sample(position_world.y);
+}
+
+// Bake the wing list into the flat AeroModel table (max deflection resolved once here)
+void Aircraft::compileAeroModel() {
+    aero.compile(wings, getMaxDeflections());
+    aero.updateControls(wings);
+}
 
-    // Setup the graphical model (same as before)
-    setupModel();
+std::vector<float> Aircraft::getMaxDeflections() const {
+    std::vector<float> max_deflection(wings.size(), 20.0f); // Rough guess for non-control surfaces
+    for (size_t i = 0; i < wings.size(); ++i) {
+        const Wing* wing = wings[i].get();
+        if (wing == elevator) max_deflection[i] = PhysicsConfig::MAX_ELEVATOR_DEFLECTION_DEG;
+        else if (wing == rudder) max_deflection[i] = PhysicsConfig::MAX_RUDDER_DEFLECTION_DEG;
+        else if (wing == left_aileron || wing == right_aileron) max_deflection[i] = PhysicsConfig::MAX_AILERON_DEFLECTION_DEG;
+    }
+    return max_deflection;
 }
 
 // Helper to find wings by name
@@ -52,17 +72,17 @@ void Aircraft::findControlSurfaces() {
 }
 
 
-// Process user input and apply to engine/control surfaces
+// Apply the current control axes to engine/control surfaces
 void Aircraft::processInputs(float dt) {
     // --- Throttle ---
     // Smooth throttle changes slightly? Or direct map? Let's use direct for now.
-    engine.setThrottle(Input::Throttle);
+    engine.setThrottle(controls.throttle);
 
     // --- Control Surfaces ---
-    // Map Input::Pitch, Roll, Yaw (-1 to 1) to wing control inputs
-    float roll_input = Input::Roll;
-    float pitch_input = Input::Pitch;
-    float yaw_input = Input::Yaw;
+    // Map pitch, roll, yaw (-1 to 1) to wing control inputs
+    float roll_input = controls.roll;
+    float pitch_input = controls.pitch;
+    float yaw_input = controls.yaw;
 
     // Ailerons: Roll input affects left and right ailerons differentially
     if (left_aileron) left_aileron->setControlInput(roll_input); // Left aileron up for right roll (+)
@@ -77,36 +97,30 @@ void Aircraft::processInputs(float dt) {
     // Positive yaw input (nose right) means rudder trailing edge goes right = positive control input?
     if (rudder) rudder->setControlInput(yaw_input);
 
+    // Deflected normals for the compiled table
+    aero.updateControls(wings);
 }
 
 
 // Aircraft's main update loop - Overrides RigidBody::update
 void Aircraft::update(float dt) {
+    FS_TRACE_ZONE("Aircraft::update");
     // 1. Process Inputs -> Set Engine Throttle & Wing Controls
     processInputs(dt);
+    atmosphere = Atmosphere::sample(position_world.y); // Held for the whole step (incl. RK4 stages)
 
-    // 2. Apply Engine Force
-    engine.applyForce(this); // 'this' is the RigidBody pointer
-
-    // 3. Apply Aerodynamic Forces from Wings
-    for (const auto& wing : wings) {
-        // Determine max deflection angle based on surface type (rough guess)
-        float max_deflection = 20.0f;
-        if (wing.get() == elevator) max_deflection = PhysicsConfig::MAX_ELEVATOR_DEFLECTION_DEG;
-        else if (wing.get() == rudder) max_deflection = PhysicsConfig::MAX_RUDDER_DEFLECTION_DEG;
-        else if (wing.get() == left_aileron || wing.get() == right_aileron) max_deflection = PhysicsConfig::MAX_AILERON_DEFLECTION_DEG;
-
-        wing->applyForces(this, max_deflection);
-    }
+    // 2. + 3. Apply Engine Force and Aerodynamic Forces from Wings
+    applyForces();
 
     // 4. Call the Base RigidBody Update to Integrate Physics
     RigidBody::update(dt);
 
     // 5. Post-Physics Checks / Clamping (Optional)
     // e.g., limit excessive spin rates, check altitude bounds etc.
-     if (position_world.y < 0.5f && velocity_world.y < 0.0f) {
+     float ground_height = ground ? ground->height(position_world.x, position_world.z) : 0.0f;
+     if (position_world.y < ground_height + 0.5f && velocity_world.y < 0.0f) {
           // Crude ground collision handling (similar to before, but integrated better)
-          position_world.y = 0.5f;
+          position_world.y = ground_height + 0.5f;
           velocity_world.y = 0.0f;
           velocity_world.x *= 0.5f;
           velocity_world.z *= 0.5f;
@@ -115,33 +129,23 @@ void Aircraft::update(float dt) {
 }
 
 
-// Rendering - Uses position_world and orientation_world from RigidBody base
-void Aircraft::render(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos) {
-    if (!Graphics::basicShader || this->VAO == 0) return;
-
-    Graphics::basicShader->use();
-
-    // Model matrix uses RigidBody state
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, position_world);     // Use position_world
-    model = model * glm::toMat4(orientation_world); // Use orientation_world
-    // Optional scaling
-    // model = glm::scale(model, glm::vec3(5.0f)); // Scale model UP if needed
+// Engine thrust + aerodynamic forces for the current state
+void Aircraft::applyForces() {
+    // Engine Force
+    engine.applyForce(this); // 'this' is the RigidBody pointer
 
-    // Set shader uniforms
-    Graphics::basicShader->setMat4("model", model);
-    Graphics::basicShader->setMat4("view", view);
-    Graphics::basicShader->setMat4("projection", projection);
-    Graphics::basicShader->setBool("useTexture", false);
-    Graphics::basicShader->setVec4("objectColor", glm::vec4(0.8f, 0.8f, 0.9f, 1.0f)); // Light grey/white color
-    Graphics::basicShader->setVec3("cameraPos", cameraPos);
+    // Aerodynamic Forces from all surfaces in one pass
+    AeroModel::Loads loads = aero.evaluate(*this, atmosphere);
+    addForceWorld(loads.force_world);
+    addTorqueBody(loads.torque_body);
+}
 
-    // Draw the model
-    glBindVertexArray(this->VAO);
-    glDrawElements(GL_TRIANGLES, 18, GL_UNSIGNED_INT, 0); // Use correct index count for pyramid
-    glBindVertexArray(0);
+bool Aircraft::evaluateForces() {
+    applyForces();
+    return true;
 }
 
+
 // Getters using RigidBody state
 float Aircraft::getSpeed() const {
     return glm::length(velocity_world) * 3.6f; // m/s to km/h
@@ -150,40 +154,3 @@ float Aircraft::getSpeed() const {
 float Aircraft::getAltitude() const {
     return position_world.y; // Directly from RigidBody state
 }
-
-
-// setupModel remains largely the same as before (setting up VAO/VBO/EBO for pyramid)
-void Aircraft::setupModel() {
-    float simple_pyramid_vertices[] = {
-        -0.5f, -0.25f, -0.5f,  0.0f, 0.0f, // 0
-         0.5f, -0.25f, -0.5f,  1.0f, 0.0f, // 1
-         0.5f, -0.25f,  0.5f,  1.0f, 1.0f, // 2
-        -0.5f, -0.25f,  0.5f,  0.0f, 1.0f, // 3
-         0.0f,  0.75f,  0.0f,  0.5f, 0.5f  // 4
-     };
-     unsigned int simple_pyramid_indices[] = {
-        0, 1, 4, 1, 2, 4, 2, 3, 4, 3, 0, 4, // Sides
-        3, 2, 0, 2, 1, 0                      // Base
-     };
-
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(simple_pyramid_vertices), simple_pyramid_vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(simple_pyramid_indices), simple_pyramid_indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    // Note: EBO remains bound to VAO state implicitly
-}
@@ -6,15 +6,21 @@
 #include "Airfoil.h"       // Include Airfoil type definition
 #include "PhysicsConfig.h" // Include PhysicsConfig for defaults etc.
 #include "Wing.h"          // <-- ***** ADDED: Need full Wing definition for unique_ptr *****
+#include "AeroModel.h"     // Compiled wing table evaluated each step
+#include "Heightfield.h"   // Ground height for contact
 #include <vector>
 #include <memory>         // <-- ***** ADDED: For unique_ptr *****
 #include <string>         // For wing names
 
-// Forward declarations
-class Shader;             // Still needed for render function signature
+// Rendering lives in AircraftRenderer so this header (and the physics library) stays free of GL
 
-// Required for GLuint type for rendering members
-#include <GL/glew.h>
+// Pilot/autopilot control axes, applied to the engine and control surfaces every update
+struct ControlInputs {
+    float throttle = 0.0f; // 0.0 to 1.0
+    float pitch = 0.0f;    // -1.0 to 1.0
+    float roll = 0.0f;     // -1.0 to 1.0
+    float yaw = 0.0f;      // -1.0 to 1.0
+};
 
 // --- Type alias for unique pointer to Wing ---
 // Define *before* Aircraft class
@@ -22,14 +28,16 @@ using WingPtr = std::unique_ptr<Wing>; // <-- ***** MOVED & ENSURED Wing.h/memor
 
 // Rename/refactor Aircraft to Airplane conceptually, inherits RigidBody
 class Aircraft : public RigidBody {
-public: // <-- ***** MOVED STATIC AIRFOILS TO PUBLIC *****
-    // Static airfoil objects (defined in Aircraft.cpp, linked against PhysicsConfig.cpp data)
-    // Must be accessible by main.cpp to pass pointers when creating wings.
-    static Airfoil airfoil_naca0012;
-    static Airfoil airfoil_naca2412;
+public:
+    // Shared airfoil tables (built from PhysicsConfig data on first use, so they are safe to
+    // reference from other static initializers). Pass their addresses when creating wings.
+    static const Airfoil& airfoilNACA0012();
+    static const Airfoil& airfoilNACA2412();
 
     // --- Components ---
     Engine engine;
+    ControlInputs controls; // Set by the caller (keyboard, script, replay) before update()
+    const Heightfield* ground = nullptr; // Terrain for ground contact; nullptr = flat ground at y = 0
     std::vector<WingPtr> wings; // Use the WingPtr alias
 
     // Pointers to specific control surfaces for easier access (optional)
@@ -44,28 +52,37 @@ public: // <-- ***** MOVED STATIC AIRFOILS TO PUBLIC *****
              Engine aircraft_engine,
              std::vector<WingPtr> aircraft_wings); // Takes vector of wing unique_ptrs
 
+    // Rebuild the compiled aero table after changing wing geometry/airfoils (called by the constructor)
+    void compileAeroModel();
+    // Full-deflection angle (deg) of each entry in `wings`, by control surface role
+    std::vector<float> getMaxDeflections() const;
+    const AeroModel& getAeroModel() const { return aero; }
+    // Air at the aircraft, sampled once at the start of each update() and shared by all surfaces
+    const AtmosphereState& getAtmosphere() const { return atmosphere; }
+
     // Destructor override if needed (unique_ptr handles wing cleanup automatically)
     virtual ~Aircraft() override = default;
 
     // --- Simulation Update Override ---
     virtual void update(float dt) override;
 
-    // --- Rendering (Keep existing structure) ---
-    void render(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos);
     float getSpeed() const; // km/h
     float getAltitude() const; // meters
 
-private: // <-- ***** KEEP RENDERING/INTERNAL STUFF PRIVATE *****
-    // Rendering resources
-    GLuint VAO = 0;
-    GLuint VBO = 0;
-    GLuint EBO = 0;
+protected:
+    // RK4 stages re-run the engine and wing forces at intermediate states
+    bool evaluateForces() override;
 
-    void setupModel(); // Sets up the VAO/VBO/EBO
+private:
+    AeroModel aero; // Flat per-surface constants baked from `wings`
+    AtmosphereState atmosphere;
 
     // --- Input Processing Helper ---
     void processInputs(float dt);
 
+    // Apply engine thrust and wing aerodynamics (via the compiled AeroModel) for the current state
+    void applyForces();
+
     // Helper to find control surfaces by name during construction
     void findControlSurfaces();
 };
@@ -0,0 +1,71 @@
+#include "AircraftConfig.h"
+#include <algorithm>
+
+namespace {
+
+// Resolves a parameter name to the float it controls. tail_x is handled by the callers
+// because it writes two fields.
+float* lookup(AircraftConfig& config, const std::string& name) {
+    if (name == "mass") return &config.mass;
+    if (name == "thrust") return &config.max_thrust;
+    if (name == "ixx") return &config.inertia[0][0];
+    if (name == "iyy") return &config.inertia[1][1];
+    if (name == "izz") return &config.inertia[2][2];
+
+    size_t dot = name.find('.');
+    if (dot == std::string::npos) return nullptr;
+    std::string surface_name = name.substr(0, dot);
+    std::string field = name.substr(dot + 1);
+
+    SurfaceConfig* surface = nullptr;
+    if (surface_name == "wing") surface = &config.wing;
+    else if (surface_name == "aileron") surface = &config.aileron;
+    else if (surface_name == "elevator") surface = &config.elevator;
+    else if (surface_name == "rudder") surface = &config.rudder;
+    if (!surface) return nullptr;
+
+    if (field == "x") return &surface->position.x;
+    if (field == "y") return &surface->position.y;
+    if (field == "z") return &surface->position.z;
+    if (field == "span") return &surface->span;
+    if (field == "chord") return &surface->chord;
+    return nullptr;
+}
+
+} // namespace
+
+bool AircraftConfig::set(const std::string& name, float value) {
+    if (name == "tail_x") {
+        elevator.position.x = value;
+        rudder.position.x = value;
+        return true;
+    }
+    float* field = lookup(*this, name);
+    if (!field) return false;
+    *field = value;
+    return true;
+}
+
+bool AircraftConfig::get(const std::string& name, float& value) const {
+    if (name == "tail_x") {
+        value = elevator.position.x;
+        return true;
+    }
+    float* field = lookup(const_cast<AircraftConfig&>(*this), name);
+    if (!field) return false;
+    value = *field;
+    return true;
+}
+
+const std::vector<std::string>& AircraftConfig::parameterNames() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> list = {"mass", "thrust", "ixx", "iyy", "izz", "tail_x"};
+        for (const char* surface : {"wing", "aileron", "elevator", "rudder"}) {
+            for (const char* field : {"x", "y", "z", "span", "chord"}) {
+                list.push_back(std::string(surface) + "." + field);
+            }
+        }
+        return list;
+    }();
+    return names;
+}
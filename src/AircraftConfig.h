@@ -0,0 +1,38 @@
+#ifndef AIRCRAFT_CONFIG_H
+#define AIRCRAFT_CONFIG_H
+
+#include "PhysicsConfig.h"
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+// Geometry of one lifting surface, body coords relative to the CG (+X forward, +Y right, +Z down)
+struct SurfaceConfig {
+    glm::vec3 position;
+    float span;  // m
+    float chord; // m
+};
+
+// Runtime airframe description. Defaults reproduce the PhysicsConfig constants; the factory
+// builds an Aircraft from any instance, so parameters can be varied without recompiling.
+// Left/right wings and ailerons are mirrored: only the left (-Y) side is stored.
+struct AircraftConfig {
+    float mass = PhysicsConfig::DEFAULT_MASS;
+    float max_thrust = PhysicsConfig::DEFAULT_THRUST;
+    glm::mat3 inertia = PhysicsConfig::DEFAULT_INERTIA_TENSOR;
+
+    SurfaceConfig wing     = {PhysicsConfig::LEFT_WING_POS,    6.96f, 2.50f};
+    SurfaceConfig aileron  = {PhysicsConfig::LEFT_AILERON_POS, 3.80f, 1.26f};
+    SurfaceConfig elevator = {PhysicsConfig::ELEVATOR_POS,     6.54f, 2.70f};
+    SurfaceConfig rudder   = {PhysicsConfig::RUDDER_POS,       5.31f, 3.10f};
+
+    // --- Named parameters (sweeps, command line) ---
+    // Names: mass, thrust, ixx, iyy, izz, tail_x (elevator and rudder x), and
+    // <surface>.<x|y|z|span|chord> for surface in wing, aileron, elevator, rudder.
+    // Returns false for an unknown name.
+    bool set(const std::string& name, float value);
+    bool get(const std::string& name, float& value) const;
+    static const std::vector<std::string>& parameterNames();
+};
+
+#endif // AIRCRAFT_CONFIG_H
@@ -0,0 +1,46 @@
+#include "AircraftFactory.h"
+#include "PhysicsConfig.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace AircraftFactory {
+
+std::unique_ptr<Aircraft> createAircraft(const AircraftConfig& config) {
+    // --- Wings ---
+    Engine engine(config.max_thrust);
+    std::vector<WingPtr> wings;
+    auto addWing = [&](const std::string& name, const glm::vec3& pos, float span, float chord, const Airfoil* foil, const glm::vec3& normal = PhysicsConfig::BODY_UP, float flapRatio = 0.0f) {
+        if (!foil) throw std::runtime_error("Null airfoil for " + name);
+        wings.push_back(std::make_unique<Wing>(name, pos, span, chord, foil, normal, flapRatio));
+    };
+    auto mirrored = [](const glm::vec3& p) { return glm::vec3(p.x, -p.y, p.z); };
+    const SurfaceConfig& wing = config.wing;
+    const SurfaceConfig& aileron = config.aileron;
+    const SurfaceConfig& elevator = config.elevator;
+    const SurfaceConfig& rudder = config.rudder;
+    addWing("Left Wing",       wing.position,              wing.span,     wing.chord,     &Aircraft::airfoilNACA2412());
+    addWing("Right Wing",      mirrored(wing.position),    wing.span,     wing.chord,     &Aircraft::airfoilNACA2412());
+    addWing("Left Aileron",    aileron.position,           aileron.span,  aileron.chord,  &Aircraft::airfoilNACA0012(), PhysicsConfig::BODY_UP, 1.0f);
+    addWing("Right Aileron",   mirrored(aileron.position), aileron.span,  aileron.chord,  &Aircraft::airfoilNACA0012(), PhysicsConfig::BODY_UP, 1.0f);
+    addWing("Elevator",        elevator.position,          elevator.span, elevator.chord, &Aircraft::airfoilNACA0012(), PhysicsConfig::BODY_UP, 1.0f);
+    addWing("Rudder",          rudder.position,            rudder.span,   rudder.chord,   &Aircraft::airfoilNACA0012(), PhysicsConfig::BODY_RIGHT, 1.0f);
+
+    // --- Airframe ---
+    auto aircraft = std::make_unique<Aircraft>(
+        config.mass,
+        config.inertia,
+        engine,
+        std::move(wings)
+    );
+    aircraft->position_world = glm::vec3(0.0f, 1000.0f, 0.0f);
+    aircraft->velocity_world = glm::vec3(180.0f, 0.0f, 0.0f);
+    aircraft->orientation_world = glm::quatLookAt(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return aircraft;
+}
+
+std::unique_ptr<Aircraft> createDefaultAircraft() {
+    return createAircraft(AircraftConfig{});
+}
+
+} // namespace AircraftFactory
@@ -0,0 +1,20 @@
+#ifndef AIRCRAFT_FACTORY_H
+#define AIRCRAFT_FACTORY_H
+
+#include "Aircraft.h"
+#include "AircraftConfig.h"
+#include <memory>
+
+// Builds the default airframe (wings, control surfaces, engine) shared by the
+// windowed simulator, the headless runner and the benchmarks.
+namespace AircraftFactory {
+
+    // Aircraft built from `config`, in level flight at 1000 m, 180 m/s heading along world +X
+    std::unique_ptr<Aircraft> createAircraft(const AircraftConfig& config);
+
+    // createAircraft(AircraftConfig{}): the PhysicsConfig airframe
+    std::unique_ptr<Aircraft> createDefaultAircraft();
+
+} // namespace AircraftFactory
+
+#endif // AIRCRAFT_FACTORY_H
@@ -0,0 +1,81 @@
+#include "AircraftRenderer.h"
+#include "Aircraft.h"
+#include "Graphics.h"
+#include "Shader.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+AircraftRenderer::AircraftRenderer() {
+    setupModel();
+}
+
+AircraftRenderer::~AircraftRenderer() {
+    if (VAO != 0) glDeleteVertexArrays(1, &VAO);
+    if (VBO != 0) glDeleteBuffers(1, &VBO);
+    if (EBO != 0) glDeleteBuffers(1, &EBO);
+}
+
+// Rendering - Uses position_world and orientation_world from RigidBody base
+void AircraftRenderer::render(const Aircraft& aircraft) const {
+    render(aircraft.position_world, aircraft.orientation_world);
+}
+
+void AircraftRenderer::render(const glm::vec3& renderPosition, const glm::quat& renderOrientation) const {
+    if (!Graphics::basicShader || this->VAO == 0) return;
+
+    Graphics::basicShader->use();
+
+    // Model matrix uses the render pose (RigidBody state, or interpolated between steps)
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, renderPosition);
+    model = model * glm::toMat4(renderOrientation);
+    // Optional scaling
+    // model = glm::scale(model, glm::vec3(5.0f)); // Scale model UP if needed
+
+    // Set shader uniforms (view/projection/camera/fog are in FrameData)
+    Graphics::basicShader->setMat4("model", model);
+    Graphics::basicShader->setBool("useTexture", false);
+    Graphics::basicShader->setVec4("objectColor", glm::vec4(0.8f, 0.8f, 0.9f, 1.0f)); // Light grey/white color
+
+    // Draw the model
+    glBindVertexArray(this->VAO);
+    glDrawElements(GL_TRIANGLES, 18, GL_UNSIGNED_INT, 0); // Use correct index count for pyramid
+    glBindVertexArray(0);
+    Graphics::basicShader->use(false);
+}
+
+// setupModel remains largely the same as before (setting up VAO/VBO/EBO for pyramid)
+void AircraftRenderer::setupModel() {
+    float simple_pyramid_vertices[] = {
+        -0.5f, -0.25f, -0.5f,  0.0f, 0.0f, // 0
+         0.5f, -0.25f, -0.5f,  1.0f, 0.0f, // 1
+         0.5f, -0.25f,  0.5f,  1.0f, 1.0f, // 2
+        -0.5f, -0.25f,  0.5f,  0.0f, 1.0f, // 3
+         0.0f,  0.75f,  0.0f,  0.5f, 0.5f  // 4
+     };
+     unsigned int simple_pyramid_indices[] = {
+        0, 1, 4, 1, 2, 4, 2, 3, 4, 3, 0, 4, // Sides
+        3, 2, 0, 2, 1, 0                      // Base
+     };
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(simple_pyramid_vertices), simple_pyramid_vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(simple_pyramid_indices), simple_pyramid_indices, GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    // Note: EBO remains bound to VAO state implicitly
+}
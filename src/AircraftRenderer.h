@@ -0,0 +1,35 @@
+#ifndef AIRCRAFT_RENDERER_H
+#define AIRCRAFT_RENDERER_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <GL/glew.h>
+
+class Aircraft;
+
+// GL side of the aircraft: owns the mesh and draws it with Graphics::basicShader.
+// Kept separate from Aircraft so the flight model builds without a graphics context.
+class AircraftRenderer {
+public:
+    AircraftRenderer();  // Requires a current GL context
+    ~AircraftRenderer();
+
+    AircraftRenderer(const AircraftRenderer&) = delete;
+    AircraftRenderer& operator=(const AircraftRenderer&) = delete;
+
+    // Camera, projection and fog come from the shared FrameData block (Graphics::setFrameData)
+    // Render at the aircraft's current physics pose
+    void render(const Aircraft& aircraft) const;
+    // Render at an explicit pose (e.g. interpolated between physics steps by PhysicsScheduler)
+    void render(const glm::vec3& renderPosition, const glm::quat& renderOrientation) const;
+
+private:
+    // Rendering resources
+    GLuint VAO = 0;
+    GLuint VBO = 0;
+    GLuint EBO = 0;
+
+    void setupModel(); // Sets up the VAO/VBO/EBO
+};
+
+#endif // AIRCRAFT_RENDERER_H
@@ -1,60 +1,383 @@
 #include "Airfoil.h"
+#include "SimdLane.h"
 #include <stdexcept> // For exceptions
 #include <limits>    // For numeric_limits
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
 
-Airfoil::Airfoil(const std::vector<glm::vec3>& curveData) : data(curveData) {
-    if (data.empty()) {
-        throw std::runtime_error("Airfoil data cannot be empty.");
-    }
-    min_alpha_deg = data.front().x;
-    max_alpha_deg = data.back().x;
-    // Optional: Add check for sorted data here
-}
+namespace {
 
-std::tuple<float, float> Airfoil::sample(float alpha_deg) const {
-    // Clamp alpha to the range of the data
-    alpha_deg = std::clamp(alpha_deg, min_alpha_deg, max_alpha_deg);
+const char TABLE_MAGIC[4] = {'F', 'S', 'A', 'F'};
+const uint32_t TABLE_VERSION = 1;
+// Sanity limits for counts read from a cached table (far above any real polar set)
+const uint32_t MAX_TABLE_ALPHAS = 1u << 16;
+const uint32_t MAX_TABLE_AXIS = 256;
 
-    // Find the first data point whose alpha is not less than the input alpha
+// Piecewise-linear lookup into sorted source points (the original sampling method),
+// used to resample each polar onto the uniform grid
+glm::vec2 interpolatePoints(const std::vector<glm::vec3>& data, float alpha_deg) {
+    alpha_deg = std::clamp(alpha_deg, data.front().x, data.back().x);
     auto it = std::lower_bound(data.begin(), data.end(), alpha_deg,
                                [](const glm::vec3& point, float alpha) {
                                    return point.x < alpha;
                                });
+    if (it == data.begin()) return {it->y, it->z};
+    if (it == data.end()) return {data.back().y, data.back().z};
+
+    const glm::vec3& p1 = *(it - 1);
+    const glm::vec3& p2 = *it;
+    if (std::abs(p2.x - p1.x) < 1e-6f) return {p1.y, p1.z};
+
+    float t = (alpha_deg - p1.x) / (p2.x - p1.x);
+    return {p1.y + t * (p2.y - p1.y), p1.z + t * (p2.z - p1.z)};
+}
+
+// Index and weight along a small ascending axis, clamped to its ends
+void axisLookup(const std::vector<float>& axis, float value, size_t& index, float& t) {
+    if (axis.size() < 2 || value <= axis.front()) { index = 0; t = 0.0f; return; }
+    if (value >= axis.back()) { index = axis.size() - 2; t = 1.0f; return; }
+    index = 0;
+    while (index + 2 < axis.size() && value >= axis[index + 1]) ++index;
+    t = (value - axis[index]) / (axis[index + 1] - axis[index]);
+}
 
-    // Handle edge cases: alpha is exactly the first or last point, or outside range (already clamped)
-    if (it == data.begin()) {
-        return {it->y, it->z}; // Return first point's Cl, Cd
+// Append the sorted unique value to an axis
+void addAxisValue(std::vector<float>& axis, float value) {
+    for (float v : axis) {
+        if (std::abs(v - value) < 1e-6f) return;
     }
-    if (it == data.end()) {
-        return {(data.end() - 1)->y, (data.end() - 1)->z}; // Return last point's Cl, Cd
+    axis.insert(std::upper_bound(axis.begin(), axis.end(), value), value);
+}
+
+size_t axisIndex(const std::vector<float>& axis, float value) {
+    for (size_t i = 0; i < axis.size(); ++i) {
+        if (std::abs(axis[i] - value) < 1e-6f) return i;
     }
+    return axis.size();
+}
 
-    // Linear interpolation between the point before 'it' and 'it'
-    const glm::vec3& p1 = *(it - 1); // Point before or equal to alpha
-    const glm::vec3& p2 = *it;       // Point after alpha
+float log10Reynolds(float reynolds) {
+    return std::log10(std::max(reynolds, 1.0f));
+}
 
-    // Avoid division by zero if data points have same alpha
-    if (std::abs(p2.x - p1.x) < 1e-6f) {
-        return {p1.y, p1.z}; // or p2, doesn't matter much
+// FNV-1a over the source files, so the cache is rebuilt whenever any of them changes
+uint64_t hashSources(const std::vector<std::string>& paths, float alpha_step_deg) {
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](const char* bytes, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<uint8_t>(bytes[i]);
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(reinterpret_cast<const char*>(&alpha_step_deg), sizeof(float));
+    for (const auto& path : paths) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) throw std::runtime_error("Failed to open polar file: " + path);
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        const std::string& s = contents.str();
+        mix(s.data(), s.size());
+        mix("\0", 1); // File separator
     }
+    return hash;
+}
 
-    // Calculate interpolation factor (t)
-    float t = (alpha_deg - p1.x) / (p2.x - p1.x);
+template <typename T>
+void writeRaw(std::ofstream& out, const T* data, size_t count) {
+    out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(sizeof(T) * count));
+}
+
+template <typename T>
+bool readRaw(std::ifstream& in, T* data, size_t count) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(sizeof(T) * count)));
+}
+
+} // namespace
+
+Airfoil::Airfoil(const std::vector<glm::vec3>& curveData, float alpha_step_deg) {
+    Polar polar;
+    polar.points = curveData;
+    build({polar}, alpha_step_deg);
+}
+
+Airfoil::Airfoil(const std::vector<Polar>& polars, float alpha_step_deg) {
+    build(polars, alpha_step_deg);
+}
+
+void Airfoil::build(std::vector<Polar> polars, float alpha_step_deg) {
+    if (polars.empty()) {
+        throw std::runtime_error("Airfoil data cannot be empty.");
+    }
+    if (!(alpha_step_deg > 0.0f)) {
+        throw std::runtime_error("Airfoil alpha step must be positive.");
+    }
+
+    // --- Axes ---
+    float lo = std::numeric_limits<float>::infinity();
+    float hi = -std::numeric_limits<float>::infinity();
+    re_axis.clear();
+    mach_axis.clear();
+    for (auto& polar : polars) {
+        if (polar.points.empty()) {
+            throw std::runtime_error("Airfoil data cannot be empty.");
+        }
+        std::stable_sort(polar.points.begin(), polar.points.end(),
+                         [](const glm::vec3& a, const glm::vec3& b) { return a.x < b.x; });
+        lo = std::min(lo, polar.points.front().x);
+        hi = std::max(hi, polar.points.back().x);
+        addAxisValue(re_axis, log10Reynolds(polar.reynolds));
+        addAxisValue(mach_axis, polar.mach);
+    }
+    if (polars.size() != re_axis.size() * mach_axis.size()) {
+        throw std::runtime_error("Airfoil polars must cover every Reynolds/Mach combination exactly once.");
+    }
+
+    // --- Uniform alpha grid covering every polar (shorter polars hold their end values) ---
+    alpha_step = alpha_step_deg;
+    inv_alpha_step = 1.0f / alpha_step;
+    alpha_min = lo;
+    alpha_count = std::max<size_t>(2, static_cast<size_t>(std::ceil((hi - lo) * inv_alpha_step - 1e-4f)) + 1);
+
+    size_t slice_count = re_axis.size() * mach_axis.size();
+    cl_table.assign(slice_count * alpha_count, 0.0f);
+    cd_table.assign(slice_count * alpha_count, 0.0f);
+    std::vector<bool> filled(slice_count, false);
+
+    for (const auto& polar : polars) {
+        size_t r = axisIndex(re_axis, log10Reynolds(polar.reynolds));
+        size_t m = axisIndex(mach_axis, polar.mach);
+        size_t slice = m * re_axis.size() + r;
+        if (filled[slice]) {
+            throw std::runtime_error("Airfoil polars must cover every Reynolds/Mach combination exactly once.");
+        }
+        filled[slice] = true;
+
+        float* cl = &cl_table[slice * alpha_count];
+        float* cd = &cd_table[slice * alpha_count];
+        for (size_t i = 0; i < alpha_count; ++i) {
+            glm::vec2 c = interpolatePoints(polar.points, alpha_min + alpha_step * static_cast<float>(i));
+            cl[i] = c.x;
+            cd[i] = c.y;
+        }
+    }
+
+    // First polar in (Re, Mach) order is the default slice; keep its raw points for reference
+    for (const auto& polar : polars) {
+        if (axisIndex(re_axis, log10Reynolds(polar.reynolds)) == 0 && axisIndex(mach_axis, polar.mach) == 0) {
+            source_points = polar.points;
+        }
+    }
+
+    // Simplistic: just find max value in data. A more robust way might involve curve fitting.
+    max_cl = *std::max_element(cl_table.begin(), cl_table.begin() + static_cast<std::ptrdiff_t>(alpha_count));
+}
 
-    // Interpolate Cl and Cd
-    float Cl = p1.y + t * (p2.y - p1.y);
-    float Cd = p1.z + t * (p2.z - p1.z);
+void Airfoil::sampleSlice(size_t slice, float alpha_deg, float& cl, float& cd) const {
+    // Grid coordinate, clamped so i and i + 1 are always valid
+    float x = std::clamp((alpha_deg - alpha_min) * inv_alpha_step, 0.0f, static_cast<float>(alpha_count - 1));
+    size_t i = std::min(static_cast<size_t>(x), alpha_count - 2);
+    float t = x - static_cast<float>(i);
 
-    return {Cl, Cd};
+    const float* c_l = &cl_table[slice * alpha_count + i];
+    const float* c_d = &cd_table[slice * alpha_count + i];
+    cl = c_l[0] + t * (c_l[1] - c_l[0]);
+    cd = c_d[0] + t * (c_d[1] - c_d[0]);
 }
 
-float Airfoil::getMaxCl() const {
-     // Simplistic: just find max value in data. A more robust way might involve curve fitting.
-     float maxCl = -std::numeric_limits<float>::infinity();
-     for(const auto& point : data) {
-         if (point.y > maxCl) {
-             maxCl = point.y;
-         }
-     }
-     return (maxCl > -std::numeric_limits<float>::infinity()) ? maxCl : 1.5f; // Return default if no data
+std::tuple<float, float> Airfoil::sample(float alpha_deg) const {
+    float cl, cd;
+    sampleSlice(0, alpha_deg, cl, cd);
+    return {cl, cd};
+}
+
+std::tuple<float, float> Airfoil::sample(float alpha_deg, float reynolds, float mach) const {
+    if (!hasReynoldsMach()) return sample(alpha_deg);
+
+    size_t r, m;
+    float tr, tm;
+    axisLookup(re_axis, log10Reynolds(reynolds), r, tr);
+    axisLookup(mach_axis, mach, m, tm);
+    size_t r1 = std::min(r + 1, re_axis.size() - 1);
+    size_t m1 = std::min(m + 1, mach_axis.size() - 1);
+    size_t n_re = re_axis.size();
+
+    float cl00, cd00, cl01, cd01, cl10, cd10, cl11, cd11;
+    sampleSlice(m * n_re + r, alpha_deg, cl00, cd00);
+    sampleSlice(m * n_re + r1, alpha_deg, cl01, cd01);
+    sampleSlice(m1 * n_re + r, alpha_deg, cl10, cd10);
+    sampleSlice(m1 * n_re + r1, alpha_deg, cl11, cd11);
+
+    float cl0 = cl00 + tr * (cl01 - cl00), cl1 = cl10 + tr * (cl11 - cl10);
+    float cd0 = cd00 + tr * (cd01 - cd00), cd1 = cd10 + tr * (cd11 - cd10);
+    return {cl0 + tm * (cl1 - cl0), cd0 + tm * (cd1 - cd0)};
+}
+
+void Airfoil::sampleBatch(const float* alpha_deg, float* cl, float* cd, size_t count) const {
+    using namespace lane;
+    const Lane lo = splat(alpha_min);
+    const Lane inv_step = splat(inv_alpha_step);
+    const Lane zero = splat(0.0f);
+    const Lane x_max = splat(static_cast<float>(alpha_count - 1));
+    const Lane i_max = splat(static_cast<float>(alpha_count - 2));
+    const float* c_l = cl_table.data();
+    const float* c_d = cd_table.data();
+
+    size_t vector_end = count - (count % SIMD_WIDTH);
+    int32_t idx[SIMD_WIDTH];
+    alignas(32) float l0[SIMD_WIDTH], l1[SIMD_WIDTH], d0[SIMD_WIDTH], d1[SIMD_WIDTH];
+    for (size_t n = 0; n < vector_end; n += SIMD_WIDTH) {
+        Lane x = min(max(mul(sub(load(alpha_deg + n), lo), inv_step), zero), x_max);
+        Lane fi = min(floor(x), i_max);
+        Lane t = sub(x, fi);
+        toIndices(idx, fi);
+
+        // Gather the two bracketing entries per lane
+        for (size_t k = 0; k < SIMD_WIDTH; ++k) {
+            l0[k] = c_l[idx[k]]; l1[k] = c_l[idx[k] + 1];
+            d0[k] = c_d[idx[k]]; d1[k] = c_d[idx[k] + 1];
+        }
+        Lane a = load(l0), b = load(d0);
+        store(cl + n, add(a, mul(t, sub(load(l1), a))));
+        store(cd + n, add(b, mul(t, sub(load(d1), b))));
+    }
+
+    // Remainder
+    for (size_t n = vector_end; n < count; ++n) {
+        sampleSlice(0, alpha_deg[n], cl[n], cd[n]);
+    }
+}
+
+// --- Polar Files ---
+
+Airfoil::Polar Airfoil::parsePolarFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Failed to open polar file: " + path);
+
+    Polar polar;
+    std::string line;
+    while (std::getline(file, line)) {
+        // XFOIL header: " Mach =   0.000     Re =     1.000 e 6     Ncrit =   9.000"
+        size_t mach_pos = line.find("Mach =");
+        size_t re_pos = line.find("Re =");
+        if (mach_pos != std::string::npos) {
+            polar.mach = std::strtof(line.c_str() + mach_pos + 6, nullptr);
+        }
+        if (re_pos != std::string::npos) {
+            size_t end = line.find("Ncrit", re_pos);
+            std::string number;
+            for (size_t i = re_pos + 4; i < std::min(end, line.size()); ++i) {
+                if (line[i] != ' ') number += line[i]; // "1.000 e 6" -> "1.000e6"
+            }
+            polar.reynolds = std::strtof(number.c_str(), nullptr);
+            continue;
+        }
+
+        // Data rows: first three columns are alpha, Cl, Cd (whitespace or comma separated)
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream row(line);
+        glm::vec3 point;
+        if (row >> point.x >> point.y >> point.z) {
+            polar.points.push_back(point);
+        }
+    }
+
+    if (polar.points.size() < 2) {
+        throw std::runtime_error("Polar file has fewer than two data rows: " + path);
+    }
+    std::stable_sort(polar.points.begin(), polar.points.end(),
+                     [](const glm::vec3& a, const glm::vec3& b) { return a.x < b.x; });
+    return polar;
+}
+
+Airfoil Airfoil::loadPolarFiles(const std::vector<std::string>& paths, const std::string& cache_path, float alpha_step_deg) {
+    if (paths.empty()) throw std::runtime_error("No polar files given.");
+
+    uint64_t hash = hashSources(paths, alpha_step_deg);
+    if (!cache_path.empty()) {
+        Airfoil cached;
+        uint64_t cached_hash = 0;
+        if (loadBinary(cache_path, cached, &cached_hash) && cached_hash == hash) {
+            return cached;
+        }
+    }
+
+    std::vector<Polar> polars;
+    for (const auto& path : paths) polars.push_back(parsePolarFile(path));
+    Airfoil airfoil(polars, alpha_step_deg);
+
+    if (!cache_path.empty() && !airfoil.saveBinary(cache_path, hash)) {
+        std::cerr << "Warning: Could not write airfoil cache: " << cache_path << std::endl;
+    }
+    return airfoil;
+}
+
+bool Airfoil::saveBinary(const std::string& path, uint64_t source_hash) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    uint32_t header[4] = {TABLE_VERSION, static_cast<uint32_t>(alpha_count),
+                          static_cast<uint32_t>(re_axis.size()), static_cast<uint32_t>(mach_axis.size())};
+    uint32_t source_count = static_cast<uint32_t>(source_points.size());
+    out.write(TABLE_MAGIC, 4);
+    writeRaw(out, header, 4);
+    writeRaw(out, &source_hash, 1);
+    writeRaw(out, &alpha_min, 1);
+    writeRaw(out, &alpha_step, 1);
+    writeRaw(out, &max_cl, 1);
+    writeRaw(out, re_axis.data(), re_axis.size());
+    writeRaw(out, mach_axis.data(), mach_axis.size());
+    writeRaw(out, cl_table.data(), cl_table.size());
+    writeRaw(out, cd_table.data(), cd_table.size());
+    writeRaw(out, &source_count, 1);
+    writeRaw(out, source_points.data(), source_points.size());
+    return static_cast<bool>(out);
+}
+
+bool Airfoil::loadBinary(const std::string& path, Airfoil& out, uint64_t* source_hash) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    in.seekg(0, std::ios::end);
+    const uint64_t file_size = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+
+    char magic[4];
+    uint32_t header[4];
+    uint64_t hash = 0;
+    Airfoil a;
+    if (!in.read(magic, 4) || std::memcmp(magic, TABLE_MAGIC, 4) != 0 ||
+        !readRaw(in, header, 4) || header[0] != TABLE_VERSION || header[1] < 2 || header[1] > MAX_TABLE_ALPHAS ||
+        header[2] == 0 || header[2] > MAX_TABLE_AXIS || header[3] == 0 || header[3] > MAX_TABLE_AXIS ||
+        !readRaw(in, &hash, 1) || !readRaw(in, &a.alpha_min, 1) || !readRaw(in, &a.alpha_step, 1) || !readRaw(in, &a.max_cl, 1) ||
+        !(a.alpha_step > 0.0f)) {
+        return false;
+    }
+
+    // The axes and both tables must fit in what is left of the file before anything is sized
+    const uint64_t cells = static_cast<uint64_t>(header[1]) * header[2] * header[3];
+    uint64_t remaining = file_size - static_cast<uint64_t>(in.tellg());
+    if ((static_cast<uint64_t>(header[2]) + header[3] + 2 * cells) * sizeof(float) + sizeof(uint32_t) > remaining) return false;
+
+    a.alpha_count = header[1];
+    a.inv_alpha_step = 1.0f / a.alpha_step;
+    a.re_axis.resize(header[2]);
+    a.mach_axis.resize(header[3]);
+    a.cl_table.resize(static_cast<size_t>(cells));
+    a.cd_table.resize(a.cl_table.size());
+    uint32_t source_count = 0;
+    if (!readRaw(in, a.re_axis.data(), a.re_axis.size()) || !readRaw(in, a.mach_axis.data(), a.mach_axis.size()) ||
+        !readRaw(in, a.cl_table.data(), a.cl_table.size()) || !readRaw(in, a.cd_table.data(), a.cd_table.size()) ||
+        !readRaw(in, &source_count, 1)) {
+        return false;
+    }
+    remaining = file_size - static_cast<uint64_t>(in.tellg());
+    if (static_cast<uint64_t>(source_count) * sizeof(glm::vec3) > remaining) return false;
+    a.source_points.resize(source_count);
+    if (!readRaw(in, a.source_points.data(), a.source_points.size())) return false;
+
+    out = std::move(a);
+    if (source_hash) *source_hash = hash;
+    return true;
 }
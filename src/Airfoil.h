@@ -3,26 +3,84 @@
 
 #include <vector>
 #include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
 #include <tuple> // For std::tuple
-#include <algorithm> // For std::lower_bound, std::clamp
+#include <algorithm> // For std::clamp
 #include "PhysicsConfig.h" // For sq function maybe, or move helpers
 
+// Lift/drag polar table. The airfoil owns its data: input points are resampled onto
+// a uniform alpha grid at construction, so sample() is an O(1) index + lerp with no
+// search or branches. Optionally the table has Reynolds number and Mach dimensions
+// (one polar per grid point), interpolated linearly in log10(Re) and Mach.
 class Airfoil {
 public:
-    // Data points are expected as { alpha_degrees, Cl, Cd } sorted by alpha
-    Airfoil(const std::vector<glm::vec3>& curveData);
+    // One polar: { alpha_degrees, Cl, Cd } points measured at a Reynolds number and Mach
+    struct Polar {
+        float reynolds = 0.0f;
+        float mach = 0.0f;
+        std::vector<glm::vec3> points;
+    };
 
-    // Get Cl and Cd for a given angle of attack (alpha) in degrees.
-    // Uses linear interpolation between known data points.
+    static constexpr float DEFAULT_ALPHA_STEP_DEG = 0.25f;
+
+    // Data points are expected as { alpha_degrees, Cl, Cd } sorted by alpha. The data is copied.
+    explicit Airfoil(const std::vector<glm::vec3>& curveData, float alpha_step_deg = DEFAULT_ALPHA_STEP_DEG);
+    // Polars covering a full Reynolds x Mach grid (any order)
+    explicit Airfoil(const std::vector<Polar>& polars, float alpha_step_deg = DEFAULT_ALPHA_STEP_DEG);
+
+    // --- Loading ---
+    // Polar text files (XFOIL/XFLR5 output or plain "alpha Cl Cd" columns), one per Re/Mach.
+    // With a cache_path, the resampled table is stored in binary form and reused while the
+    // source files are unchanged. Throws std::runtime_error if the files cannot be used.
+    static Airfoil loadPolarFiles(const std::vector<std::string>& paths, const std::string& cache_path = "",
+                                  float alpha_step_deg = DEFAULT_ALPHA_STEP_DEG);
+    static Polar parsePolarFile(const std::string& path);
+
+    // Binary form of the resampled table (see loadPolarFiles)
+    bool saveBinary(const std::string& path, uint64_t source_hash = 0) const;
+    static bool loadBinary(const std::string& path, Airfoil& out, uint64_t* source_hash = nullptr);
+
+    // --- Sampling ---
+    // Cl and Cd at alpha (degrees), clamped to the table range. Multi-dimensional tables
+    // use their first (lowest Re, lowest Mach) polar here.
     std::tuple<float, float> sample(float alpha_deg) const;
+    // Cl and Cd at alpha, Reynolds number and Mach (each clamped to the table)
+    std::tuple<float, float> sample(float alpha_deg, float reynolds, float mach) const;
+    // sample(alpha) for `count` angles at once (SIMD)
+    void sampleBatch(const float* alpha_deg, float* cl, float* cd, size_t count) const;
 
-    // Find max Cl (useful for flaps) - simplistic implementation
-    float getMaxCl() const;
+    // Max Cl over the table (useful for flaps) - computed once at construction
+    float getMaxCl() const { return max_cl; }
+
+    // --- Table Info ---
+    bool hasReynoldsMach() const { return re_axis.size() > 1 || mach_axis.size() > 1; }
+    float getAlphaMin() const { return alpha_min; }
+    float getAlphaMax() const { return alpha_min + alpha_step * static_cast<float>(alpha_count - 1); }
+    float getAlphaStep() const { return alpha_step; }
+    size_t getAlphaCount() const { return alpha_count; }
+    // Original points of the first polar (before resampling)
+    const std::vector<glm::vec3>& getSourcePoints() const { return source_points; }
 
 private:
-    const std::vector<glm::vec3>& data; // Reference to the constant data
-    float min_alpha_deg;
-    float max_alpha_deg;
+    Airfoil() = default; // For loadBinary
+
+    // --- Uniform grid ---
+    float alpha_min = 0.0f;
+    float alpha_step = DEFAULT_ALPHA_STEP_DEG;
+    float inv_alpha_step = 1.0f / DEFAULT_ALPHA_STEP_DEG;
+    size_t alpha_count = 0;
+    std::vector<float> re_axis;   // log10(Re), ascending
+    std::vector<float> mach_axis; // Ascending
+    // Tables indexed [mach][re][alpha]
+    std::vector<float> cl_table;
+    std::vector<float> cd_table;
+
+    float max_cl = 0.0f;
+    std::vector<glm::vec3> source_points;
+
+    void build(std::vector<Polar> polars, float alpha_step_deg);
+    void sampleSlice(size_t slice, float alpha_deg, float& cl, float& cd) const;
 };
 
 #endif // AIRFOIL_H
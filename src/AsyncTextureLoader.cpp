@@ -0,0 +1,282 @@
+#include "AsyncTextureLoader.h"
+#include "BakedTexture.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <stb_image.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// Same channel -> format mapping as Texture::loadTexture, plus single-channel float
+bool pixelFormat(int channels, GLenum type, GLenum& internal_format, GLenum& data_format) {
+    if (type == GL_FLOAT) {
+        internal_format = GL_R32F;
+        data_format = GL_RED;
+        return channels == 1;
+    }
+    if (type != GL_UNSIGNED_BYTE) return false;
+    switch (channels) {
+        case 1: internal_format = GL_RED; data_format = GL_RED; return true;
+        case 3: internal_format = GL_RGB; data_format = GL_RGB; return true;
+        case 4: internal_format = GL_RGBA; data_format = GL_RGBA; return true;
+        default: return false;
+    }
+}
+
+} // namespace
+
+AsyncTextureLoader::AsyncTextureLoader() : AsyncTextureLoader(Options()) {}
+
+AsyncTextureLoader::AsyncTextureLoader(Options opts) : options(opts) {
+    options.decode_threads = std::max<size_t>(options.decode_threads, 1);
+    options.pbo_count = std::max<size_t>(options.pbo_count, 1);
+    options.pbo_bytes = std::max<size_t>(options.pbo_bytes, 64u << 10);
+    pool = std::make_unique<ThreadPool>(options.decode_threads);
+
+    ring.resize(options.pbo_count);
+    for (PixelBuffer& pbo : ring) {
+        glGenBuffers(1, &pbo.buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(options.pbo_bytes), nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+AsyncTextureLoader::~AsyncTextureLoader() {
+    pool.reset(); // Runs the remaining decodes; their results are dropped with `decoded`
+    for (PixelBuffer& pbo : ring) {
+        if (pbo.fence) glDeleteSync(pbo.fence);
+        if (pbo.buffer) glDeleteBuffers(1, &pbo.buffer);
+    }
+}
+
+std::shared_ptr<TextureUploadStatus> AsyncTextureLoader::loadFile(GLuint texture, const std::string& path, const GLUtil::TextureParams& params) {
+    auto job = std::make_shared<Job>();
+    job->texture = texture;
+    job->path = path;
+    job->params = params;
+    job->status = std::make_shared<TextureUploadStatus>();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++decoding;
+    }
+    pool->submit([this, job]() { decode(job); });
+    return job->status;
+}
+
+std::shared_ptr<TextureUploadStatus> AsyncTextureLoader::loadPixels(GLuint texture, int width, int height, int channels,
+                                                                    std::shared_ptr<const uint8_t> pixels, const GLUtil::TextureParams& params,
+                                                                    GLenum type) {
+    auto job = std::make_shared<Job>();
+    job->texture = texture;
+    job->params = params;
+    job->status = std::make_shared<TextureUploadStatus>();
+    if (width <= 0 || height <= 0 || channels <= 0) {
+        std::cerr << "Warning: Rejected " << width << "x" << height << "x" << channels << " texture upload" << std::endl;
+        job->status->failed = true;
+        ++stats.failed;
+        return job->status;
+    }
+    job->width = width;
+    job->height = height;
+    job->channels = channels;
+    job->type = type;
+    job->pixels = std::move(pixels);
+    uploads.push_back(job);
+    return job->status;
+}
+
+std::shared_ptr<TextureUploadStatus> AsyncTextureLoader::loadBaked(GLuint texture, std::shared_ptr<const BakedTexture> baked,
+                                                                   const GLUtil::TextureParams& params) {
+    auto job = std::make_shared<Job>();
+    job->texture = texture;
+    job->path = baked->getPath();
+    job->params = params;
+    job->status = std::make_shared<TextureUploadStatus>();
+    job->width = baked->getWidth();
+    job->height = baked->getHeight();
+    job->channels = baked->getChannels();
+    job->baked = std::move(baked);
+    uploads.push_back(job);
+    return job->status;
+}
+
+// --- Pool thread ---
+void AsyncTextureLoader::decode(const std::shared_ptr<Job>& job) {
+    FS_TRACE_ZONE("texture decode");
+    stbi_set_flip_vertically_on_load_thread(1); // OpenGL row order, as Texture loads
+    int w = 0, h = 0, channels = 0;
+    unsigned char* data = stbi_load(job->path.c_str(), &w, &h, &channels, 0);
+    if (data) {
+        job->width = w;
+        job->height = h;
+        job->channels = channels;
+        job->pixels = std::shared_ptr<const uint8_t>(data, [](const uint8_t* p) { stbi_image_free(const_cast<uint8_t*>(p)); });
+    } else {
+        std::cerr << "Error: Failed to load texture data from: " << job->path << std::endl;
+        std::cerr << "STB Reason: " << stbi_failure_reason() << std::endl;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    decoded.push_back(job);
+    --decoding;
+}
+
+// --- GL thread ---
+void AsyncTextureLoader::update() {
+    FS_TRACE_ZONE("AsyncTextureLoader::update");
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed_ms = [&start]() { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(); };
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uploads.insert(uploads.end(), decoded.begin(), decoded.end());
+        decoded.clear();
+    }
+
+    bool progressed = false;
+    while (!uploads.empty()) {
+        Job& job = *uploads.front();
+        GLenum internal_format, data_format;
+        if (job.status.use_count() == 1) { // Texture destroyed before its upload finished
+            uploads.pop_front();
+            continue;
+        }
+        if (job.baked) {
+            if (progressed && elapsed_ms() >= options.budget_ms) break;
+            uploadBakedStrip(job);
+            progressed = true;
+            if (job.next_level >= job.baked->getLevelCount()) {
+                finish(job);
+                uploads.pop_front();
+            }
+            continue;
+        }
+        if (!job.pixels || !pixelFormat(job.channels, job.type, internal_format, data_format)) {
+            if (job.pixels) std::cerr << "Warning: Unsupported texture channels (" << job.channels << ") in: " << job.path << std::endl;
+            job.status->failed = true;
+            ++stats.failed;
+            uploads.pop_front();
+            continue;
+        }
+        if (progressed && elapsed_ms() >= options.budget_ms) break;
+        if (!uploadStrip(job)) {
+            ++stats.fence_waits;
+            break;
+        }
+        progressed = true;
+        if (job.next_row >= job.height) {
+            finish(job);
+            uploads.pop_front();
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    stats.last_update_ms = elapsed_ms();
+}
+
+bool AsyncTextureLoader::uploadStrip(Job& job) {
+    FS_TRACE_ZONE("texture upload strip");
+    PixelBuffer& pbo = ring[next_buffer];
+    if (pbo.fence) {
+        // Zero timeout: only asks whether the GPU is done reading this buffer
+        GLenum state = glClientWaitSync(pbo.fence, 0, 0);
+        if (state == GL_TIMEOUT_EXPIRED) return false;
+        glDeleteSync(pbo.fence);
+        pbo.fence = nullptr;
+    }
+
+    GLenum internal_format = GL_RGB, data_format = GL_RGB;
+    pixelFormat(job.channels, job.type, internal_format, data_format);
+    size_t row_bytes = static_cast<size_t>(job.width) * job.channels * (job.type == GL_FLOAT ? sizeof(float) : 1);
+    int rows = static_cast<int>(std::max<size_t>(options.pbo_bytes / row_bytes, 1));
+    rows = std::min(rows, job.height - job.next_row);
+    size_t bytes = static_cast<size_t>(rows) * row_bytes;
+
+    glBindTexture(GL_TEXTURE_2D, job.texture);
+    if (job.next_row == 0) {
+        // Allocate level 0 (no unpack buffer bound: null means no data, not offset 0)
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, job.params.texture_wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, job.params.texture_wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, job.params.texture_min_filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, job.params.texture_mag_filter);
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, job.width, job.height, 0, data_format, job.type, nullptr);
+    }
+
+    const uint8_t* source = job.pixels.get() + static_cast<size_t>(job.next_row) * row_bytes;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.buffer);
+    void* target = nullptr;
+    if (bytes <= options.pbo_bytes) {
+        // The fence has signalled, so nothing still reads the buffer: no implicit sync needed
+        target = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes),
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+    if (target) {
+        std::memcpy(target, source, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job.next_row, job.width, rows, data_format, job.type, nullptr);
+        pbo.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        next_buffer = (next_buffer + 1) % ring.size();
+    } else {
+        // A single row larger than a PBO, or mapping failed: plain client-memory upload
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job.next_row, job.width, rows, data_format, job.type, source);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    job.next_row += rows;
+    stats.bytes_uploaded += bytes;
+    return true;
+}
+
+// Straight from the mapping, so no PBO is involved; strips are sized like the PBO strips
+void AsyncTextureLoader::uploadBakedStrip(Job& job) {
+    FS_TRACE_ZONE_VALUE("texture upload baked strip", job.next_level);
+    const BakedTexture& baked = *job.baked;
+    const BakedLevel& level = baked.level(job.next_level);
+    glBindTexture(GL_TEXTURE_2D, job.texture);
+    if (job.next_level == 0 && job.next_row == 0) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, job.params.texture_wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, job.params.texture_wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, job.params.texture_min_filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, job.params.texture_mag_filter);
+    }
+    if (job.next_row == 0) GLUtil::allocateBakedLevel(baked, job.next_level);
+
+    size_t row_bytes = GLUtil::bakedRowBytes(baked, job.next_level);
+    int row_height = GLUtil::bakedRowHeight(baked);
+    int rows = static_cast<int>(std::max<size_t>(options.pbo_bytes / row_bytes, 1)) * row_height;
+    rows = std::min(rows, level.height - job.next_row);
+    GLUtil::uploadBakedRows(baked, job.next_level, job.next_row, rows);
+    stats.bytes_uploaded += static_cast<size_t>((rows + row_height - 1) / row_height) * row_bytes;
+
+    job.next_row += rows;
+    if (job.next_row >= level.height) {
+        job.next_row = 0;
+        ++job.next_level;
+    }
+}
+
+void AsyncTextureLoader::finish(Job& job) {
+    glBindTexture(GL_TEXTURE_2D, job.texture);
+    if (job.baked) GLUtil::finishBakedLevels(*job.baked, job.params);
+    else if (GLUtil::usesMipmaps(job.params.texture_min_filter)) glGenerateMipmap(GL_TEXTURE_2D);
+    job.status->width = job.width;
+    job.status->height = job.height;
+    job.status->channels = job.channels;
+    job.status->ready = true;
+    job.pixels.reset();
+    job.baked.reset(); // Unmaps
+    ++stats.completed;
+}
+
+AsyncTextureLoader::Stats AsyncTextureLoader::getStats() const {
+    Stats result = stats;
+    result.uploading = uploads.size();
+    std::lock_guard<std::mutex> lock(mutex);
+    result.decoding = decoding;
+    result.uploading += decoded.size();
+    return result;
+}
@@ -0,0 +1,121 @@
+#ifndef ASYNC_TEXTURE_LOADER_H
+#define ASYNC_TEXTURE_LOADER_H
+
+#include "OpenGLUtils.h" // TextureParams
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class BakedTexture;
+class ThreadPool;
+
+// Progress of one asynchronous texture, shared between the loader and the Texture it fills.
+// Written on the GL thread only (AsyncTextureLoader::update), so plain fields suffice.
+struct TextureUploadStatus {
+    bool ready = false;  // Every level uploaded: the texture may be sampled
+    bool failed = false; // Decode failed or the format is unsupported; stays invalid
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+};
+
+// Asynchronous texture creation: files are decoded by stb_image on a worker pool, then the
+// GL thread streams the pixels into the texture through a ring of pixel buffer objects,
+// a strip of rows at a time, for at most budget_ms per frame. Each PBO is fenced after its
+// glTexSubImage2D and reused only once the fence has signalled, so neither the CPU copy nor
+// the driver ever waits on the GPU. A texture becomes ready after its last strip (and its
+// glGenerateMipmap, for mipmapped filters).
+//
+// The loader uploads into texture names created by the caller (see Texture::loadAsync). If the
+// caller drops its status before the upload completes, the remaining work is skipped.
+class AsyncTextureLoader {
+public:
+    struct Options {
+        size_t decode_threads = 2;
+        size_t pbo_count = 4;          // Strips in flight on the GPU
+        size_t pbo_bytes = 4u << 20;   // Largest strip (rows per strip = pbo_bytes / row size)
+        double budget_ms = 2.0;        // GL-thread time per update(); at least one strip always goes
+    };
+
+    struct Stats {
+        size_t decoding = 0;   // Files on the worker pool
+        size_t uploading = 0;  // Decoded, waiting for or in upload
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+        uint64_t bytes_uploaded = 0;
+        double last_update_ms = 0.0;
+        int fence_waits = 0;   // update() calls that stopped early because every PBO was busy
+    };
+
+    AsyncTextureLoader(); // Requires a current GL context
+    explicit AsyncTextureLoader(Options options);
+    ~AsyncTextureLoader(); // Waits for running decodes; pending uploads are dropped
+
+    AsyncTextureLoader(const AsyncTextureLoader&) = delete;
+    AsyncTextureLoader& operator=(const AsyncTextureLoader&) = delete;
+
+    // Decode `path` on the pool, then upload into `texture` (GL thread)
+    std::shared_ptr<TextureUploadStatus> loadFile(GLuint texture, const std::string& path, const GLUtil::TextureParams& params);
+    // Upload already-decoded pixels (rows in OpenGL order): 8-bit with 1/3/4 channels, or
+    // single-channel GL_FLOAT (stored as R32F). `pixels` is kept alive until the upload completes.
+    // A non-positive width, height or channel count fails at once.
+    std::shared_ptr<TextureUploadStatus> loadPixels(GLuint texture, int width, int height, int channels,
+                                                    std::shared_ptr<const uint8_t> pixels, const GLUtil::TextureParams& params,
+                                                    GLenum type = GL_UNSIGNED_BYTE);
+    // Upload the levels of an opened baked texture straight from its mapping (no decode, no PBO
+    // copy), a strip of rows (BC1: block rows) per step under the same budget. The mapping
+    // stays open until the last level is in.
+    std::shared_ptr<TextureUploadStatus> loadBaked(GLuint texture, std::shared_ptr<const BakedTexture> baked,
+                                                   const GLUtil::TextureParams& params);
+
+    // GL thread, once per frame
+    void update();
+
+    Stats getStats() const;
+    const Options& getOptions() const { return options; }
+
+private:
+    struct Job {
+        GLuint texture = 0;
+        std::string path;
+        GLUtil::TextureParams params;
+        std::shared_ptr<TextureUploadStatus> status;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        GLenum type = GL_UNSIGNED_BYTE;
+        std::shared_ptr<const uint8_t> pixels;
+        int next_row = 0; // Rows below this are uploaded (of level next_level, for baked jobs)
+        std::shared_ptr<const BakedTexture> baked;
+        int next_level = 0; // Baked levels below this are uploaded
+    };
+    struct PixelBuffer {
+        GLuint buffer = 0;
+        GLsync fence = nullptr; // Last upload reading from this buffer
+    };
+
+    Options options;
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<PixelBuffer> ring;
+    size_t next_buffer = 0;
+
+    std::deque<std::shared_ptr<Job>> uploads; // GL thread only
+
+    mutable std::mutex mutex;
+    std::vector<std::shared_ptr<Job>> decoded; // Finished on the pool, not yet taken by update()
+    size_t decoding = 0;
+
+    Stats stats;
+
+    void decode(const std::shared_ptr<Job>& job); // Pool thread
+    bool uploadStrip(Job& job);                   // False if no PBO is free yet
+    void uploadBakedStrip(Job& job);
+    void finish(Job& job);
+};
+
+#endif // ASYNC_TEXTURE_LOADER_H
@@ -0,0 +1,179 @@
+#include "Atmosphere.h"
+#include "SimdLane.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// --- ISA constants ---
+const double G0 = 9.80665;           // m/s^2 (standard gravity used by the ISA definition)
+const double R_AIR = 287.05287;      // J/(kg*K)
+const double GAMMA = 1.4;
+const double SUTHERLAND_BETA = 1.458e-6;
+const double SUTHERLAND_S = 110.4;   // K
+
+// Layer bases: geopotential altitude (m), base temperature (K), lapse rate (K/m)
+struct Layer {
+    double base_altitude;
+    double base_temperature;
+    double lapse_rate;
+};
+const Layer LAYERS[] = {
+    {0.0,     288.15, -0.0065}, // Troposphere
+    {11000.0, 216.65,  0.0},    // Tropopause
+    {20000.0, 216.65,  0.001},  // Stratosphere 1
+    {32000.0, 228.65,  0.0028}, // Stratosphere 2
+};
+const size_t LAYER_COUNT = sizeof(LAYERS) / sizeof(LAYERS[0]);
+
+// Pressure at the base of each layer, integrated upward from sea level
+double layerPressure(size_t layer) {
+    double p = 101325.0;
+    for (size_t i = 0; i < layer; ++i) {
+        const Layer& l = LAYERS[i];
+        double h = LAYERS[i + 1].base_altitude - l.base_altitude;
+        if (l.lapse_rate != 0.0) {
+            double t = l.base_temperature + l.lapse_rate * h;
+            p *= std::pow(t / l.base_temperature, -G0 / (R_AIR * l.lapse_rate));
+        } else {
+            p *= std::exp(-G0 * h / (R_AIR * l.base_temperature));
+        }
+    }
+    return p;
+}
+
+// SoA table, one array per quantity
+struct Table {
+    size_t count = 0;
+    std::vector<float> density, temperature, pressure, speed_of_sound, dynamic_viscosity;
+
+    Table() {
+        count = static_cast<size_t>((Atmosphere::MAX_ALTITUDE - Atmosphere::MIN_ALTITUDE) / Atmosphere::TABLE_SPACING) + 1;
+        for (auto* v : {&density, &temperature, &pressure, &speed_of_sound, &dynamic_viscosity}) v->resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            AtmosphereState s = Atmosphere::computeExact(Atmosphere::MIN_ALTITUDE + Atmosphere::TABLE_SPACING * static_cast<double>(i));
+            density[i] = s.density;
+            temperature[i] = s.temperature;
+            pressure[i] = s.pressure;
+            speed_of_sound[i] = s.speed_of_sound;
+            dynamic_viscosity[i] = s.dynamic_viscosity;
+        }
+    }
+};
+
+const Table& table() {
+    static const Table t; // Built on first use
+    return t;
+}
+
+// Table cell and weight for an altitude (clamped)
+inline void locate(const Table& t, float altitude_m, size_t& i, float& w) {
+    float x = (altitude_m - Atmosphere::MIN_ALTITUDE) * (1.0f / Atmosphere::TABLE_SPACING);
+    x = std::clamp(x, 0.0f, static_cast<float>(t.count - 1));
+    i = std::min(static_cast<size_t>(x), t.count - 2);
+    w = x - static_cast<float>(i);
+}
+
+inline float lerpAt(const std::vector<float>& v, size_t i, float w) {
+    return v[i] + w * (v[i + 1] - v[i]);
+}
+
+} // namespace
+
+AtmosphereState Atmosphere::computeExact(double altitude_m) {
+    altitude_m = std::clamp(altitude_m, static_cast<double>(MIN_ALTITUDE), static_cast<double>(MAX_ALTITUDE));
+
+    // Below sea level the troposphere equations are extended downward
+    size_t layer = 0;
+    while (layer + 1 < LAYER_COUNT && altitude_m >= LAYERS[layer + 1].base_altitude) ++layer;
+    const Layer& l = LAYERS[layer];
+    double h = altitude_m - l.base_altitude;
+    double p_base = layerPressure(layer);
+
+    double t, p;
+    if (l.lapse_rate != 0.0) {
+        t = l.base_temperature + l.lapse_rate * h;
+        p = p_base * std::pow(t / l.base_temperature, -G0 / (R_AIR * l.lapse_rate));
+    } else {
+        t = l.base_temperature;
+        p = p_base * std::exp(-G0 * h / (R_AIR * t));
+    }
+
+    AtmosphereState s;
+    s.temperature = static_cast<float>(t);
+    s.pressure = static_cast<float>(p);
+    s.density = static_cast<float>(p / (R_AIR * t));
+    s.speed_of_sound = static_cast<float>(std::sqrt(GAMMA * R_AIR * t));
+    s.dynamic_viscosity = static_cast<float>(SUTHERLAND_BETA * t * std::sqrt(t) / (t + SUTHERLAND_S));
+    return s;
+}
+
+AtmosphereState Atmosphere::sample(float altitude_m) {
+    const Table& t = table();
+    size_t i;
+    float w;
+    locate(t, altitude_m, i, w);
+
+    AtmosphereState s;
+    s.density = lerpAt(t.density, i, w);
+    s.temperature = lerpAt(t.temperature, i, w);
+    s.pressure = lerpAt(t.pressure, i, w);
+    s.speed_of_sound = lerpAt(t.speed_of_sound, i, w);
+    s.dynamic_viscosity = lerpAt(t.dynamic_viscosity, i, w);
+    return s;
+}
+
+float Atmosphere::density(float altitude_m) {
+    const Table& t = table();
+    size_t i;
+    float w;
+    locate(t, altitude_m, i, w);
+    return lerpAt(t.density, i, w);
+}
+
+void Atmosphere::sampleBatch(const float* altitude_m, size_t count,
+                             float* density, float* temperature, float* pressure,
+                             float* speed_of_sound, float* dynamic_viscosity) {
+    using namespace lane;
+    const Table& t = table();
+    const std::vector<float>* columns[5] = {&t.density, &t.temperature, &t.pressure, &t.speed_of_sound, &t.dynamic_viscosity};
+    float* outputs[5] = {density, temperature, pressure, speed_of_sound, dynamic_viscosity};
+
+    const Lane lo = splat(MIN_ALTITUDE);
+    const Lane inv_spacing = splat(1.0f / TABLE_SPACING);
+    const Lane zero = splat(0.0f);
+    const Lane x_max = splat(static_cast<float>(t.count - 1));
+    const Lane i_max = splat(static_cast<float>(t.count - 2));
+
+    size_t vector_end = count - (count % SIMD_WIDTH);
+    int32_t idx[SIMD_WIDTH];
+    alignas(32) float v0[SIMD_WIDTH], v1[SIMD_WIDTH];
+    for (size_t n = 0; n < vector_end; n += SIMD_WIDTH) {
+        Lane x = min(max(mul(sub(load(altitude_m + n), lo), inv_spacing), zero), x_max);
+        Lane fi = min(floor(x), i_max);
+        Lane w = sub(x, fi);
+        toIndices(idx, fi);
+
+        for (int c = 0; c < 5; ++c) {
+            if (!outputs[c]) continue;
+            const float* column = columns[c]->data();
+            for (size_t k = 0; k < SIMD_WIDTH; ++k) {
+                v0[k] = column[idx[k]];
+                v1[k] = column[idx[k] + 1];
+            }
+            Lane a = load(v0);
+            store(outputs[c] + n, add(a, mul(w, sub(load(v1), a))));
+        }
+    }
+
+    // Remainder
+    for (size_t n = vector_end; n < count; ++n) {
+        size_t i;
+        float w;
+        locate(t, altitude_m[n], i, w);
+        for (int c = 0; c < 5; ++c) {
+            if (outputs[c]) outputs[c][n] = lerpAt(*columns[c], i, w);
+        }
+    }
+}
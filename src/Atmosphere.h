@@ -0,0 +1,41 @@
+#ifndef ATMOSPHERE_H
+#define ATMOSPHERE_H
+
+#include <cstddef>
+
+// Air properties at one altitude
+struct AtmosphereState {
+    float density = 1.225f;            // kg/m^3
+    float temperature = 288.15f;       // K
+    float pressure = 101325.0f;        // Pa
+    float speed_of_sound = 340.294f;   // m/s
+    float dynamic_viscosity = 1.789e-5f; // kg/(m*s), Sutherland's law
+};
+
+// International Standard Atmosphere (1976) from -1 km to 47 km, geopotential altitude.
+// The layer equations are evaluated once into a small table (100 m spacing, ~10 KB,
+// stays in L1/L2) and queries linearly interpolate it, so no exp/pow per lookup.
+// Altitudes outside the table are clamped to its ends.
+class Atmosphere {
+public:
+    static constexpr float MIN_ALTITUDE = -1000.0f;   // m
+    static constexpr float MAX_ALTITUDE = 47000.0f;   // m (top of the stratosphere layers)
+    static constexpr float TABLE_SPACING = 100.0f;    // m
+
+    // Interpolated table lookup
+    static AtmosphereState sample(float altitude_m);
+    static float density(float altitude_m);
+
+    // Table lookup for `count` altitudes at once (SIMD). Any output pointer may be null.
+    static void sampleBatch(const float* altitude_m, size_t count,
+                            float* density, float* temperature = nullptr, float* pressure = nullptr,
+                            float* speed_of_sound = nullptr, float* dynamic_viscosity = nullptr);
+
+    // Reference: evaluate the ISA layer equations directly (double precision)
+    static AtmosphereState computeExact(double altitude_m);
+
+private:
+    Atmosphere() = delete;
+};
+
+#endif // ATMOSPHERE_H
@@ -0,0 +1,312 @@
+#include "BakedTexture.h"
+#include <stb_image.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char MAGIC[4] = {'F', 'S', 'T', 'X'};
+const uint32_t BAKED_VERSION = 1;
+const size_t HEADER_SIZE = 4 + 7 * sizeof(uint32_t);
+const size_t LEVEL_ENTRY_SIZE = 2 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+const size_t DATA_ALIGNMENT = 16;
+const int MAX_LEVELS = 16; // 32768 px
+
+template <typename T>
+void put(std::vector<uint8_t>& buffer, const T& value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+T read(const uint8_t*& cursor) {
+    T value;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return value;
+}
+
+size_t alignUp(size_t value) {
+    return (value + DATA_ALIGNMENT - 1) & ~(DATA_ALIGNMENT - 1);
+}
+
+bool validFormat(uint32_t format) {
+    return format == static_cast<uint32_t>(BakedFormat::R8) || format == static_cast<uint32_t>(BakedFormat::RGB8) ||
+           format == static_cast<uint32_t>(BakedFormat::RGBA8) || format == static_cast<uint32_t>(BakedFormat::BC1);
+}
+
+// --- BC1 ---
+uint16_t pack565(const float color[3]) {
+    auto channel = [](float value, int max) {
+        return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 255.0f) * max / 255.0f));
+    };
+    return static_cast<uint16_t>((channel(color[0], 31) << 11) | (channel(color[1], 63) << 5) | channel(color[2], 31));
+}
+
+void unpack565(uint16_t packed, float color[3]) {
+    int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+    color[0] = static_cast<float>((r << 3) | (r >> 2));
+    color[1] = static_cast<float>((g << 2) | (g >> 4));
+    color[2] = static_cast<float>((b << 3) | (b >> 2));
+}
+
+// Endpoints at the extremes of the block's principal colour axis, indices to the nearest of
+// the four palette entries
+void encodeBc1Block(const float texels[16][3], uint8_t* out) {
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) mean[c] += texels[i][c] / 16.0f;
+    }
+    float cov[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}; // rr rg rb gg gb bb
+    for (int i = 0; i < 16; ++i) {
+        float d[3] = {texels[i][0] - mean[0], texels[i][1] - mean[1], texels[i][2] - mean[2]};
+        cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+        cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+    }
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (int iteration = 0; iteration < 8; ++iteration) { // Power iteration
+        float next[3] = {cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                         cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                         cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]};
+        float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6f) break; // Flat block: any axis will do
+        for (int c = 0; c < 3; ++c) axis[c] = next[c] / length;
+    }
+    float t_min = 0.0f, t_max = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        float t = (texels[i][0] - mean[0]) * axis[0] + (texels[i][1] - mean[1]) * axis[1] + (texels[i][2] - mean[2]) * axis[2];
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+    }
+    float end0[3], end1[3];
+    for (int c = 0; c < 3; ++c) {
+        end0[c] = mean[c] + axis[c] * t_max;
+        end1[c] = mean[c] + axis[c] * t_min;
+    }
+    uint16_t color0 = pack565(end0), color1 = pack565(end1);
+    if (color0 < color1) std::swap(color0, color1); // color0 > color1 selects the four-colour mode
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        float palette[4][3];
+        unpack565(color0, palette[0]);
+        unpack565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+        }
+        for (int i = 0; i < 16; ++i) {
+            uint32_t best = 0;
+            float best_error = 1e30f;
+            for (uint32_t p = 0; p < 4; ++p) {
+                float dr = texels[i][0] - palette[p][0], dg = texels[i][1] - palette[p][1], db = texels[i][2] - palette[p][2];
+                float error = dr * dr + dg * dg + db * db;
+                if (error < best_error) {
+                    best_error = error;
+                    best = p;
+                }
+            }
+            indices |= best << (2 * i);
+        }
+    }
+    std::memcpy(out, &color0, 2);
+    std::memcpy(out + 2, &color1, 2);
+    std::memcpy(out + 4, &indices, 4);
+}
+
+} // namespace
+
+// --- Paths ---
+std::string BakedTexture::pathFor(const std::string& source_path) {
+    return source_path + EXTENSION;
+}
+
+std::string BakedTexture::findFor(const std::string& source_path) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::string baked = pathFor(source_path);
+    if (!fs::is_regular_file(baked, ec)) return "";
+    auto baked_time = fs::last_write_time(baked, ec);
+    if (ec) return "";
+    auto source_time = fs::last_write_time(source_path, ec);
+    if (!ec && source_time > baked_time) {
+        std::cerr << "Warning: " << baked << " is older than its source, ignoring it (re-run the baker)" << std::endl;
+        return "";
+    }
+    return baked; // Also used when only the baked file was shipped
+}
+
+// --- Building blocks ---
+size_t BakedTexture::levelSize(BakedFormat format, int width, int height) {
+    if (format == BakedFormat::BC1) return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * 8;
+    return static_cast<size_t>(width) * height * static_cast<size_t>(format);
+}
+
+std::vector<uint8_t> BakedTexture::downsample(const std::vector<uint8_t>& pixels, int width, int height, int channels) {
+    int out_width = std::max(width / 2, 1), out_height = std::max(height / 2, 1);
+    std::vector<uint8_t> out(static_cast<size_t>(out_width) * out_height * channels);
+    for (int y = 0; y < out_height; ++y) {
+        const uint8_t* row0 = pixels.data() + static_cast<size_t>(std::min(2 * y, height - 1)) * width * channels;
+        const uint8_t* row1 = pixels.data() + static_cast<size_t>(std::min(2 * y + 1, height - 1)) * width * channels;
+        uint8_t* dst = out.data() + static_cast<size_t>(y) * out_width * channels;
+        for (int x = 0; x < out_width; ++x) {
+            int x0 = std::min(2 * x, width - 1) * channels, x1 = std::min(2 * x + 1, width - 1) * channels;
+            for (int c = 0; c < channels; ++c) {
+                dst[x * channels + c] = static_cast<uint8_t>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+            }
+        }
+    }
+    return out;
+}
+
+std::vector<uint8_t> BakedTexture::compressBc1(const std::vector<uint8_t>& pixels, int width, int height, int channels) {
+    int blocks_x = (width + 3) / 4, blocks_y = (height + 3) / 4;
+    std::vector<uint8_t> out(static_cast<size_t>(blocks_x) * blocks_y * 8);
+    float texels[16][3];
+    for (int by = 0; by < blocks_y; ++by) {
+        for (int bx = 0; bx < blocks_x; ++bx) {
+            for (int i = 0; i < 16; ++i) {
+                int x = std::min(bx * 4 + (i & 3), width - 1);
+                int y = std::min(by * 4 + (i >> 2), height - 1);
+                const uint8_t* texel = pixels.data() + (static_cast<size_t>(y) * width + x) * channels;
+                for (int c = 0; c < 3; ++c) texels[i][c] = texel[c];
+            }
+            encodeBc1Block(texels, out.data() + (static_cast<size_t>(by) * blocks_x + bx) * 8);
+        }
+    }
+    return out;
+}
+
+// --- Baking ---
+bool BakedTexture::bake(const std::string& source_path, const std::string& output_path, const BakeOptions& options) {
+    stbi_set_flip_vertically_on_load_thread(1); // OpenGL row order, as Texture loads
+    int w = 0, h = 0, channels = 0;
+    unsigned char* data = stbi_load(source_path.c_str(), &w, &h, &channels, 0);
+    if (!data) {
+        std::cerr << "Error: Failed to load texture data from: " << source_path << " (" << stbi_failure_reason() << ")" << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> pixels(data, data + static_cast<size_t>(w) * h * channels);
+    stbi_image_free(data);
+    if (channels != 1 && channels != 3 && channels != 4) {
+        std::cerr << "Error: Unsupported texture channels (" << channels << ") in: " << source_path << std::endl;
+        return false;
+    }
+
+    BakedFormat format = static_cast<BakedFormat>(channels);
+    if (options.bc1) {
+        bool opaque = true;
+        for (size_t i = 3; channels == 4 && opaque && i < pixels.size(); i += 4) opaque = pixels[i] == 255;
+        if (channels == 1 || !opaque) {
+            std::cerr << "Warning: " << source_path << (channels == 1 ? " is single-channel" : " has transparency")
+                      << ", storing it uncompressed instead of BC1" << std::endl;
+        } else {
+            format = BakedFormat::BC1;
+        }
+    }
+
+    // Level payloads, finest first
+    std::vector<std::vector<uint8_t>> payloads;
+    std::vector<std::pair<int, int>> sizes;
+    int level_width = w, level_height = h;
+    while (true) {
+        payloads.push_back(format == BakedFormat::BC1 ? compressBc1(pixels, level_width, level_height, channels) : pixels);
+        sizes.emplace_back(level_width, level_height);
+        if (!options.mipmaps || (level_width == 1 && level_height == 1)) break;
+        pixels = downsample(pixels, level_width, level_height, channels);
+        level_width = std::max(level_width / 2, 1);
+        level_height = std::max(level_height / 2, 1);
+    }
+
+    std::vector<uint8_t> header;
+    header.insert(header.end(), MAGIC, MAGIC + 4);
+    put(header, BAKED_VERSION);
+    put(header, static_cast<uint32_t>(format));
+    put(header, static_cast<uint32_t>(w));
+    put(header, static_cast<uint32_t>(h));
+    put(header, static_cast<uint32_t>(channels));
+    put(header, static_cast<uint32_t>(payloads.size()));
+    put(header, uint32_t(0));
+    uint64_t offset = alignUp(HEADER_SIZE + payloads.size() * LEVEL_ENTRY_SIZE);
+    std::vector<uint64_t> offsets;
+    for (size_t i = 0; i < payloads.size(); ++i) {
+        offsets.push_back(offset);
+        put(header, offset);
+        put(header, static_cast<uint64_t>(payloads[i].size()));
+        put(header, static_cast<uint32_t>(sizes[i].first));
+        put(header, static_cast<uint32_t>(sizes[i].second));
+        offset = alignUp(offset + payloads[i].size());
+    }
+
+    std::ofstream out(output_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Error: Cannot create " << output_path << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    const char padding[DATA_ALIGNMENT] = {};
+    uint64_t written = header.size();
+    for (size_t i = 0; i < payloads.size(); ++i) {
+        out.write(padding, static_cast<std::streamsize>(offsets[i] - written));
+        out.write(reinterpret_cast<const char*>(payloads[i].data()), static_cast<std::streamsize>(payloads[i].size()));
+        written = offsets[i] + payloads[i].size();
+    }
+    if (!out) {
+        std::cerr << "Error: Failed writing " << output_path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- Loading ---
+bool BakedTexture::open(const std::string& file_path) {
+    levels.clear();
+    path = file_path;
+    if (!file.open(file_path)) return false;
+
+    auto fail = [this](const char* reason) {
+        std::cerr << "Error: " << path << ": " << reason << std::endl;
+        file.close();
+        levels.clear();
+        return false;
+    };
+    if (file.size() < HEADER_SIZE || std::memcmp(file.data(), MAGIC, 4) != 0) return fail("not a baked texture");
+    const uint8_t* cursor = file.data() + 4;
+    uint32_t version = read<uint32_t>(cursor);
+    uint32_t format_value = read<uint32_t>(cursor);
+    uint32_t w = read<uint32_t>(cursor);
+    uint32_t h = read<uint32_t>(cursor);
+    uint32_t source_channels = read<uint32_t>(cursor);
+    uint32_t level_count = read<uint32_t>(cursor);
+    read<uint32_t>(cursor); // reserved
+    if (version != BAKED_VERSION) return fail("unsupported version");
+    if (!validFormat(format_value)) return fail("unknown format");
+    if (w == 0 || h == 0 || level_count == 0 || level_count > MAX_LEVELS) return fail("bad dimensions");
+    if (file.size() < HEADER_SIZE + level_count * LEVEL_ENTRY_SIZE) return fail("truncated level table");
+
+    format = static_cast<BakedFormat>(format_value);
+    width = static_cast<int>(w);
+    height = static_cast<int>(h);
+    channels = static_cast<int>(source_channels);
+    int expected_width = width, expected_height = height;
+    for (uint32_t i = 0; i < level_count; ++i) {
+        uint64_t offset = read<uint64_t>(cursor);
+        uint64_t size = read<uint64_t>(cursor);
+        BakedLevel level;
+        level.width = static_cast<int>(read<uint32_t>(cursor));
+        level.height = static_cast<int>(read<uint32_t>(cursor));
+        if (level.width != expected_width || level.height != expected_height) return fail("level sizes do not halve");
+        if (size != levelSize(format, level.width, level.height)) return fail("level size mismatch");
+        if (offset > file.size() || size > file.size() - offset) return fail("level outside the file");
+        level.data = file.data() + offset;
+        level.size = static_cast<size_t>(size);
+        levels.push_back(level);
+        expected_width = std::max(expected_width / 2, 1);
+        expected_height = std::max(expected_height / 2, 1);
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef BAKED_TEXTURE_H
+#define BAKED_TEXTURE_H
+
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// GPU-ready texture container, written offline by `FlightSimHeadless bake` and memory-mapped at
+// run time so every mip level goes straight from the page cache to glTexImage2D /
+// glCompressedTexImage2D: no decode, no heap copy, no glGenerateMipmap.
+//
+// File layout (little-endian, written as raw host values):
+//   Header : "FSTX" | u32 version | u32 format | u32 width | u32 height | u32 channels | u32 level_count | u32 reserved
+//   Levels : { u64 offset | u64 size | u32 width | u32 height } * level_count, level 0 first
+//   Data   : each level at a 16-byte aligned offset; rows in OpenGL order (bottom row first,
+//            as Texture loads images), tightly packed (unpack alignment 1)
+//
+// A baked file lives next to its source image as <source>.ftex (texture.png -> texture.png.ftex);
+// findFor() ignores it once the source is newer.
+enum class BakedFormat : uint32_t {
+    R8 = 1,
+    RGB8 = 3,
+    RGBA8 = 4,
+    BC1 = 0x100, // S3TC DXT1, opaque RGB, 8 bytes per 4x4 block
+};
+
+struct BakedLevel {
+    int width = 0;
+    int height = 0;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+class BakedTexture {
+public:
+    static constexpr const char* EXTENSION = ".ftex";
+
+    struct BakeOptions {
+        bool mipmaps = true; // Full chain down to 1x1 (box filter)
+        bool bc1 = false;    // Block-compress 3/4-channel opaque images
+    };
+
+    // Baked file path for a source image
+    static std::string pathFor(const std::string& source_path);
+    // pathFor(source) if that file exists and is not older than the source, else ""
+    static std::string findFor(const std::string& source_path);
+
+    // Decode `source_path` (stb_image), build the mip chain, optionally compress, and write
+    // `output_path`. Returns false (and logs) on failure.
+    static bool bake(const std::string& source_path, const std::string& output_path, const BakeOptions& options);
+
+    // Map and validate a baked file. Returns false (and logs) if it is missing or malformed.
+    bool open(const std::string& path);
+
+    bool isOpen() const { return file.isOpen(); }
+    BakedFormat getFormat() const { return format; }
+    bool isCompressed() const { return format == BakedFormat::BC1; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getChannels() const { return channels; } // Of the source image
+    int getLevelCount() const { return static_cast<int>(levels.size()); }
+    const BakedLevel& level(int index) const { return levels[index]; }
+    size_t getFileSize() const { return file.size(); }
+    const std::string& getPath() const { return path; }
+
+    // --- Building blocks (bake) ---
+    // Bytes of one level
+    static size_t levelSize(BakedFormat format, int width, int height);
+    // 2x2 box filter to max(1, w/2) x max(1, h/2); odd edges reuse the last texel
+    static std::vector<uint8_t> downsample(const std::vector<uint8_t>& pixels, int width, int height, int channels);
+    // BC1 blocks for an 8-bit image with 3 or 4 channels (alpha ignored); edge blocks clamp
+    static std::vector<uint8_t> compressBc1(const std::vector<uint8_t>& pixels, int width, int height, int channels);
+
+private:
+    MappedFile file;
+    std::string path;
+    BakedFormat format = BakedFormat::RGBA8;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<BakedLevel> levels;
+};
+
+#endif // BAKED_TEXTURE_H
@@ -0,0 +1,32 @@
+#ifndef FLIGHT_SCRIPT_H
+#define FLIGHT_SCRIPT_H
+
+#include "Aircraft.h"
+
+// --- Scripted flight ---
+// Open-loop control schedule: constant throttle, one pitch doublet and one roll step.
+// Shared by the headless batch runner (randomized per flight) and the configuration sweep.
+struct FlightScript {
+    unsigned seed = 0;
+    float initial_altitude = 1000.0f; // m
+    float initial_speed = 180.0f;     // m/s
+    float throttle = 0.8f;
+    float pitch_start = 5.0f;         // s
+    float pitch_duration = 2.0f;      // s, each half of the doublet
+    float pitch_amplitude = 0.3f;
+    float roll_start = 15.0f;         // s
+    float roll_amplitude = 0.2f;
+
+    ControlInputs controlsAt(float t) const {
+        ControlInputs c;
+        c.throttle = throttle;
+        if (t >= pitch_start && t < pitch_start + pitch_duration) c.pitch = pitch_amplitude;
+        else if (t >= pitch_start + pitch_duration && t < pitch_start + 2.0f * pitch_duration) c.pitch = -pitch_amplitude;
+        if (t >= roll_start) c.roll = roll_amplitude;
+        return c;
+    }
+
+    float doubletEnd() const { return pitch_start + 2.0f * pitch_duration; }
+};
+
+#endif // FLIGHT_SCRIPT_H
@@ -0,0 +1,30 @@
+#ifndef FRAME_DATA_H
+#define FRAME_DATA_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+
+// Per-frame values shared by every program, uploaded once per frame into one uniform
+// buffer (Graphics::setFrameData) instead of being set on each program separately.
+// std140 layout: only mat4/vec4 members, so the C++ layout matches with no padding.
+// Mirrored by `layout(std140) uniform FrameData` in the shaders - keep them in sync.
+struct FrameData {
+    static constexpr unsigned int BINDING = 0; // Uniform buffer binding point
+
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::mat4 view_projection{1.0f};
+    glm::mat4 screen_projection{1.0f}; // Orthographic, pixels with a top-left origin (2D overlays)
+    glm::vec4 camera_position{0.0f};   // xyz, w unused
+    glm::vec4 sun_direction{0.0f, -1.0f, 0.0f, 0.0f}; // xyz normalized, direction the light travels
+    glm::vec4 fog_color{0.5f, 0.6f, 0.7f, 0.00005f};  // rgb, a = exponential-squared density (objects)
+    glm::vec4 fog_range{1000.0f, 60000.0f, 0.0f, 0.0f}; // x = start, y = full fog distance (terrain)
+    glm::vec4 viewport{1.0f, 1.0f, 1.0f, 1.0f};       // width, height, 1/width, 1/height
+};
+
+static_assert(offsetof(FrameData, screen_projection) == 192, "FrameData must match the std140 block");
+static_assert(offsetof(FrameData, camera_position) == 256, "FrameData must match the std140 block");
+static_assert(offsetof(FrameData, viewport) == 320, "FrameData must match the std140 block");
+static_assert(sizeof(FrameData) == 336, "FrameData must match the std140 block");
+
+#endif // FRAME_DATA_H
@@ -0,0 +1,41 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+// View frustum as six planes (ax + by + cz + d >= 0 inside), extracted from a combined
+// projection * view matrix (Gribb/Hartmann). Used for CPU-side culling before submission.
+struct Frustum {
+    enum Plane { LEFT, RIGHT, BOTTOM, TOP, NEAR_PLANE, FAR_PLANE, PLANE_COUNT };
+
+    glm::vec4 planes[PLANE_COUNT];
+
+    static Frustum fromViewProjection(const glm::mat4& m) {
+        // Rows of the column-major matrix
+        glm::vec4 row[4];
+        for (int i = 0; i < 4; ++i) row[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+        Frustum f;
+        f.planes[LEFT] = row[3] + row[0];
+        f.planes[RIGHT] = row[3] - row[0];
+        f.planes[BOTTOM] = row[3] + row[1];
+        f.planes[TOP] = row[3] - row[1];
+        f.planes[NEAR_PLANE] = row[3] + row[2];
+        f.planes[FAR_PLANE] = row[3] - row[2];
+        return f;
+    }
+
+    // False only if the box is entirely outside one plane (may keep some boxes that are
+    // outside near a frustum corner, never drops a visible one)
+    bool intersectsAabb(const glm::vec3& box_min, const glm::vec3& box_max) const {
+        for (const glm::vec4& p : planes) {
+            // Box corner furthest along the plane normal
+            glm::vec3 v(p.x >= 0.0f ? box_max.x : box_min.x,
+                        p.y >= 0.0f ? box_max.y : box_min.y,
+                        p.z >= 0.0f ? box_max.z : box_min.z);
+            if (p.x * v.x + p.y * v.y + p.z * v.z + p.w < 0.0f) return false;
+        }
+        return true;
+    }
+};
+
+#endif // FRUSTUM_H
@@ -0,0 +1,364 @@
+#include "GoldenTrajectory.h"
+#include "AircraftFactory.h"
+#include "TrimSolver.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+const char GOLDEN_MAGIC[4] = {'F', 'S', 'G', 'T'};
+const uint32_t GOLDEN_VERSION = 1;
+const uint32_t MAX_GROUND_PATH = 4096;
+const uint64_t SAMPLE_BYTES = sizeof(uint64_t) + sizeof(double) + 13 * sizeof(float); // ReplayKeyframe payload
+
+// --- Maneuvers ---
+// Open-loop control schedules flown from a trimmed, wings-level start. They are chosen to
+// exercise different parts of the model: sustained thrust/lift (climb), the roll and yaw
+// axes (roll), high load factor through inverted flight (loop), and the post-stall
+// airfoil tables plus recovery (stall).
+// The trim values are fixed inputs (from `FlightSimHeadless trim`), not re-solved per run,
+// so a physics change shows up as a trajectory difference rather than a different start.
+struct Maneuver {
+    const char* name;
+    float altitude;   // m
+    float speed;      // m/s, along world +X
+    float duration;   // s
+    ControlInputs trim;
+    float trim_pitch_deg;
+    ControlInputs (*controls)(float t, ControlInputs trim);
+};
+
+ControlInputs climbControls(float t, ControlInputs c) {
+    c.throttle = 1.0f;
+    if (t >= 1.0f) c.pitch += 0.02f;
+    return c;
+}
+
+ControlInputs rollControls(float t, ControlInputs c) {
+    if (t >= 2.0f && t < 4.0f) c.roll = 0.05f;
+    else if (t >= 4.0f && t < 6.0f) c.roll = -0.05f;
+    if (t >= 9.0f && t < 11.0f) c.yaw = 0.05f;
+    return c;
+}
+
+ControlInputs loopControls(float t, ControlInputs c) {
+    c.throttle = 1.0f;
+    if (t >= 1.0f && t < 12.0f) c.pitch += 0.06f;
+    return c;
+}
+
+ControlInputs stallControls(float t, ControlInputs c) {
+    // Idle and ease the nose up until well past the stall, then unload and power out
+    c.throttle = t < 12.0f ? 0.0f : 1.0f;
+    if (t >= 1.0f) c.pitch += t < 12.0f ? 0.01f * (t - 1.0f) : -0.05f;
+    return c;
+}
+
+ControlInputs trimmed(float throttle, float elevator) {
+    ControlInputs c;
+    c.throttle = throttle;
+    c.pitch = elevator;
+    return c;
+}
+
+const Maneuver MANEUVERS[] = {
+    {"climb", 1000.0f, 160.0f, 20.0f, trimmed(0.2405f, 0.0648f), 0.228f, climbControls},
+    {"roll",  2000.0f, 180.0f, 15.0f, trimmed(0.2617f, 0.0125f), 0.642f, rollControls},
+    {"loop",  2000.0f, 200.0f, 20.0f, trimmed(0.3110f, -0.0558f), 1.182f, loopControls},
+    {"stall", 3000.0f, 120.0f, 25.0f, trimmed(0.2945f, 0.4189f), -2.315f, stallControls},
+};
+
+const Maneuver* findManeuver(const std::string& name) {
+    for (const Maneuver& m : MANEUVERS) {
+        if (name == m.name) return &m;
+    }
+    return nullptr;
+}
+
+void hashBytes(uint64_t& hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+void hashFloat(uint64_t& hash, float value) {
+    if (value == 0.0f) value = 0.0f; // Fold -0 into +0
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    hashBytes(hash, &bits, sizeof(bits));
+}
+
+// Angle of the rotation taking a to b. atan2 of the relative quaternion's vector and scalar
+// parts stays exact near zero, where acos(dot) would report rounding noise as ~1e-3 rad.
+float attitudeError(const glm::quat& a, const glm::quat& b) {
+    // conj(a) * b
+    float w = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+    glm::vec3 v(a.w * b.x - a.x * b.w - (a.y * b.z - a.z * b.y),
+                a.w * b.y - a.y * b.w - (a.z * b.x - a.x * b.z),
+                a.w * b.z - a.z * b.w - (a.x * b.y - a.y * b.x));
+    return 2.0f * std::atan2(glm::length(v), std::abs(w));
+}
+
+template <typename T>
+void put(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool get(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void putVec3(std::ofstream& out, const glm::vec3& v) {
+    put(out, v.x); put(out, v.y); put(out, v.z);
+}
+
+bool getVec3(std::istream& in, glm::vec3& v) {
+    return get(in, v.x) && get(in, v.y) && get(in, v.z);
+}
+
+} // namespace
+
+const char* GoldenComparison::channelName(int channel) {
+    switch (channel) {
+        case POSITION: return "position";
+        case VELOCITY: return "velocity";
+        case ATTITUDE: return "attitude";
+        case ANGULAR_VELOCITY: return "angular_velocity";
+        default: return "unknown";
+    }
+}
+
+const std::vector<std::string>& GoldenHarness::maneuverNames() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> list;
+        for (const Maneuver& m : MANEUVERS) list.push_back(m.name);
+        return list;
+    }();
+    return names;
+}
+
+uint64_t GoldenHarness::hashState(const RigidBody& body) {
+    uint64_t hash = 14695981039346656037ull;
+    const glm::vec3& p = body.position_world;
+    const glm::quat& q = body.orientation_world;
+    const glm::vec3& v = body.velocity_world;
+    const glm::vec3& w = body.angular_velocity_body;
+    for (float value : {p.x, p.y, p.z, q.w, q.x, q.y, q.z, v.x, v.y, v.z, w.x, w.y, w.z}) hashFloat(hash, value);
+    return hash;
+}
+
+GoldenTrajectory GoldenHarness::fly(const std::string& name, float dt, uint32_t sample_interval, IntegratorType integrator,
+                                    const Heightfield* ground) {
+    const Maneuver* maneuver = findManeuver(name);
+    if (!maneuver) throw std::runtime_error("Unknown golden maneuver: " + name);
+
+    GoldenTrajectory trajectory;
+    trajectory.maneuver = name;
+    trajectory.integrator = integrator;
+    trajectory.dt = dt;
+    trajectory.sample_interval = std::max(1u, sample_interval);
+    trajectory.step_count = static_cast<uint32_t>(std::ceil(maneuver->duration / dt));
+    if (ground) trajectory.ground = ground->getSource();
+
+    std::unique_ptr<Aircraft> aircraft = AircraftFactory::createDefaultAircraft();
+    aircraft->integrator = integrator;
+    aircraft->ground = ground;
+    aircraft->position_world = glm::vec3(0.0f, maneuver->altitude, 0.0f);
+    aircraft->orientation_world = TrimSolver::levelAttitude(glm::radians(maneuver->trim_pitch_deg));
+    aircraft->velocity_world = glm::vec3(maneuver->speed, 0.0f, 0.0f);
+    aircraft->angular_velocity_body = glm::vec3(0.0f);
+
+    trajectory.samples.push_back(ReplayKeyframe::capture(*aircraft, 0, 0.0));
+    trajectory.step_hashes.reserve(trajectory.step_count);
+    for (uint32_t step = 1; step <= trajectory.step_count; ++step) {
+        // Controls for the step that starts at (step - 1) * dt, as PhysicsScheduler::pre_step would set them
+        aircraft->controls = maneuver->controls(static_cast<float>(step - 1) * dt, maneuver->trim);
+        aircraft->update(dt);
+        trajectory.step_hashes.push_back(hashState(*aircraft));
+        if (step % trajectory.sample_interval == 0) {
+            trajectory.samples.push_back(ReplayKeyframe::capture(*aircraft, step, static_cast<double>(step) * dt));
+        }
+    }
+    return trajectory;
+}
+
+GoldenComparison GoldenHarness::check(const GoldenTrajectory& reference) {
+    Heightfield ground;
+    if (reference.ground.hash != 0 && (reference.ground.path.empty() || !ground.loadSource(reference.ground))) {
+        std::cerr << "Error: Terrain of golden maneuver " << reference.maneuver << " is not available"
+                  << (reference.ground.path.empty() ? " (not loaded from a file)" : "") << std::endl;
+        GoldenComparison result;
+        result.maneuver = reference.maneuver;
+        result.ground_unavailable = true;
+        return result;
+    }
+    GoldenTrajectory candidate = fly(reference.maneuver, reference.dt, reference.sample_interval, reference.integrator,
+                                     reference.ground.hash != 0 ? &ground : nullptr);
+    return compare(reference, candidate);
+}
+
+GoldenComparison GoldenHarness::compare(const GoldenTrajectory& reference, const GoldenTrajectory& candidate) {
+    GoldenComparison result;
+    result.maneuver = reference.maneuver;
+    if (reference.step_count != candidate.step_count || reference.samples.size() != candidate.samples.size() ||
+        reference.step_hashes.size() != candidate.step_hashes.size()) {
+        result.structure_mismatch = true;
+        return result;
+    }
+
+    for (size_t s = 0; s < reference.step_hashes.size(); ++s) {
+        if (reference.step_hashes[s] != candidate.step_hashes[s]) {
+            result.first_divergent_step = static_cast<int64_t>(s) + 1; // Hash s is the state after step s + 1
+            break;
+        }
+    }
+    result.bit_exact = result.first_divergent_step < 0;
+
+    for (size_t i = 0; i < reference.samples.size(); ++i) {
+        const ReplayKeyframe& a = reference.samples[i];
+        const ReplayKeyframe& b = candidate.samples[i];
+        float errors[GoldenComparison::CHANNEL_COUNT] = {
+            glm::length(a.position - b.position),
+            glm::length(a.velocity - b.velocity),
+            attitudeError(a.orientation, b.orientation),
+            glm::length(a.angular_velocity - b.angular_velocity),
+        };
+        for (int c = 0; c < GoldenComparison::CHANNEL_COUNT; ++c) {
+            // NaN in the candidate must fail, so compare with !(x <= max)
+            if (!(errors[c] <= result.max_error[c])) {
+                result.max_error[c] = std::isnan(errors[c]) ? INFINITY : errors[c];
+                result.worst_step[c] = a.step;
+            }
+        }
+    }
+
+    const GoldenTolerance& tol = reference.tolerance;
+    result.within_tolerance = result.max_error[GoldenComparison::POSITION] <= tol.position &&
+                              result.max_error[GoldenComparison::VELOCITY] <= tol.velocity &&
+                              result.max_error[GoldenComparison::ATTITUDE] <= tol.attitude &&
+                              result.max_error[GoldenComparison::ANGULAR_VELOCITY] <= tol.angular_velocity;
+    return result;
+}
+
+// --- Storage ---
+
+bool GoldenHarness::save(const std::string& path, const std::vector<GoldenTrajectory>& trajectories) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Error: Failed to create golden file: " << path << std::endl;
+        return false;
+    }
+    out.write(GOLDEN_MAGIC, 4);
+    put(out, GOLDEN_VERSION);
+    put(out, static_cast<uint32_t>(trajectories.size()));
+    for (const GoldenTrajectory& t : trajectories) {
+        put(out, static_cast<uint32_t>(t.maneuver.size()));
+        out.write(t.maneuver.data(), static_cast<std::streamsize>(t.maneuver.size()));
+        put(out, static_cast<uint32_t>(t.integrator));
+        put(out, t.dt);
+        put(out, t.step_count);
+        put(out, t.sample_interval);
+        put(out, t.tolerance.position);
+        put(out, t.tolerance.velocity);
+        put(out, t.tolerance.attitude);
+        put(out, t.tolerance.angular_velocity);
+        put(out, static_cast<uint32_t>(t.ground.path.size()));
+        out.write(t.ground.path.data(), static_cast<std::streamsize>(t.ground.path.size()));
+        put(out, t.ground.world_size);
+        put(out, t.ground.max_height);
+        put(out, t.ground.hash);
+        put(out, static_cast<uint32_t>(t.samples.size()));
+        for (const ReplayKeyframe& k : t.samples) {
+            put(out, k.step);
+            put(out, k.sim_time);
+            putVec3(out, k.position);
+            put(out, k.orientation.w); put(out, k.orientation.x); put(out, k.orientation.y); put(out, k.orientation.z);
+            putVec3(out, k.velocity);
+            putVec3(out, k.angular_velocity);
+        }
+        out.write(reinterpret_cast<const char*>(t.step_hashes.data()),
+                  static_cast<std::streamsize>(t.step_hashes.size() * sizeof(uint64_t)));
+    }
+    if (!out) {
+        std::cerr << "Error: Failed to write golden file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool GoldenHarness::load(const std::string& path, std::vector<GoldenTrajectory>& trajectories) {
+    trajectories.clear();
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Error: Failed to open golden file: " << path << std::endl;
+        return false;
+    }
+
+    in.seekg(0, std::ios::end);
+    const uint64_t file_size = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+
+    char magic[4];
+    uint32_t version = 0, count = 0;
+    if (!in.read(magic, 4) || std::memcmp(magic, GOLDEN_MAGIC, 4) != 0 || !get(in, version) || !get(in, count)) {
+        std::cerr << "Error: Not a golden trajectory file: " << path << std::endl;
+        return false;
+    }
+    if (version != GOLDEN_VERSION) {
+        std::cerr << "Error: Unsupported golden file version " << version << " in " << path << std::endl;
+        return false;
+    }
+
+    auto malformed = [&]() {
+        std::cerr << "Error: Truncated or malformed golden file: " << path << std::endl;
+        trajectories.clear();
+        return false;
+    };
+    for (uint32_t i = 0; i < count; ++i) {
+        GoldenTrajectory t;
+        uint32_t name_length = 0, integrator = 0, sample_count = 0;
+        if (!get(in, name_length) || name_length > 256) return malformed();
+        t.maneuver.resize(name_length);
+        if (!in.read(&t.maneuver[0], name_length)) return malformed();
+        if (!get(in, integrator) || integrator > static_cast<uint32_t>(IntegratorType::RK4) ||
+            !get(in, t.dt) || !get(in, t.step_count) || !get(in, t.sample_interval) ||
+            !get(in, t.tolerance.position) || !get(in, t.tolerance.velocity) ||
+            !get(in, t.tolerance.attitude) || !get(in, t.tolerance.angular_velocity)) {
+            return malformed();
+        }
+        uint32_t path_length = 0;
+        if (!get(in, path_length) || path_length > MAX_GROUND_PATH) return malformed();
+        t.ground.path.resize(path_length);
+        if ((path_length > 0 && !in.read(&t.ground.path[0], path_length)) ||
+            !get(in, t.ground.world_size) || !get(in, t.ground.max_height) || !get(in, t.ground.hash)) {
+            return malformed();
+        }
+        if (!get(in, sample_count) || sample_count > t.step_count + 1 || t.sample_interval == 0) return malformed();
+        // Both counts come from the file: check they fit in what is left of it before allocating
+        const uint64_t remaining = file_size - static_cast<uint64_t>(in.tellg());
+        if (sample_count * SAMPLE_BYTES + static_cast<uint64_t>(t.step_count) * sizeof(uint64_t) > remaining) return malformed();
+        t.integrator = static_cast<IntegratorType>(integrator);
+
+        t.samples.resize(sample_count);
+        for (ReplayKeyframe& k : t.samples) {
+            if (!get(in, k.step) || !get(in, k.sim_time) || !getVec3(in, k.position) ||
+                !get(in, k.orientation.w) || !get(in, k.orientation.x) || !get(in, k.orientation.y) || !get(in, k.orientation.z) ||
+                !getVec3(in, k.velocity) || !getVec3(in, k.angular_velocity)) {
+                return malformed();
+            }
+        }
+        t.step_hashes.resize(t.step_count);
+        if (!in.read(reinterpret_cast<char*>(t.step_hashes.data()), static_cast<std::streamsize>(t.step_count * sizeof(uint64_t)))) {
+            return malformed();
+        }
+        trajectories.push_back(std::move(t));
+    }
+    return true;
+}
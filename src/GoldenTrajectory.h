@@ -0,0 +1,87 @@
+#ifndef GOLDEN_TRAJECTORY_H
+#define GOLDEN_TRAJECTORY_H
+
+#include "Aircraft.h"
+#include "Integrator.h"
+#include "Replay.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Golden-trajectory regression harness.
+// A fixed set of scripted maneuvers is flown through Aircraft::update and stored as a
+// reference: a state sample every sample_interval steps plus a hash of the state after
+// every step. A later build flies the same maneuvers and is compared against the reference
+// per channel (max error against a bound) and bit for bit (the first step whose hash differs).
+//
+// File layout (little-endian, written as raw host values):
+//   Header     : "FSGT" | u32 version | u32 trajectory_count
+//   Trajectory : u32 name_length | name bytes | u32 integrator | f32 dt | u32 step_count |
+//                u32 sample_interval | f32 tolerance[4] |
+//                u32 ground_path_length | ground path bytes | f32 ground_world_size |
+//                f32 ground_max_height | u64 ground_hash (0 = flat ground) |
+//                u32 sample_count |
+//                samples (ReplayKeyframe payload: u64 step | f64 sim_time | 13 x f32) |
+//                u64 step_hash * step_count
+
+// Max-error bounds, one per compared channel
+struct GoldenTolerance {
+    float position = 2.0f;          // m
+    float velocity = 0.5f;          // m/s
+    float attitude = 0.01f;         // rad (angle between orientations)
+    float angular_velocity = 0.02f; // rad/s
+};
+
+struct GoldenTrajectory {
+    std::string maneuver;
+    IntegratorType integrator = IntegratorType::SemiImplicitEuler;
+    float dt = 1.0f / 120.0f;
+    uint32_t step_count = 0;
+    uint32_t sample_interval = 12;
+    GoldenTolerance tolerance;
+    HeightfieldSource ground;             // Terrain flown over (Aircraft::ground); hash 0 = flat ground
+    std::vector<ReplayKeyframe> samples;  // Step 0 (initial state) and every sample_interval-th step
+    std::vector<uint64_t> step_hashes;    // State hash after each step
+};
+
+struct GoldenComparison {
+    enum Channel { POSITION, VELOCITY, ATTITUDE, ANGULAR_VELOCITY, CHANNEL_COUNT };
+
+    std::string maneuver;
+    bool bit_exact = false;
+    int64_t first_divergent_step = -1;    // First step whose hash differs, -1 if none
+    float max_error[CHANNEL_COUNT] = {};
+    uint64_t worst_step[CHANNEL_COUNT] = {};
+    bool within_tolerance = false;
+    bool structure_mismatch = false;      // Step/sample counts differ: nothing comparable
+    bool ground_unavailable = false;      // The reference's terrain could not be loaded: not flown
+
+    static const char* channelName(int channel);
+};
+
+class GoldenHarness {
+public:
+    // Maneuver names in flight order: climb, roll, loop, stall
+    static const std::vector<std::string>& maneuverNames();
+
+    // Fly one maneuver from its scripted initial state, over `ground` (nullptr = flat ground).
+    // Throws std::runtime_error for an unknown maneuver name.
+    static GoldenTrajectory fly(const std::string& maneuver, float dt = 1.0f / 120.0f, uint32_t sample_interval = 12,
+                                IntegratorType integrator = IntegratorType::SemiImplicitEuler,
+                                const Heightfield* ground = nullptr);
+    // Re-fly the reference's maneuver with its dt/interval/integrator over its recorded ground
+    // (reloaded with Heightfield::loadSource) and compare
+    static GoldenComparison check(const GoldenTrajectory& reference);
+    static GoldenComparison compare(const GoldenTrajectory& reference, const GoldenTrajectory& candidate);
+
+    // FNV-1a over the raw bits of position, orientation, velocity and angular velocity
+    // (+0 and -0 hash alike)
+    static uint64_t hashState(const RigidBody& body);
+
+    // --- Storage ---
+    static bool save(const std::string& path, const std::vector<GoldenTrajectory>& trajectories);
+    // Returns false (and logs) if the file is missing or malformed
+    static bool load(const std::string& path, std::vector<GoldenTrajectory>& trajectories);
+};
+
+#endif // GOLDEN_TRAJECTORY_H
@@ -1,14 +1,21 @@
 #include "Graphics.h"
 #include "Shader.h" // Include Shader header
 #include "Input.h"  // Include Input for initialization
+#include "AsyncTextureLoader.h"
+#include <chrono>
 #include <iostream>
 
 // Initialize static members
 GLFWwindow* Graphics::window = nullptr;
 int Graphics::screenWidth = 0;
 int Graphics::screenHeight = 0;
+GLuint Graphics::frameDataUBO = 0;
+FrameData Graphics::frameData;
 std::unique_ptr<Shader> Graphics::basicShader = nullptr;
 std::unique_ptr<Shader> Graphics::minimapShader = nullptr;
+std::unique_ptr<Shader> Graphics::terrainShader = nullptr;
+std::unique_ptr<Shader> Graphics::hudShader = nullptr;
+std::unique_ptr<AsyncTextureLoader> Graphics::textureLoader = nullptr;
 
 
 bool Graphics::init(int width, int height, const std::string& title) {
@@ -51,11 +58,33 @@ bool Graphics::init(int width, int height, const std::string& title) {
     glEnable(GL_BLEND); // Enable blending for potential transparency
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    // Load Shaders
-    basicShader = std::make_unique<Shader>("assets/shaders/basic_shader.vert", "assets/shaders/basic_shader.frag");
-    minimapShader = std::make_unique<Shader>("assets/shaders/minimap_shader.vert", "assets/shaders/minimap_shader.frag");
-
-    if (!basicShader->ID || !minimapShader->ID) {
+    // Shared per-frame uniform block (contents set by setFrameData)
+    glGenBuffers(1, &frameDataUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameDataUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), &frameData, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FrameData::BINDING, frameDataUBO);
+
+    textureLoader = std::make_unique<AsyncTextureLoader>();
+
+    // Load Shaders: one batch, so cache misses compile in parallel where the driver can
+    auto shaderStart = std::chrono::steady_clock::now();
+    auto shaders = Shader::loadBatch({
+        {"assets/shaders/basic_shader.vert", "assets/shaders/basic_shader.frag"},
+        {"assets/shaders/minimap_shader.vert", "assets/shaders/minimap_shader.frag"},
+        {"assets/shaders/terrain.vert", "assets/shaders/terrain.frag"},
+        {"assets/shaders/hud.vert", "assets/shaders/hud.frag"},
+    });
+    double shaderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shaderStart).count();
+    int cached = 0;
+    for (const auto& shader : shaders) cached += shader->isFromCache();
+    std::cout << "Shaders: " << shaders.size() << " programs (" << cached << " from cache) in " << shaderMs << " ms" << std::endl;
+    basicShader = std::move(shaders[0]);
+    minimapShader = std::move(shaders[1]);
+    terrainShader = std::move(shaders[2]);
+    hudShader = std::move(shaders[3]);
+
+    if (!basicShader->ID || !minimapShader->ID || !terrainShader->ID || !hudShader->ID) {
          std::cerr << "Failed to load shaders." << std::endl;
          cleanup(); // Cleanup already initialized resources
          return false;
@@ -73,6 +102,13 @@ void Graphics::cleanup() {
     // Shaders cleaned up by unique_ptr automatically
     basicShader.reset();
     minimapShader.reset();
+    terrainShader.reset();
+    hudShader.reset();
+    textureLoader.reset(); // Before the context goes away (owns PBOs and fences)
+    if (frameDataUBO != 0) {
+        glDeleteBuffers(1, &frameDataUBO);
+        frameDataUBO = 0;
+    }
 
     if (window) {
         glfwDestroyWindow(window);
@@ -93,6 +129,15 @@ void Graphics::swapBuffers() {
     glfwPollEvents(); // Poll for input events
 }
 
+void Graphics::setFrameData(const FrameData& frame) {
+    frameData = frame;
+    if (frameDataUBO == 0) return;
+    glBindBuffer(GL_UNIFORM_BUFFER, frameDataUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &frameData);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FrameData::BINDING, frameDataUBO);
+}
+
 bool Graphics::shouldClose() {
     return glfwWindowShouldClose(window);
 }
@@ -3,12 +3,14 @@
 
 #include <GL/glew.h> // Must be included before GLFW
 #include <GLFW/glfw3.h>
+#include "FrameData.h"
 #include <string>
 #include <memory> // For unique_ptr
 
 // Forward declarations
 class Shader;
 class Camera;
+class AsyncTextureLoader;
 
 class Graphics {
 public:
@@ -21,14 +23,26 @@ public:
     static int getWidth();
     static int getHeight();
 
+    // Upload this frame's camera/projection/fog/sun block and bind it to FrameData::BINDING.
+    // Call once per frame before drawing; every program reads it through its FrameData block.
+    static void setFrameData(const FrameData& frame);
+    static const FrameData& getFrameData() { return frameData; }
+
     // Manage Shaders (can be expanded)
     static std::unique_ptr<Shader> basicShader;
     static std::unique_ptr<Shader> minimapShader;
+    static std::unique_ptr<Shader> terrainShader; // Used by Terrain; built in the same batch
+    static std::unique_ptr<Shader> hudShader;     // Per-vertex coloured screen-space quads (Profiler)
+
+    // Background decode + budgeted PBO upload for Texture::loadAsync; update() once per frame
+    static std::unique_ptr<AsyncTextureLoader> textureLoader;
 
 private:
     static GLFWwindow* window;
     static int screenWidth;
     static int screenHeight;
+    static GLuint frameDataUBO;
+    static FrameData frameData; // Last uploaded copy, for CPU-side users (culling, LOD)
 
     // Callback for window resize
     static void framebuffer_size_callback(GLFWwindow* window, int width, int height);
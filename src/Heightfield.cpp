@@ -0,0 +1,211 @@
+#include "Heightfield.h"
+#include "SimdLane.h"
+#include <stb_image.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+bool Heightfield::loadImage(const std::string& path, float terrain_world_size, float terrain_max_height) {
+    int w = 0, h = 0, channels = 0;
+    // Same row order as the GPU copy (Texture loads flipped for OpenGL)
+    stbi_set_flip_vertically_on_load(true);
+    unsigned char* data = stbi_load(path.c_str(), &w, &h, &channels, 0);
+    if (!data) {
+        std::cerr << "Error: Failed to load heightfield from: " << path << std::endl;
+        std::cerr << "STB Reason: " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+
+    // GL normalizes 8-bit texels to [0, 1]; the shader reads the red channel
+    std::vector<float> heights(static_cast<size_t>(w) * h);
+    const float scale = terrain_max_height / 255.0f;
+    for (size_t i = 0; i < heights.size(); ++i) heights[i] = data[i * channels] * scale;
+    stbi_image_free(data);
+
+    setHeights(w, h, heights, terrain_world_size);
+    source.path = path;
+    source.max_height = terrain_max_height;
+    return true;
+}
+
+bool Heightfield::loadSource(const HeightfieldSource& wanted) {
+    if (!loadImage(wanted.path, wanted.world_size, wanted.max_height)) return false;
+    if (source.hash != wanted.hash) {
+        std::cerr << "Error: Heightfield " << wanted.path << " has changed since it was recorded (hash "
+                  << std::hex << source.hash << ", expected " << wanted.hash << std::dec << ")" << std::endl;
+        setHeights(0, 0, {}, 1.0f);
+        return false;
+    }
+    return true;
+}
+
+void Heightfield::setHeights(int w, int h, const std::vector<float>& heights_m, float terrain_world_size) {
+    width = w;
+    height_texels = h;
+    world_size = terrain_world_size;
+    tiles.clear();
+    source = HeightfieldSource();
+    source.world_size = terrain_world_size;
+    if (empty() || heights_m.size() < static_cast<size_t>(w) * h) {
+        width = height_texels = 0;
+        min_height = max_height = 0.0f;
+        return;
+    }
+
+    const int cells_x = w - 1, cells_z = h - 1;
+    tiles_x = (cells_x + TILE_CELLS - 1) / TILE_CELLS;
+    const int tiles_z = (cells_z + TILE_CELLS - 1) / TILE_CELLS;
+    tiles.resize(static_cast<size_t>(tiles_x) * tiles_z * TILE_STRIDE * TILE_STRIDE);
+
+    // Copy into tiles; the apron and the ragged last tiles repeat the edge texels
+    for (int tz = 0; tz < tiles_z; ++tz) {
+        for (int tx = 0; tx < tiles_x; ++tx) {
+            float* tile = &tiles[(static_cast<size_t>(tz) * tiles_x + tx) * TILE_STRIDE * TILE_STRIDE];
+            for (int ly = 0; ly < TILE_STRIDE; ++ly) {
+                int y = std::min(tz * TILE_CELLS + ly, h - 1);
+                for (int lx = 0; lx < TILE_STRIDE; ++lx) {
+                    int x = std::min(tx * TILE_CELLS + lx, w - 1);
+                    tile[ly * TILE_STRIDE + lx] = heights_m[static_cast<size_t>(y) * w + x];
+                }
+            }
+        }
+    }
+    auto range = std::minmax_element(heights_m.begin(), heights_m.begin() + static_cast<size_t>(w) * h);
+    min_height = *range.first;
+    max_height = *range.second;
+
+    // Identifies the surface in replay and golden files
+    uint64_t hash = 14695981039346656037ull;
+    auto hashBytes = [&hash](const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    hashBytes(&w, sizeof(w));
+    hashBytes(&h, sizeof(h));
+    hashBytes(&world_size, sizeof(world_size));
+    hashBytes(heights_m.data(), static_cast<size_t>(w) * h * sizeof(float));
+    source.hash = hash != 0 ? hash : 1;
+
+    // uv = xz / size + 0.5; texel coordinate = uv * texels - 0.5 (GL_LINEAR sample positions)
+    texels_per_metre_x = static_cast<float>(w) / world_size;
+    texels_per_metre_z = static_cast<float>(h) / world_size;
+    texel_offset_x = 0.5f * static_cast<float>(w) - 0.5f;
+    texel_offset_z = 0.5f * static_cast<float>(h) - 0.5f;
+}
+
+float Heightfield::texel(int x, int y) const {
+    if (empty()) return 0.0f;
+    x = std::clamp(x, 0, width - 1);
+    y = std::clamp(y, 0, height_texels - 1);
+    // The last texel row/column is only stored as the apron of the last cell
+    int cx = std::min(x, width - 2), cz = std::min(y, height_texels - 2);
+    return tiles[cellBase(cx, cz) + static_cast<size_t>(y - cz) * TILE_STRIDE + static_cast<size_t>(x - cx)];
+}
+
+size_t Heightfield::locate(float world_x, float world_z, float& fx, float& fz) const {
+    // Clamping the texel coordinate to [0, n-1] is exactly clamp-to-edge for bilinear filtering
+    float tx = std::clamp(world_x * texels_per_metre_x + texel_offset_x, 0.0f, static_cast<float>(width - 1));
+    float tz = std::clamp(world_z * texels_per_metre_z + texel_offset_z, 0.0f, static_cast<float>(height_texels - 1));
+    int cx = std::min(static_cast<int>(tx), width - 2);
+    int cz = std::min(static_cast<int>(tz), height_texels - 2);
+    fx = tx - static_cast<float>(cx);
+    fz = tz - static_cast<float>(cz);
+    return cellBase(cx, cz);
+}
+
+float Heightfield::height(float world_x, float world_z) const {
+    if (empty()) return 0.0f;
+    float fx, fz;
+    const float* c = &tiles[locate(world_x, world_z, fx, fz)];
+    float h0 = c[0] + fx * (c[1] - c[0]);
+    float h1 = c[TILE_STRIDE] + fx * (c[TILE_STRIDE + 1] - c[TILE_STRIDE]);
+    return h0 + fz * (h1 - h0);
+}
+
+glm::vec3 Heightfield::normal(float world_x, float world_z) const {
+    float h;
+    glm::vec3 n;
+    sample(world_x, world_z, h, n);
+    return n;
+}
+
+void Heightfield::sample(float world_x, float world_z, float& height_out, glm::vec3& normal_out) const {
+    if (empty()) {
+        height_out = 0.0f;
+        normal_out = glm::vec3(0.0f, 1.0f, 0.0f);
+        return;
+    }
+    float fx, fz;
+    const float* c = &tiles[locate(world_x, world_z, fx, fz)];
+    float h00 = c[0], h10 = c[1], h01 = c[TILE_STRIDE], h11 = c[TILE_STRIDE + 1];
+    float h0 = h00 + fx * (h10 - h00);
+    float h1 = h01 + fx * (h11 - h01);
+    height_out = h0 + fz * (h1 - h0);
+
+    // Slopes of the bilinear patch, per metre
+    float dh_dx = ((h10 - h00) + fz * ((h11 - h01) - (h10 - h00))) * texels_per_metre_x;
+    float dh_dz = (h1 - h0) * texels_per_metre_z;
+    normal_out = glm::normalize(glm::vec3(-dh_dx, 1.0f, -dh_dz));
+}
+
+void Heightfield::sampleBatch(const float* world_x, const float* world_z, size_t count, float* heights, glm::vec3* normals) const {
+    if (empty()) {
+        for (size_t i = 0; i < count; ++i) {
+            heights[i] = 0.0f;
+            if (normals) normals[i] = glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+        return;
+    }
+
+    using namespace lane;
+    const Lane scale_x = splat(texels_per_metre_x), offset_x = splat(texel_offset_x);
+    const Lane scale_z = splat(texels_per_metre_z), offset_z = splat(texel_offset_z);
+    const Lane zero = splat(0.0f);
+    const Lane max_tx = splat(static_cast<float>(width - 1)), max_cx = splat(static_cast<float>(width - 2));
+    const Lane max_tz = splat(static_cast<float>(height_texels - 1)), max_cz = splat(static_cast<float>(height_texels - 2));
+
+    size_t vector_end = count - (count % SIMD_WIDTH);
+    int32_t ix[SIMD_WIDTH], iz[SIMD_WIDTH];
+    alignas(32) float c00[SIMD_WIDTH], c10[SIMD_WIDTH], c01[SIMD_WIDTH], c11[SIMD_WIDTH];
+    alignas(32) float slope_x[SIMD_WIDTH], slope_z[SIMD_WIDTH];
+    for (size_t n = 0; n < vector_end; n += SIMD_WIDTH) {
+        Lane tx = min(max(add(mul(load(world_x + n), scale_x), offset_x), zero), max_tx);
+        Lane tz = min(max(add(mul(load(world_z + n), scale_z), offset_z), zero), max_tz);
+        Lane cx = min(floor(tx), max_cx);
+        Lane cz = min(floor(tz), max_cz);
+        Lane fx = sub(tx, cx), fz = sub(tz, cz);
+        toIndices(ix, cx);
+        toIndices(iz, cz);
+
+        // Gather the 4 corners (one tile per lane)
+        for (size_t k = 0; k < SIMD_WIDTH; ++k) {
+            const float* c = &tiles[cellBase(ix[k], iz[k])];
+            c00[k] = c[0];
+            c10[k] = c[1];
+            c01[k] = c[TILE_STRIDE];
+            c11[k] = c[TILE_STRIDE + 1];
+        }
+        Lane h00 = load(c00), h10 = load(c10), h01 = load(c01), h11 = load(c11);
+        Lane d0 = sub(h10, h00), d1 = sub(h11, h01);
+        Lane h0 = add(h00, mul(fx, d0));
+        Lane h1 = add(h01, mul(fx, d1));
+        store(heights + n, add(h0, mul(fz, sub(h1, h0))));
+
+        if (normals) {
+            store(slope_x, mul(add(d0, mul(fz, sub(d1, d0))), scale_x));
+            store(slope_z, mul(sub(h1, h0), scale_z));
+            for (size_t k = 0; k < SIMD_WIDTH; ++k) {
+                normals[n + k] = glm::normalize(glm::vec3(-slope_x[k], 1.0f, -slope_z[k]));
+            }
+        }
+    }
+
+    // Remainder
+    for (size_t n = vector_end; n < count; ++n) {
+        if (normals) sample(world_x[n], world_z[n], heights[n], normals[n]);
+        else heights[n] = height(world_x[n], world_z[n]);
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef HEIGHTFIELD_H
+#define HEIGHTFIELD_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Where a heightfield came from, so a recording can reload exactly the same surface
+struct HeightfieldSource {
+    std::string path;        // Image given to loadImage(); empty for setHeights() data
+    float world_size = 0.0f;
+    float max_height = 0.0f; // loadImage() scale, not the highest texel
+    uint64_t hash = 0;       // getContentHash() of the loaded texels; 0 = no heightfield (flat ground)
+};
+
+// CPU copy of the terrain heightmap for ground contact and height queries.
+// Queries use the same mapping as terrain.vert: uv = worldXZ / world_size + 0.5, clamped
+// to [0, 1], bilinear filtering with clamp-to-edge, texel rows in OpenGL order (stb loads
+// flipped), height = red * max_height. An empty heightfield is flat at y = 0.
+//
+// Texels are stored in 16x16-cell tiles with a one-texel apron (17x17 floats, ~1 KB), so
+// the four texels of any bilinear lookup sit in one tile and nearby queries share cache lines.
+class Heightfield {
+public:
+    static constexpr int TILE_SHIFT = 4;
+    static constexpr int TILE_CELLS = 1 << TILE_SHIFT; // 16
+    static constexpr int TILE_STRIDE = TILE_CELLS + 1; // Texels per tile row (incl. apron)
+
+    // Red channel of an image file (any stb format) scaled to [0, max_height] metres.
+    // Prints an error and returns false if the file cannot be read; the heightfield is unchanged.
+    bool loadImage(const std::string& path, float world_size, float max_height);
+
+    // Heights in metres, row-major, row 0 at the -Z edge (OpenGL texture order)
+    void setHeights(int width, int height, const std::vector<float>& heights_m, float world_size);
+
+    // loadImage() with a recorded source. Fails (and logs) if the image is missing, or if it no
+    // longer hashes to source.hash, in which case the heightfield is left empty.
+    bool loadSource(const HeightfieldSource& source);
+    // Path and scale of the last loadImage() (empty path after setHeights()) and the content hash
+    const HeightfieldSource& getSource() const { return source; }
+    // FNV-1a over the dimensions, world size and texels; 0 for an empty heightfield
+    uint64_t getContentHash() const { return source.hash; }
+
+    // --- Queries (world X/Z in metres) ---
+    float height(float world_x, float world_z) const;
+    glm::vec3 normal(float world_x, float world_z) const; // Of the bilinear surface, world space, +Y up
+    void sample(float world_x, float world_z, float& height_out, glm::vec3& normal_out) const;
+
+    // `count` queries at once (SIMD). normals may be null.
+    void sampleBatch(const float* world_x, const float* world_z, size_t count, float* heights, glm::vec3* normals = nullptr) const;
+
+    bool empty() const { return width < 2 || height_texels < 2; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height_texels; }
+    float getWorldSize() const { return world_size; }
+    float getMinHeight() const { return min_height; }
+    float getMaxHeight() const { return max_height; }
+
+    // Raw texel (clamped to the edges), metres
+    float texel(int x, int y) const;
+
+    // --- Cell access (TerrainRaycaster) ---
+    // World X/Z -> continuous texel coordinates (texel centres at integers, before clamping)
+    glm::vec2 worldToTexel(float world_x, float world_z) const {
+        return glm::vec2(world_x * texels_per_metre_x + texel_offset_x, world_z * texels_per_metre_z + texel_offset_z);
+    }
+    glm::vec2 getTexelsPerMetre() const { return glm::vec2(texels_per_metre_x, texels_per_metre_z); }
+    // Corners of cell (cx, cz) in [0, width-2] x [0, height-2]: c[0] (x, z), c[1] (x+1, z),
+    // c[TILE_STRIDE] (x, z+1), c[TILE_STRIDE + 1] (x+1, z+1)
+    const float* cell(int cx, int cz) const { return &tiles[cellBase(cx, cz)]; }
+
+private:
+    int width = 0;
+    int height_texels = 0;
+    int tiles_x = 0;
+    float world_size = 1.0f;
+    float min_height = 0.0f;
+    float max_height = 0.0f;
+    HeightfieldSource source;
+    std::vector<float> tiles; // tiles_x * tiles_y tiles of TILE_STRIDE^2 texels
+
+    // World metres -> texel coordinates (cell index + fraction), per axis
+    float texels_per_metre_x = 0.0f, texels_per_metre_z = 0.0f;
+    float texel_offset_x = 0.0f, texel_offset_z = 0.0f;
+
+    // Cell lookup: texel coordinate -> first of the 4 corner texels + fractions
+    size_t locate(float world_x, float world_z, float& fx, float& fz) const;
+    // Cells are non-negative and TILE_CELLS is a power of two: shifts and masks, no division
+    size_t cellBase(int cx, int cz) const {
+        const unsigned x = static_cast<unsigned>(cx), z = static_cast<unsigned>(cz);
+        size_t tile = static_cast<size_t>(z >> TILE_SHIFT) * tiles_x + (x >> TILE_SHIFT);
+        return tile * (TILE_STRIDE * TILE_STRIDE) + (z & (TILE_CELLS - 1)) * TILE_STRIDE + (x & (TILE_CELLS - 1));
+    }
+};
+
+#endif // HEIGHTFIELD_H
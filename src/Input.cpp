@@ -7,6 +7,7 @@ float Input::Pitch = 0.0f;
 float Input::Roll = 0.0f;
 float Input::Yaw = 0.0f;
 std::map<int, bool> Input::keys;
+std::map<int, bool> Input::pressed;
 
 void Input::Initialize(GLFWwindow* window) {
     glfwSetKeyCallback(window, keyCallback);
@@ -23,11 +24,19 @@ void Input::keyCallback(GLFWwindow* window, int key, int scancode, int action, i
     // Update key state map
     if (action == GLFW_PRESS) {
         keys[key] = true;
+        pressed[key] = true;
     } else if (action == GLFW_RELEASE) {
         keys[key] = false;
     }
 }
 
+bool Input::consumeKeyPress(int key) {
+    auto it = pressed.find(key);
+    if (it == pressed.end() || !it->second) return false;
+    it->second = false;
+    return true;
+}
+
 void Input::ProcessInput(GLFWwindow *window) {
     // Reset axes that depend on continuous press
     Pitch = 0.0f;
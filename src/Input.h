@@ -14,6 +14,8 @@ public:
 
     static void Initialize(GLFWwindow* window);
     static void ProcessInput(GLFWwindow *window); // Process continuous key presses
+    // True once per press of `key` since the last call (toggles like the F3 profiler)
+    static bool consumeKeyPress(int key);
 
 private:
     // Callback function for key presses/releases
@@ -21,6 +23,8 @@ private:
 
     // Track which keys are currently held down
     static std::map<int, bool> keys;
+    // Presses not yet consumed
+    static std::map<int, bool> pressed;
 };
 
 #endif // INPUT_H
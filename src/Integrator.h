@@ -0,0 +1,41 @@
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include <cstdint>
+
+// Integration schemes selectable per RigidBody (see RigidBody::integrator)
+enum class IntegratorType {
+    SemiImplicitEuler, // Original scheme: v then x, additive quaternion update + renormalize
+    ExponentialMap,    // Symplectic Euler for velocities, orientation rotated by exp(0.5*w*dt) (stays on the unit sphere)
+    RK4                // Classic 4th order Runge-Kutta, forces re-evaluated at each stage via RigidBody::evaluateForces()
+};
+
+inline const char* integratorName(IntegratorType type) {
+    switch (type) {
+        case IntegratorType::SemiImplicitEuler: return "SemiImplicitEuler";
+        case IntegratorType::ExponentialMap:    return "ExponentialMap";
+        case IntegratorType::RK4:               return "RK4";
+    }
+    return "Unknown";
+}
+
+// Accuracy metrics gathered while RigidBody::track_integrator_stats is enabled.
+// energy_error compares the change in mechanical energy with the work done by the
+// accumulated (non-gravity) forces and torques, so it isolates integration error
+// even when the body is being pushed around by aerodynamics.
+struct IntegratorStats {
+    uint64_t steps = 0;
+    double initial_energy = 0.0;    // Kinetic + potential energy when tracking started (J)
+    double energy = 0.0;            // Current kinetic + potential energy (J)
+    double energy_error = 0.0;      // Accumulated sum of (dE - external work) over all steps (J)
+    double max_step_energy_error = 0.0;
+    float quat_norm_error = 0.0f;   // | |q| - 1 | before renormalization, last step
+    float max_quat_norm_error = 0.0f;
+
+    // Energy error relative to the initial energy (dimensionless)
+    double relativeEnergyError() const {
+        return initial_energy != 0.0 ? energy_error / (initial_energy < 0.0 ? -initial_energy : initial_energy) : energy_error;
+    }
+};
+
+#endif // INTEGRATOR_H
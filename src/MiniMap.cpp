@@ -1,6 +1,7 @@
 #include "MiniMap.h"
 #include "Graphics.h"       // Access shader, screen dimensions, OpenGL functions via glew.h
 #include "Shader.h"         // <-- ***** ADD THIS LINE ***** For full Shader definition
+#include "Trace.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <vector>
 #include <iostream>         // For debugging if needed
@@ -95,6 +96,7 @@ void MiniMap::setupRenderData() {
 
 // Render function - Now has access to Shader definition and member VAOs/VBOs
 void MiniMap::render(const glm::vec3& aircraftPosition, const glm::quat& aircraftOrientation, float worldSize) {
+    FS_TRACE_ZONE("MiniMap::render");
     // Check required resources are valid
     if (!Graphics::minimapShader || VAO_quad == 0 || VAO_tri == 0) {
          // std::cerr << "Minimap render skipped: Missing shader or VAOs" << std::endl;
@@ -105,14 +107,9 @@ void MiniMap::render(const glm::vec3& aircraftPosition, const glm::quat& aircraf
     int screenHeight = Graphics::getHeight();
     if (screenWidth <= 0 || screenHeight <= 0) return; // Avoid division by zero or invalid projection
 
-    // --- Setup Orthographic Projection ---
-    // Map screen coordinates (0,0) top-left to (W, H) bottom-right
-    // Use 0.0f for near/far planes for simple 2D ortho
-    glm::mat4 projection = glm::ortho(0.0f, (float)screenWidth, (float)screenHeight, 0.0f, -1.0f, 1.0f);
-
-    // Use the minimap shader - Compiler now knows these functions
+    // Orthographic screen projection ((0,0) top-left to (W, H) bottom-right) is
+    // FrameData::screen_projection, shared through the per-frame uniform block
     Graphics::minimapShader->use();
-    Graphics::minimapShader->setMat4("projection", projection);
 
     // --- State Changes for 2D Overlay ---
     GLboolean last_depth_test = glIsEnabled(GL_DEPTH_TEST); // Store previous depth test state
@@ -1,6 +1,7 @@
 #ifndef OPENGL_UTILS_H
 #define OPENGL_UTILS_H
 
+#include "BakedTexture.h"
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <vector>
@@ -90,6 +91,79 @@ struct TextureParams {
     GLenum texture_min_filter = GL_LINEAR_MIPMAP_LINEAR;
 };
 
+inline bool usesMipmaps(GLenum min_filter) {
+    return min_filter == GL_NEAREST_MIPMAP_NEAREST || min_filter == GL_LINEAR_MIPMAP_NEAREST ||
+           min_filter == GL_NEAREST_MIPMAP_LINEAR || min_filter == GL_LINEAR_MIPMAP_LINEAR;
+}
+
+// --- Baked textures (see BakedTexture.h) ---
+// BC1 needs EXT_texture_compression_s3tc (every desktop driver has it, core 3.3 does not promise it)
+inline bool canUploadBaked(const BakedTexture& baked) {
+    return baked.isOpen() && (!baked.isCompressed() || GLEW_EXT_texture_compression_s3tc);
+}
+
+// Upload one level into the bound GL_TEXTURE_2D straight from the file mapping.
+// No pixel unpack buffer may be bound.
+inline void uploadBakedLevel(const BakedTexture& baked, int index) {
+    const BakedLevel& level = baked.level(index);
+    if (baked.isCompressed()) {
+        glCompressedTexImage2D(GL_TEXTURE_2D, index, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, level.width, level.height, 0,
+                               static_cast<GLsizei>(level.size), level.data);
+        return;
+    }
+    GLenum format = baked.getFormat() == BakedFormat::R8 ? GL_RED : baked.getFormat() == BakedFormat::RGB8 ? GL_RGB : GL_RGBA;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, index, format, level.width, level.height, 0, format, GL_UNSIGNED_BYTE, level.data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+// Incremental upload of one level (AsyncTextureLoader): allocate it, then fill it a strip of
+// rows at a time. BC1 strips are whole block rows, so `row` and `rows` are multiples of 4
+// except where the strip ends at the top edge.
+inline void allocateBakedLevel(const BakedTexture& baked, int index) {
+    const BakedLevel& level = baked.level(index);
+    if (baked.isCompressed()) {
+        glTexImage2D(GL_TEXTURE_2D, index, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, level.width, level.height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        return;
+    }
+    GLenum format = baked.getFormat() == BakedFormat::R8 ? GL_RED : baked.getFormat() == BakedFormat::RGB8 ? GL_RGB : GL_RGBA;
+    glTexImage2D(GL_TEXTURE_2D, index, format, level.width, level.height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+}
+
+// Bytes per row of texels, or per row of 4x4 blocks for BC1
+inline size_t bakedRowBytes(const BakedTexture& baked, int index) {
+    const BakedLevel& level = baked.level(index);
+    if (baked.isCompressed()) return static_cast<size_t>((level.width + 3) / 4) * 8;
+    return static_cast<size_t>(level.width) * static_cast<size_t>(baked.getFormat());
+}
+
+// Texel rows covered by one bakedRowBytes() row
+inline int bakedRowHeight(const BakedTexture& baked) { return baked.isCompressed() ? 4 : 1; }
+
+inline void uploadBakedRows(const BakedTexture& baked, int index, int row, int rows) {
+    const BakedLevel& level = baked.level(index);
+    const uint8_t* source = level.data + static_cast<size_t>(row / bakedRowHeight(baked)) * bakedRowBytes(baked, index);
+    if (baked.isCompressed()) {
+        GLsizei size = static_cast<GLsizei>(static_cast<size_t>((rows + 3) / 4) * bakedRowBytes(baked, index));
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, index, 0, row, level.width, rows, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, size, source);
+        return;
+    }
+    GLenum format = baked.getFormat() == BakedFormat::R8 ? GL_RED : baked.getFormat() == BakedFormat::RGB8 ? GL_RGB : GL_RGBA;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, index, 0, row, level.width, rows, format, GL_UNSIGNED_BYTE, source);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+// After the last baked level: make the texture complete for its filter. A stored chain is
+// capped at its last level; a single uncompressed level gets GPU mipmaps as a fallback.
+inline void finishBakedLevels(const BakedTexture& baked, const TextureParams& params) {
+    if (baked.getLevelCount() == 1 && usesMipmaps(params.texture_min_filter) && !baked.isCompressed()) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        return;
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, baked.getLevelCount() - 1);
+}
+
 } // namespace GLUtil
 
 #endif // OPENGL_UTILS_H
@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <cmath> // For std::exp
+#include "Atmosphere.h"
 
 namespace PhysicsConfig {
     const float GRAVITY = 9.81f;
@@ -13,16 +14,11 @@ namespace PhysicsConfig {
     inline float sq(float val) { return val * val; }
 
     // --- ISA (International Standard Atmosphere) Model ---
-    // Simplified version - returns air density (kg/m^3) based on altitude (meters)
-    // Sea level density: 1.225 kg/m^3
-    // Temperature lapse rate: -0.0065 K/m up to 11km
-    // Pressure = P0 * (T/T0)^(-g/(R*L))
-    // Density = P / (R * T)
-    // Very simplified exponential decay approximation for density:
+    // Returns air density (kg/m^3) based on altitude (meters).
+    // Forwards to the tabulated ISA model; use Atmosphere::sample() for temperature,
+    // pressure, speed of sound and viscosity as well.
     inline float get_air_density(float altitude_m) {
-        const float seaLevelDensity = 1.225f;
-        const float scaleHeight = 8500.0f; // Approximate scale height for density
-        return seaLevelDensity * std::exp(-altitude_m / scaleHeight);
+        return Atmosphere::density(altitude_m);
     }
 
     // --- Airfoil Data (Example NACA 0012 & 2412) ---
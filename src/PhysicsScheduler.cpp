@@ -0,0 +1,105 @@
+#include "PhysicsScheduler.h"
+#include "SpatialHash.h"
+#include <algorithm>
+#include <cmath>
+
+PhysicsScheduler::PhysicsScheduler(float step_rate_hz, int max_substeps_per_frame) :
+    fixed_dt(1.0f / 120.0f),
+    max_substeps(1)
+{
+    setStepRate(step_rate_hz);
+    setMaxSubsteps(max_substeps_per_frame);
+}
+
+void PhysicsScheduler::addBody(RigidBody* body) {
+    if (!body) return;
+    if (std::find(bodies.begin(), bodies.end(), body) != bodies.end()) return;
+    bodies.push_back(body);
+    previous_poses.push_back(poseOf(body));
+    if (broadphase) broadphase->build(bodies); // Queries between steps must see the new index range
+}
+
+void PhysicsScheduler::removeBody(RigidBody* body) {
+    auto it = std::find(bodies.begin(), bodies.end(), body);
+    if (it == bodies.end()) return;
+    size_t index = static_cast<size_t>(it - bodies.begin());
+    bodies.erase(it);
+    previous_poses.erase(previous_poses.begin() + index);
+    if (broadphase) broadphase->build(bodies); // Indices after `index` shifted down
+}
+
+void PhysicsScheduler::setBroadphase(SpatialHash* hash) {
+    broadphase = hash;
+    if (broadphase) broadphase->build(bodies);
+}
+
+void PhysicsScheduler::setStepRate(float hz) {
+    fixed_dt = 1.0f / std::max(1.0f, hz);
+}
+
+void PhysicsScheduler::setMaxSubsteps(int steps) {
+    max_substeps = std::max(1, steps);
+}
+
+void PhysicsScheduler::setMaxFrameTime(float seconds) {
+    max_frame_time = std::max(fixed_dt, seconds);
+}
+
+PhysicsScheduler::Pose PhysicsScheduler::poseOf(const RigidBody* body) {
+    return {body->position_world, body->orientation_world};
+}
+
+void PhysicsScheduler::step() {
+    if (pre_step) pre_step(fixed_dt);
+
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        previous_poses[i] = poseOf(bodies[i]);
+        bodies[i]->update(fixed_dt); // Virtual: Aircraft applies its forces, then integrates
+    }
+
+    if (broadphase) broadphase->build(bodies);
+    if (post_step) post_step(fixed_dt);
+
+    ++step_count;
+    sim_time += fixed_dt;
+}
+
+int PhysicsScheduler::advance(float frame_dt) {
+    // Clamp pathological frames (debugger breaks, window drags) before accumulating
+    if (frame_dt < 0.0f) frame_dt = 0.0f;
+    if (frame_dt > max_frame_time) {
+        dropped_time += frame_dt - max_frame_time;
+        frame_dt = max_frame_time;
+    }
+    accumulator += frame_dt;
+
+    int steps = 0;
+    while (accumulator >= fixed_dt && steps < max_substeps) {
+        step();
+        accumulator -= fixed_dt;
+        ++steps;
+    }
+
+    // Still behind after the substep cap: drop whole steps so we don't spiral,
+    // the simulation runs slower than real time instead of destabilizing
+    if (accumulator >= fixed_dt) {
+        double whole_steps = std::floor(accumulator / fixed_dt);
+        dropped_time += whole_steps * fixed_dt;
+        accumulator -= whole_steps * fixed_dt;
+    }
+
+    alpha = static_cast<float>(accumulator / fixed_dt);
+    last_substeps = steps;
+    return steps;
+}
+
+PhysicsScheduler::Pose PhysicsScheduler::getInterpolatedPose(const RigidBody* body) const {
+    auto it = std::find(bodies.begin(), bodies.end(), body);
+    if (it == bodies.end()) return poseOf(body);
+
+    const Pose& previous = previous_poses[static_cast<size_t>(it - bodies.begin())];
+    Pose pose;
+    pose.position = glm::mix(previous.position, body->position_world, alpha);
+    pose.orientation = glm::slerp(previous.orientation, body->orientation_world, alpha);
+    return pose;
+}
@@ -0,0 +1,87 @@
+#ifndef PHYSICS_SCHEDULER_H
+#define PHYSICS_SCHEDULER_H
+
+#include "RigidBody.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class SpatialHash;
+
+// Fixed-timestep accumulator loop ("fix your timestep").
+// The frame loop hands in its variable frame time; the scheduler steps every registered
+// body with a constant dt, at most max_substeps times per frame, and keeps the previous
+// physics pose of each body so rendering can interpolate between the last two states.
+class PhysicsScheduler {
+public:
+    // Rendered pose of a body (interpolated between physics steps)
+    struct Pose {
+        glm::vec3 position{0.0f};
+        glm::quat orientation{1.0f, 0.0f, 0.0f, 0.0f};
+    };
+
+    // Optional hooks run around every fixed step (e.g. input recording, broadphase rebuild)
+    std::function<void(float dt)> pre_step;
+    std::function<void(float dt)> post_step;
+
+    explicit PhysicsScheduler(float step_rate_hz = 120.0f, int max_substeps = 8);
+
+    // --- Bodies (not owned) ---
+    void addBody(RigidBody* body);
+    void removeBody(RigidBody* body);
+    const std::vector<RigidBody*>& getBodies() const { return bodies; }
+
+    // --- Broadphase (not owned) ---
+    // Rebuilt from getBodies() after every step (before post_step) and on addBody/removeBody,
+    // so its indices always match getBodies()
+    void setBroadphase(SpatialHash* hash);
+    SpatialHash* getBroadphase() const { return broadphase; }
+
+    // --- Configuration ---
+    void setStepRate(float hz);          // Physics steps per simulated second
+    void setMaxSubsteps(int steps);      // Cap on steps per frame; extra time is dropped
+    void setMaxFrameTime(float seconds); // Frame times above this are clamped first
+    float getStepRate() const { return 1.0f / fixed_dt; }
+    float getFixedDt() const { return fixed_dt; }
+    int getMaxSubsteps() const { return max_substeps; }
+
+    // --- Stepping ---
+    // Advance the simulation by a (variable) frame time. Returns the number of fixed steps taken.
+    int advance(float frame_dt);
+    // Run exactly one fixed step regardless of the accumulator (headless/scripted use)
+    void step();
+
+    // --- Interpolation ---
+    // Fraction of a step left in the accumulator, in [0, 1)
+    float getAlpha() const { return alpha; }
+    // Pose blended between the previous and current physics state by getAlpha()
+    Pose getInterpolatedPose(const RigidBody* body) const;
+
+    // --- Statistics ---
+    int getLastSubsteps() const { return last_substeps; }
+    uint64_t getStepCount() const { return step_count; }
+    double getSimTime() const { return sim_time; }
+    double getDroppedTime() const { return dropped_time; } // Time discarded due to the substep cap
+
+private:
+    std::vector<RigidBody*> bodies;
+    std::vector<Pose> previous_poses; // Parallel to bodies
+    SpatialHash* broadphase = nullptr;
+
+    float fixed_dt;
+    int max_substeps;
+    float max_frame_time = 0.25f;
+
+    double accumulator = 0.0;
+    float alpha = 0.0f;
+    int last_substeps = 0;
+    uint64_t step_count = 0;
+    double sim_time = 0.0;
+    double dropped_time = 0.0;
+
+    static Pose poseOf(const RigidBody* body);
+};
+
+#endif // PHYSICS_SCHEDULER_H
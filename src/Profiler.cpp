@@ -0,0 +1,313 @@
+#include "Profiler.h"
+#include "Graphics.h"
+#include "Shader.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+const double DISPLAY_INTERVAL_MS = 500.0;
+const float GRAPH_RANGE_MS = 1000.0f / 30.0f; // Full graph height / bar width
+// Profiler's own CPU time (endFrame and renderHud). One pointer for both: sections are matched by pointer
+const char* const PROFILER_SECTION = "profiler";
+
+// --- HUD layout (pixels, origin top-left as FrameData::screen_projection) ---
+const float HUD_X = 10.0f;
+const float HUD_Y = 10.0f;
+const float BAR_STEP = 2.0f;                                // Graph column width
+const float HUD_WIDTH = Profiler::HISTORY * BAR_STEP;
+const float GRAPH_HEIGHT = 100.0f;
+const float BREAKDOWN_HEIGHT = 12.0f;
+
+const float PALETTE[][4] = {
+    {0.95f, 0.45f, 0.35f, 1.0f}, {0.35f, 0.75f, 0.95f, 1.0f}, {0.55f, 0.90f, 0.40f, 1.0f}, {0.95f, 0.80f, 0.30f, 1.0f},
+    {0.75f, 0.50f, 0.95f, 1.0f}, {0.95f, 0.55f, 0.80f, 1.0f}, {0.40f, 0.90f, 0.80f, 1.0f}, {0.80f, 0.80f, 0.80f, 1.0f},
+};
+const int PALETTE_SIZE = sizeof(PALETTE) / sizeof(PALETTE[0]);
+
+struct HudVertex {
+    float x, y;
+    float r, g, b, a;
+};
+
+struct QuerySet {
+    GLuint queries[Profiler::MAX_SECTIONS] = {};
+    const char* names[Profiler::MAX_SECTIONS] = {};
+    int count = 0;
+    bool pending = false; // Ended, not read back yet
+};
+
+struct State {
+    bool initialized = false;
+    bool enabled = false;
+    std::string title;
+    uint64_t frame = 0;
+    double last_frame_start = 0.0;
+
+    std::vector<Profiler::Section> cpu_frame; // This frame's scopes
+    QuerySet sets[Profiler::FRAMES_IN_FLIGHT];
+    QuerySet* current = nullptr;
+    bool gpu_active = false;
+
+    float frame_history[Profiler::HISTORY] = {};
+    float gpu_history[Profiler::HISTORY] = {};
+    int frame_history_pos = 0;
+    int gpu_history_pos = 0;
+
+    // Sums over the display interval, and their averages
+    std::vector<Profiler::Section> cpu_sum, gpu_sum;
+    double frame_sum = 0.0, gpu_total_sum = 0.0;
+    int frame_count = 0, gpu_frame_count = 0;
+    double interval_start = 0.0;
+    std::vector<Profiler::Section> cpu_average, gpu_average;
+    float frame_average = 0.0f, gpu_average_total = 0.0f;
+
+    GLuint vao = 0, vbo = 0;
+    std::vector<HudVertex> vertices;
+};
+
+State state;
+
+double nowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void addTo(std::vector<Profiler::Section>& sections, const char* name, float ms) {
+    for (Profiler::Section& section : sections) {
+        if (section.name == name) {
+            section.ms += ms;
+            return;
+        }
+    }
+    if (sections.size() < static_cast<size_t>(Profiler::MAX_SECTIONS)) sections.push_back({name, ms});
+}
+
+void quad(float x, float y, float w, float h, const float color[4]) {
+    HudVertex v[4] = {{x, y, color[0], color[1], color[2], color[3]}, {x + w, y, color[0], color[1], color[2], color[3]},
+                      {x + w, y + h, color[0], color[1], color[2], color[3]}, {x, y + h, color[0], color[1], color[2], color[3]}};
+    const int order[6] = {0, 1, 2, 0, 2, 3};
+    for (int i : order) state.vertices.push_back(v[i]);
+}
+
+// Stacked horizontal bar, GRAPH_RANGE_MS = full width
+void breakdown(float y, const std::vector<Profiler::Section>& sections) {
+    float x = HUD_X;
+    for (size_t i = 0; i < sections.size(); ++i) {
+        float w = std::min(sections[i].ms / GRAPH_RANGE_MS * HUD_WIDTH, HUD_X + HUD_WIDTH - x);
+        if (w <= 0.0f) break;
+        quad(x, y, std::max(w, 1.0f), BREAKDOWN_HEIGHT, PALETTE[i % PALETTE_SIZE]);
+        x += w;
+    }
+}
+
+void appendSections(char*& out, char* end, const std::vector<Profiler::Section>& sections) {
+    for (size_t i = 0; i < sections.size() && out < end; ++i) {
+        out += std::snprintf(out, static_cast<size_t>(end - out), "%s%s %.2f", i ? ", " : " ", sections[i].name, sections[i].ms);
+    }
+}
+
+void publishInterval(double now) {
+    int frames = std::max(state.frame_count, 1);
+    state.frame_average = static_cast<float>(state.frame_sum / frames);
+    state.cpu_average = state.cpu_sum;
+    for (Profiler::Section& section : state.cpu_average) section.ms /= frames;
+    int gpu_frames = std::max(state.gpu_frame_count, 1);
+    state.gpu_average_total = static_cast<float>(state.gpu_total_sum / gpu_frames);
+    state.gpu_average = state.gpu_sum;
+    for (Profiler::Section& section : state.gpu_average) section.ms /= gpu_frames;
+
+    char text[1024];
+    char* out = text;
+    char* end = text + sizeof(text);
+    float fps = state.frame_average > 0.0f ? 1000.0f / state.frame_average : 0.0f;
+    out += std::snprintf(out, static_cast<size_t>(end - out), "%s | %.2f ms (%.0f fps) | CPU ms:", state.title.c_str(), state.frame_average, fps);
+    appendSections(out, end, state.cpu_average);
+    if (out < end) out += std::snprintf(out, static_cast<size_t>(end - out), " | GPU %.2f ms:", state.gpu_average_total);
+    appendSections(out, end, state.gpu_average);
+    if (Graphics::getWindow()) glfwSetWindowTitle(Graphics::getWindow(), text);
+
+    state.cpu_sum.clear();
+    state.gpu_sum.clear();
+    state.frame_sum = state.gpu_total_sum = 0.0;
+    state.frame_count = state.gpu_frame_count = 0;
+    state.interval_start = now;
+}
+
+// Read back every ended query set whose results are ready; never waits
+void collectQueries() {
+    for (int age = Profiler::FRAMES_IN_FLIGHT - 1; age >= 1; --age) {
+        QuerySet& set = state.sets[(state.frame + Profiler::FRAMES_IN_FLIGHT - age) % Profiler::FRAMES_IN_FLIGHT];
+        if (!set.pending) continue;
+        GLint available = 0;
+        glGetQueryObjectiv(set.queries[set.count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue; // Queries of one set finish in order: try again next frame
+        float total = 0.0f;
+        for (int i = 0; i < set.count; ++i) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(set.queries[i], GL_QUERY_RESULT, &ns);
+            float ms = static_cast<float>(ns * 1e-6);
+            addTo(state.gpu_sum, set.names[i], ms);
+            total += ms;
+        }
+        set.pending = false;
+        state.gpu_history[state.gpu_history_pos] = total;
+        state.gpu_history_pos = (state.gpu_history_pos + 1) % Profiler::HISTORY;
+        state.gpu_total_sum += total;
+        ++state.gpu_frame_count;
+    }
+}
+
+} // namespace
+
+void Profiler::init(const std::string& window_title) {
+    state.title = window_title;
+    for (QuerySet& set : state.sets) glGenQueries(MAX_SECTIONS, set.queries);
+
+    glGenVertexArrays(1, &state.vao);
+    glGenBuffers(1, &state.vbo);
+    glBindVertexArray(state.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, state.vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    state.initialized = true;
+}
+
+void Profiler::cleanup() {
+    if (!state.initialized) return;
+    for (QuerySet& set : state.sets) glDeleteQueries(MAX_SECTIONS, set.queries);
+    glDeleteBuffers(1, &state.vbo);
+    glDeleteVertexArrays(1, &state.vao);
+    state = State();
+}
+
+void Profiler::setEnabled(bool enabled) {
+    if (!state.initialized || enabled == state.enabled) return;
+    state.enabled = enabled;
+    if (!enabled) {
+        if (Graphics::getWindow()) glfwSetWindowTitle(Graphics::getWindow(), state.title.c_str());
+        return;
+    }
+    // Start clean: no half-recorded frame or stale queries
+    for (QuerySet& set : state.sets) set.pending = false;
+    std::fill(std::begin(state.frame_history), std::end(state.frame_history), 0.0f);
+    std::fill(std::begin(state.gpu_history), std::end(state.gpu_history), 0.0f);
+    state.cpu_sum.clear();
+    state.gpu_sum.clear();
+    state.frame_sum = state.gpu_total_sum = 0.0;
+    state.frame_count = state.gpu_frame_count = 0;
+    state.last_frame_start = 0.0;
+    state.current = nullptr;
+    state.interval_start = nowMs();
+}
+
+bool Profiler::isEnabled() {
+    return state.enabled;
+}
+
+void Profiler::beginFrame() {
+    if (!state.enabled) return;
+    double now = nowMs();
+    if (state.last_frame_start > 0.0) {
+        float ms = static_cast<float>(now - state.last_frame_start);
+        state.frame_history[state.frame_history_pos] = ms;
+        state.frame_history_pos = (state.frame_history_pos + 1) % HISTORY;
+        state.frame_sum += ms;
+        ++state.frame_count;
+    }
+    state.last_frame_start = now;
+    state.cpu_frame.clear();
+    state.current = &state.sets[state.frame % FRAMES_IN_FLIGHT];
+    state.current->count = 0; // Unread results of this set (GPU very far behind) are dropped
+    state.current->pending = false;
+}
+
+void Profiler::endFrame() {
+    if (!state.enabled || !state.current) return;
+    double start = nowMs();
+    for (const Section& section : state.cpu_frame) addTo(state.cpu_sum, section.name, section.ms);
+    state.current->pending = state.current->count > 0;
+    ++state.frame;
+    collectQueries();
+    double now = nowMs();
+    addTo(state.cpu_sum, PROFILER_SECTION, static_cast<float>(now - start));
+    if (now - state.interval_start >= DISPLAY_INTERVAL_MS) publishInterval(now);
+}
+
+// --- Scopes ---
+Profiler::CpuScope::CpuScope(const char* scope_name) : name(scope_name), start_ms(state.enabled ? nowMs() : 0.0) {}
+
+Profiler::CpuScope::~CpuScope() {
+    if (state.enabled && start_ms > 0.0) addTo(state.cpu_frame, name, static_cast<float>(nowMs() - start_ms));
+}
+
+Profiler::GpuScope::GpuScope(const char* name) : active(false) {
+    if (!state.enabled || !state.current || state.gpu_active || state.current->count >= MAX_SECTIONS) return;
+    QuerySet& set = *state.current;
+    set.names[set.count] = name;
+    glBeginQuery(GL_TIME_ELAPSED, set.queries[set.count]);
+    state.gpu_active = true;
+    active = true;
+}
+
+Profiler::GpuScope::~GpuScope() {
+    if (!active) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    ++state.current->count;
+    state.gpu_active = false;
+}
+
+// --- HUD ---
+void Profiler::renderHud() {
+    if (!state.enabled || !Graphics::hudShader || !Graphics::hudShader->ID) return;
+    CpuScope self(PROFILER_SECTION);
+    GpuScope gpu("hud");
+
+    state.vertices.clear();
+    const float background[4] = {0.0f, 0.0f, 0.0f, 0.55f};
+    const float line[4] = {1.0f, 1.0f, 1.0f, 0.35f};
+    const float gpu_color[4] = {0.30f, 0.60f, 1.00f, 0.85f};
+    const float good[4] = {0.35f, 0.85f, 0.35f, 0.9f};
+    const float slow[4] = {0.95f, 0.80f, 0.25f, 0.9f};
+    const float bad[4] = {0.95f, 0.30f, 0.25f, 0.9f};
+    float breakdown_y = HUD_Y + GRAPH_HEIGHT + 6.0f;
+    quad(HUD_X - 4.0f, HUD_Y - 4.0f, HUD_WIDTH + 8.0f, GRAPH_HEIGHT + 2.0f * BREAKDOWN_HEIGHT + 18.0f, background);
+
+    // Frame time graph, oldest on the left; GPU total as a thinner bar in front
+    for (int i = 0; i < HISTORY; ++i) {
+        float ms = state.frame_history[(state.frame_history_pos + i) % HISTORY];
+        float h = std::min(ms / GRAPH_RANGE_MS, 1.0f) * GRAPH_HEIGHT;
+        const float* color = ms <= 1000.0f / 60.0f + 0.5f ? good : ms <= GRAPH_RANGE_MS ? slow : bad;
+        if (h > 0.0f) quad(HUD_X + i * BAR_STEP, HUD_Y + GRAPH_HEIGHT - h, BAR_STEP - 0.5f, h, color);
+        float gpu_ms = state.gpu_history[(state.gpu_history_pos + i) % HISTORY];
+        float gpu_h = std::min(gpu_ms / GRAPH_RANGE_MS, 1.0f) * GRAPH_HEIGHT;
+        if (gpu_h > 0.0f) quad(HUD_X + i * BAR_STEP + 0.5f, HUD_Y + GRAPH_HEIGHT - gpu_h, BAR_STEP - 1.5f, gpu_h, gpu_color);
+    }
+    quad(HUD_X, HUD_Y + GRAPH_HEIGHT * 0.5f, HUD_WIDTH, 1.0f, line); // 60 fps
+    quad(HUD_X, HUD_Y, HUD_WIDTH, 1.0f, line);                        // 30 fps
+
+    breakdown(breakdown_y, state.cpu_average);
+    breakdown(breakdown_y + BREAKDOWN_HEIGHT + 4.0f, state.gpu_average);
+
+    GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    Graphics::hudShader->use();
+    glBindVertexArray(state.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, state.vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(state.vertices.size() * sizeof(HudVertex)), state.vertices.data(), GL_STREAM_DRAW);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(state.vertices.size()));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    Graphics::hudShader->use(false);
+    if (depth_test) glEnable(GL_DEPTH_TEST);
+}
+
+const std::vector<Profiler::Section>& Profiler::getCpuSections() { return state.cpu_average; }
+const std::vector<Profiler::Section>& Profiler::getGpuSections() { return state.gpu_average; }
+float Profiler::getFrameMs() { return state.frame_average; }
+float Profiler::getGpuMs() { return state.gpu_average_total; }
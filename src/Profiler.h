@@ -0,0 +1,73 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+// In-sim frame profiler (F3). Per frame it records the wall time between beginFrame() calls,
+// CPU time of named scopes (CpuScope) and GPU time of named passes (GpuScope, GL_TIME_ELAPSED).
+//
+// GPU queries are never waited on: each frame writes its own set of FRAMES_IN_FLIGHT query
+// sets, and a set is read back FRAMES_IN_FLIGHT - 1 frames later, only once
+// GL_QUERY_RESULT_AVAILABLE says so (a set that is still busy is skipped, never stalled on).
+//
+// renderHud() draws a rolling frame-time graph and stacked CPU / GPU breakdown bars in one
+// draw call (Graphics::hudShader); the numbers behind the bars, averaged over half a second,
+// go to the window title in the same left-to-right order. The profiler times itself: the
+// "profiler" CPU section is its own cost. Disabled, every entry point is a single branch.
+class Profiler {
+public:
+    static constexpr int HISTORY = 240;        // Frames in the graph
+    static constexpr int FRAMES_IN_FLIGHT = 3; // Query sets; results are FRAMES_IN_FLIGHT - 1 frames old
+    static constexpr int MAX_SECTIONS = 12;    // CPU scopes / GPU passes per frame (extra ones are dropped)
+
+    struct Section {
+        const char* name; // String literal; sections are matched by pointer
+        float ms;
+    };
+
+    static void init(const std::string& window_title); // GL context current
+    static void cleanup();
+
+    static void setEnabled(bool enabled);
+    static void toggle() { setEnabled(!isEnabled()); }
+    static bool isEnabled();
+
+    static void beginFrame(); // Start of the main loop iteration
+    static void endFrame();   // After swapBuffers: collects finished GPU queries
+
+    // Times the enclosing block on the CPU
+    class CpuScope {
+    public:
+        explicit CpuScope(const char* name);
+        ~CpuScope();
+        CpuScope(const CpuScope&) = delete;
+        CpuScope& operator=(const CpuScope&) = delete;
+    private:
+        const char* name;
+        double start_ms;
+    };
+
+    // Times the GL commands issued in the enclosing block on the GPU. GL_TIME_ELAPSED queries
+    // cannot nest, so a GpuScope inside another one is ignored.
+    class GpuScope {
+    public:
+        explicit GpuScope(const char* name);
+        ~GpuScope();
+        GpuScope(const GpuScope&) = delete;
+        GpuScope& operator=(const GpuScope&) = delete;
+    private:
+        bool active;
+    };
+
+    static void renderHud();
+
+    // Averages over the last display interval (what the HUD and title show)
+    static const std::vector<Section>& getCpuSections();
+    static const std::vector<Section>& getGpuSections();
+    static float getFrameMs();
+    static float getGpuMs();
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,411 @@
+#include "Replay.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const char HEADER_MAGIC[4] = {'F', 'S', 'R', 'P'};
+const char TRAILER_MAGIC[4] = {'F', 'S', 'R', 'I'};
+const uint32_t REPLAY_VERSION = 1;
+
+const uint8_t TAG_INPUT = 'I';
+const uint8_t TAG_KEYFRAME = 'K';
+
+const size_t INPUT_PAYLOAD = 5 * sizeof(float);
+const size_t KEYFRAME_PAYLOAD = sizeof(uint64_t) + sizeof(double) + 13 * sizeof(float);
+const size_t INDEX_ENTRY_SIZE = sizeof(uint64_t) + sizeof(double) + sizeof(uint64_t);
+const size_t TRAILER_SIZE = 2 * sizeof(uint64_t) + 4;
+const uint32_t MAX_GROUND_PATH = 4096; // Longer means a corrupt header
+
+// Hand the flush thread a buffer once it holds this much
+const size_t FLUSH_THRESHOLD = 64 * 1024;
+
+template <typename T>
+void put(std::vector<uint8_t>& buffer, const T& value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void putVec3(std::vector<uint8_t>& buffer, const glm::vec3& v) {
+    put(buffer, v.x); put(buffer, v.y); put(buffer, v.z);
+}
+
+template <typename T>
+bool get(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+bool getVec3(std::istream& in, glm::vec3& v) {
+    return get(in, v.x) && get(in, v.y) && get(in, v.z);
+}
+
+bool readKeyframePayload(std::istream& in, ReplayKeyframe& k) {
+    return get(in, k.step) && get(in, k.sim_time) && getVec3(in, k.position) &&
+           get(in, k.orientation.w) && get(in, k.orientation.x) && get(in, k.orientation.y) && get(in, k.orientation.z) &&
+           getVec3(in, k.velocity) && getVec3(in, k.angular_velocity);
+}
+
+} // namespace
+
+// --- ReplayKeyframe ---
+
+ReplayKeyframe ReplayKeyframe::capture(const RigidBody& body, uint64_t step, double sim_time) {
+    ReplayKeyframe k;
+    k.step = step;
+    k.sim_time = sim_time;
+    k.position = body.position_world;
+    k.orientation = body.orientation_world;
+    k.velocity = body.velocity_world;
+    k.angular_velocity = body.angular_velocity_body;
+    return k;
+}
+
+void ReplayKeyframe::restore(RigidBody& body) const {
+    body.position_world = position;
+    body.orientation_world = orientation;
+    body.velocity_world = velocity;
+    body.angular_velocity_body = angular_velocity;
+    body.clearAccumulators();
+}
+
+// --- ReplayRecorder ---
+
+ReplayRecorder::ReplayRecorder(uint32_t interval) :
+    keyframe_interval(std::max(1u, interval))
+{
+}
+
+ReplayRecorder::~ReplayRecorder() {
+    close();
+}
+
+bool ReplayRecorder::open(const std::string& path, float dt, const Heightfield* ground) {
+    close();
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Error: Failed to open replay file for writing: " << path << std::endl;
+        return false;
+    }
+
+    fixed_dt = dt;
+    step_count = 0;
+    sim_time = 0.0;
+    index.clear();
+    front.clear();
+    front.reserve(FLUSH_THRESHOLD * 2);
+    back.clear();
+    back.reserve(FLUSH_THRESHOLD * 2);
+    back_pending = false;
+    stopping = false;
+
+    // Header goes out synchronously, before the flush thread owns the file
+    std::vector<uint8_t> header;
+    header.insert(header.end(), HEADER_MAGIC, HEADER_MAGIC + 4);
+    put(header, REPLAY_VERSION);
+    put(header, fixed_dt);
+    put(header, keyframe_interval);
+    HeightfieldSource source = ground ? ground->getSource() : HeightfieldSource();
+    if (source.hash != 0 && source.path.empty()) {
+        std::cerr << "Warning: Replay ground was not loaded from a file; playback cannot reproduce contact with it" << std::endl;
+    }
+    put(header, static_cast<uint32_t>(source.path.size()));
+    header.insert(header.end(), source.path.begin(), source.path.end());
+    put(header, source.world_size);
+    put(header, source.max_height);
+    put(header, source.hash);
+    file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    stream_offset = header.size();
+
+    flush_thread = std::thread(&ReplayRecorder::flushLoop, this);
+    recording = true;
+    return true;
+}
+
+void ReplayRecorder::recordStep(const RigidBody& body, const ControlInputs& controls, float dt) {
+    if (!recording) return;
+
+    if (step_count % keyframe_interval == 0) {
+        ReplayKeyframe k = ReplayKeyframe::capture(body, step_count, sim_time);
+        index.push_back({step_count, sim_time, stream_offset + front.size()});
+        front.push_back(TAG_KEYFRAME);
+        put(front, k.step);
+        put(front, k.sim_time);
+        putVec3(front, k.position);
+        put(front, k.orientation.w); put(front, k.orientation.x); put(front, k.orientation.y); put(front, k.orientation.z);
+        putVec3(front, k.velocity);
+        putVec3(front, k.angular_velocity);
+    }
+
+    front.push_back(TAG_INPUT);
+    put(front, controls.throttle);
+    put(front, controls.pitch);
+    put(front, controls.roll);
+    put(front, controls.yaw);
+    put(front, dt);
+
+    ++step_count;
+    sim_time += dt;
+
+    if (front.size() >= FLUSH_THRESHOLD) handOff();
+}
+
+void ReplayRecorder::handOff() {
+    // Never block the frame loop: if the flush thread is busy, keep growing front
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock() || back_pending) return;
+
+    stream_offset += front.size();
+    std::swap(front, back);
+    front.clear();
+    back_pending = true;
+    lock.unlock();
+    wake.notify_one();
+}
+
+void ReplayRecorder::flushLoop() {
+    FS_TRACE_THREAD("Replay flush");
+    std::vector<uint8_t> writing;
+    writing.reserve(FLUSH_THRESHOLD * 2);
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return back_pending || stopping; });
+            if (!back_pending) return; // Stopping and nothing left
+            std::swap(back, writing);  // back gets the empty buffer (keeps its capacity)
+            back_pending = false;
+        }
+        file.write(reinterpret_cast<const char*>(writing.data()), static_cast<std::streamsize>(writing.size()));
+        writing.clear();
+    }
+}
+
+void ReplayRecorder::close() {
+    if (!recording) return;
+    recording = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (flush_thread.joinable()) flush_thread.join();
+
+    // Flush thread is gone; the rest is written from this thread
+    file.write(reinterpret_cast<const char*>(front.data()), static_cast<std::streamsize>(front.size()));
+    uint64_t index_offset = stream_offset + front.size();
+    front.clear();
+
+    std::vector<uint8_t> footer;
+    put(footer, static_cast<uint64_t>(index.size()));
+    for (const auto& entry : index) {
+        put(footer, entry.step);
+        put(footer, entry.sim_time);
+        put(footer, entry.offset);
+    }
+    put(footer, step_count);
+    put(footer, index_offset);
+    footer.insert(footer.end(), TRAILER_MAGIC, TRAILER_MAGIC + 4);
+    file.write(reinterpret_cast<const char*>(footer.data()), static_cast<std::streamsize>(footer.size()));
+
+    if (!file) std::cerr << "Warning: Errors occurred while writing the replay file." << std::endl;
+    file.close();
+}
+
+// --- ReplayPlayer ---
+
+bool ReplayPlayer::open(const std::string& path) {
+    file.close();
+    file.clear();
+    index.clear();
+    step_count = 0;
+    current_step = 0;
+    positioned = false;
+
+    file.open(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Error: Failed to open replay file: " << path << std::endl;
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    if (!file.read(magic, 4) || std::memcmp(magic, HEADER_MAGIC, 4) != 0 ||
+        !get(file, version) || !get(file, fixed_dt) || !get(file, keyframe_interval)) {
+        std::cerr << "Error: Not a replay file: " << path << std::endl;
+        return false;
+    }
+    if (version != REPLAY_VERSION) {
+        std::cerr << "Error: Unsupported replay version " << version << " in " << path << std::endl;
+        return false;
+    }
+    if (keyframe_interval == 0) keyframe_interval = 1;
+
+    ground = HeightfieldSource();
+    uint32_t path_length = 0;
+    if (!get(file, path_length) || path_length > MAX_GROUND_PATH) {
+        std::cerr << "Error: Malformed replay header in " << path << std::endl;
+        return false;
+    }
+    ground.path.resize(path_length);
+    if ((path_length > 0 && !file.read(&ground.path[0], path_length)) ||
+        !get(file, ground.world_size) || !get(file, ground.max_height) || !get(file, ground.hash)) {
+        std::cerr << "Error: Malformed replay header in " << path << std::endl;
+        return false;
+    }
+    data_begin = static_cast<uint64_t>(file.tellg());
+
+    file.seekg(0, std::ios::end);
+    uint64_t file_size = static_cast<uint64_t>(file.tellg());
+
+    if (!readTrailer(file_size)) {
+        std::cerr << "Warning: Replay index missing (recording was not closed), rebuilding: " << path << std::endl;
+        if (!rebuildIndex()) return false;
+    }
+    if (index.empty()) {
+        std::cerr << "Error: Replay contains no keyframes: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ReplayPlayer::readTrailer(uint64_t file_size) {
+    if (file_size < data_begin + TRAILER_SIZE) return false;
+
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(file_size - TRAILER_SIZE));
+    uint64_t steps = 0, index_offset = 0;
+    char magic[4];
+    if (!get(file, steps) || !get(file, index_offset) || !file.read(magic, 4) ||
+        std::memcmp(magic, TRAILER_MAGIC, 4) != 0) {
+        return false;
+    }
+
+    // Offset and count come from the file: bound both by its size before multiplying or allocating
+    if (index_offset < data_begin || index_offset > file_size - TRAILER_SIZE - sizeof(uint64_t)) return false;
+    const uint64_t max_count = (file_size - index_offset - sizeof(uint64_t) - TRAILER_SIZE) / INDEX_ENTRY_SIZE;
+    uint64_t count = 0;
+    file.seekg(static_cast<std::streamoff>(index_offset));
+    if (!get(file, count) || count > max_count ||
+        index_offset + sizeof(uint64_t) + count * INDEX_ENTRY_SIZE + TRAILER_SIZE != file_size) {
+        return false;
+    }
+    std::vector<IndexEntry> entries(count);
+    for (auto& e : entries) {
+        if (!get(file, e.step) || !get(file, e.sim_time) || !get(file, e.offset)) return false;
+    }
+
+    index = std::move(entries);
+    step_count = steps;
+    data_end = index_offset;
+    return true;
+}
+
+bool ReplayPlayer::rebuildIndex() {
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(data_begin));
+
+    uint64_t offset = data_begin;
+    uint64_t steps = 0;
+    for (;;) {
+        uint8_t tag = 0;
+        if (!get(file, tag)) break;
+        if (tag == TAG_INPUT) {
+            float payload[5];
+            if (!file.read(reinterpret_cast<char*>(payload), INPUT_PAYLOAD)) break;
+            ++steps;
+            offset += 1 + INPUT_PAYLOAD;
+        } else if (tag == TAG_KEYFRAME) {
+            ReplayKeyframe k;
+            if (!readKeyframePayload(file, k)) break;
+            index.push_back({k.step, k.sim_time, offset});
+            offset += 1 + KEYFRAME_PAYLOAD;
+        } else {
+            break; // Torn write or the start of a partial index
+        }
+    }
+
+    step_count = steps;
+    data_end = offset;
+    file.clear();
+    return true;
+}
+
+bool ReplayPlayer::readKeyframe(size_t keyframe, ReplayKeyframe& out) {
+    if (keyframe >= index.size()) return false;
+    std::streampos saved = file.tellg();
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(index[keyframe].offset));
+    uint8_t tag = 0;
+    bool ok = get(file, tag) && tag == TAG_KEYFRAME && readKeyframePayload(file, out);
+    file.clear();
+    file.seekg(saved);
+    return ok;
+}
+
+uint64_t ReplayPlayer::seek(Aircraft& aircraft, double time) {
+    if (time <= 0.0 || fixed_dt <= 0.0f) return seekStep(aircraft, 0);
+    // Small bias so times that are exact step multiples don't round down a step
+    return seekStep(aircraft, static_cast<uint64_t>(time / fixed_dt + 1e-6));
+}
+
+uint64_t ReplayPlayer::seekStep(Aircraft& aircraft, uint64_t target) {
+    if (index.empty()) return current_step;
+    target = std::min(target, step_count);
+
+    // Keyframes are written every keyframe_interval steps from step 0, so the entry is
+    // a direct lookup; fall back to a search if the file was recorded differently
+    size_t k = std::min(static_cast<size_t>(target / keyframe_interval), index.size() - 1);
+    if (index[k].step > target || (k + 1 < index.size() && index[k + 1].step <= target)) {
+        auto it = std::upper_bound(index.begin(), index.end(), target,
+                                   [](uint64_t s, const IndexEntry& e) { return s < e.step; });
+        k = it == index.begin() ? 0 : static_cast<size_t>(it - index.begin()) - 1;
+    }
+
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(index[k].offset));
+    uint8_t tag = 0;
+    ReplayKeyframe keyframe;
+    if (!get(file, tag) || tag != TAG_KEYFRAME || !readKeyframePayload(file, keyframe)) {
+        std::cerr << "Error: Corrupt replay keyframe " << k << std::endl;
+        positioned = false;
+        return current_step;
+    }
+    keyframe.restore(aircraft);
+    current_step = keyframe.step;
+    positioned = true;
+
+    // Re-simulate the remainder (at most keyframe_interval steps)
+    while (current_step < target && step(aircraft)) {}
+    return current_step;
+}
+
+bool ReplayPlayer::step(Aircraft& aircraft) {
+    if (!positioned) {
+        seekStep(aircraft, 0);
+        if (!positioned) return false;
+    }
+    if (current_step >= step_count) return false;
+
+    uint8_t tag = 0;
+    if (!get(file, tag)) return false;
+    if (tag == TAG_KEYFRAME) {
+        // Already in sync; skip the stored state
+        file.seekg(static_cast<std::streamoff>(KEYFRAME_PAYLOAD), std::ios::cur);
+        if (!get(file, tag)) return false;
+    }
+
+    float dt = 0.0f;
+    if (tag != TAG_INPUT || !get(file, aircraft.controls.throttle) || !get(file, aircraft.controls.pitch) ||
+        !get(file, aircraft.controls.roll) || !get(file, aircraft.controls.yaw) || !get(file, dt)) {
+        std::cerr << "Error: Corrupt replay input record at step " << current_step << std::endl;
+        positioned = false;
+        return false;
+    }
+
+    aircraft.update(dt);
+    ++current_step;
+    return true;
+}
@@ -0,0 +1,147 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "Aircraft.h"
+#include "Heightfield.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Deterministic flight replay.
+//
+// File layout (little-endian, written as raw host values):
+//   Header   : "FSRP" | u32 version | f32 fixed_dt | u32 keyframe_interval |
+//              u32 ground_path_length | ground path bytes | f32 ground_world_size |
+//              f32 ground_max_height | u64 ground_hash (0 = flat ground at y = 0)
+//   Records  : tagged stream, one input record per physics step and a keyframe
+//              before every keyframe_interval-th step
+//              'I' | f32 throttle, pitch, roll, yaw | f32 dt
+//              'K' | u64 step | f64 sim_time | vec3 position | quat (w,x,y,z) | vec3 velocity | vec3 angular_velocity
+//   Index    : u64 keyframe_count | { u64 step | f64 sim_time | u64 file_offset } * count
+//   Trailer  : u64 step_count | u64 index_offset | "FSRI"
+// A file without a trailer (recorder crashed) is still readable: the player rebuilds
+// the index by scanning the tagged records.
+
+// Full RigidBody state at the start of a step
+struct ReplayKeyframe {
+    uint64_t step = 0;
+    double sim_time = 0.0;
+    glm::vec3 position{0.0f};
+    glm::quat orientation{1.0f, 0.0f, 0.0f, 0.0f};
+    glm::vec3 velocity{0.0f};
+    glm::vec3 angular_velocity{0.0f};
+
+    static ReplayKeyframe capture(const RigidBody& body, uint64_t step, double sim_time);
+    void restore(RigidBody& body) const;
+};
+
+// Records per-step inputs from the frame loop. recordStep() only appends to an
+// in-memory buffer; a background thread writes full buffers to disk.
+class ReplayRecorder {
+public:
+    explicit ReplayRecorder(uint32_t keyframe_interval = 120);
+    ~ReplayRecorder(); // Calls close()
+
+    ReplayRecorder(const ReplayRecorder&) = delete;
+    ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+    // Create the file and start the flush thread. Returns false (and logs) on failure.
+    // `ground` is the Aircraft::ground the recorded body flies over (nullptr = flat ground);
+    // its source is stored so playback can load the same surface.
+    bool open(const std::string& path, float fixed_dt, const Heightfield* ground = nullptr);
+    // Call once per physics step, before the body is integrated (PhysicsScheduler::pre_step)
+    void recordStep(const RigidBody& body, const ControlInputs& controls, float dt);
+    // Flush remaining data, write the keyframe index and close the file
+    void close();
+
+    bool isRecording() const { return recording; }
+    uint64_t getStepCount() const { return step_count; }
+
+private:
+    struct IndexEntry {
+        uint64_t step;
+        double sim_time;
+        uint64_t offset;
+    };
+
+    uint32_t keyframe_interval;
+    float fixed_dt = 0.0f;
+    bool recording = false;
+
+    // --- Main thread state ---
+    std::vector<uint8_t> front;       // Appended to by recordStep()
+    uint64_t stream_offset = 0;       // File offset of the end of `front`
+    uint64_t step_count = 0;
+    double sim_time = 0.0;
+    std::vector<IndexEntry> index;
+
+    // --- Flush thread (double buffer: front is swapped with back when full) ---
+    std::ofstream file;
+    std::vector<uint8_t> back;        // Handed to the flush thread, guarded by mutex
+    bool back_pending = false;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread flush_thread;
+
+    void flushLoop();
+    void handOff(); // Non-blocking: swaps front/back only if the flush thread is idle
+};
+
+// Plays a recording back into an Aircraft. seek() restores the nearest keyframe at or
+// before the target (a constant-time index lookup) and re-simulates at most
+// keyframe_interval steps.
+class ReplayPlayer {
+public:
+    // Open a recording. Returns false (and logs) if the file is missing or malformed.
+    bool open(const std::string& path);
+
+    float getFixedDt() const { return fixed_dt; }
+    uint32_t getKeyframeInterval() const { return keyframe_interval; }
+    uint64_t getStepCount() const { return step_count; }
+    double getDuration() const { return static_cast<double>(step_count) * fixed_dt; }
+    size_t getKeyframeCount() const { return index.size(); }
+    uint64_t getCurrentStep() const { return current_step; }
+
+    // Terrain the recording was flown over. Playback must use a heightfield loaded from it
+    // (Heightfield::loadSource) to reproduce the flight; hash 0 means flat ground.
+    const HeightfieldSource& getGround() const { return ground; }
+
+    // Jump to the step at `time` seconds (clamped to the recording). Returns the step reached.
+    uint64_t seek(Aircraft& aircraft, double time);
+    uint64_t seekStep(Aircraft& aircraft, uint64_t step);
+    // Apply the next recorded input and integrate one step. Returns false at the end.
+    bool step(Aircraft& aircraft);
+
+    // Read a stored keyframe without changing the playback position
+    bool readKeyframe(size_t keyframe, ReplayKeyframe& out);
+
+private:
+    struct IndexEntry {
+        uint64_t step;
+        double sim_time;
+        uint64_t offset;
+    };
+
+    std::ifstream file;
+    float fixed_dt = 0.0f;
+    uint32_t keyframe_interval = 1;
+    uint64_t step_count = 0;
+    uint64_t data_begin = 0; // End of the header (first record)
+    uint64_t data_end = 0; // End of the record stream (start of the index)
+    HeightfieldSource ground;
+    std::vector<IndexEntry> index;
+    uint64_t current_step = 0;
+    bool positioned = false; // A keyframe has been restored, so step() may continue
+
+    bool readTrailer(uint64_t file_size);
+    bool rebuildIndex();
+};
+
+#endif // REPLAY_H
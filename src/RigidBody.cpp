@@ -1,6 +1,8 @@
 #include "RigidBody.h"
 #include "PhysicsConfig.h" // For GRAVITY
 #include <glm/gtc/matrix_inverse.hpp> // For matrix inverse
+#include <algorithm> // For std::max
+#include <cmath>     // For std::abs
 
 RigidBody::RigidBody() :
     mass(1.0f),
@@ -80,6 +82,10 @@ void RigidBody::addForceAtPointWorld(const glm::vec3& force_world, const glm::ve
      m_torque_accumulator_body += worldToBodyDir(torque_world);
 }
 
+void RigidBody::addTorqueBody(const glm::vec3& torque_body) {
+    m_torque_accumulator_body += torque_body;
+}
+
 void RigidBody::clearAccumulators() {
     m_force_accumulator_world = glm::vec3(0.0f);
     m_torque_accumulator_body = glm::vec3(0.0f);
@@ -88,6 +94,75 @@ void RigidBody::clearAccumulators() {
 void RigidBody::update(float dt) {
     if (mass <= 0.0f || dt <= 0.0f) return; // Safety check
 
+    // Energy bookkeeping needs the state and external load before the step
+    double energy_before = 0.0;
+    glm::vec3 velocity_before(0.0f), angular_velocity_before(0.0f);
+    glm::vec3 force_before(0.0f), torque_before(0.0f);
+    if (track_integrator_stats) {
+        if (!m_integrator_stats_started) {
+            m_integrator_stats.initial_energy = getMechanicalEnergy();
+            m_integrator_stats_started = true;
+        }
+        energy_before = getMechanicalEnergy();
+        velocity_before = velocity_world;
+        angular_velocity_before = angular_velocity_body;
+        force_before = m_force_accumulator_world;
+        torque_before = m_torque_accumulator_body;
+    }
+
+    switch (integrator) {
+        case IntegratorType::SemiImplicitEuler: integrateSemiImplicitEuler(dt); break;
+        case IntegratorType::ExponentialMap:    integrateExponentialMap(dt); break;
+        case IntegratorType::RK4:               integrateRK4(dt); break;
+    }
+
+    if (track_integrator_stats) {
+        // Work of the non-gravity load over the step (trapezoidal in velocity)
+        double work = dt * (glm::dot(force_before, 0.5f * (velocity_before + velocity_world)) +
+                            glm::dot(torque_before, 0.5f * (angular_velocity_before + angular_velocity_body)));
+        double energy_after = getMechanicalEnergy();
+        double step_error = (energy_after - energy_before) - work;
+
+        m_integrator_stats.steps++;
+        m_integrator_stats.energy = energy_after;
+        m_integrator_stats.energy_error += step_error;
+        m_integrator_stats.max_step_energy_error = std::max(m_integrator_stats.max_step_energy_error, std::abs(step_error));
+        m_integrator_stats.max_quat_norm_error = std::max(m_integrator_stats.max_quat_norm_error, m_integrator_stats.quat_norm_error);
+    }
+
+    // --- Reset Accumulators for next frame ---
+    clearAccumulators();
+}
+
+void RigidBody::resetIntegratorStats() {
+    m_integrator_stats = IntegratorStats{};
+    m_integrator_stats_started = false;
+}
+
+double RigidBody::getMechanicalEnergy() const {
+    double kinetic = 0.5 * mass * glm::dot(velocity_world, velocity_world) +
+                     0.5 * glm::dot(angular_velocity_body, inertia_tensor_body * angular_velocity_body);
+    double potential = apply_gravity ? static_cast<double>(mass) * PhysicsConfig::GRAVITY * position_world.y : 0.0;
+    return kinetic + potential;
+}
+
+RigidBody::Derivative RigidBody::computeDerivative(const glm::vec3& force_world, const glm::vec3& torque_body) const {
+    Derivative d;
+    glm::vec3 final_force = force_world;
+    if (apply_gravity) {
+        final_force += glm::vec3(0.0f, -PhysicsConfig::GRAVITY * mass, 0.0f);
+    }
+    d.velocity = velocity_world;
+    d.acceleration = final_force / mass;
+    glm::vec3 gyro_term = glm::cross(angular_velocity_body, inertia_tensor_body * angular_velocity_body);
+    d.angular_acceleration = inv_inertia_tensor_body * (torque_body - gyro_term);
+    // dQ/dt = 0.5 * Q * PureQuaternion(w_body)
+    d.orientation_rate = (orientation_world * glm::quat(0.0f, angular_velocity_body.x, angular_velocity_body.y, angular_velocity_body.z)) * 0.5f;
+    return d;
+}
+
+// Original scheme, kept bit-for-bit (RigidBodyBatch mirrors it)
+void RigidBody::integrateSemiImplicitEuler(float dt) {
     // --- Linear Motion ---
     // Add gravity if applicable
     glm::vec3 final_force = m_force_accumulator_world;
@@ -125,10 +200,79 @@ void RigidBody::update(float dt) {
     glm::quat w_quat_body(0.0f, angular_velocity_body.x, angular_velocity_body.y, angular_velocity_body.z);
     orientation_world += (orientation_world * w_quat_body) * (0.5f * dt);
 
+    if (track_integrator_stats) {
+        // Measure how far the additive update drifted off the unit sphere before renormalizing
+        m_integrator_stats.quat_norm_error = std::abs(glm::length(orientation_world) - 1.0f);
+    }
+
     // Re-normalize orientation quaternion to prevent drift due to numerical errors
     orientation_world = glm::normalize(orientation_world);
+}
 
+// Symplectic Euler for the velocities, geometric (exponential map) orientation update.
+// The rotation by |w|*dt is applied exactly, so large angular rates don't shrink/skew the quaternion.
+void RigidBody::integrateExponentialMap(float dt) {
+    Derivative d = computeDerivative(m_force_accumulator_world, m_torque_accumulator_body);
 
-    // --- Reset Accumulators for next frame ---
-    clearAccumulators();
+    velocity_world += d.acceleration * dt;
+    position_world += velocity_world * dt;
+
+    angular_velocity_body += d.angular_acceleration * dt;
+
+    // Q_new = Q_old * exp(0.5 * w_body * dt)  ==  Q_old * angleAxis(|w| dt, w/|w|)
+    float rate = glm::length(angular_velocity_body);
+    if (rate > 1e-9f) {
+        glm::quat delta = glm::angleAxis(rate * dt, angular_velocity_body / rate);
+        orientation_world = orientation_world * delta;
+    }
+
+    if (track_integrator_stats) {
+        m_integrator_stats.quat_norm_error = std::abs(glm::length(orientation_world) - 1.0f);
+    }
+    // Only rounding error to remove here, but keep the invariant explicit
+    orientation_world = glm::normalize(orientation_world);
+}
+
+// Classic RK4. Stage 1 uses the forces accumulated before update(); stages 2-4 set the
+// intermediate state and call evaluateForces() so aerodynamic loads follow the motion.
+void RigidBody::integrateRK4(float dt) {
+    const glm::vec3 p0 = position_world;
+    const glm::vec3 v0 = velocity_world;
+    const glm::quat q0 = orientation_world;
+    const glm::vec3 w0 = angular_velocity_body;
+    const glm::vec3 f0 = m_force_accumulator_world;
+    const glm::vec3 t0 = m_torque_accumulator_body;
+
+    auto setStage = [&](const Derivative& k, float h) {
+        position_world = p0 + k.velocity * h;
+        velocity_world = v0 + k.acceleration * h;
+        orientation_world = glm::normalize(q0 + k.orientation_rate * h);
+        angular_velocity_body = w0 + k.angular_acceleration * h;
+        clearAccumulators();
+        if (!evaluateForces()) {
+            m_force_accumulator_world = f0;
+            m_torque_accumulator_body = t0;
+        }
+        return computeDerivative(m_force_accumulator_world, m_torque_accumulator_body);
+    };
+
+    Derivative k1 = computeDerivative(f0, t0);
+    Derivative k2 = setStage(k1, 0.5f * dt);
+    Derivative k3 = setStage(k2, 0.5f * dt);
+    Derivative k4 = setStage(k3, dt);
+
+    const float w = dt / 6.0f;
+    position_world = p0 + (k1.velocity + 2.0f * k2.velocity + 2.0f * k3.velocity + k4.velocity) * w;
+    velocity_world = v0 + (k1.acceleration + 2.0f * k2.acceleration + 2.0f * k3.acceleration + k4.acceleration) * w;
+    angular_velocity_body = w0 + (k1.angular_acceleration + 2.0f * k2.angular_acceleration + 2.0f * k3.angular_acceleration + k4.angular_acceleration) * w;
+    orientation_world = q0 + (k1.orientation_rate + k2.orientation_rate * 2.0f + k3.orientation_rate * 2.0f + k4.orientation_rate) * w;
+
+    // Restore the stage-1 load so the caller's accumulators (and stats) reflect this step's input
+    m_force_accumulator_world = f0;
+    m_torque_accumulator_body = t0;
+
+    if (track_integrator_stats) {
+        m_integrator_stats.quat_norm_error = std::abs(glm::length(orientation_world) - 1.0f);
+    }
+    orientation_world = glm::normalize(orientation_world);
 }
@@ -3,6 +3,7 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include "Integrator.h"
 
 class RigidBody {
 protected: // Protected so derived classes can access directly if needed
@@ -23,6 +24,8 @@ public:
 
     // --- Control ---
     bool apply_gravity = true;
+    IntegratorType integrator = IntegratorType::SemiImplicitEuler; // Scheme used by update()
+    bool track_integrator_stats = false; // Gather energy/drift metrics each step (small extra cost)
 
     // --- Constructor ---
     RigidBody(); // Default constructor
@@ -54,6 +57,12 @@ public:
     void addForceAtPointBody(const glm::vec3& force_body, const glm::vec3& point_body);
      // Apply a force specified in world space at a point offset in world space (less common for aero)
     void addForceAtPointWorld(const glm::vec3& force_world, const glm::vec3& point_world);
+    // Apply a pure torque specified in body space
+    void addTorqueBody(const glm::vec3& torque_body);
+
+    // --- Accumulator Access (read by batched integrators, see RigidBodyBatch) ---
+    const glm::vec3& getForceAccumulatorWorld() const { return m_force_accumulator_world; }
+    const glm::vec3& getTorqueAccumulatorBody() const { return m_torque_accumulator_body; }
 
     // --- Simulation Update ---
     // Integrates physics state forward by dt seconds
@@ -61,6 +70,36 @@ public:
 
     // --- Reset Accumulators (called internally by update) ---
     void clearAccumulators();
+
+    // --- Integrator Metrics ---
+    const IntegratorStats& getIntegratorStats() const { return m_integrator_stats; }
+    void resetIntegratorStats();
+    // Kinetic (translational + rotational) plus gravitational potential energy (J)
+    double getMechanicalEnergy() const;
+
+protected:
+    // Re-apply forces for the current state during multi-stage integration (RK4).
+    // Implementations clear nothing themselves; the accumulators are already empty when called.
+    // Returns false if the body cannot re-evaluate, in which case the forces that were
+    // accumulated before update() are held constant across the stages.
+    virtual bool evaluateForces() { return false; }
+
+private:
+    // Time derivative of the state for a given force/torque
+    struct Derivative {
+        glm::vec3 velocity;
+        glm::vec3 acceleration;
+        glm::quat orientation_rate;
+        glm::vec3 angular_acceleration;
+    };
+    Derivative computeDerivative(const glm::vec3& force_world, const glm::vec3& torque_body) const;
+
+    void integrateSemiImplicitEuler(float dt);
+    void integrateExponentialMap(float dt);
+    void integrateRK4(float dt);
+
+    IntegratorStats m_integrator_stats;
+    bool m_integrator_stats_started = false;
 };
 
 #endif // RIGIDBODY_H
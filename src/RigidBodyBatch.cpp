@@ -0,0 +1,223 @@
+#include "RigidBodyBatch.h"
+#include "PhysicsConfig.h" // For GRAVITY
+#include "SimdLane.h"
+
+// Every lane operation used below maps 1:1 onto the scalar expression in
+// RigidBody::update, in the same order, so each lane rounds exactly like the scalar path.
+
+void RigidBodyBatch::clear() {
+    resize(0);
+}
+
+void RigidBodyBatch::reserve(size_t n) {
+    for (auto* v : {&pos_x, &pos_y, &pos_z, &vel_x, &vel_y, &vel_z,
+                    &rot_w, &rot_x, &rot_y, &rot_z, &ang_x, &ang_y, &ang_z,
+                    &force_x, &force_y, &force_z, &torque_x, &torque_y, &torque_z,
+                    &mass, &gravity}) {
+        v->reserve(n);
+    }
+    for (int k = 0; k < 9; ++k) {
+        inertia[k].reserve(n);
+        inv_inertia[k].reserve(n);
+    }
+}
+
+void RigidBodyBatch::resize(size_t n) {
+    for (auto* v : {&pos_x, &pos_y, &pos_z, &vel_x, &vel_y, &vel_z,
+                    &rot_w, &rot_x, &rot_y, &rot_z, &ang_x, &ang_y, &ang_z,
+                    &force_x, &force_y, &force_z, &torque_x, &torque_y, &torque_z,
+                    &mass, &gravity}) {
+        v->resize(n, 0.0f);
+    }
+    for (int k = 0; k < 9; ++k) {
+        inertia[k].resize(n, 0.0f);
+        inv_inertia[k].resize(n, 0.0f);
+    }
+    count = n;
+}
+
+size_t RigidBodyBatch::add(const RigidBody& body) {
+    size_t i = count;
+    resize(count + 1);
+    load(i, body);
+    return i;
+}
+
+void RigidBodyBatch::load(size_t i, const RigidBody& body) {
+    pos_x[i] = body.position_world.x; pos_y[i] = body.position_world.y; pos_z[i] = body.position_world.z;
+    vel_x[i] = body.velocity_world.x; vel_y[i] = body.velocity_world.y; vel_z[i] = body.velocity_world.z;
+    rot_w[i] = body.orientation_world.w; rot_x[i] = body.orientation_world.x;
+    rot_y[i] = body.orientation_world.y; rot_z[i] = body.orientation_world.z;
+    ang_x[i] = body.angular_velocity_body.x; ang_y[i] = body.angular_velocity_body.y; ang_z[i] = body.angular_velocity_body.z;
+
+    const glm::vec3& f = body.getForceAccumulatorWorld();
+    const glm::vec3& t = body.getTorqueAccumulatorBody();
+    force_x[i] = f.x; force_y[i] = f.y; force_z[i] = f.z;
+    torque_x[i] = t.x; torque_y[i] = t.y; torque_z[i] = t.z;
+
+    mass[i] = body.mass;
+    gravity[i] = body.apply_gravity ? -PhysicsConfig::GRAVITY : 0.0f;
+    for (int c = 0; c < 3; ++c) {
+        for (int r = 0; r < 3; ++r) {
+            inertia[c * 3 + r][i] = body.inertia_tensor_body[c][r];
+            inv_inertia[c * 3 + r][i] = body.inv_inertia_tensor_body[c][r];
+        }
+    }
+}
+
+void RigidBodyBatch::store(size_t i, RigidBody& body) const {
+    body.position_world = glm::vec3(pos_x[i], pos_y[i], pos_z[i]);
+    body.velocity_world = glm::vec3(vel_x[i], vel_y[i], vel_z[i]);
+    body.orientation_world = glm::quat(rot_w[i], rot_x[i], rot_y[i], rot_z[i]);
+    body.angular_velocity_body = glm::vec3(ang_x[i], ang_y[i], ang_z[i]);
+}
+
+void RigidBodyBatch::gather(const std::vector<RigidBody*>& bodies) {
+    resize(bodies.size());
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        load(i, *bodies[i]);
+    }
+}
+
+void RigidBodyBatch::scatter(const std::vector<RigidBody*>& bodies) const {
+    size_t n = std::min(bodies.size(), count);
+    for (size_t i = 0; i < n; ++i) {
+        store(i, *bodies[i]);
+        bodies[i]->clearAccumulators();
+    }
+}
+
+const char* RigidBodyBatch::simdPath() {
+    return lane::SIMD_NAME;
+}
+
+
+void RigidBodyBatch::integrate(float dt) {
+    if (dt <= 0.0f || count == 0) return; // Same safety check as RigidBody::update
+
+    const size_t vector_end = count - (count % lane::SIMD_WIDTH);
+
+    const lane::Lane vdt = lane::splat(dt);
+    const lane::Lane half_dt = lane::splat(0.5f * dt);
+    const lane::Lane zero = lane::splat(0.0f);
+    const lane::Lane one = lane::splat(1.0f);
+
+    for (size_t i = 0; i < vector_end; i += lane::SIMD_WIDTH) {
+        // Bodies with mass <= 0 are left untouched (RigidBody::update returns early)
+        const lane::Lane m_raw = lane::load(&mass[i]);
+        const lane::Lane active = lane::greater(m_raw, zero);
+        const lane::Lane m = lane::select(active, m_raw, one);
+
+        // --- Linear Motion ---
+        const lane::Lane fx = lane::load(&force_x[i]);
+        const lane::Lane fy = lane::add(lane::load(&force_y[i]), lane::mul(lane::load(&gravity[i]), m));
+        const lane::Lane fz = lane::load(&force_z[i]);
+
+        const lane::Lane vx_old = lane::load(&vel_x[i]), vy_old = lane::load(&vel_y[i]), vz_old = lane::load(&vel_z[i]);
+        const lane::Lane vx = lane::add(vx_old, lane::mul(lane::div(fx, m), vdt));
+        const lane::Lane vy = lane::add(vy_old, lane::mul(lane::div(fy, m), vdt));
+        const lane::Lane vz = lane::add(vz_old, lane::mul(lane::div(fz, m), vdt));
+
+        const lane::Lane px_old = lane::load(&pos_x[i]), py_old = lane::load(&pos_y[i]), pz_old = lane::load(&pos_z[i]);
+        lane::store(&pos_x[i], lane::select(active, lane::add(px_old, lane::mul(vx, vdt)), px_old));
+        lane::store(&pos_y[i], lane::select(active, lane::add(py_old, lane::mul(vy, vdt)), py_old));
+        lane::store(&pos_z[i], lane::select(active, lane::add(pz_old, lane::mul(vz, vdt)), pz_old));
+        lane::store(&vel_x[i], lane::select(active, vx, vx_old));
+        lane::store(&vel_y[i], lane::select(active, vy, vy_old));
+        lane::store(&vel_z[i], lane::select(active, vz, vz_old));
+
+        // --- Angular Motion ---
+        const lane::Lane wx_old = lane::load(&ang_x[i]), wy_old = lane::load(&ang_y[i]), wz_old = lane::load(&ang_z[i]);
+
+        // Iw = I * w (column-major)
+        const lane::Lane Iwx = lane::add(lane::add(lane::mul(lane::load(&inertia[0][i]), wx_old), lane::mul(lane::load(&inertia[3][i]), wy_old)), lane::mul(lane::load(&inertia[6][i]), wz_old));
+        const lane::Lane Iwy = lane::add(lane::add(lane::mul(lane::load(&inertia[1][i]), wx_old), lane::mul(lane::load(&inertia[4][i]), wy_old)), lane::mul(lane::load(&inertia[7][i]), wz_old));
+        const lane::Lane Iwz = lane::add(lane::add(lane::mul(lane::load(&inertia[2][i]), wx_old), lane::mul(lane::load(&inertia[5][i]), wy_old)), lane::mul(lane::load(&inertia[8][i]), wz_old));
+
+        // net = torque - cross(w, Iw)
+        const lane::Lane tx = lane::sub(lane::load(&torque_x[i]), lane::sub(lane::mul(wy_old, Iwz), lane::mul(Iwy, wz_old)));
+        const lane::Lane ty = lane::sub(lane::load(&torque_y[i]), lane::sub(lane::mul(wz_old, Iwx), lane::mul(Iwz, wx_old)));
+        const lane::Lane tz = lane::sub(lane::load(&torque_z[i]), lane::sub(lane::mul(wx_old, Iwy), lane::mul(Iwx, wy_old)));
+
+        // alpha = I_inv * net
+        const lane::Lane ax = lane::add(lane::add(lane::mul(lane::load(&inv_inertia[0][i]), tx), lane::mul(lane::load(&inv_inertia[3][i]), ty)), lane::mul(lane::load(&inv_inertia[6][i]), tz));
+        const lane::Lane ay = lane::add(lane::add(lane::mul(lane::load(&inv_inertia[1][i]), tx), lane::mul(lane::load(&inv_inertia[4][i]), ty)), lane::mul(lane::load(&inv_inertia[7][i]), tz));
+        const lane::Lane az = lane::add(lane::add(lane::mul(lane::load(&inv_inertia[2][i]), tx), lane::mul(lane::load(&inv_inertia[5][i]), ty)), lane::mul(lane::load(&inv_inertia[8][i]), tz));
+
+        const lane::Lane wx = lane::add(wx_old, lane::mul(ax, vdt));
+        const lane::Lane wy = lane::add(wy_old, lane::mul(ay, vdt));
+        const lane::Lane wz = lane::add(wz_old, lane::mul(az, vdt));
+        lane::store(&ang_x[i], lane::select(active, wx, wx_old));
+        lane::store(&ang_y[i], lane::select(active, wy, wy_old));
+        lane::store(&ang_z[i], lane::select(active, wz, wz_old));
+
+        // --- Orientation: Q += (Q * (0, w)) * 0.5dt, then normalize ---
+        const lane::Lane qw_old = lane::load(&rot_w[i]), qx_old = lane::load(&rot_x[i]), qy_old = lane::load(&rot_y[i]), qz_old = lane::load(&rot_z[i]);
+        const lane::Lane dw = lane::sub(lane::sub(lane::sub(lane::mul(qw_old, zero), lane::mul(qx_old, wx)), lane::mul(qy_old, wy)), lane::mul(qz_old, wz));
+        const lane::Lane dx = lane::sub(lane::add(lane::add(lane::mul(qw_old, wx), lane::mul(qx_old, zero)), lane::mul(qy_old, wz)), lane::mul(qz_old, wy));
+        const lane::Lane dy = lane::sub(lane::add(lane::add(lane::mul(qw_old, wy), lane::mul(qy_old, zero)), lane::mul(qz_old, wx)), lane::mul(qx_old, wz));
+        const lane::Lane dz = lane::sub(lane::add(lane::add(lane::mul(qw_old, wz), lane::mul(qz_old, zero)), lane::mul(qx_old, wy)), lane::mul(qy_old, wx));
+
+        const lane::Lane qw = lane::add(qw_old, lane::mul(dw, half_dt));
+        const lane::Lane qx = lane::add(qx_old, lane::mul(dx, half_dt));
+        const lane::Lane qy = lane::add(qy_old, lane::mul(dy, half_dt));
+        const lane::Lane qz = lane::add(qz_old, lane::mul(dz, half_dt));
+
+        // glm::normalize(quat): dot summed as (ww + xx) + (yy + zz), then multiply by 1/len
+        const lane::Lane len = lane::sqrt(lane::add(lane::add(lane::mul(qw, qw), lane::mul(qx, qx)), lane::add(lane::mul(qy, qy), lane::mul(qz, qz))));
+        const lane::Lane valid = lane::greater(len, zero);
+        const lane::Lane inv_len = lane::div(one, lane::select(valid, len, one));
+        const lane::Lane keep = lane::select(valid, active, zero); // zero-length quats reset to identity (glm behaviour)
+        lane::store(&rot_w[i], lane::select(active, lane::select(valid, lane::mul(qw, inv_len), one), qw_old));
+        lane::store(&rot_x[i], lane::select(keep, lane::mul(qx, inv_len), lane::select(active, zero, qx_old)));
+        lane::store(&rot_y[i], lane::select(keep, lane::mul(qy, inv_len), lane::select(active, zero, qy_old)));
+        lane::store(&rot_z[i], lane::select(keep, lane::mul(qz, inv_len), lane::select(active, zero, qz_old)));
+
+        // --- Reset Accumulators ---
+        lane::store(&force_x[i], zero); lane::store(&force_y[i], zero); lane::store(&force_z[i], zero);
+        lane::store(&torque_x[i], zero); lane::store(&torque_y[i], zero); lane::store(&torque_z[i], zero);
+    }
+
+    // Remainder that doesn't fill a full SIMD register
+    integrateRange(vector_end, count, dt);
+}
+
+void RigidBodyBatch::integrateScalar(float dt) {
+    if (dt <= 0.0f) return;
+    integrateRange(0, count, dt);
+}
+
+// Scalar kernel: the same math as RigidBody::update, written against the arrays
+void RigidBodyBatch::integrateRange(size_t begin, size_t end, float dt) {
+    for (size_t i = begin; i < end; ++i) {
+        if (mass[i] <= 0.0f) continue;
+
+        glm::vec3 final_force(force_x[i], force_y[i], force_z[i]);
+        final_force += glm::vec3(0.0f, gravity[i] * mass[i], 0.0f);
+        glm::vec3 velocity = glm::vec3(vel_x[i], vel_y[i], vel_z[i]) + (final_force / mass[i]) * dt;
+        glm::vec3 position = glm::vec3(pos_x[i], pos_y[i], pos_z[i]) + velocity * dt;
+
+        glm::mat3 I, I_inv;
+        for (int c = 0; c < 3; ++c) {
+            for (int r = 0; r < 3; ++r) {
+                I[c][r] = inertia[c * 3 + r][i];
+                I_inv[c][r] = inv_inertia[c * 3 + r][i];
+            }
+        }
+        glm::vec3 w(ang_x[i], ang_y[i], ang_z[i]);
+        glm::vec3 net_torque = glm::vec3(torque_x[i], torque_y[i], torque_z[i]) - glm::cross(w, I * w);
+        w += (I_inv * net_torque) * dt;
+
+        glm::quat q(rot_w[i], rot_x[i], rot_y[i], rot_z[i]);
+        q += (q * glm::quat(0.0f, w.x, w.y, w.z)) * (0.5f * dt);
+        q = glm::normalize(q);
+
+        pos_x[i] = position.x; pos_y[i] = position.y; pos_z[i] = position.z;
+        vel_x[i] = velocity.x; vel_y[i] = velocity.y; vel_z[i] = velocity.z;
+        ang_x[i] = w.x; ang_y[i] = w.y; ang_z[i] = w.z;
+        rot_w[i] = q.w; rot_x[i] = q.x; rot_y[i] = q.y; rot_z[i] = q.z;
+
+        force_x[i] = force_y[i] = force_z[i] = 0.0f;
+        torque_x[i] = torque_y[i] = torque_z[i] = 0.0f;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef RIGIDBODY_BATCH_H
+#define RIGIDBODY_BATCH_H
+
+#include "RigidBody.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+#include <cstddef>
+
+// Structure-of-arrays store for many rigid bodies.
+// Integrates every body in one pass with the same semi-implicit Euler scheme as
+// RigidBody::update, processing SIMD_WIDTH bodies per iteration (AVX: 8, SSE2: 4).
+// Typical use per physics step:
+//   1. Accumulate forces on each RigidBody as usual (engine, wings...)
+//   2. batch.gather(bodies)   - copies state + accumulators into the arrays
+//   3. batch.integrate(dt)    - vectorized integration
+//   4. batch.scatter(bodies)  - writes state back and clears the accumulators
+class RigidBodyBatch {
+public:
+    // --- State (world space unless noted) ---
+    std::vector<float> pos_x, pos_y, pos_z;
+    std::vector<float> vel_x, vel_y, vel_z;
+    std::vector<float> rot_w, rot_x, rot_y, rot_z;   // Orientation quaternion
+    std::vector<float> ang_x, ang_y, ang_z;          // Angular velocity (body space)
+
+    // --- Accumulators (cleared by integrate) ---
+    std::vector<float> force_x, force_y, force_z;    // World space
+    std::vector<float> torque_x, torque_y, torque_z; // Body space
+
+    // --- Static Properties ---
+    std::vector<float> mass;
+    std::vector<float> gravity;                      // -GRAVITY if apply_gravity, else 0
+    // Inertia tensors, column-major like glm: inertia[c * 3 + r] holds I[c][r]
+    std::vector<float> inertia[9];
+    std::vector<float> inv_inertia[9];
+
+    RigidBodyBatch() = default;
+
+    size_t size() const { return count; }
+    void clear();
+    void reserve(size_t n);
+
+    // Append a body (state, properties and current accumulators). Returns its index.
+    size_t add(const RigidBody& body);
+    // Overwrite slot i from / to a RigidBody
+    void load(size_t i, const RigidBody& body);
+    void store(size_t i, RigidBody& body) const;
+
+    // Convenience: resize to bodies.size() and load/store them all.
+    // scatter() also clears the bodies' force/torque accumulators like RigidBody::update does.
+    void gather(const std::vector<RigidBody*>& bodies);
+    void scatter(const std::vector<RigidBody*>& bodies) const;
+
+    // --- Simulation ---
+    // Integrates all bodies forward by dt using SIMD lanes where available.
+    void integrate(float dt);
+    // Reference one-body-at-a-time version of the same kernel (for validation/benchmarks)
+    void integrateScalar(float dt);
+
+    // Name of the instruction set the vector kernel was compiled for ("AVX", "SSE2", "scalar")
+    static const char* simdPath();
+
+private:
+    size_t count = 0;
+
+    void resize(size_t n);
+    void integrateRange(size_t begin, size_t end, float dt);
+};
+
+#endif // RIGIDBODY_BATCH_H
@@ -1,9 +1,145 @@
 #include "Shader.h"
+#include "FrameData.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+namespace {
+
+const char CACHE_MAGIC[4] = {'F', 'S', 'P', 'B'};
+const uint32_t CACHE_VERSION = 1;
+
+uint64_t fnv1a64(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Binaries from another driver, GPU or driver version are useless (and may be rejected)
+uint64_t driverHash() {
+    static uint64_t hash = 0;
+    if (hash == 0) {
+        hash = 14695981039346656037ull;
+        for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+            const char* value = reinterpret_cast<const char*>(glGetString(name));
+            if (value) hash = fnv1a64(hash, value, std::strlen(value) + 1);
+        }
+    }
+    return hash;
+}
+
+bool programBinarySupported() {
+    static int supported = -1;
+    if (supported < 0) {
+        GLint formats = 0;
+        if (GLEW_ARB_get_program_binary) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        supported = formats > 0 ? 1 : 0;
+    }
+    return supported == 1;
+}
+
+std::string cachePath(uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(Shader::programCacheDirectory) / name).string();
+}
+
+bool readCachedBinary(uint64_t key, GLenum& format, std::vector<char>& binary) {
+    std::ifstream file(cachePath(key), std::ios::binary);
+    if (!file) return false;
+    char magic[4];
+    uint32_t version = 0, size = 0;
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&format), sizeof(format));
+    file.read(reinterpret_cast<char*>(&size), sizeof(size));
+    if (!file || std::memcmp(magic, CACHE_MAGIC, 4) != 0 || version != CACHE_VERSION || size == 0) return false;
+    // The binary is the rest of the file: a truncated or corrupt size means recompiling,
+    // not allocating whatever the header claims
+    std::streampos data_start = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff remaining = file.tellg() - data_start;
+    if (!file || remaining != static_cast<std::streamoff>(size)) {
+        std::cerr << "Warning: Ignoring malformed shader cache entry " << cachePath(key) << std::endl;
+        return false;
+    }
+    file.seekg(data_start);
+    binary.resize(size);
+    return static_cast<bool>(file.read(binary.data(), size));
+}
+
+void writeCachedBinary(uint64_t key, GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    std::error_code ec;
+    std::filesystem::create_directories(Shader::programCacheDirectory, ec);
+    std::string path = cachePath(key);
+    std::string temp = path + ".tmp"; // Renamed into place: a crash never leaves a torn file
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        uint32_t size = static_cast<uint32_t>(length);
+        file.write(CACHE_MAGIC, 4);
+        file.write(reinterpret_cast<const char*>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+        file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        file.write(binary.data(), length);
+        if (!file) {
+            std::cerr << "Warning: Cannot write shader cache " << temp << std::endl;
+            file.close();
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::cerr << "Warning: Cannot store shader cache " << path << " (" << ec.message() << ")" << std::endl;
+        std::filesystem::remove(temp, ec);
+    }
+}
+
+} // namespace
+
+std::string Shader::programCacheDirectory = "shader_cache";
+
 Shader::Shader(const char* vertexPath, const char* fragmentPath) : ID(0) { // Initialize ID
+    submit(vertexPath, fragmentPath);
+    complete();
+}
+
+std::vector<std::unique_ptr<Shader>> Shader::loadBatch(const std::vector<ShaderFiles>& files) {
+    // Let the driver use as many compiler threads as it likes. The entry points are only
+    // declared by newer GLEW headers (KHR: 2.2, ARB: 2.1); without them the driver picks.
+#if defined(GL_KHR_parallel_shader_compile)
+    if (GLEW_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+    else if (GLEW_ARB_parallel_shader_compile) glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+#elif defined(GL_ARB_parallel_shader_compile)
+    if (GLEW_ARB_parallel_shader_compile) glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+#endif
+
+    std::vector<std::unique_ptr<Shader>> shaders;
+    shaders.reserve(files.size());
+    for (const ShaderFiles& f : files) {
+        shaders.emplace_back(new Shader());
+        shaders.back()->submit(f.vertex, f.fragment);
+    }
+    for (auto& shader : shaders) shader->complete();
+    return shaders;
+}
+
+void Shader::submit(const char* vertexPath, const char* fragmentPath) {
+    label = std::string(vertexPath) + " + " + fragmentPath;
     // 1. Retrieve the vertex/fragment source code from filePath
     std::string vertexCode;
     std::string fragmentCode;
@@ -32,45 +168,109 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) : ID(0) { // In
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
 
-    // 2. Compile shaders
-    GLuint vertex = 0, fragment = 0; // Initialize handles
-    // Vertex shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
-    // Fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
-    // Shader Program
     ID = glCreateProgram();
     if (ID == 0) {
         std::cerr << "ERROR::SHADER::PROGRAM_CREATION_FAILED" << std::endl;
-        if (vertex != 0) glDeleteShader(vertex);
-        if (fragment != 0) glDeleteShader(fragment);
         return;
     }
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
+
+    // 2. Cached binary for exactly these sources on this driver
+    if (!programCacheDirectory.empty() && programBinarySupported()) {
+        uint64_t hash = fnv1a64(driverHash(), vertexCode.c_str(), vertexCode.size() + 1);
+        cache_key = fnv1a64(hash, fShaderCode, fragmentCode.size());
+        GLenum format = 0;
+        std::vector<char> binary;
+        if (readCachedBinary(cache_key, format, binary)) {
+            glProgramBinary(ID, format, binary.data(), static_cast<GLsizei>(binary.size()));
+            // Binaries load without compiling, so this query does not serialize the batch
+            GLint success = 0;
+            glGetProgramiv(ID, GL_LINK_STATUS, &success);
+            if (success) {
+                from_cache = true;
+                return;
+            }
+            std::cerr << "Shader cache entry rejected by the driver, recompiling: " << label << std::endl;
+        }
+        glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // 3. Compile and link; results are only queried in complete()
+    pending_vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(pending_vertex, 1, &vShaderCode, NULL);
+    glCompileShader(pending_vertex);
+    pending_fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(pending_fragment, 1, &fShaderCode, NULL);
+    glCompileShader(pending_fragment);
+    glAttachShader(ID, pending_vertex);
+    glAttachShader(ID, pending_fragment);
     glLinkProgram(ID);
+}
+
+void Shader::complete() {
+    if (ID == 0 || from_cache) {
+        if (ID != 0) cacheUniforms();
+        return;
+    }
+    checkCompileErrors(pending_vertex, "VERTEX");
+    checkCompileErrors(pending_fragment, "FRAGMENT");
     checkCompileErrors(ID, "PROGRAM");
 
     // Delete the shaders as they're linked into our program now and no longer necessary
     // Check handles before deleting
-    if (vertex != 0) glDeleteShader(vertex);
-    if (fragment != 0) glDeleteShader(fragment);
-
-     // Check link status after deleting shaders? Or before? Usually check link status first.
-     GLint success;
-     glGetProgramiv(ID, GL_LINK_STATUS, &success);
-     if (!success) {
-         // ID might be invalid after failed link, maybe cleanup?
-         // For now, ID remains non-zero but program is unusable.
-         std::cerr << "Shader program linking failed." << std::endl;
-         // Optionally delete program: glDeleteProgram(ID); ID = 0;
-     }
+    if (pending_vertex != 0) glDeleteShader(pending_vertex);
+    if (pending_fragment != 0) glDeleteShader(pending_fragment);
+    pending_vertex = pending_fragment = 0;
+
+    GLint success;
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    if (!success) {
+        std::cerr << "Shader program linking failed: " << label << std::endl;
+        glDeleteProgram(ID); // ID 0 marks the failure for callers
+        ID = 0;
+        return;
+    }
+    if (cache_key != 0) writeCachedBinary(cache_key, ID);
+    cacheUniforms();
+}
+
+// --- Uniform location table ---
+void Shader::cacheUniforms() {
+    uniform_locations.clear();
+    GLint count = 0, max_length = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+    std::vector<GLchar> name(static_cast<size_t>(std::max(max_length, 1)));
+
+    auto add = [&](const char* uniform_name, GLint location) {
+        uint32_t hash = uniformHash(uniform_name);
+        for (const auto& entry : uniform_locations) {
+            if (entry.first == hash && entry.second != location) {
+                std::cerr << "ERROR::SHADER::UNIFORM_HASH_COLLISION on '" << uniform_name << "'" << std::endl;
+            }
+        }
+        uniform_locations.emplace_back(hash, location);
+    };
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, static_cast<GLuint>(i), max_length, &length, &size, &type, name.data());
+        GLint location = glGetUniformLocation(ID, name.data());
+        if (location < 0) continue; // Uniform block member: set through the block's buffer
+        add(name.data(), location);
+        // Arrays are reported as "name[0]"; also allow addressing them by "name"
+        std::string base(name.data(), static_cast<size_t>(length));
+        if (base.size() > 3 && base.compare(base.size() - 3, 3, "[0]") == 0) add(base.substr(0, base.size() - 3).c_str(), location);
+    }
+    std::sort(uniform_locations.begin(), uniform_locations.end());
+
+    GLuint block = glGetUniformBlockIndex(ID, FRAME_DATA_BLOCK);
+    if (block != GL_INVALID_INDEX) glUniformBlockBinding(ID, block, FrameData::BINDING);
+}
+
+GLint Shader::getUniformLocation(UniformId id) const {
+    auto it = std::lower_bound(uniform_locations.begin(), uniform_locations.end(), std::make_pair(id.hash, static_cast<GLint>(-1)));
+    return it != uniform_locations.end() && it->first == id.hash ? it->second : -1;
 }
 
 Shader::~Shader() {
@@ -116,15 +316,15 @@ void Shader::checkCompileErrors(GLuint shader, std::string type) {
 }
 
 // --- Utility uniform functions implementation ---
-void Shader::setBool(const std::string &name, bool value) const { if(ID) glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); }
-void Shader::setInt(const std::string &name, int value) const { if(ID) glUniform1i(glGetUniformLocation(ID, name.c_str()), value); }
-void Shader::setFloat(const std::string &name, float value) const { if(ID) glUniform1f(glGetUniformLocation(ID, name.c_str()), value); }
-void Shader::setVec2(const std::string &name, const glm::vec2 &value) const { if(ID) glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); }
-void Shader::setVec2(const std::string &name, float x, float y) const { if(ID) glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y); }
-void Shader::setVec3(const std::string &name, const glm::vec3 &value) const { if(ID) glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); }
-void Shader::setVec3(const std::string &name, float x, float y, float z) const { if(ID) glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); }
-void Shader::setVec4(const std::string &name, const glm::vec4 &value) const { if(ID) glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); }
-void Shader::setVec4(const std::string &name, float x, float y, float z, float w) const { if(ID) glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); }
-void Shader::setMat2(const std::string &name, const glm::mat2 &mat) const { if(ID) glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]); }
-void Shader::setMat3(const std::string &name, const glm::mat3 &mat) const { if(ID) glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]); }
-void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const { if(ID) glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]); }
+void Shader::setBool(UniformId id, bool value) const { if(ID) glUniform1i(getUniformLocation(id), (int)value); }
+void Shader::setInt(UniformId id, int value) const { if(ID) glUniform1i(getUniformLocation(id), value); }
+void Shader::setFloat(UniformId id, float value) const { if(ID) glUniform1f(getUniformLocation(id), value); }
+void Shader::setVec2(UniformId id, const glm::vec2 &value) const { if(ID) glUniform2fv(getUniformLocation(id), 1, &value[0]); }
+void Shader::setVec2(UniformId id, float x, float y) const { if(ID) glUniform2f(getUniformLocation(id), x, y); }
+void Shader::setVec3(UniformId id, const glm::vec3 &value) const { if(ID) glUniform3fv(getUniformLocation(id), 1, &value[0]); }
+void Shader::setVec3(UniformId id, float x, float y, float z) const { if(ID) glUniform3f(getUniformLocation(id), x, y, z); }
+void Shader::setVec4(UniformId id, const glm::vec4 &value) const { if(ID) glUniform4fv(getUniformLocation(id), 1, &value[0]); }
+void Shader::setVec4(UniformId id, float x, float y, float z, float w) const { if(ID) glUniform4f(getUniformLocation(id), x, y, z, w); }
+void Shader::setMat2(UniformId id, const glm::mat2 &mat) const { if(ID) glUniformMatrix2fv(getUniformLocation(id), 1, GL_FALSE, &mat[0][0]); }
+void Shader::setMat3(UniformId id, const glm::mat3 &mat) const { if(ID) glUniformMatrix3fv(getUniformLocation(id), 1, GL_FALSE, &mat[0][0]); }
+void Shader::setMat4(UniformId id, const glm::mat4 &mat) const { if(ID) glUniformMatrix4fv(getUniformLocation(id), 1, GL_FALSE, &mat[0][0]); }
@@ -1,37 +1,108 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include <glm/glm.hpp>
 #include <GL/glew.h> // Use GLEW
 
+// FNV-1a of a uniform name. constexpr so names known at compile time hash for free.
+constexpr uint32_t uniformHash(const char* name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= static_cast<uint8_t>(*name++);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Key into a Shader's uniform location table. Converts implicitly from a name, so
+// setMat4("u_Model", m) still works; hot paths declare `constexpr UniformId U_MODEL("u_Model");`
+// so the hash is guaranteed to be folded at compile time.
+struct UniformId {
+    uint32_t hash;
+    const char* name; // Diagnostics only
+
+    constexpr UniformId(const char* uniform_name) : hash(uniformHash(uniform_name)), name(uniform_name) {}
+    UniformId(const std::string& uniform_name) : hash(uniformHash(uniform_name.c_str())), name(uniform_name.c_str()) {}
+};
+
+// Source files of one program
+struct ShaderFiles {
+    const char* vertex;
+    const char* fragment;
+};
+
 class Shader {
 public:
     GLuint ID; // Program ID
 
-    Shader(const char* vertexPath, const char* fragmentPath);
+    // Uniform block shared by every program (see FrameData.h), bound to this binding point at link time
+    static constexpr const char* FRAME_DATA_BLOCK = "FrameData";
+
+    // Linked program binaries (glGetProgramBinary) are kept here, one file per program, keyed by
+    // a hash of both sources and the GL vendor/renderer/version strings, and loaded instead of
+    // compiling on later runs. Empty disables the cache. Set before creating shaders.
+    static std::string programCacheDirectory;
+
+    Shader(const char* vertexPath, const char* fragmentPath); // A batch of one
     ~Shader();
 
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+    // Build several programs at once: every cache load and every compile + link is submitted
+    // before any status is queried, so a driver that compiles on its own threads
+    // (KHR_parallel_shader_compile, Mesa's threaded compiler) overlaps them. Same order as
+    // `files`; a program that failed has ID 0.
+    static std::vector<std::unique_ptr<Shader>> loadBatch(const std::vector<ShaderFiles>& files);
+
+    bool isFromCache() const { return from_cache; } // Loaded from a cached binary, not compiled
+
     // --- Modified use() method ---
     // Allows calling use() to activate, use(true) to activate, use(false) to deactivate
     void use(bool activate = true) const;
 
-    // Utility uniform functions
-    void setBool(const std::string &name, bool value) const;
-    void setInt(const std::string &name, int value) const;
-    void setFloat(const std::string &name, float value) const;
-    void setVec2(const std::string &name, const glm::vec2 &value) const;
-    void setVec2(const std::string &name, float x, float y) const;
-    void setVec3(const std::string &name, const glm::vec3 &value) const;
-    void setVec3(const std::string &name, float x, float y, float z) const;
-    void setVec4(const std::string &name, const glm::vec4 &value) const;
-    void setVec4(const std::string &name, float x, float y, float z, float w) const;
-    void setMat2(const std::string &name, const glm::mat2 &mat) const;
-    void setMat3(const std::string &name, const glm::mat3 &mat) const;
-    void setMat4(const std::string &name, const glm::mat4 &mat) const;
+    // Location of an active uniform from the table built at link time (-1 if the program has
+    // no such uniform; glUniform* ignores -1, as it did with glGetUniformLocation)
+    GLint getUniformLocation(UniformId id) const;
+
+    // Utility uniform functions (no string building or GL location query per call)
+    void setBool(UniformId id, bool value) const;
+    void setInt(UniformId id, int value) const;
+    void setFloat(UniformId id, float value) const;
+    void setVec2(UniformId id, const glm::vec2 &value) const;
+    void setVec2(UniformId id, float x, float y) const;
+    void setVec3(UniformId id, const glm::vec3 &value) const;
+    void setVec3(UniformId id, float x, float y, float z) const;
+    void setVec4(UniformId id, const glm::vec4 &value) const;
+    void setVec4(UniformId id, float x, float y, float z, float w) const;
+    void setMat2(UniformId id, const glm::mat2 &mat) const;
+    void setMat3(UniformId id, const glm::mat3 &mat) const;
+    void setMat4(UniformId id, const glm::mat4 &mat) const;
 
 private:
+    std::vector<std::pair<uint32_t, GLint>> uniform_locations; // (name hash, location), sorted by hash
+
+    // --- Build state between submit() and complete() ---
+    std::string label;           // "vertex + fragment" paths, for messages
+    GLuint pending_vertex = 0;   // Compiling (cache miss)
+    GLuint pending_fragment = 0;
+    uint64_t cache_key = 0;      // 0 = not cacheable
+    bool from_cache = false;
+
+    Shader() : ID(0) {}
+    // Read the sources, then load the cached binary or start compiling and linking; no queries
+    void submit(const char* vertexPath, const char* fragmentPath);
+    // Wait for the result, report errors, store a new binary and build the uniform table
+    void complete();
+
     void checkCompileErrors(GLuint shader, std::string type);
+    // Build uniform_locations and bind the FrameData block, after a successful link
+    void cacheUniforms();
 };
 
 #endif // SHADER_H
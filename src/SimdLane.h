@@ -0,0 +1,77 @@
+#ifndef SIMD_LANE_H
+#define SIMD_LANE_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+// --- SIMD lane abstraction ---
+// Thin wrappers over SSE2/AVX so kernels are written once against `lane::Lane`
+// and fall back to plain floats on other targets.
+namespace lane {
+
+#if defined(__AVX__)
+using Lane = __m256;
+constexpr size_t SIMD_WIDTH = 8;
+inline Lane load(const float* p) { return _mm256_loadu_ps(p); }
+inline void store(float* p, Lane v) { _mm256_storeu_ps(p, v); }
+inline Lane splat(float v) { return _mm256_set1_ps(v); }
+inline Lane add(Lane a, Lane b) { return _mm256_add_ps(a, b); }
+inline Lane sub(Lane a, Lane b) { return _mm256_sub_ps(a, b); }
+inline Lane mul(Lane a, Lane b) { return _mm256_mul_ps(a, b); }
+inline Lane div(Lane a, Lane b) { return _mm256_div_ps(a, b); }
+inline Lane sqrt(Lane a) { return _mm256_sqrt_ps(a); }
+inline Lane greater(Lane a, Lane b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline Lane select(Lane mask, Lane a, Lane b) { return _mm256_blendv_ps(b, a, mask); }
+inline Lane min(Lane a, Lane b) { return _mm256_min_ps(a, b); }
+inline Lane max(Lane a, Lane b) { return _mm256_max_ps(a, b); }
+inline Lane floor(Lane a) { return _mm256_floor_ps(a); }
+// Truncate to int32 and spill, for table gathers (AVX1 has no gather instruction)
+inline void toIndices(int32_t* out, Lane a) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_cvttps_epi32(a)); }
+inline const char* const SIMD_NAME = "AVX";
+#elif defined(__SSE2__) || defined(_M_X64)
+using Lane = __m128;
+constexpr size_t SIMD_WIDTH = 4;
+inline Lane load(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, Lane v) { _mm_storeu_ps(p, v); }
+inline Lane splat(float v) { return _mm_set1_ps(v); }
+inline Lane add(Lane a, Lane b) { return _mm_add_ps(a, b); }
+inline Lane sub(Lane a, Lane b) { return _mm_sub_ps(a, b); }
+inline Lane mul(Lane a, Lane b) { return _mm_mul_ps(a, b); }
+inline Lane div(Lane a, Lane b) { return _mm_div_ps(a, b); }
+inline Lane sqrt(Lane a) { return _mm_sqrt_ps(a); }
+inline Lane greater(Lane a, Lane b) { return _mm_cmpgt_ps(a, b); }
+inline Lane select(Lane mask, Lane a, Lane b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+inline Lane min(Lane a, Lane b) { return _mm_min_ps(a, b); }
+inline Lane max(Lane a, Lane b) { return _mm_max_ps(a, b); }
+// SSE2 has no floor; inputs are clamped non-negative before use, so truncation is floor
+inline Lane floor(Lane a) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(a)); }
+inline void toIndices(int32_t* out, Lane a) { _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_cvttps_epi32(a)); }
+inline const char* const SIMD_NAME = "SSE2";
+#else
+using Lane = float;
+constexpr size_t SIMD_WIDTH = 1;
+inline Lane load(const float* p) { return *p; }
+inline void store(float* p, Lane v) { *p = v; }
+inline Lane splat(float v) { return v; }
+inline Lane add(Lane a, Lane b) { return a + b; }
+inline Lane sub(Lane a, Lane b) { return a - b; }
+inline Lane mul(Lane a, Lane b) { return a * b; }
+inline Lane div(Lane a, Lane b) { return a / b; }
+inline Lane sqrt(Lane a) { return std::sqrt(a); }
+inline Lane greater(Lane a, Lane b) { return a > b ? 1.0f : 0.0f; }
+inline Lane select(Lane mask, Lane a, Lane b) { return mask != 0.0f ? a : b; }
+inline Lane min(Lane a, Lane b) { return a < b ? a : b; }
+inline Lane max(Lane a, Lane b) { return a > b ? a : b; }
+inline Lane floor(Lane a) { return std::floor(a); }
+inline void toIndices(int32_t* out, Lane a) { *out = static_cast<int32_t>(a); }
+inline const char* const SIMD_NAME = "scalar";
+#endif
+
+} // namespace lane
+
+#endif // SIMD_LANE_H
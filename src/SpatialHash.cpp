@@ -0,0 +1,196 @@
+#include "SpatialHash.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 21 bits per axis (+-1M cells: +-500,000 km at 500 m cells)
+const int64_t AXIS_BIAS = 1 << 20;
+const uint64_t AXIS_MASK = (1u << 21) - 1;
+
+// Rough cost of one table probe (a likely cache miss) relative to testing one occupied cell
+// while streaming through cell_coords
+const double PROBE_COST = 8.0;
+
+} // namespace
+
+SpatialHash::SpatialHash(float size) {
+    setCellSize(size);
+}
+
+void SpatialHash::setCellSize(float size) {
+    cell_size = std::max(size, 1e-3f);
+    inv_cell_size = 1.0f / cell_size;
+}
+
+glm::ivec3 SpatialHash::cellOf(const glm::vec3& p) const {
+    return glm::ivec3(static_cast<int>(std::floor(p.x * inv_cell_size)),
+                      static_cast<int>(std::floor(p.y * inv_cell_size)),
+                      static_cast<int>(std::floor(p.z * inv_cell_size)));
+}
+
+uint64_t SpatialHash::packKey(const glm::ivec3& cell) {
+    auto axis = [](int c) { return static_cast<uint64_t>(static_cast<int64_t>(c) + AXIS_BIAS) & AXIS_MASK; };
+    return axis(cell.x) | (axis(cell.y) << 21) | (axis(cell.z) << 42);
+}
+
+uint32_t SpatialHash::slotOf(uint64_t key) const {
+    // Fibonacci hashing: multiply, keep the high bits
+    return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & table_mask;
+}
+
+uint32_t SpatialHash::findCell(const glm::ivec3& cell) const {
+    const uint64_t key = packKey(cell);
+    for (uint32_t slot = slotOf(key);; slot = (slot + 1) & table_mask) {
+        const Slot& entry = table[slot];
+        if (entry.cell == NO_CELL || entry.key == key) return entry.cell;
+    }
+}
+
+void SpatialHash::build(const glm::vec3* input, size_t count) {
+    positions.assign(input, input + count);
+    body_cell.resize(count);
+    cell_keys.clear();
+    cell_coords.clear();
+
+    // Load factor <= 0.5 (there are at most `count` occupied cells)
+    uint32_t slots = 16;
+    while (slots < 2 * count) slots <<= 1;
+    table_mask = slots - 1;
+    table.assign(slots, Slot{0, NO_CELL});
+
+    // Assign cell ids and count bodies per cell
+    cell_start.assign(1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        const glm::ivec3 cell = cellOf(positions[i]);
+        const uint64_t key = packKey(cell);
+        uint32_t slot = slotOf(key);
+        while (table[slot].cell != NO_CELL && table[slot].key != key) slot = (slot + 1) & table_mask;
+        if (table[slot].cell == NO_CELL) {
+            table[slot] = Slot{key, static_cast<uint32_t>(cell_keys.size())};
+            cell_keys.push_back(key);
+            cell_coords.push_back(cell);
+            cell_start.push_back(0);
+        }
+        body_cell[i] = table[slot].cell;
+        ++cell_start[body_cell[i] + 1];
+    }
+
+    // Counting sort by cell id; cell_start is shifted back after the scatter
+    for (size_t c = 1; c < cell_start.size(); ++c) cell_start[c] += cell_start[c - 1];
+    sorted.resize(count);
+    for (size_t i = 0; i < count; ++i) sorted[cell_start[body_cell[i]]++] = static_cast<uint32_t>(i);
+    for (size_t c = cell_start.size() - 1; c > 0; --c) cell_start[c] = cell_start[c - 1];
+    cell_start[0] = 0;
+}
+
+void SpatialHash::build(const std::vector<RigidBody*>& bodies) {
+    gathered.resize(bodies.size());
+    for (size_t i = 0; i < bodies.size(); ++i) gathered[i] = bodies[i]->position_world;
+    build(gathered.data(), gathered.size());
+}
+
+template <typename Visit>
+void SpatialHash::forEachCellInRange(const glm::ivec3& c0, const glm::ivec3& c1, Visit&& visit) const {
+    const double range_cells = (static_cast<double>(c1.x) - c0.x + 1) * (static_cast<double>(c1.y) - c0.y + 1) *
+                               (static_cast<double>(c1.z) - c0.z + 1);
+    if (range_cells * PROBE_COST > static_cast<double>(cell_keys.size())) {
+        // Sparse grid, big range: a linear pass over every occupied cell beats probing the
+        // (mostly empty) range one random table access at a time
+        for (uint32_t id = 0; id < cell_keys.size(); ++id) {
+            const glm::ivec3& c = cell_coords[id];
+            if (c.x >= c0.x && c.x <= c1.x && c.y >= c0.y && c.y <= c1.y && c.z >= c0.z && c.z <= c1.z) visit(id);
+        }
+        return;
+    }
+    for (int z = c0.z; z <= c1.z; ++z) {
+        for (int y = c0.y; y <= c1.y; ++y) {
+            for (int x = c0.x; x <= c1.x; ++x) {
+                uint32_t id = findCell(glm::ivec3(x, y, z));
+                if (id != NO_CELL) visit(id);
+            }
+        }
+    }
+}
+
+template <typename Visit>
+void SpatialHash::forEachInSphere(const glm::vec3& center, float radius, Visit&& visit) const {
+    if (positions.empty()) return;
+    const float r2 = radius * radius;
+    forEachCellInRange(cellOf(center - glm::vec3(radius)), cellOf(center + glm::vec3(radius)), [&](uint32_t id) {
+        for (uint32_t s = cell_start[id]; s < cell_start[id + 1]; ++s) {
+            const uint32_t index = sorted[s];
+            glm::vec3 d = positions[index] - center;
+            float d2 = glm::dot(d, d);
+            if (d2 <= r2) visit(index, d2);
+        }
+    });
+}
+
+void SpatialHash::queryRadius(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const {
+    forEachInSphere(center, radius, [&](uint32_t index, float) { out.push_back(index); });
+}
+
+void SpatialHash::nearest(const glm::vec3& center, size_t k, std::vector<uint32_t>& out, float max_radius, uint32_t exclude) const {
+    out.clear();
+    if (k == 0 || positions.empty()) return;
+    const size_t available = positions.size() - (exclude < positions.size() ? 1 : 0);
+
+    // Grow the search sphere until it holds k bodies (or everything / max_radius): anything
+    // outside the sphere is farther than everything inside it, so the k closest are final
+    float radius = cell_size;
+    for (;;) {
+        radius = std::min(radius, max_radius);
+        candidates.clear();
+        forEachInSphere(center, radius, [&](uint32_t index, float d2) {
+            if (index != exclude) candidates.emplace_back(d2, index);
+        });
+        if (candidates.size() >= k || candidates.size() >= available || radius >= max_radius) break;
+        radius *= 2.0f;
+    }
+
+    size_t n = std::min(k, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + n, candidates.end());
+    for (size_t i = 0; i < n; ++i) out.push_back(candidates[i].second);
+}
+
+void SpatialHash::findPairs(float radius, std::vector<std::pair<uint32_t, uint32_t>>& out) const {
+    out.clear();
+    const float r2 = radius * radius;
+    const int reach = std::max(1, static_cast<int>(std::ceil(radius * inv_cell_size)));
+
+    // Cell against cell: each occupied cell pairs with itself and the neighbours that sort after
+    // it, so every cell pair (and so every body pair) is visited exactly once
+    for (uint32_t a = 0; a < cell_keys.size(); ++a) {
+        const glm::ivec3 ca = cell_coords[a];
+        const uint32_t a_begin = cell_start[a], a_end = cell_start[a + 1];
+
+        for (uint32_t s = a_begin; s < a_end; ++s) {
+            for (uint32_t t = s + 1; t < a_end; ++t) {
+                uint32_t i = sorted[s], j = sorted[t];
+                glm::vec3 d = positions[j] - positions[i];
+                if (glm::dot(d, d) <= r2) out.emplace_back(std::min(i, j), std::max(i, j));
+            }
+        }
+
+        for (int dz = -reach; dz <= reach; ++dz) {
+            for (int dy = -reach; dy <= reach; ++dy) {
+                for (int dx = -reach; dx <= reach; ++dx) {
+                    // Forward half-neighbourhood in (z, y, x) lexicographic order
+                    if (dz < 0 || (dz == 0 && (dy < 0 || (dy == 0 && dx <= 0)))) continue;
+                    uint32_t b = findCell(glm::ivec3(ca.x + dx, ca.y + dy, ca.z + dz));
+                    if (b == NO_CELL) continue;
+                    for (uint32_t s = a_begin; s < a_end; ++s) {
+                        const uint32_t i = sorted[s];
+                        const glm::vec3 p = positions[i];
+                        for (uint32_t t = cell_start[b]; t < cell_start[b + 1]; ++t) {
+                            uint32_t j = sorted[t];
+                            glm::vec3 d = positions[j] - p;
+                            if (glm::dot(d, d) <= r2) out.emplace_back(std::min(i, j), std::max(i, j));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include "RigidBody.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Uniform-grid broadphase over body positions, stored as a hashed grid so empty space costs
+// nothing. build() assigns each occupied cell an id through an open-addressed table and
+// counting-sorts the bodies by cell (O(N), no allocation once the buffers have grown), so
+// rebuilding every physics step is cheaper than tracking moves.
+// Results are indices into the positions/bodies passed to the last build().
+//
+// Pick cell_size around the typical pair/proximity radius: queries reach
+// ceil(radius / cell_size) cells in each direction. Large queries that would probe more
+// cells than are occupied walk the occupied cells instead.
+class SpatialHash {
+public:
+    explicit SpatialHash(float cell_size = 500.0f);
+
+    void setCellSize(float size);
+    float getCellSize() const { return cell_size; }
+
+    // --- Build ---
+    void build(const glm::vec3* positions, size_t count);
+    void build(const std::vector<RigidBody*>& bodies);
+    size_t size() const { return positions.size(); }
+    size_t getOccupiedCellCount() const { return cell_keys.size(); }
+    const glm::vec3& getPosition(uint32_t index) const { return positions[index]; }
+
+    // --- Queries ---
+    // Every body within `radius` of `center` (unordered). Appends to `out`.
+    void queryRadius(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const;
+    // Up to k bodies closest to `center` within max_radius, nearest first. Replaces `out`.
+    // `exclude` (e.g. the querying body itself) is skipped.
+    void nearest(const glm::vec3& center, size_t k, std::vector<uint32_t>& out,
+                 float max_radius = 1.0e6f, uint32_t exclude = UINT32_MAX) const;
+    // Every unordered pair (i < j) closer than `radius`. Replaces `out`.
+    void findPairs(float radius, std::vector<std::pair<uint32_t, uint32_t>>& out) const;
+
+private:
+    static constexpr uint32_t NO_CELL = UINT32_MAX;
+
+    float cell_size;
+    float inv_cell_size;
+
+    std::vector<glm::vec3> positions;   // Input order
+    std::vector<uint32_t> body_cell;    // Input order: cell id
+
+    // --- Occupied cells (ids in first-seen order) ---
+    std::vector<uint64_t> cell_keys;    // Packed cell coordinates
+    std::vector<glm::ivec3> cell_coords;
+    std::vector<uint32_t> cell_start;   // Prefix sums into `sorted` (cell count + 1)
+    std::vector<uint32_t> sorted;       // Body indices grouped by cell
+
+    // --- Key -> cell id, linear probing (key stored inline: one cache miss per probe) ---
+    struct Slot {
+        uint64_t key;
+        uint32_t cell;
+    };
+    std::vector<Slot> table;
+    uint32_t table_mask = 0;
+
+    mutable std::vector<std::pair<float, uint32_t>> candidates; // nearest() scratch
+    std::vector<glm::vec3> gathered;                            // build(bodies) scratch
+
+    glm::ivec3 cellOf(const glm::vec3& p) const;
+    static uint64_t packKey(const glm::ivec3& cell);
+    uint32_t slotOf(uint64_t key) const;
+    uint32_t findCell(const glm::ivec3& cell) const;
+
+    // Calls visit(cell_id) for every occupied cell overlapping the cell range [c0, c1]
+    template <typename Visit>
+    void forEachCellInRange(const glm::ivec3& c0, const glm::ivec3& c1, Visit&& visit) const;
+    // Calls visit(index, distance_sq) for every body within `radius` of `center`
+    template <typename Visit>
+    void forEachInSphere(const glm::vec3& center, float radius, Visit&& visit) const;
+};
+
+#endif // SPATIAL_HASH_H
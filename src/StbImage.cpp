@@ -0,0 +1,4 @@
+// Single definition of the stb_image implementation, shared by the physics library
+// (Heightfield) and the viewer (Texture)
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
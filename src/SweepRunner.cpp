@@ -0,0 +1,184 @@
+#include "SweepRunner.h"
+#include "AircraftFactory.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+// Flights above this many configurations are refused: the results alone would not fit
+const size_t MAX_CONFIGURATIONS = 50000000;
+
+const float ROLL_WINDOW = 2.0f;   // s after roll_start averaged for roll_rate
+const float SETTLE_WINDOW = 3.0f; // s after the doublet used for pitch_settle_rms
+
+} // namespace
+
+bool SweepParameter::parse(const std::string& spec, SweepParameter& out) {
+    size_t eq = spec.find('=');
+    if (eq == std::string::npos || eq == 0) return false;
+    out.name = spec.substr(0, eq);
+
+    float first = 0.0f, last = 0.0f;
+    unsigned long steps = 2; // Both ends when only the range is given
+    int fields = std::sscanf(spec.c_str() + eq + 1, "%f:%f:%lu", &first, &last, &steps);
+    if (fields == 1) {
+        out.min = out.max = first;
+        out.steps = 1;
+        return true;
+    }
+    if (fields < 2 || steps == 0 || last < first) return false;
+    out.min = first;
+    out.max = last;
+    out.steps = static_cast<size_t>(steps);
+    return true;
+}
+
+SweepRunner::SweepRunner(const AircraftConfig& base_config, std::vector<SweepParameter> sweep_parameters, Options sweep_options) :
+    base(base_config),
+    parameters(std::move(sweep_parameters)),
+    options(sweep_options)
+{
+    AircraftConfig probe = base;
+    count = 1;
+    for (const auto& p : parameters) {
+        if (!probe.set(p.name, p.min)) throw std::runtime_error("Unknown sweep parameter: " + p.name);
+        if (p.steps == 0) throw std::runtime_error("Sweep parameter " + p.name + " has no steps");
+        if (options.samples == 0) {
+            if (count > MAX_CONFIGURATIONS / p.steps) throw std::runtime_error("Sweep grid is too large; use sampling");
+            count *= p.steps;
+        }
+    }
+    if (options.samples > 0) count = std::min(options.samples, MAX_CONFIGURATIONS);
+    if (!(options.step_rate_hz > 0.0f) || !(options.duration > 0.0f)) throw std::runtime_error("Sweep needs a positive duration and step rate");
+}
+
+AircraftConfig SweepRunner::configAt(size_t index) const {
+    AircraftConfig config = base;
+    if (options.samples > 0) {
+        // Seeded per index, so results do not depend on which thread ran which flight
+        std::seed_seq seq{options.seed, static_cast<unsigned>(index), static_cast<unsigned>(static_cast<uint64_t>(index) >> 32)};
+        std::mt19937 rng(seq);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (const auto& p : parameters) config.set(p.name, p.min + (p.max - p.min) * unit(rng));
+        return config;
+    }
+    // Mixed radix: the first parameter varies fastest
+    for (const auto& p : parameters) {
+        size_t step = index % p.steps;
+        index /= p.steps;
+        float t = p.steps > 1 ? static_cast<float>(step) / static_cast<float>(p.steps - 1) : 0.0f;
+        config.set(p.name, p.min + (p.max - p.min) * t);
+    }
+    return config;
+}
+
+SweepResult SweepRunner::evaluate(size_t index) const {
+    SweepResult r;
+    r.index = static_cast<uint32_t>(index);
+
+    const FlightScript& script = options.maneuver;
+    std::unique_ptr<Aircraft> aircraft = AircraftFactory::createAircraft(configAt(index));
+    aircraft->position_world.y = script.initial_altitude;
+    aircraft->velocity_world = glm::normalize(aircraft->velocity_world) * script.initial_speed;
+
+    const float dt = 1.0f / options.step_rate_hz;
+    const uint64_t steps = static_cast<uint64_t>(std::ceil(options.duration * options.step_rate_hz));
+    const float doublet_end = script.doubletEnd();
+
+    float min_altitude = script.initial_altitude;
+    float climb_rate = -std::numeric_limits<float>::infinity();
+    double settle_sum = 0.0, roll_sum = 0.0;
+    size_t settle_samples = 0, roll_samples = 0;
+
+    for (uint64_t s = 0; s < steps; ++s) {
+        const float t = static_cast<float>(s) * dt;
+        aircraft->controls = script.controlsAt(t);
+        aircraft->update(dt);
+
+        const glm::vec3& w = aircraft->angular_velocity_body;
+        float altitude = aircraft->getAltitude();
+        if (!std::isfinite(altitude) || !std::isfinite(w.x + w.y + w.z)) {
+            r.diverged = true;
+            break;
+        }
+        min_altitude = std::min(min_altitude, altitude);
+        r.peak_rate = std::max(r.peak_rate, glm::length(w));
+        if (altitude <= 0.5f) {
+            r.crashed = true;
+            break; // Nothing useful happens on the ground clamp
+        }
+
+        const float t_end = t + dt;
+        if (t_end > script.pitch_start && t_end <= script.pitch_start + script.pitch_duration) {
+            climb_rate = std::max(climb_rate, aircraft->velocity_world.y);
+        }
+        if (t_end > doublet_end && t_end <= doublet_end + SETTLE_WINDOW) {
+            settle_sum += static_cast<double>(w.y) * w.y;
+            ++settle_samples;
+        }
+        if (t_end > script.roll_start && t_end <= script.roll_start + ROLL_WINDOW) {
+            roll_sum += std::abs(w.x);
+            ++roll_samples;
+        }
+    }
+
+    r.altitude_loss = script.initial_altitude - min_altitude;
+    r.final_speed = glm::length(aircraft->velocity_world);
+    r.pitch_settle_rms = settle_samples ? static_cast<float>(std::sqrt(settle_sum / settle_samples)) : 0.0f;
+    r.climb_rate = std::isfinite(climb_rate) ? climb_rate : 0.0f;
+    r.roll_rate = roll_samples ? static_cast<float>(roll_sum / roll_samples) : 0.0f;
+
+    const Weights& k = options.weights;
+    r.score = (r.crashed || r.diverged)
+        ? -std::numeric_limits<float>::infinity()
+        : k.roll * r.roll_rate + k.climb * r.climb_rate - k.damping * r.pitch_settle_rms - k.altitude * r.altitude_loss;
+    return r;
+}
+
+std::vector<SweepResult> SweepRunner::run(ThreadPool& pool, std::atomic<size_t>* completed) const {
+    std::vector<SweepResult> results(count);
+    // Flights differ in cost (crashes stop early), so let the pool balance by stealing small blocks
+    pool.parallelFor(count, [&](size_t i) {
+        results[i] = evaluate(i);
+        if (completed) completed->fetch_add(1, std::memory_order_relaxed);
+    }, 4);
+    return results;
+}
+
+void SweepRunner::rank(std::vector<SweepResult>& results) {
+    std::sort(results.begin(), results.end(), [](const SweepResult& a, const SweepResult& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.index < b.index; // Stable order for ties (and between failures)
+    });
+}
+
+bool SweepRunner::writeCsv(const std::string& path, const std::vector<SweepResult>& results) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Error: could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+    out << "index,score,crashed,diverged,altitude_loss_m,final_speed_ms,peak_rate_rads,pitch_settle_rms_rads,roll_rate_rads,climb_rate_ms";
+    for (const auto& p : parameters) out << ',' << p.name;
+    out << "\n";
+
+    for (const auto& r : results) {
+        out << r.index << ',' << r.score << ',' << r.crashed << ',' << r.diverged << ',' << r.altitude_loss << ','
+            << r.final_speed << ',' << r.peak_rate << ',' << r.pitch_settle_rms << ',' << r.roll_rate << ',' << r.climb_rate;
+        AircraftConfig config = configAt(r.index);
+        for (const auto& p : parameters) {
+            float value = 0.0f;
+            config.get(p.name, value);
+            out << ',' << value;
+        }
+        out << "\n";
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,90 @@
+#ifndef SWEEP_RUNNER_H
+#define SWEEP_RUNNER_H
+
+#include "AircraftConfig.h"
+#include "FlightScript.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// One swept parameter: `steps` evenly spaced values in [min, max] (grid mode), or a uniform
+// draw from [min, max] (sampled mode). Names are AircraftConfig::parameterNames().
+struct SweepParameter {
+    std::string name;
+    float min = 0.0f;
+    float max = 0.0f;
+    size_t steps = 1;
+
+    // "name=min:max:steps", "name=min:max" (2 steps; the range for sampling) or "name=value"
+    static bool parse(const std::string& spec, SweepParameter& out);
+};
+
+// Outcome of flying the maneuver with one configuration. Small enough that a 100k sweep keeps
+// every result in memory; the configuration itself is re-derived from `index` on demand.
+struct SweepResult {
+    uint32_t index = 0;
+    bool crashed = false;           // Touched the ground clamp
+    bool diverged = false;          // Non-finite state
+    float score = 0.0f;             // Higher is better; failed flights score -inf
+    float altitude_loss = 0.0f;     // Start altitude - lowest altitude (m)
+    float final_speed = 0.0f;       // m/s
+    float peak_rate = 0.0f;         // Peak |angular velocity| (rad/s)
+    float pitch_settle_rms = 0.0f;  // RMS pitch rate after the doublet (rad/s), lower = better damped
+    float roll_rate = 0.0f;         // Mean |roll rate| in the first seconds of the roll step (rad/s)
+    float climb_rate = 0.0f;        // Peak vertical speed during the pitch-up half of the doublet (m/s)
+};
+
+// Flies a scripted maneuver for every configuration of a parameter sweep and ranks them.
+// Configurations are decoded from their index (mixed-radix over the grid, or a per-index
+// seeded draw when sampling), never stored, so the sweep scales to 100k+ points; the flights
+// are spread over a work-stealing ThreadPool.
+class SweepRunner {
+public:
+    // score = roll * roll_rate + climb * climb_rate - damping * pitch_settle_rms - altitude * altitude_loss
+    struct Weights {
+        float roll = 1.0f;
+        float climb = 0.02f;
+        float damping = 2.0f;
+        float altitude = 0.001f;
+    };
+
+    struct Options {
+        float duration = 25.0f;          // s per flight
+        float step_rate_hz = 120.0f;
+        FlightScript maneuver;           // Flown by every configuration
+        size_t samples = 0;              // 0: full grid; otherwise this many random configurations
+        unsigned seed = 1;               // Sampled mode
+        Weights weights;
+    };
+
+    // Throws std::runtime_error for unknown parameter names or an oversized grid
+    SweepRunner(const AircraftConfig& base, std::vector<SweepParameter> parameters, Options options);
+
+    size_t size() const { return count; }
+    const std::vector<SweepParameter>& getParameters() const { return parameters; }
+
+    AircraftConfig configAt(size_t index) const;
+    SweepResult evaluate(size_t index) const;
+
+    // Every configuration, in index order. `completed` (optional) counts finished flights
+    // so another thread can report progress.
+    std::vector<SweepResult> run(ThreadPool& pool, std::atomic<size_t>* completed = nullptr) const;
+
+    // Best first; crashed/diverged flights last
+    static void rank(std::vector<SweepResult>& results);
+
+    // One row per result, with the parameter values of its configuration
+    bool writeCsv(const std::string& path, const std::vector<SweepResult>& results) const;
+
+private:
+    AircraftConfig base;
+    std::vector<SweepParameter> parameters;
+    Options options;
+    size_t count = 0;
+};
+
+#endif // SWEEP_RUNNER_H
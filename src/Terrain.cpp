@@ -1,6 +1,9 @@
 #include "Terrain.h"
 #include "Graphics.h"      // For GL calls via GLEW
 #include "OpenGLUtils.h"   // For PRIMITIVE_RESTART_INDEX
+#include "AsyncTextureLoader.h"
+#include "TerrainConfig.h"
+#include "Trace.h"
 #include <glm/gtc/type_ptr.hpp> // Potentially for matrix passing, though Shader class handles it
 #include <iostream>        // For errors/debug
 
@@ -17,13 +20,20 @@ const GLUtil::TextureParams heightmapTexParams = {
     .texture_mag_filter = GL_LINEAR,
     .texture_min_filter = GL_LINEAR // Use simple linear filtering
 };
+// Streamed tile colour: mipmapped like the detail map, but a tile ends at its edge
+const GLUtil::TextureParams tileTexParams = {
+    .texture_wrap = GL_CLAMP_TO_EDGE,
+    .texture_mag_filter = GL_LINEAR,
+    .texture_min_filter = GL_LINEAR_MIPMAP_LINEAR
+};
 
 
 Terrain::Terrain(int levels, int segments_per_block, float segment_size) :
     num_levels(std::max(1, levels)),
     block_segments(std::max(4, segments_per_block)),
     base_segment_size(std::max(0.1f, segment_size)),
-    terrain_world_size(40000.0f), // Example: 40 km, adjust as needed
+    terrain_world_size(TerrainConfig::WORLD_SIZE), // 40 km, shared with the headless tools
+    max_height(TerrainConfig::MAX_HEIGHT),
 
     // Initialize Geometry Blocks (using constructor of TerrainBlock/Seam)
     block_fine(block_segments, block_segments, base_segment_size, true), // Use primitive restart
@@ -35,44 +45,165 @@ Terrain::Terrain(int levels, int segments_per_block, float segment_size) :
     block_seam(block_segments * 2 + 2, base_segment_size) // Seam uses DrawArrays
 {
     // --- Load Shader ---
-    shader = std::make_unique<Shader>("assets/shaders/terrain.vert", "assets/shaders/terrain.frag");
+    shader = Graphics::terrainShader.get(); // Compiled with the other programs in Graphics::init
     if (!shader || shader->ID == 0) {
         throw std::runtime_error("Failed to load terrain shader.");
     }
+    // Texture units never change: set them once (placement and height scale follow the
+    // texture set bound in draw())
+    shader->use();
+    shader->setInt("u_Heightmap", 0);
+    shader->setInt("u_Normalmap", 1);
+    shader->setInt("u_Texture", 2);
+    shader->use(false);
 
     // --- Load Textures ---
-    std::string heightPath = "assets/" + TERRAIN_DATA_PATH + "heightmap.png";
+    std::string heightPath = TerrainConfig::HEIGHTMAP_PATH; // Also the Heightfield source recorded in replays
     std::string normalPath = "assets/" + TERRAIN_DATA_PATH + "normalmap.png";
     std::string detailPath = "assets/" + TERRAIN_DATA_PATH + "texture.png";
 
-    // Load textures using the defined parameters
-    Texture hm(heightPath.c_str(), heightmapTexParams);
-    Texture nm(normalPath.c_str(), heightmapTexParams); // Use same params for normal map
-    Texture dm(detailPath.c_str(), terrainTexParams);   // Use repeating params for detail map
-
-    // Check validity immediately after construction attempt
-    if (!hm.isValid()) {
-        std::cerr << "Warning: Failed to load heightmap texture from: " << heightPath << std::endl;
-    }
-    if (!nm.isValid()) {
-        std::cerr << "Warning: Failed to load normalmap texture from: " << normalPath << std::endl;
-    }
-    if (!dm.isValid()) {
-        std::cerr << "Warning: Failed to load detail texture from: " << detailPath << std::endl;
-    }
+    // Load textures using the defined parameters. With the background loader they arrive a few
+    // frames later (draw() skips the terrain until all three are valid) instead of blocking here.
+    auto loadTexture = [](const std::string& path, const GLUtil::TextureParams& params) {
+        if (Graphics::textureLoader) return Texture::loadAsync(*Graphics::textureLoader, path, params);
+        Texture texture(path.c_str(), params);
+        if (!texture.isValid()) std::cerr << "Warning: Failed to load terrain texture from: " << path << std::endl;
+        return texture;
+    };
+    Texture hm = loadTexture(heightPath, heightmapTexParams);
+    Texture nm = loadTexture(normalPath, heightmapTexParams); // Use same params for normal map
+    Texture dm = loadTexture(detailPath, terrainTexParams);   // Use repeating params for detail map
      // Consider throwing if heightmap is essential:
      // if (!hm.isValid()) { throw std::runtime_error("Essential heightmap texture failed to load."); }
 
 
+    // CPU copy of the same heightmap for height queries and ground contact
+    if (!heightfield.loadImage(heightPath, terrain_world_size, max_height)) {
+        std::cerr << "Warning: Terrain height queries fall back to flat ground (y = 0)" << std::endl;
+    }
+    raycaster.build(heightfield);
+
     // Move loaded textures into member variables
     heightmap = std::move(hm);
     normalmap = std::move(nm);
     detailmap = std::move(dm);
 
     std::cout << "Terrain initialized." << std::endl;
-    if (heightmap.isValid()) std::cout << "  Heightmap loaded (" << heightmap.Width << "x" << heightmap.Height << ")" << std::endl;
-    if (normalmap.isValid()) std::cout << "  Normalmap loaded (" << normalmap.Width << "x" << normalmap.Height << ")" << std::endl;
-    if (detailmap.isValid()) std::cout << "  Detailmap loaded (" << detailmap.Width << "x" << detailmap.Height << ")" << std::endl;
+    if (heightmap.isValid()) std::cout << "  Heightmap loaded (" << heightmap.getWidth() << "x" << heightmap.getHeight() << ")" << std::endl;
+    else if (heightmap.isPending()) std::cout << "  Heightmap loading in the background" << std::endl;
+    if (normalmap.isValid()) std::cout << "  Normalmap loaded (" << normalmap.getWidth() << "x" << normalmap.getHeight() << ")" << std::endl;
+    if (!heightfield.empty()) std::cout << "  Heightfield " << heightfield.getWidth() << "x" << heightfield.getHeight()
+                                       << ", " << heightfield.getMinHeight() << " - " << heightfield.getMaxHeight() << " m" << std::endl;
+    if (detailmap.isValid()) std::cout << "  Detailmap loaded (" << detailmap.getWidth() << "x" << detailmap.getHeight() << ")" << std::endl;
+}
+
+// --- Streamed tiles ---
+void Terrain::updateTiles(TileManager& tiles) {
+    FS_TRACE_ZONE("Terrain::updateTiles");
+    tile_source = &tiles;
+    tile_evictions.clear();
+    tiles.takeEvictions(tile_evictions);
+    for (const TileKey& key : tile_evictions) tile_textures.erase(key.packed()); // Cancels unfinished uploads
+
+    tile_arrivals.clear();
+    tiles.takeArrivals(tile_arrivals);
+    if (!Graphics::textureLoader) return;
+    const float half = 0.5f * terrain_world_size;
+    for (const auto& tile : tile_arrivals) {
+        // Inside the heightfield square the default set is drawn (blockTextureSet): a tile
+        // wholly within it would never be sampled, so it gets no GPU copy
+        if (tile->world_min.x >= -half && tile->world_min.y >= -half && tile->world_max.x <= half && tile->world_max.y <= half) continue;
+        // A tile is drawn with all three layers or not at all (a coarser one covers it)
+        const bool metres = !tile->heights.empty();
+        if ((!metres && tile->heightmap.empty()) || tile->normalmap.empty() || tile->texture.empty()) continue;
+        // Aliasing pointers keep the decoded tile alive until each upload completes
+        auto upload = [&tile](const TileImage& image, const GLUtil::TextureParams& params) {
+            return Texture::fromPixelsAsync(*Graphics::textureLoader, image.width, image.height, image.channels,
+                                            std::shared_ptr<const uint8_t>(tile, image.pixels.data()), params);
+        };
+        TileTextures& textures = tile_textures[tile->key.packed()];
+        textures.world_min = tile->world_min;
+        textures.world_max = tile->world_max;
+        if (metres) {
+            // Pack or Terrarium heights stay in metres (R32F): u_MaxHeight = 1 replaces dividing
+            // each texel by max_height here and multiplying it back in terrain.vert. They can
+            // exceed max_height, which is why they are only drawn outside the heightfield square.
+            auto data = reinterpret_cast<const uint8_t*>(tile->heights.data());
+            textures.heightmap = Texture::fromPixelsAsync(*Graphics::textureLoader, tile->height_width, tile->height_height, 1,
+                                                          std::shared_ptr<const uint8_t>(tile, data), heightmapTexParams, GL_FLOAT);
+            textures.height_scale = 1.0f;
+        } else {
+            textures.heightmap = upload(tile->heightmap, heightmapTexParams);
+            textures.height_scale = max_height; // heightmap.png is full scale at max_height, like the default set
+        }
+        textures.min_height = tile->min_height;
+        textures.max_height = tile->max_height;
+        textures.normalmap = upload(tile->normalmap, heightmapTexParams);
+        textures.texture = upload(tile->texture, tileTexParams);
+    }
+}
+
+const Terrain::TileTextures* Terrain::findTile(const glm::vec2& lo, const glm::vec2& hi) const {
+    if (!tile_source || tile_textures.empty()) return nullptr;
+    const TileManager::Options& options = tile_source->getOptions();
+    glm::vec2 center = (lo + hi) * 0.5f;
+    for (int zoom = options.max_zoom; zoom >= options.min_zoom; --zoom) {
+        auto it = tile_textures.find(tile_source->tileAt(zoom, center.x, center.y).packed());
+        if (it == tile_textures.end() || !it->second.isReady()) continue;
+        const TileTextures& tile = it->second;
+        if (lo.x >= tile.world_min.x && lo.y >= tile.world_min.y && hi.x <= tile.world_max.x && hi.y <= tile.world_max.y) return &tile;
+    }
+    return nullptr;
+}
+
+bool Terrain::bindTextureSet(const TileTextures* tile) const {
+    const Texture* height = &heightmap;
+    const Texture* normal = &normalmap;
+    const Texture* color = &detailmap;
+    glm::vec2 origin(-0.5f * terrain_world_size);
+    glm::vec2 size(terrain_world_size);
+    float height_scale = max_height;
+    if (tile) {
+        height = &tile->heightmap;
+        normal = &tile->normalmap;
+        color = &tile->texture;
+        origin = tile->world_min;
+        size = tile->world_max - tile->world_min;
+        height_scale = tile->height_scale;
+    }
+    if (!height->isValid() || !normal->isValid() || !color->isValid()) return false;
+    height->bind(GL_TEXTURE0);
+    normal->bind(GL_TEXTURE1);
+    color->bind(GL_TEXTURE2);
+    shader->setVec4("u_TileRect", origin.x, origin.y, 1.0f / size.x, 1.0f / size.y);
+    shader->setFloat("u_MaxHeight", height_scale);
+    return true;
+}
+
+const Terrain::TileTextures* Terrain::blockTextureSet(const glm::vec2& lo, const glm::vec2& hi) const {
+    float half = 0.5f * terrain_world_size;
+    if (lo.x < half && hi.x > -half && lo.y < half && hi.y > -half) return nullptr;
+    return findTile(lo, hi);
+}
+
+Terrain::TerrainBatch& Terrain::batchFor(const TileTextures* tile) {
+    for (size_t i = 0; i < batch_count; ++i) {
+        if (batches[i].tile == tile) return batches[i];
+    }
+    if (batch_count == batches.size()) batches.emplace_back();
+    TerrainBatch& batch = batches[batch_count++];
+    batch.tile = tile;
+    for (auto& instances : batch.instances) instances.clear();
+    return batch;
+}
+
+TerrainBlock& Terrain::blockGeometry(BlockGeometry geometry) {
+    switch (geometry) {
+    case BLOCK_CENTER: return block_center;
+    case BLOCK_H_TRIM: return block_h_trim;
+    case BLOCK_V_TRIM: return block_v_trim;
+    default: return block_fine;
+    }
 }
 
 // Helper to calculate base offset for a level grid origin (using reference logic)
@@ -91,32 +222,37 @@ glm::vec2 Terrain::calculateLevelBaseOffset(int level, const glm::vec2& cameraPo
     return baseOffset;
 }
 
-// Helper to calculate model matrix for a block
-glm::mat4 Terrain::calculateModelMatrix(const glm::vec2& positionXZ, float scale, float rotation_deg) const {
-    glm::mat4 model = glm::mat4(1.0f);
-    // Translate to the world position first
-    model = glm::translate(model, glm::vec3(positionXZ.x, 0.0f, positionXZ.y));
-    // Then rotate if needed
-    if (std::abs(rotation_deg) > 1e-3f) {
-        model = glm::rotate(model, glm::radians(rotation_deg), glm::vec3(0.0f, 1.0f, 0.0f));
+void Terrain::submitBlock(BlockGeometry geometry, const TerrainBlockInstance& instance, const Frustum& frustum,
+                          TerrainLevelStats& stats) {
+    glm::vec2 half = blockGeometry(geometry).half_extent * instance.scale;
+    glm::vec2 lo = instance.offsetXZ - half;
+    glm::vec2 hi = instance.offsetXZ + half;
+    const TileTextures* tile = blockTextureSet(lo, hi);
+    if (culling) {
+        float min_y = 0.0f, max_y = max_height; // No CPU heightfield: anything the texture can reach
+        if (tile) {
+            min_y = tile->min_height; // The whole tile: no per-block bounds for streamed heights
+            max_y = tile->max_height;
+        } else if (!heightfield.empty()) {
+            raycaster.heightRange(lo.x, lo.y, hi.x, hi.y, min_y, max_y);
+        }
+        // One 8-bit heightmap step of slack: the GPU filters the texture, not the CPU copy
+        float slack = max_height / 255.0f;
+        if (!frustum.intersectsAabb(glm::vec3(lo.x, min_y - slack, lo.y), glm::vec3(hi.x, max_y + slack, hi.y))) {
+            ++stats.culled;
+            return;
+        }
     }
-    // Then scale the geometry (vertices are defined in local space relative to segment size)
-    model = glm::scale(model, glm::vec3(scale));
-    return model; // Order: Scale -> Rotate -> Translate (applied in reverse: T * R * S)
+    batchFor(tile).instances[geometry].push_back(instance);
+    ++stats.drawn;
 }
 
-
-void Terrain::draw(const Camera& camera, const glm::mat4& projection, const glm::vec3& sunDirection) {
+void Terrain::draw(const FrameData& frame) {
+    FS_TRACE_ZONE("Terrain::draw");
     if (!shader || !shader->ID) {
         std::cerr << "Terrain::draw error: Shader not valid!" << std::endl;
         return; // Cannot draw without shader
     }
-     if (!heightmap.isValid()) {
-        // std::cerr << "Terrain::draw error: Heightmap not valid!" << std::endl;
-        // Maybe draw flat terrain if heightmap missing? For now, just return.
-        return;
-     }
-
     // --- OpenGL State ---
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
@@ -125,57 +261,45 @@ void Terrain::draw(const Camera& camera, const glm::mat4& projection, const glm:
     if (wireframe) { glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); }
     else { glPolygonMode(GL_FRONT_AND_BACK, GL_FILL); }
 
-    // --- Activate Shader and Bind Textures ---
+    // --- Activate Shader ---
     shader->use();
-    if (heightmap.isValid()) heightmap.bind(0); else return;
-    if (normalmap.isValid()) normalmap.bind(1); else return; // Need normalmap now
-    if (detailmap.isValid()) detailmap.bind(2); else return; // Need detailmap now
-
-    // Set Uniforms
-    shader->setMat4("u_View", camera.GetViewMatrix());
-    shader->setMat4("u_Projection", projection);
-    shader->setVec3("u_CameraPos", camera.Position);
-    shader->setVec3("u_SunDirection", glm::normalize(sunDirection)); // <-- Set Sun Direction
 
-    shader->setInt("u_Heightmap", 0);
-    shader->setInt("u_Normalmap", 1); // <-- Set Normalmap unit
-    shader->setInt("u_Texture", 2);   // <-- Set Detailmap unit
-
-    shader->setFloat("u_TerrainSize", terrain_world_size);
-    shader->setFloat("u_MaxHeight", 3000.0f);
-    // shader->setVec3("u_Background", ...); // Background/fo    // --- Draw Clipmap Levels ---
-    glm::vec3 cameraPos = camera.Position;
+    // --- Gather Clipmap Blocks ---
+    // Every block is a translate + uniform scale of one of four geometries, so placements are
+    // collected per geometry and texture set, and each pair is drawn once, instanced. The
+    // default set covers the heightfield square, so what is drawn there is what the aircraft
+    // touches; streamed tiles only fill in beyond it.
+    glm::vec3 cameraPos = glm::vec3(frame.camera_position);
     glm::vec2 cameraPosXZ = glm::vec2(cameraPos.x, cameraPos.z);
 
+    batch_count = 0;
+    batchFor(nullptr); // Default set first
+    level_stats.assign(static_cast<size_t>(num_levels), TerrainLevelStats{});
+    Frustum frustum = Frustum::fromViewProjection(frame.view_projection);
+
     // Determine minimum level (higher camera -> coarser min level)
     int min_level = 0;
     min_level = static_cast<int>(glm::clamp(cameraPos.y / 3000.0f, 0.0f, (float)num_levels - 2.0f));
 
     for (int l = min_level; l < num_levels; ++l) {
+        FS_TRACE_ZONE_VALUE("Terrain level", l);
         float scale = std::pow(2.0f, static_cast<float>(l));
         float scaled_segment_size = base_segment_size * scale;
         float block_world_size = static_cast<float>(block_segments) * scaled_segment_size;
         glm::vec2 base = calculateLevelBaseOffset(l, cameraPosXZ);
+        TerrainLevelStats& stats = level_stats[static_cast<size_t>(l)];
 
-        // Set u_Model per block inside the loop, u_Scale not directly needed by shader if model matrix scales
-        // shader->setFloat("u_Scale", scale); // Shader uses Model matrix now
-        // shader->setFloat("u_Level", static_cast<float>(l)); // Shader only uses this for debug color in previous step
-
-        // --- Draw Center (Finest Level Only) ---
+        // --- Center (Finest Level Only) ---
         if (l == min_level) {
              // Reference uses a specific 'center' block geometry for L-shapes
              // Using block_center which has dimensions (2N+2) x (2N+2)
              glm::vec2 center_grid_origin = base + block_world_size * 1.5f; // Bottom-left of center 3x3 area
-             // Need to position this block correctly relative to its geometry definition origin
-             // If block geometry is centered, positionXZ is the world center.
-             // If block geometry starts at (0,0), positionXZ is the world bottom-left.
-             // Let's assume TerrainBlock centers its geometry.
+             // TerrainBlock centers its geometry, so the instance offset is the world center
              glm::vec2 center_block_world_pos = center_grid_origin + block_world_size; // Center of the 2x2 center area
-             shader->setMat4("u_Model", calculateModelMatrix(center_block_world_pos, scale));
-             block_center.draw(); // Draw the special center block
+             submitBlock(BLOCK_CENTER, {center_block_world_pos, scale}, frustum, stats);
 
         } else {
-            // --- Draw Trim/Fixup Geometry for Coarser Levels ---
+            // --- Trim/Fixup Geometry for Coarser Levels ---
             glm::vec2 prev_base = calculateLevelBaseOffset(l - 1, cameraPosXZ);
             glm::vec2 diff = glm::abs(base - prev_base); // Difference in base positions
 
@@ -190,8 +314,7 @@ void Terrain::draw(const Camera& camera, const glm::mat4& projection, const glm:
                 // Draw trim along the bottom edge of the 3x3 inner area
                 h_trim_pos = base + glm::vec2(block_world_size * 2.5f, block_world_size * 1.5f); // Centered on bottom edge
             }
-            shader->setMat4("u_Model", calculateModelMatrix(h_trim_pos, scale));
-            block_h_trim.draw();
+            submitBlock(BLOCK_H_TRIM, {h_trim_pos, scale}, frustum, stats);
 
             // Vertical Trim (Position based on which column needs the trim)
             glm::vec2 v_trim_pos;
@@ -202,12 +325,11 @@ void Terrain::draw(const Camera& camera, const glm::mat4& projection, const glm:
                 // Draw trim along the left edge of the 3x3 inner area
                  v_trim_pos = base + glm::vec2(block_world_size * 1.5f, block_world_size * 2.5f); // Centered on left edge
             }
-            shader->setMat4("u_Model", calculateModelMatrix(v_trim_pos, scale));
-            block_v_trim.draw();
+            submitBlock(BLOCK_V_TRIM, {v_trim_pos, scale}, frustum, stats);
         }
 
 
-        // --- Draw Outer Ring Blocks (5x5 grid, excluding inner 3x3) ---
+        // --- Outer Ring Blocks (5x5 grid, excluding inner 3x3) ---
         // This part requires the most refinement to match the reference's stitching
         for (int r = 0; r < 5; ++r) {
             for (int c = 0; c < 5; ++c) {
@@ -219,20 +341,25 @@ void Terrain::draw(const Camera& camera, const glm::mat4& projection, const glm:
                  // Calculate center position assuming block geometry is centered
                 glm::vec2 block_center_pos = block_corner_pos + block_world_size * 0.5f;
 
-                // Set model matrix for this block
-                shader->setMat4("u_Model", calculateModelMatrix(block_center_pos, scale));
-
-                // Determine which block geometry to draw (tile, fixup, seam?)
                 // Simplified: Use standard block_fine for all outer ring blocks
-                block_fine.draw();
-
-                // TODO: Add seam drawing logic here if needed, potentially rotating/positioning block_seam
-                // Example: If on outer edge, draw a rotated seam
-                // This needs careful calculation of seam position and rotation based on edge (N, S, E, W)
+                // TODO: Seams (block_seam) on the outer edge, rotated per edge (N, S, E, W)
+                submitBlock(BLOCK_FINE, {block_center_pos, scale}, frustum, stats);
             }
         }
     } // End level loop
 
+    // --- Draw: one instanced call per geometry and texture set ---
+    {
+        FS_TRACE_ZONE("Terrain drawInstanced");
+        for (size_t i = 0; i < batch_count; ++i) {
+            const TerrainBatch& batch = batches[i];
+            if (!bindTextureSet(batch.tile)) continue; // Default set still loading: nothing to sample
+            for (int g = 0; g < BLOCK_GEOMETRY_COUNT; ++g) {
+                blockGeometry(static_cast<BlockGeometry>(g)).drawInstanced(batch.instances[g]);
+            }
+        }
+    }
+
     // --- Restore OpenGL State ---
     if (wireframe) { glPolygonMode(GL_FRONT_AND_BACK, GL_FILL); }
     glDisable(GL_PRIMITIVE_RESTART);
@@ -246,8 +373,3 @@ void Terrain::draw(const Camera& camera, const glm::mat4& projection, const glm:
 
     shader->use(false); // Unbind shader
 }
-
-// Basic height sampling (Placeholder - Needs proper implementation)
-float Terrain::getTerrainHeight(float worldX, float worldZ) {
-    return 0.0f;
-}
@@ -5,33 +5,66 @@
 #include "TerrainBlock.h" // For Block/Seam geometry
 #include "Shader.h"     // Our Shader class
 #include "Texture.h"    // Our Texture class
-#include "Camera.h"     // Need camera info
+#include "FrameData.h"  // Per-frame camera/sun/fog block
+#include "Heightfield.h" // CPU copy of the heightmap for queries
+#include "TerrainRaycaster.h" // Ray queries over the heightfield
+#include "Frustum.h"    // Block culling
+#include "TileManager.h" // Streamed terrain tiles
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <string>
 #include <vector>
 #include <memory> // For unique_ptr
+#include <unordered_map>
 #include <cmath> // For std::pow, std::floor
 #include <stdexcept> // <-- ADDED for error throwing in constructor
 
 // Configurable path (relative to assets)
 const std::string TERRAIN_DATA_PATH = "textures/terrain/default/"; // Example path
 
+// Blocks submitted / rejected by culling on one clipmap level in the last draw()
+struct TerrainLevelStats {
+    int drawn = 0;
+    int culled = 0;
+};
+
 class Terrain {
 public:
     bool wireframe = false; // Toggle wireframe rendering
+    bool culling = true;    // Frustum-cull blocks against their height bounds
 
     Terrain(int levels = 8, int segments_per_block = 16, float base_segment_size = 4.0f); // Constructor
     virtual ~Terrain() = default;
 
-    // Main draw call
-    void draw(const Camera& camera, const glm::mat4& projection, const glm::vec3& sunDirection); // Added projection
+    // Main draw call. View, projection, sun and fog come from the shared FrameData block
+    // (Graphics::setFrameData); `frame` is the same data, used here for LOD placement.
+    // Inside the heightfield square the default set is drawn; outside it each block samples the
+    // finest resident tile that covers it whole. One instanced call per geometry and texture set.
+    void draw(const FrameData& frame);
+
+    // Upload tiles that became resident in `tiles` (asynchronously, through
+    // Graphics::textureLoader) and release the GPU copies of evicted ones. Once per frame,
+    // after tiles.update(); `tiles` must outlive the draws that follow.
+    void updateTiles(TileManager& tiles);
+    size_t getTileTextureCount() const { return tile_textures.size(); }
 
-    // Get approximate terrain height at world XZ coordinates (optional, basic sampling)
-    float getTerrainHeight(float worldX, float worldZ);
+    // Terrain height / surface normal at world XZ, matching what terrain.vert renders inside
+    // the heightfield square (streamed tiles are only drawn outside it)
+    float getTerrainHeight(float worldX, float worldZ) const { return heightfield.height(worldX, worldZ); }
+    glm::vec3 getTerrainNormal(float worldX, float worldZ) const { return heightfield.normal(worldX, worldZ); }
+
+    // For ground contact (Aircraft::ground) and batched queries
+    const Heightfield& getHeightfield() const { return heightfield; }
+    // Line of sight, radar altitude and swept collision against the same surface
+    const TerrainRaycaster& getRaycaster() const { return raycaster; }
 
     float getTerrainSize() const { return terrain_world_size; }
+    float getMaxHeight() const { return max_height; }
+
+    // Per clipmap level (index = level), from the last draw(). Levels below the camera's
+    // minimum level stay at zero.
+    const std::vector<TerrainLevelStats>& getLevelStats() const { return level_stats; }
 
 private:
     // --- Configuration ---
@@ -39,13 +72,35 @@ private:
     const int block_segments;
     const float base_segment_size;
     const float terrain_world_size;
+    const float max_height; // u_MaxHeight: world height of a full-scale heightmap texel
     // REMOVED: const unsigned int primitive_restart_index = 0xFFFF; // Use global one
 
     // --- OpenGL Resources ---
-    std::unique_ptr<Shader> shader;
+    Shader* shader = nullptr; // Graphics::terrainShader
     Texture heightmap;
     Texture normalmap;
     Texture detailmap;
+    Heightfield heightfield;
+
+    // GPU copy of a streamed tile, keyed by TileKey::packed()
+    struct TileTextures {
+        glm::vec2 world_min{0.0f};
+        glm::vec2 world_max{0.0f};
+        Texture heightmap;
+        Texture normalmap;
+        Texture texture;
+        float height_scale = 0.0f; // u_MaxHeight for this heightmap
+        float min_height = 0.0f;   // Metres, for culling
+        float max_height = 0.0f;
+
+        bool isReady() const { return heightmap.isValid() && normalmap.isValid() && texture.isValid(); }
+    };
+    std::unordered_map<uint64_t, TileTextures> tile_textures;
+    const TileManager* tile_source = nullptr; // Tile placement, from the last updateTiles()
+    std::vector<std::shared_ptr<const TerrainTile>> tile_arrivals; // Scratch for updateTiles
+    std::vector<TileKey> tile_evictions;
+
+    TerrainRaycaster raycaster; // Min/max pyramid over `heightfield`
 
     // Geometry Blocks
     TerrainBlock block_fine;
@@ -56,9 +111,34 @@ private:
     TerrainBlock block_v_trim;
     TerrainSeam block_seam;
 
+    // Per-frame block placements for one texture set, one list per geometry
+    enum BlockGeometry { BLOCK_CENTER, BLOCK_H_TRIM, BLOCK_V_TRIM, BLOCK_FINE, BLOCK_GEOMETRY_COUNT };
+    struct TerrainBatch {
+        const TileTextures* tile = nullptr; // null = the default set
+        std::vector<TerrainBlockInstance> instances[BLOCK_GEOMETRY_COUNT];
+    };
+    std::vector<TerrainBatch> batches; // [0] = default set; past batch_count kept to reuse their capacity
+    size_t batch_count = 0;
+    std::vector<TerrainLevelStats> level_stats;
+
+    // Append the block at `instance` to the batch of its texture set unless culling rejects its
+    // world box (height bounds from the tile, or from the heightfield for the default set)
+    void submitBlock(BlockGeometry geometry, const TerrainBlockInstance& instance, const Frustum& frustum,
+                     TerrainLevelStats& stats);
+
+    // Texture set for a block over [lo, hi]: the default set wherever it touches the
+    // heightfield square (drawn ground = ground contact), else the finest resident tile
+    // containing it; null = the default set
+    const TileTextures* blockTextureSet(const glm::vec2& lo, const glm::vec2& hi) const;
+    // Finest resident tile whose square contains [lo, hi], or null
+    const TileTextures* findTile(const glm::vec2& lo, const glm::vec2& hi) const;
+    TerrainBatch& batchFor(const TileTextures* tile);
+    // Bind a tile's textures and placement (null = the default set); false if not ready
+    bool bindTextureSet(const TileTextures* tile) const;
+    TerrainBlock& blockGeometry(BlockGeometry geometry);
+
     // --- Helper Methods ---
     glm::vec2 calculateLevelBaseOffset(int level, const glm::vec2& cameraPosXZ) const;
-    glm::mat4 calculateModelMatrix(const glm::vec2& positionXZ, float scale, float rotation_deg = 0.0f) const;
 };
 
 #endif // TERRAIN_H
@@ -6,20 +6,33 @@
 #include <vector>
 #include <stdexcept> // For runtime_error
 
+// Per-instance placement of a clipmap block: world XZ of the block centre and the level scale.
+// Equivalent to the model matrix translate(x, 0, z) * scale(s) (blocks are never rotated).
+struct TerrainBlockInstance {
+    glm::vec2 offsetXZ;
+    float scale;
+};
+
 // Represents a single mesh block for the terrain clipmap
 class TerrainBlock {
 public:
+    // Vertex attribute fed from instance_vbo (location 0 is the grid position)
+    static constexpr GLuint INSTANCE_ATTRIBUTE = 1;
+
     GLUtil::VertexArrayObject vao;
     GLUtil::VertexBuffer vbo;
     GLUtil::ElementBufferObject ebo;
+    GLUtil::VertexBuffer instance_vbo; // TerrainBlockInstance per drawn copy, refilled each frame
     unsigned int index_count = 0;
     GLenum draw_mode = GL_TRIANGLE_STRIP;
+    glm::vec2 half_extent{0.0f}; // Half size in X/Z at scale 1 (geometry is centred on the origin)
 
     TerrainBlock(int width_segments, int height_segments, float segment_size, bool usePrimitiveRestart = true)
     {
         if (width_segments <= 0 || height_segments <= 0 || segment_size <= 0) {
             throw std::runtime_error("Invalid dimensions for TerrainBlock.");
         }
+        half_extent = glm::vec2(width_segments * segment_size * 0.5f, height_segments * segment_size * 0.5f);
 
         std::vector<glm::vec3> vertices;
         std::vector<unsigned int> indices; // Use unsigned int for indices matching GL_UNSIGNED_INT
@@ -74,15 +87,35 @@ public:
         ebo.buffer(indices);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
         glEnableVertexAttribArray(0);
+        instance_vbo.buffer(nullptr, 0, GL_STREAM_DRAW);
+        glVertexAttribPointer(INSTANCE_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, sizeof(TerrainBlockInstance), (void*)0);
+        glEnableVertexAttribArray(INSTANCE_ATTRIBUTE);
+        glVertexAttribDivisor(INSTANCE_ATTRIBUTE, 1);
         vao.unbind();
+        instance_vbo.unbind();
     }
 
-    void draw() const {
-        if (index_count == 0) return;
+    // Upload `instances` and draw them all with one call. The buffer is re-specified each time
+    // (orphaned), so the driver never waits on last frame's draw.
+    void drawInstanced(const std::vector<TerrainBlockInstance>& instances) {
+        if (index_count == 0 || instances.empty()) return;
+        size_t bytes = instances.size() * sizeof(TerrainBlockInstance);
+        instance_vbo.bind();
+        if (bytes > instance_capacity) {
+            instance_vbo.buffer(instances.data(), bytes, GL_STREAM_DRAW);
+            instance_capacity = bytes;
+        } else {
+            glBufferData(GL_ARRAY_BUFFER, instance_capacity, nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+        }
+        instance_vbo.unbind();
         vao.bind();
-        glDrawElements(draw_mode, index_count, GL_UNSIGNED_INT, 0);
+        glDrawElementsInstanced(draw_mode, index_count, GL_UNSIGNED_INT, 0, static_cast<GLsizei>(instances.size()));
         vao.unbind();
     }
+
+private:
+    size_t instance_capacity = 0; // Bytes allocated in instance_vbo
 };
 
 // Simple geometry for Seam
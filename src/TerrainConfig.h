@@ -0,0 +1,22 @@
+#ifndef TERRAIN_CONFIG_H
+#define TERRAIN_CONFIG_H
+
+#include <string>
+
+// Placement of the default terrain. The renderer (Terrain), the physics heightfield and the
+// headless tools all read it from here so they agree on the surface.
+namespace TerrainConfig {
+    const std::string HEIGHTMAP_PATH = "assets/textures/terrain/default/heightmap.png";
+    const float WORLD_SIZE = 40000.0f; // m, edge of the square heightmap, centred on the origin
+    const float MAX_HEIGHT = 3000.0f;  // m, height of a full-scale heightmap texel (u_MaxHeight)
+
+    // Streamed slippy-map tiles (TileManager): the anchor tile is centred on the origin (top of
+    // the image at +Z, like the heightmap) at its real ground width, ~52.6 km at zoom 9 here.
+    // Terrain draws the heightmap inside its WORLD_SIZE square, where the physics heightfield
+    // gives ground contact, and resident tiles only beyond it (drawn, not collided with).
+    const int TILE_ANCHOR_ZOOM = 9;
+    const int TILE_ANCHOR_X = 268;
+    const int TILE_ANCHOR_Y = 178;
+}
+
+#endif // TERRAIN_CONFIG_H
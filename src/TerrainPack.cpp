@@ -0,0 +1,382 @@
+#include "TerrainPack.h"
+#include <stb_image.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <tuple>
+
+namespace {
+
+const char MAGIC[4] = {'F', 'S', 'T', 'P'};
+const uint32_t PACK_VERSION = 2; // 2: pack-wide height source and step in the header
+const size_t HEADER_SIZE = 4 + 3 * sizeof(uint32_t) + sizeof(float);
+const size_t DATA_ALIGNMENT = 16;
+
+size_t alignUp(size_t value) {
+    return (value + DATA_ALIGNMENT - 1) & ~(DATA_ALIGNMENT - 1);
+}
+
+bool parseIndex(const std::string& name, int& value) {
+    if (name.empty() || name.size() > 9) return false;
+    for (char c : name) {
+        if (c < '0' || c > '9') return false;
+    }
+    value = std::stoi(name);
+    return true;
+}
+
+struct Image {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<uint8_t> pixels;
+};
+
+// Decode if the file exists; empty image otherwise (missing layers are normal)
+Image decode(const std::filesystem::path& path) {
+    Image image;
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) return image;
+    stbi_set_flip_vertically_on_load_thread(1); // OpenGL row order, as TileManager loads
+    unsigned char* data = stbi_load(path.string().c_str(), &image.width, &image.height, &image.channels, 0);
+    if (!data) {
+        std::cerr << "Warning: failed to decode " << path.string() << " (" << stbi_failure_reason() << ")" << std::endl;
+        return Image();
+    }
+    image.pixels.assign(data, data + static_cast<size_t>(image.width) * image.height * image.channels);
+    stbi_image_free(data);
+    return image;
+}
+
+struct HeightGrid {
+    int width = 0;
+    int height = 0;
+    std::vector<float> metres;
+    uint32_t flags = 0;
+
+    bool empty() const { return metres.empty(); }
+};
+
+using TileId = std::tuple<int, int, int>; // z, x, y: std::map order is the index order
+
+} // namespace
+
+// --- Build ---
+bool TerrainPack::build(const std::string& root, const std::string& output_path, const BuildOptions& options, BuildReport* report) {
+    namespace fs = std::filesystem;
+    BuildReport local;
+    BuildReport& result = report ? *report : local;
+    result = BuildReport();
+
+    // 1. Every z/x/y directory
+    std::map<TileId, fs::path> tiles;
+    std::error_code ec;
+    for (const auto& z_dir : fs::directory_iterator(root, ec)) {
+        int z = 0;
+        if (!z_dir.is_directory(ec) || !parseIndex(z_dir.path().filename().string(), z)) continue;
+        for (const auto& x_dir : fs::directory_iterator(z_dir.path(), ec)) {
+            int x = 0;
+            if (!x_dir.is_directory(ec) || !parseIndex(x_dir.path().filename().string(), x)) continue;
+            for (const auto& y_dir : fs::directory_iterator(x_dir.path(), ec)) {
+                int y = 0;
+                if (!y_dir.is_directory(ec) || !parseIndex(y_dir.path().filename().string(), y)) continue;
+                tiles[TileId{z, x, y}] = y_dir.path();
+            }
+        }
+    }
+    if (tiles.empty()) {
+        std::cerr << "Error: no z/x/y tile directories under " << root << std::endl;
+        return false;
+    }
+
+    // 2. One height source for the whole pack, so every level is in the same units and precision
+    TerrainHeightSource source = options.height_source;
+    if (source == TerrainHeightSource::None) {
+        source = TerrainHeightSource::Heightmap8;
+        for (const auto& [id, dir] : tiles) {
+            if (fs::is_regular_file(dir / "heightmap_encoded.png", ec)) {
+                source = TerrainHeightSource::Encoded;
+                break;
+            }
+        }
+    }
+
+    // 3. Heights in metres, all tiles (the pyramid pass needs parents and children together)
+    std::map<TileId, HeightGrid> heights;
+    for (const auto& [id, dir] : tiles) {
+        HeightGrid grid;
+        if (source == TerrainHeightSource::Encoded) {
+            Image encoded = decode(dir / "heightmap_encoded.png");
+            if (!encoded.pixels.empty() && encoded.channels >= 3) {
+                grid.width = encoded.width;
+                grid.height = encoded.height;
+                grid.metres.resize(static_cast<size_t>(grid.width) * grid.height);
+                for (size_t i = 0; i < grid.metres.size(); ++i) grid.metres[i] = terrariumMetres(&encoded.pixels[i * encoded.channels]);
+            }
+        } else {
+            Image heightmap = decode(dir / "heightmap.png");
+            if (!heightmap.pixels.empty()) {
+                grid.width = heightmap.width;
+                grid.height = heightmap.height;
+                grid.metres.resize(static_cast<size_t>(grid.width) * grid.height);
+                for (size_t i = 0; i < grid.metres.size(); ++i) grid.metres[i] = heightmap.pixels[i * heightmap.channels] * options.height_step;
+            }
+        }
+        if (grid.empty()) ++result.tiles_without_source;
+        else heights[id] = std::move(grid);
+    }
+    if (heights.empty()) source = TerrainHeightSource::None;
+    if (result.tiles_without_source > 0 && source != TerrainHeightSource::None) {
+        std::cerr << "Warning: " << result.tiles_without_source << " tiles have no "
+                  << (source == TerrainHeightSource::Encoded ? "heightmap_encoded.png" : "heightmap.png")
+                  << ", packed without heights unless generated from their children" << std::endl;
+    }
+
+    // 4. Pyramid, finest zoom first so refinements propagate all the way up: each quadrant of a
+    // parent that a child covers becomes the child's 2x2 box filter. Parents down to min_zoom
+    // that the tree lacks are generated from whichever children exist.
+    int finest = heights.empty() ? 0 : std::get<0>(heights.rbegin()->first);
+    for (int z = finest - 1; z >= 0 && !heights.empty(); --z) {
+        auto first = heights.lower_bound(TileId{z + 1, 0, 0});
+        auto last = heights.lower_bound(TileId{z + 2, 0, 0});
+        std::map<TileId, std::array<const HeightGrid*, 4>> parents; // Children by quadrant (i + 2j)
+        for (auto it = first; it != last; ++it) {
+            int cx = std::get<1>(it->first), cy = std::get<2>(it->first);
+            parents[TileId{z, cx / 2, cy / 2}][(cx & 1) + 2 * (cy & 1)] = &it->second;
+        }
+        for (const auto& [id, children] : parents) {
+            int x = std::get<1>(id), y = std::get<2>(id);
+            auto parent_it = heights.find(id);
+            bool generated = parent_it == heights.end();
+            if (generated) {
+                if (z < options.min_zoom) continue;
+                const HeightGrid* any = *std::find_if(children.begin(), children.end(), [](const HeightGrid* c) { return c != nullptr; });
+                if (any->width % 2 != 0 || any->height % 2 != 0) {
+                    std::cerr << "Warning: cannot generate tile " << z << "/" << x << "/" << y << " from odd-sized children" << std::endl;
+                    continue;
+                }
+                HeightGrid grid;
+                grid.width = any->width;
+                grid.height = any->height;
+                grid.metres.assign(static_cast<size_t>(grid.width) * grid.height, 0.0f);
+                grid.flags = TerrainPackEntry::HEIGHTS_GENERATED;
+                parent_it = heights.emplace(id, std::move(grid)).first;
+                tiles.emplace(id, fs::path()); // No directory: no image layers
+                ++result.generated_tiles;
+            }
+            HeightGrid& parent = parent_it->second;
+            int half_w = parent.width / 2, half_h = parent.height / 2;
+            bool covered[4] = {};
+            float lowest = std::numeric_limits<float>::max();
+            for (int j = 0; j < 2; ++j) {
+                for (int i = 0; i < 2; ++i) {
+                    const HeightGrid* child = children[i + 2 * j];
+                    if (!child) continue;
+                    if (child->width != 2 * half_w || child->height != 2 * half_h) {
+                        std::cerr << "Warning: tile " << z + 1 << "/" << 2 * x + i << "/" << 2 * y + j
+                                  << " does not match its parent's resolution, not refining" << std::endl;
+                        continue;
+                    }
+                    // Child column i is the west (0) / east (1) half; child row j the north (0) /
+                    // south (1) half, which in OpenGL row order is the upper / lower half of the rows
+                    int col0 = i * half_w, row0 = (1 - j) * half_h;
+                    for (int r = 0; r < half_h; ++r) {
+                        const float* c0 = &child->metres[static_cast<size_t>(2 * r) * child->width];
+                        const float* c1 = c0 + child->width;
+                        float* dst = &parent.metres[static_cast<size_t>(row0 + r) * parent.width + col0];
+                        for (int c = 0; c < half_w; ++c) {
+                            float fine = 0.25f * (c0[2 * c] + c0[2 * c + 1] + c1[2 * c] + c1[2 * c + 1]);
+                            if (!generated) result.max_refinement_change = std::max(result.max_refinement_change, std::fabs(fine - dst[c]));
+                            dst[c] = fine;
+                            lowest = std::min(lowest, fine);
+                        }
+                    }
+                    covered[i + 2 * j] = true;
+                    if (!generated) {
+                        parent.flags |= TerrainPackEntry::HEIGHTS_REFINED;
+                        ++result.refined_quadrants;
+                    }
+                }
+            }
+            if (!generated) continue;
+            if (lowest == std::numeric_limits<float>::max()) { // No child matched: drop it again
+                heights.erase(parent_it);
+                tiles.erase(id);
+                --result.generated_tiles;
+                continue;
+            }
+            for (int q = 0; q < 4; ++q) {
+                if (covered[q]) continue;
+                int col0 = (q & 1) * half_w, row0 = (1 - q / 2) * half_h;
+                for (int r = 0; r < half_h; ++r) {
+                    float* dst = &parent.metres[static_cast<size_t>(row0 + r) * parent.width + col0];
+                    std::fill(dst, dst + half_w, lowest);
+                }
+                parent.flags |= TerrainPackEntry::HEIGHTS_PARTIAL;
+            }
+        }
+    }
+    result.tiles = tiles.size();
+    result.tiles_with_heights = heights.size();
+
+    // 5. Write: header + placeholder index, then data; the index goes in last
+    std::ofstream out(output_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Error: Cannot create " << output_path << std::endl;
+        return false;
+    }
+    std::vector<TerrainPackEntry> index(tiles.size());
+    uint64_t written = alignUp(HEADER_SIZE + index.size() * sizeof(TerrainPackEntry));
+    std::vector<char> zeros(written, 0);
+    out.write(zeros.data(), static_cast<std::streamsize>(written));
+
+    auto append = [&out, &written](const void* data, size_t size) {
+        uint64_t offset = written;
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        const char padding[DATA_ALIGNMENT] = {};
+        size_t aligned = alignUp(size);
+        out.write(padding, static_cast<std::streamsize>(aligned - size));
+        written += aligned;
+        return offset;
+    };
+    auto appendLayer = [&append](const Image& image, TerrainPackLayer& layer) {
+        if (image.pixels.empty()) return;
+        if (image.channels == 2) {
+            std::cerr << "Warning: skipping a 2-channel layer (unsupported by Texture)" << std::endl;
+            return;
+        }
+        layer.channels = static_cast<uint32_t>(image.channels);
+        layer.width = static_cast<uint32_t>(image.width);
+        layer.height = static_cast<uint32_t>(image.height);
+        layer.size = image.pixels.size();
+        layer.offset = append(image.pixels.data(), image.pixels.size());
+    };
+
+    size_t slot = 0;
+    for (const auto& [id, dir] : tiles) {
+        TerrainPackEntry& entry = index[slot++];
+        std::tie(entry.z, entry.x, entry.y) = id;
+        auto grid = heights.find(id);
+        if (grid != heights.end()) {
+            const HeightGrid& h = grid->second;
+            auto [lo, hi] = std::minmax_element(h.metres.begin(), h.metres.end());
+            entry.flags = h.flags;
+            entry.height_width = static_cast<uint32_t>(h.width);
+            entry.height_height = static_cast<uint32_t>(h.height);
+            entry.min_height = *lo;
+            entry.max_height = *hi;
+            if (options.float_heights) {
+                entry.height_format = static_cast<uint32_t>(TerrainHeightFormat::F32);
+                entry.height_data_size = h.metres.size() * sizeof(float);
+                entry.height_data_offset = append(h.metres.data(), entry.height_data_size);
+            } else {
+                entry.height_format = static_cast<uint32_t>(TerrainHeightFormat::U16);
+                entry.height_offset = entry.min_height;
+                entry.height_scale = (entry.max_height - entry.min_height) / 65535.0f;
+                std::vector<uint16_t> quantized(h.metres.size(), 0);
+                if (entry.height_scale > 0.0f) {
+                    for (size_t i = 0; i < quantized.size(); ++i) {
+                        float q = std::round((h.metres[i] - entry.height_offset) / entry.height_scale);
+                        quantized[i] = static_cast<uint16_t>(std::clamp(q, 0.0f, 65535.0f));
+                    }
+                }
+                entry.height_data_size = quantized.size() * sizeof(uint16_t);
+                entry.height_data_offset = append(quantized.data(), entry.height_data_size);
+            }
+            heights.erase(grid); // Written: release it before decoding the next images
+        }
+        if (dir.empty()) continue; // Generated
+        appendLayer(decode(dir / "normalmap.png"), entry.normalmap);
+        appendLayer(decode(dir / "texture.png"), entry.texture);
+    }
+
+    std::vector<uint8_t> header(MAGIC, MAGIC + 4);
+    uint32_t fields[3] = {PACK_VERSION, static_cast<uint32_t>(index.size()), static_cast<uint32_t>(source)};
+    float height_step = source == TerrainHeightSource::Heightmap8 ? options.height_step : 0.0f;
+    header.insert(header.end(), reinterpret_cast<const uint8_t*>(fields), reinterpret_cast<const uint8_t*>(fields) + sizeof(fields));
+    header.insert(header.end(), reinterpret_cast<const uint8_t*>(&height_step), reinterpret_cast<const uint8_t*>(&height_step) + sizeof(height_step));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    out.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(TerrainPackEntry)));
+    if (!out) {
+        std::cerr << "Error: Failed writing " << output_path << std::endl;
+        return false;
+    }
+    result.file_bytes = written;
+    return true;
+}
+
+// --- Load ---
+bool TerrainPack::open(const std::string& path) {
+    entries.clear();
+    lookup.clear();
+    height_source = TerrainHeightSource::None;
+    height_step = 0.0f;
+    if (!file.open(path)) return false;
+
+    auto fail = [this, &path](const char* reason) {
+        std::cerr << "Error: " << path << ": " << reason << std::endl;
+        file.close();
+        entries.clear();
+        lookup.clear();
+        return false;
+    };
+    if (file.size() < HEADER_SIZE || std::memcmp(file.data(), MAGIC, 4) != 0) return fail("not a terrain pack");
+    uint32_t fields[3];
+    std::memcpy(fields, file.data() + 4, sizeof(fields));
+    if (fields[0] != PACK_VERSION) return fail("unsupported version (rebuild it with pack-terrain)");
+    if (fields[2] > static_cast<uint32_t>(TerrainHeightSource::Heightmap8)) return fail("unknown height source");
+    height_source = static_cast<TerrainHeightSource>(fields[2]);
+    std::memcpy(&height_step, file.data() + 4 + sizeof(fields), sizeof(height_step));
+    uint64_t count = fields[1];
+    if (file.size() < HEADER_SIZE + count * sizeof(TerrainPackEntry)) return fail("truncated index");
+
+    entries.resize(static_cast<size_t>(count));
+    std::memcpy(entries.data(), file.data() + HEADER_SIZE, entries.size() * sizeof(TerrainPackEntry));
+    auto inside = [this](uint64_t offset, uint64_t size) { return offset <= file.size() && size <= file.size() - offset; };
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const TerrainPackEntry& entry = entries[i];
+        uint64_t texels = static_cast<uint64_t>(entry.height_width) * entry.height_height;
+        bool heights_ok = entry.height_format == static_cast<uint32_t>(TerrainHeightFormat::None) ||
+                          (entry.height_format == static_cast<uint32_t>(TerrainHeightFormat::U16) && entry.height_data_size == texels * 2) ||
+                          (entry.height_format == static_cast<uint32_t>(TerrainHeightFormat::F32) && entry.height_data_size == texels * 4);
+        if (!heights_ok || !inside(entry.height_data_offset, entry.height_data_size)) return fail("bad height grid");
+        for (const TerrainPackLayer* layer : {&entry.normalmap, &entry.texture}) {
+            if (layer->channels == 0) continue;
+            if (layer->size != static_cast<uint64_t>(layer->width) * layer->height * layer->channels || !inside(layer->offset, layer->size)) {
+                return fail("bad image layer");
+            }
+        }
+        lookup[packKey(entry.z, entry.x, entry.y)] = i;
+    }
+    return true;
+}
+
+const TerrainPackEntry* TerrainPack::find(int z, int x, int y) const {
+    auto it = lookup.find(packKey(z, x, y));
+    return it == lookup.end() ? nullptr : &entries[it->second];
+}
+
+void TerrainPack::readHeights(const TerrainPackEntry& entry, std::vector<float>& out) const {
+    out.clear();
+    if (!entry.hasHeights()) return;
+    const uint8_t* data = file.data() + entry.height_data_offset;
+    size_t count = static_cast<size_t>(entry.height_width) * entry.height_height;
+    out.resize(count);
+    if (entry.height_format == static_cast<uint32_t>(TerrainHeightFormat::F32)) {
+        std::memcpy(out.data(), data, count * sizeof(float));
+        return;
+    }
+    const uint16_t* values = reinterpret_cast<const uint16_t*>(data); // 16-byte aligned in the file
+    for (size_t i = 0; i < count; ++i) out[i] = entry.height_offset + entry.height_scale * values[i];
+}
+
+const uint8_t* TerrainPack::layerData(const TerrainPackLayer& layer) const {
+    return layer.channels == 0 ? nullptr : file.data() + layer.offset;
+}
@@ -0,0 +1,130 @@
+#ifndef TERRAIN_PACK_H
+#define TERRAIN_PACK_H
+
+#include "MappedFile.h"
+#include "TerrainConfig.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// All terrain tiles of a z/x/y directory tree in one memory-mapped file, built offline by
+// `FlightSimHeadless pack-terrain`. TileManager reads tiles from it by offset: no PNG decode.
+//
+// File layout (little-endian, written as raw host values):
+//   Header : "FSTP" | u32 version | u32 tile_count | u32 height_source | f32 height_step
+//   Index  : TerrainPackEntry * tile_count, sorted by (z, x, y)
+//   Data   : height grids and image layers, each at a 16-byte aligned offset
+//
+// Heights are metres (not normalized to Terrain's max_height) with rows in OpenGL order (bottom
+// = south edge first, as the PNG layers load). A pack takes every height from one source,
+// recorded in the header: heightmap_encoded.png (Terrarium: R*256 + G + B/256 - 32768), or the
+// 8-bit heightmap.png times height_step. Tiles without that source file get no heights of their
+// own. The pyramid is then built finest zoom first: every parent down to BuildOptions::min_zoom
+// gets each quadrant a child covers replaced by the child's 2x2 box-filtered heights, and a
+// parent missing from the tree is generated that way (heights only, no image layers), so the
+// levels agree where they overlap. Images are stored decoded (8-bit, 1/3/4 channels, rows in
+// OpenGL order).
+enum class TerrainHeightSource : uint32_t {
+    None = 0,       // No tile had heights
+    Encoded = 1,    // heightmap_encoded.png, Terrarium RGB
+    Heightmap8 = 2, // heightmap.png, 8-bit * height_step
+};
+
+enum class TerrainHeightFormat : uint32_t {
+    None = 0,
+    U16 = 16, // metres = height_offset + height_scale * value
+    F32 = 32, // metres
+};
+
+struct TerrainPackLayer {
+    uint32_t channels = 0; // 0 = layer absent
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t reserved = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+static_assert(sizeof(TerrainPackLayer) == 32, "TerrainPackLayer is part of the file format");
+
+struct TerrainPackEntry {
+    enum Flags : uint32_t {
+        HEIGHTS_REFINED = 1u << 1,   // At least one quadrant replaced by a finer tile
+        HEIGHTS_GENERATED = 1u << 2, // Not in the tree: built from its children
+        HEIGHTS_PARTIAL = 1u << 3,   // Generated with a quadrant no child covers (held at the lowest covered height)
+    };
+
+    int32_t z = 0;
+    int32_t x = 0;
+    int32_t y = 0;
+    uint32_t flags = 0;
+    uint32_t height_format = 0; // TerrainHeightFormat
+    uint32_t height_width = 0;
+    uint32_t height_height = 0;
+    float min_height = 0.0f;    // Metres, over the whole grid
+    float max_height = 0.0f;
+    float height_offset = 0.0f; // U16 dequantization
+    float height_scale = 0.0f;
+    uint32_t reserved = 0;
+    uint64_t height_data_offset = 0;
+    uint64_t height_data_size = 0;
+    TerrainPackLayer normalmap;
+    TerrainPackLayer texture;
+
+    bool hasHeights() const { return height_format != static_cast<uint32_t>(TerrainHeightFormat::None); }
+};
+static_assert(sizeof(TerrainPackEntry) == 128, "TerrainPackEntry is part of the file format");
+
+class TerrainPack {
+public:
+    struct BuildOptions {
+        bool float_heights = false; // F32 instead of U16 (~5 cm steps over 3.5 km)
+        TerrainHeightSource height_source = TerrainHeightSource::None; // None: Encoded if any tile has it, else Heightmap8
+        float height_step = TerrainConfig::MAX_HEIGHT / 255.0f;     // Metres per 8-bit heightmap.png step
+        int min_zoom = TerrainConfig::TILE_ANCHOR_ZOOM;             // Coarsest level generated from finer tiles
+    };
+
+    struct BuildReport {
+        size_t tiles = 0;
+        size_t tiles_with_heights = 0;
+        size_t tiles_without_source = 0; // Had a directory but not the pack's height source file
+        size_t generated_tiles = 0;
+        size_t refined_quadrants = 0;
+        float max_refinement_change = 0.0f; // Largest |coarse - fine| height replaced, metres
+        uint64_t file_bytes = 0;
+    };
+
+    // Pack every <root>/<z>/<x>/<y>/ directory into `output_path`. Returns false (and logs) on failure.
+    static bool build(const std::string& root, const std::string& output_path, const BuildOptions& options, BuildReport* report = nullptr);
+
+    // Map and validate a pack. Returns false (and logs) if it is missing or malformed.
+    bool open(const std::string& path);
+
+    bool isOpen() const { return file.isOpen(); }
+    const std::vector<TerrainPackEntry>& getEntries() const { return entries; }
+    const TerrainPackEntry* find(int z, int x, int y) const;
+    TerrainHeightSource getHeightSource() const { return height_source; }
+    float getHeightStep() const { return height_step; } // Metres per step for Heightmap8, else 0
+
+    // Heights in metres (U16 is expanded); empty if the tile has none
+    void readHeights(const TerrainPackEntry& entry, std::vector<float>& out) const;
+    // Layer bytes inside the mapping (null for an absent layer)
+    const uint8_t* layerData(const TerrainPackLayer& layer) const;
+
+    // heightmap_encoded.png texel (Terrarium RGB) to metres
+    static float terrariumMetres(const uint8_t* rgb) { return rgb[0] * 256.0f + rgb[1] + rgb[2] / 256.0f - 32768.0f; }
+
+    static uint64_t packKey(int z, int x, int y) {
+        return (static_cast<uint64_t>(z) << 56) | (static_cast<uint64_t>(x) << 28) | static_cast<uint64_t>(y);
+    }
+
+private:
+    MappedFile file;
+    std::vector<TerrainPackEntry> entries;
+    TerrainHeightSource height_source = TerrainHeightSource::None;
+    float height_step = 0.0f;
+    std::unordered_map<uint64_t, size_t> lookup; // packKey -> entries index
+};
+
+#endif // TERRAIN_PACK_H
@@ -0,0 +1,297 @@
+#include "TerrainRaycaster.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const double INF = std::numeric_limits<double>::infinity();
+const float FLOAT_INF = std::numeric_limits<float>::infinity();
+
+// Cell the ray occupies at coordinate p: on a boundary, the one it is moving into
+int cellIndex(double p, double velocity, int cell_count) {
+    int c = velocity < 0.0 ? static_cast<int>(std::ceil(p)) - 1 : static_cast<int>(std::floor(p));
+    return std::clamp(c, 0, cell_count - 1);
+}
+
+// Ray parameter where it leaves [lo, hi] along one axis
+double exitParameter(double origin, double velocity, double lo, double hi) {
+    if (velocity > 0.0) return (hi - origin) / velocity;
+    if (velocity < 0.0) return (lo - origin) / velocity;
+    return INF;
+}
+
+} // namespace
+
+void TerrainRaycaster::build(const Heightfield& heightfield) {
+    field = &heightfield;
+    levels.clear();
+    if (heightfield.empty()) return;
+
+    cells_x = heightfield.getWidth() - 1;
+    cells_z = heightfield.getHeight() - 1;
+
+    // Level 1: 2x2 cells (3x3 texels) per node. Leaf cells are bounded by their 4 corners,
+    // which the traversal reads straight from the heightfield, so they are not stored.
+    Level first;
+    first.width = (cells_x + 1) / 2;
+    first.height = (cells_z + 1) / 2;
+    first.nodes.resize(static_cast<size_t>(first.width) * first.height);
+    for (int j = 0; j < first.height; ++j) {
+        for (int i = 0; i < first.width; ++i) {
+            Bounds b{FLOAT_INF, -FLOAT_INF};
+            for (int z = 2 * j; z <= std::min(2 * j + 2, cells_z); ++z) {
+                for (int x = 2 * i; x <= std::min(2 * i + 2, cells_x); ++x) {
+                    float h = heightfield.texel(x, z);
+                    b.min = std::min(b.min, h);
+                    b.max = std::max(b.max, h);
+                }
+            }
+            first.nodes[static_cast<size_t>(j) * first.width + i] = b;
+        }
+    }
+    levels.push_back(std::move(first));
+
+    // Coarser levels: 2x2 reduction until one node covers everything
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        const Level& fine = levels.back();
+        Level coarse;
+        coarse.width = (fine.width + 1) / 2;
+        coarse.height = (fine.height + 1) / 2;
+        coarse.nodes.resize(static_cast<size_t>(coarse.width) * coarse.height);
+        for (int j = 0; j < coarse.height; ++j) {
+            for (int i = 0; i < coarse.width; ++i) {
+                Bounds b{FLOAT_INF, -FLOAT_INF};
+                for (int z = 2 * j; z <= std::min(2 * j + 1, fine.height - 1); ++z) {
+                    for (int x = 2 * i; x <= std::min(2 * i + 1, fine.width - 1); ++x) {
+                        const Bounds& child = fine.nodes[static_cast<size_t>(z) * fine.width + x];
+                        b.min = std::min(b.min, child.min);
+                        b.max = std::max(b.max, child.max);
+                    }
+                }
+                coarse.nodes[static_cast<size_t>(j) * coarse.width + i] = b;
+            }
+        }
+        levels.push_back(std::move(coarse));
+    }
+}
+
+void TerrainRaycaster::heightRange(float x0, float z0, float x1, float z1, float& min_height, float& max_height) const {
+    if (!field || levels.empty()) {
+        min_height = max_height = 0.0f;
+        return;
+    }
+    // Cells under the rectangle; outside the map the surface is the clamped edge cells
+    glm::vec2 t0 = field->worldToTexel(std::min(x0, x1), std::min(z0, z1));
+    glm::vec2 t1 = field->worldToTexel(std::max(x0, x1), std::max(z0, z1));
+    int cx0 = std::clamp(static_cast<int>(std::floor(t0.x)), 0, cells_x - 1);
+    int cx1 = std::clamp(static_cast<int>(std::floor(t1.x)), 0, cells_x - 1);
+    int cz0 = std::clamp(static_cast<int>(std::floor(t0.y)), 0, cells_z - 1);
+    int cz1 = std::clamp(static_cast<int>(std::floor(t1.y)), 0, cells_z - 1);
+
+    // levels[k - 1] nodes span 2^k cells: pick the finest level with at most 4x4 nodes
+    size_t level = 0;
+    int shift = 1;
+    while (level + 1 < levels.size() && ((cx1 >> shift) - (cx0 >> shift) >= 4 || (cz1 >> shift) - (cz0 >> shift) >= 4)) {
+        ++level;
+        ++shift;
+    }
+    const Level& l = levels[level];
+    Bounds b{FLOAT_INF, -FLOAT_INF};
+    for (int j = cz0 >> shift; j <= std::min(cz1 >> shift, l.height - 1); ++j) {
+        for (int i = cx0 >> shift; i <= std::min(cx1 >> shift, l.width - 1); ++i) {
+            const Bounds& node = l.nodes[static_cast<size_t>(j) * l.width + i];
+            b.min = std::min(b.min, node.min);
+            b.max = std::max(b.max, node.max);
+        }
+    }
+    min_height = b.min;
+    max_height = b.max;
+}
+
+TerrainRayHit TerrainRaycaster::makeHit(const glm::vec3& origin, const glm::vec3& direction, float distance) const {
+    TerrainRayHit hit;
+    hit.hit = true;
+    hit.distance = distance;
+    hit.position = origin + direction * distance;
+    float ground = 0.0f;
+    if (field) field->sample(hit.position.x, hit.position.z, ground, hit.normal);
+    hit.position.y = ground; // On the surface, not a float-rounded step off it
+    return hit;
+}
+
+bool TerrainRaycaster::intersectCell(int cx, int cz, const double o[3], const double v[3], double t_begin, double t_end, double& t_hit) const {
+    const float* corner = field->cell(cx, cz);
+    const double h00 = corner[0], h10 = corner[1];
+    const double h01 = corner[Heightfield::TILE_STRIDE], h11 = corner[Heightfield::TILE_STRIDE + 1];
+
+    // Bilinear patch h = a + b*fx + c*fz + d*fx*fz, ray local to t_begin so fx, fz stay in [0, 1]
+    const double fx = o[0] + v[0] * t_begin - cx;
+    const double fz = o[2] + v[2] * t_begin - cz;
+    const double y = o[1] + v[1] * t_begin;
+    const double a = h00, b = h10 - h00, c = h01 - h00, d = h11 - h10 - h01 + h00;
+
+    // f(s) = patch height - ray height = A s^2 + B s + C, s = t - t_begin; f >= 0 is contact
+    const double A = d * v[0] * v[2];
+    const double B = b * v[0] + c * v[2] + d * (fx * v[2] + fz * v[0]) - v[1];
+    const double C = a + b * fx + c * fz + d * fx * fz - y;
+    const double span = t_end - t_begin;
+
+    if (C >= 0.0) {
+        t_hit = t_begin;
+        return true;
+    }
+    // Smallest root in [0, span]
+    double s = INF;
+    if (std::abs(A) < 1e-12) {
+        if (B > 0.0) s = -C / B;
+    } else {
+        double disc = B * B - 4.0 * A * C;
+        if (disc >= 0.0) {
+            double q = -0.5 * (B + std::copysign(std::sqrt(disc), B)); // Stable form
+            double r0 = q / A;
+            double r1 = q != 0.0 ? C / q : INF;
+            if (r0 > r1) std::swap(r0, r1);
+            s = r0 >= 0.0 ? r0 : r1;
+        }
+    }
+    if (s < 0.0 || s > span) return false;
+    t_hit = t_begin + s;
+    return true;
+}
+
+TerrainRayHit TerrainRaycaster::raycast(const glm::vec3& origin, const glm::vec3& direction, float max_distance) const {
+    TerrainRayHit miss;
+    float length = glm::length(direction);
+    if (!(length > 0.0f) || !(max_distance > 0.0f)) return miss;
+    const glm::vec3 dir = direction / length;
+
+    if (!field || field->empty()) {
+        // Flat ground at y = 0
+        if (origin.y <= 0.0f) return {true, 0.0f, glm::vec3(origin.x, 0.0f, origin.z), glm::vec3(0.0f, 1.0f, 0.0f)};
+        if (dir.y >= 0.0f) return miss;
+        float t = -origin.y / dir.y;
+        if (t > max_distance) return miss;
+        return {true, t, glm::vec3(origin.x + dir.x * t, 0.0f, origin.z + dir.z * t), glm::vec3(0.0f, 1.0f, 0.0f)};
+    }
+
+    // Texel space for X/Z (cell (i, j) spans [i, i+1] x [j, j+1]), metres for Y; t in metres
+    const glm::vec2 texel = field->worldToTexel(origin.x, origin.z);
+    const glm::vec2 texels_per_metre = field->getTexelsPerMetre();
+    const double o[3] = {texel.x, origin.y, texel.y};
+    const double v[3] = {dir.x * static_cast<double>(texels_per_metre.x), dir.y, dir.z * static_cast<double>(texels_per_metre.y)};
+
+    // Clip to the mapped square
+    double t = 0.0, t_end = max_distance;
+    const double extent[2] = {static_cast<double>(cells_x), static_cast<double>(cells_z)};
+    for (int axis = 0; axis < 2; ++axis) {
+        const double oa = o[axis * 2], va = v[axis * 2];
+        if (va == 0.0) {
+            if (oa < 0.0 || oa > extent[axis]) return miss;
+            continue;
+        }
+        double t0 = (0.0 - oa) / va, t1 = (extent[axis] - oa) / va;
+        if (t0 > t1) std::swap(t0, t1);
+        t = std::max(t, t0);
+        t_end = std::min(t_end, t1);
+    }
+    if (t > t_end) return miss;
+
+    const int top = static_cast<int>(levels.size()); // Level index; 0 = leaf cell
+    int level = top;
+    while (t < t_end) {
+        const double px = o[0] + v[0] * t, pz = o[2] + v[2] * t;
+        const int cx = cellIndex(px, v[0], cells_x);
+        const int cz = cellIndex(pz, v[2], cells_z);
+
+        // Node footprint at this level, in cells
+        const int size = 1 << level;
+        const int nx = cx >> level, nz = cz >> level;
+        double t_exit = std::min({t_end,
+                                  exitParameter(o[0], v[0], static_cast<double>(nx * size), static_cast<double>((nx + 1) * size)),
+                                  exitParameter(o[2], v[2], static_cast<double>(nz * size), static_cast<double>((nz + 1) * size))});
+        t_exit = std::max(t_exit, t + 1e-7); // Always make progress past a boundary lost to rounding
+
+        if (level == 0) {
+            double t_hit;
+            if (intersectCell(cx, cz, o, v, t, std::min(t_exit, t_end), t_hit)) {
+                return makeHit(origin, dir, static_cast<float>(t_hit));
+            }
+            t = t_exit;
+            level = std::min(1, top);
+            continue;
+        }
+
+        const Level& lv = levels[level - 1];
+        const Bounds& bounds = lv.nodes[static_cast<size_t>(nz) * lv.width + nx];
+        const double y_begin = o[1] + v[1] * t, y_exit = o[1] + v[1] * std::min(t_exit, t_end);
+        if (std::min(y_begin, y_exit) > bounds.max) {
+            // Clear of everything under this node: skip it and try a coarser step next
+            t = t_exit;
+            level = std::min(level + 1, top);
+        } else if (std::max(y_begin, y_exit) < bounds.min) {
+            // Entirely below the terrain (the ray started underground)
+            return makeHit(origin, dir, static_cast<float>(t));
+        } else {
+            --level;
+        }
+    }
+    return miss;
+}
+
+void TerrainRaycaster::raycastBatch(const TerrainRay* rays, size_t count, TerrainRayHit* hits) const {
+    for (size_t i = 0; i < count; ++i) hits[i] = raycast(rays[i]);
+}
+
+TerrainRayHit TerrainRaycaster::castSegment(const glm::vec3& from, const glm::vec3& to) const {
+    glm::vec3 delta = to - from;
+    float length = glm::length(delta);
+    if (length <= 0.0f) {
+        // Degenerate segment: contact if the point is at or below the ground
+        TerrainRayHit hit;
+        float ground = field ? field->height(from.x, from.z) : 0.0f;
+        if (from.y <= ground) {
+            hit.hit = true;
+            hit.position = glm::vec3(from.x, ground, from.z);
+            hit.normal = field ? field->normal(from.x, from.z) : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+        return hit;
+    }
+    return raycast(from, delta, length);
+}
+
+float TerrainRaycaster::radarAltitude(const glm::vec3& position, float max_range, const glm::vec3& beam) const {
+    TerrainRayHit hit = raycast(position, beam, max_range);
+    return hit.hit ? hit.distance : max_range;
+}
+
+TerrainRayHit TerrainRaycaster::raymarch(const glm::vec3& origin, const glm::vec3& direction, float max_distance, float step) const {
+    TerrainRayHit miss;
+    float length = glm::length(direction);
+    if (!(length > 0.0f) || !(step > 0.0f)) return miss;
+    const glm::vec3 dir = direction / length;
+    const bool flat = !field || field->empty();
+    auto above = [&](float t) {
+        glm::vec3 p = origin + dir * t;
+        if (flat) return p.y > 0.0f;
+        // Same extent as raycast(): no terrain outside the mapped square
+        glm::vec2 texel = field->worldToTexel(p.x, p.z);
+        if (texel.x < 0.0f || texel.y < 0.0f || texel.x > cells_x || texel.y > cells_z) return true;
+        return p.y > field->height(p.x, p.z);
+    };
+
+    if (!above(0.0f)) return makeHit(origin, dir, 0.0f);
+    float previous = 0.0f;
+    for (float t = step; previous < max_distance; previous = t, t += step) {
+        t = std::min(t, max_distance);
+        if (above(t)) continue;
+        // Bisect the bracketing step
+        float lo = previous, hi = t;
+        for (int i = 0; i < 24; ++i) {
+            float mid = 0.5f * (lo + hi);
+            if (above(mid)) lo = mid; else hi = mid;
+        }
+        return makeHit(origin, dir, hi);
+    }
+    return miss;
+}
@@ -0,0 +1,81 @@
+#ifndef TERRAIN_RAYCASTER_H
+#define TERRAIN_RAYCASTER_H
+
+#include "Heightfield.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+struct TerrainRay {
+    glm::vec3 origin{0.0f};
+    glm::vec3 direction{0.0f, -1.0f, 0.0f}; // Need not be normalized
+    float max_distance = 1.0e5f;            // m
+};
+
+struct TerrainRayHit {
+    bool hit = false;
+    float distance = 0.0f;      // m along the (normalized) ray
+    glm::vec3 position{0.0f};
+    glm::vec3 normal{0.0f, 1.0f, 0.0f};
+};
+
+// Ray queries against a Heightfield (line of sight, radar altimeter, swept collision).
+// Builds a min/max pyramid over the heightfield cells: level k node bounds 2^k x 2^k cells.
+// The traversal descends only into nodes whose height range the ray segment overlaps, skips
+// empty space at the coarsest level that fits, and intersects the exact bilinear surface
+// (the same one Heightfield::height() returns) only in leaf cells.
+//
+// The surface ends at the heightfield's edge texels: rays are clipped to the mapped square.
+// An empty heightfield is the plane y = 0. The heightfield must outlive the raycaster and
+// build() must be called again if it changes.
+class TerrainRaycaster {
+public:
+    TerrainRaycaster() = default;
+    explicit TerrainRaycaster(const Heightfield& heightfield) { build(heightfield); }
+
+    void build(const Heightfield& heightfield);
+
+    // First intersection within max_distance
+    TerrainRayHit raycast(const glm::vec3& origin, const glm::vec3& direction, float max_distance) const;
+    TerrainRayHit raycast(const TerrainRay& ray) const { return raycast(ray.origin, ray.direction, ray.max_distance); }
+    void raycastBatch(const TerrainRay* rays, size_t count, TerrainRayHit* hits) const;
+
+    // Swept collision: first contact on the segment from -> to (e.g. last and current position)
+    TerrainRayHit castSegment(const glm::vec3& from, const glm::vec3& to) const;
+    bool lineOfSight(const glm::vec3& from, const glm::vec3& to) const { return !castSegment(from, to).hit; }
+
+    // Distance to the terrain along `beam` (default straight down); max_range if nothing is in range
+    float radarAltitude(const glm::vec3& position, float max_range, const glm::vec3& beam = glm::vec3(0.0f, -1.0f, 0.0f)) const;
+
+    // Reference: fixed-step marching with `step` metres, then bisection (for tests and benchmarks)
+    TerrainRayHit raymarch(const glm::vec3& origin, const glm::vec3& direction, float max_distance, float step) const;
+
+    // Conservative height range of the surface over the world XZ rectangle [x0, x1] x [z0, z1]
+    // (terrain culling bounds). Reads at most 16 pyramid nodes from the coarsest level that
+    // keeps them that few. An empty heightfield gives [0, 0].
+    void heightRange(float x0, float z0, float x1, float z1, float& min_height, float& max_height) const;
+
+    size_t getLevelCount() const { return levels.size(); }
+
+private:
+    struct Bounds {
+        float min;
+        float max;
+    };
+    struct Level {
+        int width = 0;  // Nodes
+        int height = 0;
+        std::vector<Bounds> nodes;
+    };
+
+    const Heightfield* field = nullptr;
+    int cells_x = 0;
+    int cells_z = 0;
+    std::vector<Level> levels; // levels[k - 1] has 2^k x 2^k cells per node; the last is 1x1
+
+    TerrainRayHit makeHit(const glm::vec3& origin, const glm::vec3& direction, float distance) const;
+    // First t in [t_begin, t_end] where the ray is on or below the bilinear patch of cell (cx, cz)
+    bool intersectCell(int cx, int cz, const double o[3], const double v[3], double t_begin, double t_end, double& t_hit) const;
+};
+
+#endif // TERRAIN_RAYCASTER_H
@@ -1,10 +1,11 @@
 #include "Texture.h"
+#include "AsyncTextureLoader.h"
+#include "BakedTexture.h"
+#include "Trace.h"
 #include <iostream>
 #include <utility> // For std::swap
 
-// Define STB_IMAGE_IMPLEMENTATION in this file only, before including stb_image.h
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
+#include <stb_image.h> // Implementation is compiled once in StbImage.cpp
 
 // Constructor implementation
 Texture::Texture(const char* path, const GLUtil::TextureParams& params)
@@ -32,9 +33,54 @@ Texture::~Texture() {
     }
 }
 
+// --- Asynchronous creation ---
+Texture Texture::loadAsync(AsyncTextureLoader& loader, const std::string& path, const GLUtil::TextureParams& params) {
+    Texture texture;
+    glGenTextures(1, &texture.ID);
+    if (texture.ID == 0) {
+        std::cerr << "Error: Failed to generate texture handle." << std::endl;
+        return texture;
+    }
+    // A baked file only needs mapping here; its levels are uploaded from the mapping by the loader
+    std::string baked_path = BakedTexture::findFor(path);
+    if (!baked_path.empty()) {
+        auto baked = std::make_shared<BakedTexture>();
+        if (baked->open(baked_path) && GLUtil::canUploadBaked(*baked)) {
+            texture.upload = loader.loadBaked(texture.ID, std::move(baked), params);
+            return texture;
+        }
+    }
+    texture.upload = loader.loadFile(texture.ID, path, params);
+    return texture;
+}
+
+Texture Texture::fromPixelsAsync(AsyncTextureLoader& loader, int width, int height, int channels,
+                                 std::shared_ptr<const uint8_t> pixels, const GLUtil::TextureParams& params, GLenum type) {
+    Texture texture;
+    glGenTextures(1, &texture.ID);
+    if (texture.ID == 0) {
+        std::cerr << "Error: Failed to generate texture handle." << std::endl;
+        return texture;
+    }
+    texture.upload = loader.loadPixels(texture.ID, width, height, channels, std::move(pixels), params, type);
+    return texture;
+}
+
+bool Texture::isValid() const {
+    return ID != 0 && (!upload || upload->ready);
+}
+
+bool Texture::isPending() const {
+    return ID != 0 && upload && !upload->ready && !upload->failed;
+}
+
+int Texture::getWidth() const { return upload ? upload->width : Width; }
+int Texture::getHeight() const { return upload ? upload->height : Height; }
+int Texture::getChannels() const { return upload ? upload->channels : NrChannels; }
+
 // Move constructor
 Texture::Texture(Texture&& other) noexcept
-    : ID(other.ID), Width(other.Width), Height(other.Height), NrChannels(other.NrChannels) {
+    : ID(other.ID), Width(other.Width), Height(other.Height), NrChannels(other.NrChannels), upload(std::move(other.upload)) {
     other.ID = 0; // Leave moved-from object in a valid (but empty) state
     other.Width = 0;
     other.Height = 0;
@@ -53,6 +99,7 @@ Texture& Texture::operator=(Texture&& other) noexcept {
         Width = other.Width;
         Height = other.Height;
         NrChannels = other.NrChannels;
+        upload = std::move(other.upload);
         // Reset moved-from object
         other.ID = 0;
         other.Width = 0;
@@ -65,6 +112,7 @@ Texture& Texture::operator=(Texture&& other) noexcept {
 
 // loadTexture implementation taking params
 bool Texture::loadTexture(const char* path, const GLUtil::TextureParams& params) {
+    FS_TRACE_ZONE("Texture::load");
     // Texture ID should already be bound here
 
     // Set texture wrapping/filtering options from params
@@ -73,6 +121,9 @@ bool Texture::loadTexture(const char* path, const GLUtil::TextureParams& params)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, params.texture_min_filter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, params.texture_mag_filter);
 
+    // Pre-baked levels next to the source skip the decode and glGenerateMipmap
+    if (loadBaked(path, params)) return true;
+
     stbi_set_flip_vertically_on_load(true);
     unsigned char *data = stbi_load(path, &Width, &Height, &NrChannels, 0);
     if (data) {
@@ -89,10 +140,7 @@ bool Texture::loadTexture(const char* path, const GLUtil::TextureParams& params)
 
         glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, Width, Height, 0, dataFormat, GL_UNSIGNED_BYTE, data);
         // Generate mipmaps if min filter uses them
-        if (params.texture_min_filter == GL_NEAREST_MIPMAP_NEAREST ||
-            params.texture_min_filter == GL_LINEAR_MIPMAP_NEAREST ||
-            params.texture_min_filter == GL_NEAREST_MIPMAP_LINEAR ||
-            params.texture_min_filter == GL_LINEAR_MIPMAP_LINEAR) {
+        if (GLUtil::usesMipmaps(params.texture_min_filter)) {
             glGenerateMipmap(GL_TEXTURE_2D);
         }
 
@@ -105,6 +153,23 @@ bool Texture::loadTexture(const char* path, const GLUtil::TextureParams& params)
     }
 }
 
+bool Texture::loadBaked(const char* path, const GLUtil::TextureParams& params) {
+    std::string baked_path = BakedTexture::findFor(path);
+    if (baked_path.empty()) return false;
+    BakedTexture baked;
+    if (!baked.open(baked_path)) return false;
+    if (!GLUtil::canUploadBaked(baked)) {
+        std::cerr << "Warning: No BC1 support, decoding " << path << " instead of its baked copy" << std::endl;
+        return false;
+    }
+    for (int level = 0; level < baked.getLevelCount(); ++level) GLUtil::uploadBakedLevel(baked, level);
+    GLUtil::finishBakedLevels(baked, params);
+    Width = baked.getWidth();
+    Height = baked.getHeight();
+    NrChannels = baked.getChannels();
+    return true; // The mapping closes here; the driver has its own copy
+}
+
 void Texture::bind(GLuint textureUnit) const {
     if (!isValid()) return; // Don't bind invalid texture
     glActiveTexture(textureUnit);
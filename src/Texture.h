@@ -2,9 +2,14 @@
 #define TEXTURE_H
 
 #include <GL/glew.h>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include "OpenGLUtils.h" // Include for TextureParams definition
 
+class AsyncTextureLoader;
+struct TextureUploadStatus;
+
 class Texture {
 public:
     GLuint ID;
@@ -16,6 +21,19 @@ public:
     Texture(const char* path, const GLUtil::TextureParams& params = {}); // Added params
     ~Texture();
 
+    // Both the constructor and loadAsync use a baked copy (<path>.ftex, see BakedTexture.h) with
+    // its stored mip chain instead of decoding the image when one sits next to it.
+
+    // Asynchronous creation: returns at once with the texture name reserved; decode and upload
+    // happen through `loader` (AsyncTextureLoader::update each frame). Until the upload has
+    // finished the texture is not valid and bind() does nothing.
+    static Texture loadAsync(AsyncTextureLoader& loader, const std::string& path, const GLUtil::TextureParams& params = {});
+    // Same, from pixels already decoded elsewhere (rows in OpenGL order, 8-bit 1/3/4 channels or
+    // 1-channel GL_FLOAT)
+    static Texture fromPixelsAsync(AsyncTextureLoader& loader, int width, int height, int channels,
+                                   std::shared_ptr<const uint8_t> pixels, const GLUtil::TextureParams& params = {},
+                                   GLenum type = GL_UNSIGNED_BYTE);
+
     // Prevent copying, allow moving
     Texture(const Texture&) = delete;
     Texture& operator=(const Texture&) = delete;
@@ -24,10 +42,19 @@ public:
 
 
     void bind(GLuint textureUnit = GL_TEXTURE0) const;
-    bool isValid() const { return ID != 0; }
+    bool isValid() const; // Has a texture name and, if loaded asynchronously, its upload finished
+    bool isPending() const; // Asynchronous load still in progress
+
+    // Size and channels; for asynchronous textures known once isValid() (Width etc. stay 0)
+    int getWidth() const;
+    int getHeight() const;
+    int getChannels() const;
 
 private:
+    std::shared_ptr<const TextureUploadStatus> upload; // Set for asynchronous loads
+
     bool loadTexture(const char* path, const GLUtil::TextureParams& params); // Added params
+    bool loadBaked(const char* path, const GLUtil::TextureParams& params); // <path>.ftex, if present and current
 };
 
 #endif // TEXTURE_H
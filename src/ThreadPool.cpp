@@ -0,0 +1,134 @@
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <algorithm>
+#include <exception>
+
+namespace {
+// Identifies the pool and queue of the current worker thread, so tasks submitted from
+// inside a task go to the submitting worker's own deque
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+}
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+    queues.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) queues.push_back(std::make_unique<WorkerQueue>());
+    workers.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    size_t target = current_pool == this ? current_worker : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1, std::memory_order_release);
+    {
+        // Taking the lock orders this notify after a worker's predicate check, so it cannot be lost
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    available.notify_one();
+}
+
+bool ThreadPool::tryPop(size_t self, std::function<void()>& task) {
+    // Own queue first, newest task (its data is most likely still in cache)
+    {
+        WorkerQueue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    // Steal the oldest task from the next non-empty victim
+    for (size_t k = 1; k < queues.size(); ++k) {
+        WorkerQueue& victim = *queues[(self + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    FS_TRACE_THREAD("ThreadPool worker");
+    current_pool = this;
+    current_worker = index;
+    for (;;) {
+        std::function<void()> task;
+        if (tryPop(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        available.wait(lock, [this]() { return stopping || queued.load(std::memory_order_acquire) > 0; });
+        if (stopping && queued.load(std::memory_order_acquire) == 0) return; // Stopping and drained
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body, size_t grain) {
+    if (count == 0) return;
+
+    const size_t slices = std::min(count, workers.size());
+    // Small enough blocks to even out the tail, large enough that the shared cursors stay cold
+    if (grain == 0) grain = std::max<size_t>(1, count / (slices * 64));
+
+    // One slice per task; `next` is advanced by the owner and by thieves alike
+    struct alignas(64) Slice {
+        std::atomic<size_t> next{0};
+        size_t end = 0;
+    };
+    std::vector<Slice> slice(slices);
+    for (size_t s = 0; s < slices; ++s) {
+        slice[s].next.store(count * s / slices, std::memory_order_relaxed);
+        slice[s].end = count * (s + 1) / slices;
+    }
+
+    auto drain = [&body, grain](Slice& range) {
+        for (;;) {
+            size_t begin = range.next.fetch_add(grain, std::memory_order_relaxed);
+            if (begin >= range.end) return;
+            size_t end = std::min(range.end, begin + grain);
+            for (size_t i = begin; i < end; ++i) body(i);
+        }
+    };
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(slices);
+    for (size_t s = 0; s < slices; ++s) {
+        pending.push_back(submit([&slice, &drain, s, slices]() {
+            for (size_t k = 0; k < slices; ++k) drain(slice[(s + k) % slices]);
+        }));
+    }
+    // Wait for every task before rethrowing: the tasks reference body and slice
+    std::exception_ptr first_error;
+    for (auto& f : pending) {
+        try {
+            f.get();
+        } catch (...) {
+            if (!first_error) first_error = std::current_exception();
+        }
+    }
+    if (first_error) std::rethrow_exception(first_error);
+}
@@ -0,0 +1,64 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size work-stealing pool for CPU-only batch work (headless flights, trims, sweeps).
+// Each worker owns a task deque: it pops its own newest task and, when empty, steals the
+// oldest task from another worker. submit() returns a future for the task's result.
+class ThreadPool {
+public:
+    // thread_count == 0 uses std::thread::hardware_concurrency()
+    explicit ThreadPool(size_t thread_count = 0);
+    ~ThreadPool(); // Finishes queued tasks, then joins the workers
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    template <typename F>
+    auto submit(F&& task) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+    // Run body(i) for every i in [0, count). Each worker starts on its own contiguous slice
+    // and, once done, steals `grain`-sized blocks from the slices of slower workers, so
+    // iterations of very different cost still finish together. grain == 0 picks one from count.
+    // Blocks until all iterations finish; rethrows the first exception raised by body.
+    // Must not be called from inside a pool task (the caller would wait on its own worker).
+    void parallelFor(size_t count, const std::function<void(size_t)>& body, size_t grain = 0);
+
+private:
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks; // Owner pops the back, thieves take the front
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkerQueue>> queues; // One per worker
+    std::atomic<size_t> queued{0};                    // Tasks pushed and not yet popped
+    std::atomic<size_t> next_queue{0};                // Round-robin target for external submits
+    std::mutex sleep_mutex;
+    std::condition_variable available;
+    bool stopping = false; // Guarded by sleep_mutex
+
+    void enqueue(std::function<void()> task);
+    bool tryPop(size_t self, std::function<void()>& task);
+    void workerLoop(size_t index);
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,373 @@
+#include "TileManager.h"
+#include "Trace.h"
+#include <stb_image.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+// Directory names that are plain non-negative integers
+bool parseIndex(const std::string& name, int& value) {
+    if (name.empty() || name.size() > 9) return false;
+    for (char c : name) {
+        if (c < '0' || c > '9') return false;
+    }
+    value = std::stoi(name);
+    return true;
+}
+
+// Decode one layer if the file exists; empty image otherwise (a missing layer is normal)
+TileImage decodeLayer(const std::filesystem::path& path) {
+    TileImage image;
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) return image;
+    stbi_set_flip_vertically_on_load_thread(1); // OpenGL row order, as Texture and Heightfield load
+    int w = 0, h = 0, channels = 0;
+    unsigned char* data = stbi_load(path.string().c_str(), &w, &h, &channels, 0);
+    if (!data) {
+        std::cerr << "TileManager: failed to decode " << path.string() << " (" << stbi_failure_reason() << ")" << std::endl;
+        return image;
+    }
+    image.width = w;
+    image.height = h;
+    image.channels = channels;
+    image.pixels.assign(data, data + static_cast<size_t>(w) * h * channels);
+    stbi_image_free(data);
+    return image;
+}
+
+const double EARTH_CIRCUMFERENCE = 40075016.686; // m, WGS84 equator (Web Mercator sphere)
+const double PI = 3.14159265358979323846;
+
+} // namespace
+
+TileManager::TileManager() : TileManager(Options()) {}
+
+TileManager::TileManager(Options opts) : options(std::move(opts)) {
+    options.min_zoom = std::max(options.min_zoom, 0);
+    options.max_zoom = std::max(options.max_zoom, options.min_zoom);
+    options.ring_radius = std::max(options.ring_radius, 0);
+    if (!(options.anchor_tile_size > 0.0)) options.anchor_tile_size = groundTileSize(options.anchor);
+    scanAvailable();
+    int count = std::max(options.worker_count, 1);
+    for (int i = 0; i < count; ++i) workers.emplace_back(&TileManager::workerLoop, this);
+}
+
+TileManager::~TileManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+    }
+    work_available.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void TileManager::scanAvailable() {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (!options.pack_path.empty() && fs::is_regular_file(options.pack_path, ec) && pack.open(options.pack_path)) {
+        for (const TerrainPackEntry& entry : pack.getEntries()) {
+            if (entry.z >= options.min_zoom && entry.z <= options.max_zoom) available.insert(TileKey{entry.z, entry.x, entry.y}.packed());
+        }
+        std::cout << "TileManager: " << pack.getEntries().size() << " tiles in " << options.pack_path << std::endl;
+    }
+    bool any_encoded = false;
+    for (int z = options.min_zoom; z <= options.max_zoom; ++z) {
+        fs::path zoom_dir = fs::path(options.root) / std::to_string(z);
+        if (!fs::is_directory(zoom_dir, ec)) continue;
+        for (const auto& x_dir : fs::directory_iterator(zoom_dir, ec)) {
+            int x = 0;
+            if (!x_dir.is_directory(ec) || !parseIndex(x_dir.path().filename().string(), x)) continue;
+            for (const auto& y_dir : fs::directory_iterator(x_dir.path(), ec)) {
+                int y = 0;
+                if (!y_dir.is_directory(ec) || !parseIndex(y_dir.path().filename().string(), y)) continue;
+                available.insert(TileKey{z, x, y}.packed());
+                if (!any_encoded) any_encoded = fs::is_regular_file(y_dir.path() / "heightmap_encoded.png", ec);
+            }
+        }
+    }
+    if (available.empty()) {
+        std::cerr << "TileManager: no tiles under " << options.root << " for zoom " << options.min_zoom << "-" << options.max_zoom << std::endl;
+    }
+
+    // One height source for packed and PNG tiles alike, so every level is in the same units
+    height_source = pack.isOpen() ? pack.getHeightSource() : TerrainHeightSource::None;
+    if (height_source == TerrainHeightSource::None) height_source = any_encoded ? TerrainHeightSource::Encoded : TerrainHeightSource::Heightmap8;
+}
+
+// --- Tile geometry ---
+double TileManager::groundTileSize(const TileKey& key) {
+    double tiles = std::ldexp(1.0, key.z);
+    double latitude = std::atan(std::sinh(PI * (1.0 - 2.0 * (key.y + 0.5) / tiles)));
+    return EARTH_CIRCUMFERENCE * std::cos(latitude) / tiles;
+}
+
+double TileManager::tileSize(int zoom) const {
+    return std::ldexp(options.anchor_tile_size, options.anchor.z - zoom);
+}
+
+TileKey TileManager::tileAt(int zoom, float world_x, float world_z) const {
+    double size = tileSize(zoom);
+    double half_anchor = options.anchor_tile_size * 0.5;
+    double anchor_x = std::ldexp(static_cast<double>(options.anchor.x), zoom - options.anchor.z);
+    double anchor_y = std::ldexp(static_cast<double>(options.anchor.y), zoom - options.anchor.z);
+    TileKey key;
+    key.z = zoom;
+    key.x = static_cast<int>(std::floor(anchor_x + (world_x + half_anchor) / size));
+    key.y = static_cast<int>(std::floor(anchor_y + (half_anchor - world_z) / size));
+    return key;
+}
+
+void TileManager::tileBounds(const TileKey& key, glm::vec2& world_min, glm::vec2& world_max) const {
+    double size = tileSize(key.z);
+    double half_anchor = options.anchor_tile_size * 0.5;
+    double anchor_x = std::ldexp(static_cast<double>(options.anchor.x), key.z - options.anchor.z);
+    double anchor_y = std::ldexp(static_cast<double>(options.anchor.y), key.z - options.anchor.z);
+    double min_x = (key.x - anchor_x) * size - half_anchor;
+    double max_z = half_anchor - (key.y - anchor_y) * size;
+    world_min = glm::vec2(static_cast<float>(min_x), static_cast<float>(max_z - size));
+    world_max = glm::vec2(static_cast<float>(min_x + size), static_cast<float>(max_z));
+}
+
+// --- Render thread ---
+void TileManager::update(const glm::vec3& camera_position) {
+    FS_TRACE_ZONE("TileManager::update");
+    // 1. Take finished tiles from the workers (only a swap under the lock)
+    std::vector<std::shared_ptr<TerrainTile>> done;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.swap(finished);
+    }
+    for (auto& tile : done) {
+        if (tile->bytes() == 0) {
+            available.erase(tile->key.packed()); // Nothing decodable: do not ask again
+            continue;
+        }
+        insert(std::move(tile));
+    }
+
+    // 2. Wanted tiles: a ring per zoom level, finer zooms only while the camera is low enough
+    wanted.clear();
+    wanted_set.clear();
+    std::vector<Request> requests;
+    size_t wanted_resident_bytes = 0;
+    for (int z = options.min_zoom; z <= options.max_zoom; ++z) {
+        double size = tileSize(z);
+        if (z > options.min_zoom && camera_position.y > options.lod_height_factor * size) break;
+        TileKey center = tileAt(z, camera_position.x, camera_position.z);
+        for (int dy = -options.ring_radius; dy <= options.ring_radius; ++dy) {
+            for (int dx = -options.ring_radius; dx <= options.ring_radius; ++dx) {
+                TileKey key{z, center.x + dx, center.y + dy};
+                uint64_t id = key.packed();
+                if (!available.count(id)) continue;
+                wanted.push_back(key);
+                wanted_set.insert(id);
+                auto it = cache.find(id);
+                if (it != cache.end()) {
+                    touch(it->second);
+                    wanted_resident_bytes += it->second.tile->bytes();
+                    continue;
+                }
+                // Coarse zooms first, then distance to the tile centre in tile widths
+                glm::vec2 lo, hi;
+                tileBounds(key, lo, hi);
+                glm::vec2 to_center = (lo + hi) * 0.5f - glm::vec2(camera_position.x, camera_position.z);
+                double priority = (z - options.min_zoom) * 1.0e6 + glm::length(to_center) / size;
+                requests.push_back({key, priority});
+            }
+        }
+    }
+
+    // 3. Queue what is missing, best first, while it still fits the budget
+    std::sort(requests.begin(), requests.end(), [](const Request& a, const Request& b) { return a.priority < b.priority; });
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t projected = wanted_resident_bytes + in_flight.size() * typical_tile_bytes;
+        queue.clear();
+        for (const Request& request : requests) {
+            uint64_t id = request.key.packed();
+            if (in_flight.count(id)) continue;
+            // Finished since the swap above: collected next frame
+            if (std::any_of(finished.begin(), finished.end(), [id](const auto& tile) { return tile->key.packed() == id; })) continue;
+            if (typical_tile_bytes > 0 && projected + typical_tile_bytes > options.byte_budget) break;
+            projected += typical_tile_bytes;
+            queue.push_back(request);
+        }
+        std::reverse(queue.begin(), queue.end()); // Workers pop the back
+    }
+    if (!queue.empty()) work_available.notify_all();
+
+    // 4. Make room
+    evictOverBudget();
+}
+
+std::shared_ptr<const TerrainTile> TileManager::find(const TileKey& key) {
+    auto it = cache.find(key.packed());
+    if (it == cache.end()) return nullptr;
+    touch(it->second);
+    return it->second.tile;
+}
+
+void TileManager::takeArrivals(std::vector<std::shared_ptr<const TerrainTile>>& out) {
+    out.insert(out.end(), arrivals.begin(), arrivals.end());
+    arrivals.clear();
+}
+
+void TileManager::takeEvictions(std::vector<TileKey>& out) {
+    out.insert(out.end(), evictions.begin(), evictions.end());
+    evictions.clear();
+}
+
+void TileManager::touch(CacheEntry& entry) {
+    lru_order.splice(lru_order.begin(), lru_order, entry.lru);
+}
+
+void TileManager::insert(std::shared_ptr<TerrainTile> tile) {
+    uint64_t id = tile->key.packed();
+    if (cache.count(id)) return;
+    size_t bytes = tile->bytes();
+    typical_tile_bytes = std::max(typical_tile_bytes, bytes);
+    lru_order.push_front(id);
+    CacheEntry entry;
+    entry.tile = std::move(tile);
+    entry.lru = lru_order.begin();
+    arrivals.push_back(entry.tile);
+    cache.emplace(id, std::move(entry));
+    resident_bytes += bytes;
+}
+
+void TileManager::evictOverBudget() {
+    // Oldest first; wanted tiles stay even over budget (requests are already budgeted)
+    auto it = lru_order.end();
+    while (resident_bytes > options.byte_budget && it != lru_order.begin()) {
+        --it;
+        uint64_t id = *it;
+        if (wanted_set.count(id)) continue;
+        auto entry = cache.find(id);
+        const TerrainTile& tile = *entry->second.tile;
+        resident_bytes -= tile.bytes();
+        // A tile nobody has picked up yet is simply withdrawn
+        auto pending = std::find(arrivals.begin(), arrivals.end(), entry->second.tile);
+        if (pending != arrivals.end()) arrivals.erase(pending);
+        else evictions.push_back(tile.key);
+        cache.erase(entry);
+        it = lru_order.erase(it);
+        ++evicted_count;
+    }
+}
+
+void TileManager::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return queue.empty() && in_flight.empty(); });
+}
+
+TileManager::Stats TileManager::getStats() const {
+    Stats stats;
+    stats.resident_tiles = cache.size();
+    stats.resident_bytes = resident_bytes;
+    stats.wanted_tiles = wanted.size();
+    stats.evicted = evicted_count;
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.queued = queue.size();
+    stats.in_flight = in_flight.size();
+    stats.loaded = loaded_count;
+    stats.failed = failed_count;
+    stats.decode_ms = decode_ms;
+    return stats;
+}
+
+// --- Workers ---
+void TileManager::workerLoop() {
+    FS_TRACE_THREAD("TileManager worker");
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        work_available.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping) return;
+        TileKey key = queue.back().key;
+        queue.pop_back();
+        in_flight.insert(key.packed());
+        lock.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<TerrainTile> tile = loadTile(key);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        in_flight.erase(key.packed());
+        finished.push_back(std::move(tile));
+        ++loaded_count;
+        if (finished.back()->bytes() == 0) ++failed_count;
+        decode_ms += ms;
+        if (queue.empty() && in_flight.empty()) idle.notify_all();
+    }
+}
+
+std::shared_ptr<TerrainTile> TileManager::loadTile(const TileKey& key) const {
+    FS_TRACE_ZONE_VALUE("tile load", key.z);
+    namespace fs = std::filesystem;
+    if (const TerrainPackEntry* entry = pack.isOpen() ? pack.find(key.z, key.x, key.y) : nullptr) return loadPackedTile(key, *entry);
+    fs::path dir = fs::path(options.root) / std::to_string(key.z) / std::to_string(key.x) / std::to_string(key.y);
+    auto tile = std::make_shared<TerrainTile>();
+    tile->key = key;
+    tileBounds(key, tile->world_min, tile->world_max);
+    if (height_source == TerrainHeightSource::Encoded) {
+        // Terrarium RGB to metres here on the worker, like the pack stores them
+        TileImage encoded = decodeLayer(dir / "heightmap_encoded.png");
+        if (encoded.channels >= 3) {
+            tile->height_width = encoded.width;
+            tile->height_height = encoded.height;
+            tile->heights.resize(static_cast<size_t>(encoded.width) * encoded.height);
+            for (size_t i = 0; i < tile->heights.size(); ++i) {
+                tile->heights[i] = TerrainPack::terrariumMetres(&encoded.pixels[i * encoded.channels]);
+            }
+            auto range = std::minmax_element(tile->heights.begin(), tile->heights.end());
+            tile->min_height = *range.first;
+            tile->max_height = *range.second;
+        }
+    } else {
+        tile->heightmap = decodeLayer(dir / "heightmap.png");
+    }
+    if (!tile->heightmap.empty()) {
+        // Culling range in metres, as terrain.vert scales heightmap.png (first channel)
+        const TileImage& image = tile->heightmap;
+        uint8_t lo = 255, hi = 0;
+        for (size_t i = 0; i < image.pixels.size(); i += static_cast<size_t>(image.channels)) {
+            lo = std::min(lo, image.pixels[i]);
+            hi = std::max(hi, image.pixels[i]);
+        }
+        tile->min_height = lo * (TerrainConfig::MAX_HEIGHT / 255.0f);
+        tile->max_height = hi * (TerrainConfig::MAX_HEIGHT / 255.0f);
+    }
+    tile->normalmap = decodeLayer(dir / "normalmap.png");
+    tile->texture = decodeLayer(dir / "texture.png");
+    return tile;
+}
+
+// Copies out of the mapping (the pages are read once, nothing is decoded)
+std::shared_ptr<TerrainTile> TileManager::loadPackedTile(const TileKey& key, const TerrainPackEntry& entry) const {
+    auto tile = std::make_shared<TerrainTile>();
+    tile->key = key;
+    tileBounds(key, tile->world_min, tile->world_max);
+    pack.readHeights(entry, tile->heights);
+    if (!tile->heights.empty()) {
+        tile->height_width = static_cast<int>(entry.height_width);
+        tile->height_height = static_cast<int>(entry.height_height);
+        tile->min_height = entry.min_height;
+        tile->max_height = entry.max_height;
+    }
+    auto copyLayer = [this](const TerrainPackLayer& layer, TileImage& image) {
+        const uint8_t* data = pack.layerData(layer);
+        if (!data) return;
+        image.width = static_cast<int>(layer.width);
+        image.height = static_cast<int>(layer.height);
+        image.channels = static_cast<int>(layer.channels);
+        image.pixels.assign(data, data + layer.size);
+    };
+    copyLayer(entry.normalmap, tile->normalmap);
+    copyLayer(entry.texture, tile->texture);
+    return tile;
+}
@@ -0,0 +1,192 @@
+#ifndef TILE_MANAGER_H
+#define TILE_MANAGER_H
+
+#include "TerrainConfig.h"
+#include "TerrainPack.h"
+#include <glm/glm.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Slippy-map tile address: zoom, column (east), row (south)
+struct TileKey {
+    int z = 0;
+    int x = 0;
+    int y = 0;
+
+    uint64_t packed() const { return (static_cast<uint64_t>(z) << 56) | (static_cast<uint64_t>(x) << 28) | static_cast<uint64_t>(y); }
+    bool operator==(const TileKey& other) const { return z == other.z && x == other.x && y == other.y; }
+};
+
+// Decoded 8-bit image, rows in OpenGL order (first row = bottom of the file image), like Texture
+struct TileImage {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<uint8_t> pixels;
+
+    bool empty() const { return pixels.empty(); }
+};
+
+// One z/x/y directory, decoded. Layers missing on disk stay empty.
+// Heights come from one source for every tile (TileManager::getHeightSource): 8-bit
+// heightmap.png in `heightmap`, or metres in `heights`.
+struct TerrainTile {
+    TileKey key;
+    glm::vec2 world_min{0.0f}; // World X/Z covered by the tile
+    glm::vec2 world_max{0.0f};
+    TileImage heightmap;       // heightmap.png (Heightmap8 source, not packed)
+    TileImage normalmap;
+    TileImage texture;
+
+    // From the terrain pack or heightmap_encoded.png instead of `heightmap`: metres, rows in
+    // OpenGL order. Not normalized to TerrainConfig::MAX_HEIGHT: Terrain samples them with
+    // u_MaxHeight = 1 rather than dividing every texel, and only outside the heightfield
+    // square (the physics ground is the 8-bit default set, which they need not agree with).
+    std::vector<float> heights;
+    int height_width = 0;
+    int height_height = 0;
+    float min_height = 0.0f;   // Metres, either source
+    float max_height = 0.0f;
+
+    size_t bytes() const {
+        return heightmap.pixels.size() + normalmap.pixels.size() + texture.pixels.size() + heights.size() * sizeof(float);
+    }
+};
+
+// Streams terrain tiles from <root>/<z>/<x>/<y>/ around the camera. If the terrain pack
+// (pack_path, see TerrainPack.h) exists, tiles it contains are read from it by offset instead
+// of decoding their PNGs, with heights in metres.
+//
+// World placement: the anchor tile is centred on the world origin and is anchor_tile_size
+// metres wide; a tile at zoom z is anchor_tile_size / 2^(z - anchor.z) wide. Tile columns grow
+// toward +X, rows toward -Z (rows run north to south and +Z is north: the top of a tile image
+// is at its +Z edge). By default the anchor tile keeps its real ground width (groundTileSize),
+// so the pyramid reaches well past the 40 km default set; Terrain draws tiles only outside it.
+//
+// update() (render thread, once per frame) works out the wanted tiles per zoom level, queues
+// the missing ones for the worker threads nearest-first (coarse zooms before fine), moves
+// finished tiles into the cache and evicts least-recently-used tiles that are no longer
+// wanted once the cache exceeds its byte budget. It never waits on a worker: decoding and
+// file I/O happen entirely on the workers. The render thread picks up tiles that became
+// resident with takeArrivals() and drops GPU copies of evicted ones via takeEvictions().
+class TileManager {
+public:
+    struct Options {
+        std::string root = "assets/textures/terrain/data/";
+        std::string pack_path = "assets/textures/terrain/data.ftp"; // FlightSimHeadless pack-terrain; optional
+        TileKey anchor{TerrainConfig::TILE_ANCHOR_ZOOM, TerrainConfig::TILE_ANCHOR_X, TerrainConfig::TILE_ANCHOR_Y};
+        double anchor_tile_size = 0.0; // m; 0 = groundTileSize(anchor)
+        int min_zoom = TerrainConfig::TILE_ANCHOR_ZOOM;
+        int max_zoom = 12;
+        int ring_radius = 1;             // Wanted tiles per zoom: (2r + 1)^2 around the camera's tile
+        float lod_height_factor = 1.0f;  // Zoom z is wanted while height above 0 < factor * tile width
+        size_t byte_budget = 256u << 20; // Decoded bytes kept resident
+        int worker_count = 2;
+    };
+
+    struct Stats {
+        size_t resident_tiles = 0;
+        size_t resident_bytes = 0;
+        size_t wanted_tiles = 0;
+        size_t queued = 0;       // Waiting for a worker
+        size_t in_flight = 0;    // Being decoded
+        uint64_t loaded = 0;     // Tiles decoded since construction
+        uint64_t evicted = 0;
+        uint64_t failed = 0;     // Tiles whose every layer failed to decode
+        double decode_ms = 0.0;  // Worker time spent in file I/O + decode
+    };
+
+    TileManager();
+    explicit TileManager(Options options);
+    ~TileManager(); // Drops queued requests, waits for tiles being decoded
+
+    TileManager(const TileManager&) = delete;
+    TileManager& operator=(const TileManager&) = delete;
+
+    // Render thread, once per frame
+    void update(const glm::vec3& camera_position);
+
+    // Resident tile (marks it recently used), or null
+    std::shared_ptr<const TerrainTile> find(const TileKey& key);
+    // Tiles that became resident / were evicted since the last call (each reported once)
+    void takeArrivals(std::vector<std::shared_ptr<const TerrainTile>>& out);
+    void takeEvictions(std::vector<TileKey>& out);
+
+    // Block until nothing is queued or in flight (tools and tests, not the frame loop)
+    void waitIdle();
+
+    // --- Tile geometry ---
+    // Ground width (m) of a slippy-map tile at its centre latitude (Web Mercator)
+    static double groundTileSize(const TileKey& key);
+    double tileSize(int zoom) const;
+    TileKey tileAt(int zoom, float world_x, float world_z) const;
+    void tileBounds(const TileKey& key, glm::vec2& world_min, glm::vec2& world_max) const;
+
+    bool isAvailable(const TileKey& key) const { return available.count(key.packed()) != 0; }
+    size_t getAvailableCount() const { return available.size(); }
+    const std::vector<TileKey>& getWanted() const { return wanted; }
+    Stats getStats() const;
+    const Options& getOptions() const { return options; }
+    // Where tile heights come from: the pack's source if one is open, else Encoded if any tile
+    // directory has heightmap_encoded.png, else Heightmap8 (as TerrainPack::build picks)
+    TerrainHeightSource getHeightSource() const { return height_source; }
+
+private:
+    struct Request {
+        TileKey key;
+        double priority; // Lower first
+    };
+    struct CacheEntry {
+        std::shared_ptr<const TerrainTile> tile;
+        std::list<uint64_t>::iterator lru; // Position in lru_order
+    };
+
+    Options options;
+    TerrainPack pack;                       // Read-only once opened: shared by the workers
+    std::unordered_set<uint64_t> available; // Tiles in the pack or with a directory on disk (scanned once)
+    TerrainHeightSource height_source = TerrainHeightSource::None;
+
+    // --- Render thread only ---
+    std::unordered_map<uint64_t, CacheEntry> cache;
+    std::list<uint64_t> lru_order; // Front = most recently used
+    size_t resident_bytes = 0;
+    std::vector<TileKey> wanted;
+    std::unordered_set<uint64_t> wanted_set;
+    std::vector<std::shared_ptr<const TerrainTile>> arrivals;
+    std::vector<TileKey> evictions;
+    uint64_t evicted_count = 0;
+    size_t typical_tile_bytes = 0; // Estimate for budgeting requests, from the tiles seen so far
+
+    // --- Shared with the workers (guarded by mutex) ---
+    mutable std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable idle;
+    std::vector<Request> queue;                      // Sorted, best last
+    std::unordered_set<uint64_t> in_flight;
+    std::vector<std::shared_ptr<TerrainTile>> finished;
+    uint64_t loaded_count = 0;
+    uint64_t failed_count = 0;
+    double decode_ms = 0.0;
+    bool stopping = false;
+
+    std::vector<std::thread> workers;
+
+    void scanAvailable();
+    void workerLoop();
+    std::shared_ptr<TerrainTile> loadTile(const TileKey& key) const;
+    std::shared_ptr<TerrainTile> loadPackedTile(const TileKey& key, const TerrainPackEntry& entry) const;
+    void touch(CacheEntry& entry);
+    void insert(std::shared_ptr<TerrainTile> tile);
+    void evictOverBudget();
+};
+
+#endif // TILE_MANAGER_H
@@ -0,0 +1,248 @@
+#include "Trace.h"
+#include <iostream>
+
+#ifdef FLIGHTSIM_TRACE
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Fields are relaxed atomics so dump() can read a slot its owner is rewriting; the owner
+// publishes each event with a release store of `head`
+struct Slot {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> start{0};
+    std::atomic<uint64_t> duration{0};
+    std::atomic<int64_t> value{Trace::NO_VALUE};
+};
+
+struct ThreadBuffer {
+    std::atomic<uint64_t> head{0}; // Events ever recorded; slot = index % capacity
+    std::unique_ptr<Slot[]> slots;  // Set on the first zone, under registry_mutex
+    size_t capacity = 0;
+    std::atomic<const char*> name{nullptr};
+    uint32_t tid = 0;
+};
+
+struct Event {
+    const char* name;
+    uint64_t start;
+    uint64_t duration;
+    int64_t value;
+    uint32_t tid;
+};
+
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry; // Live threads
+size_t events_per_thread = Trace::DEFAULT_EVENTS_PER_THREAD;
+std::vector<std::unique_ptr<Slot[]>> free_rings;        // Exited threads' rings, events_per_thread each
+std::deque<Event> retired_events;                        // Exited threads' events, the most recent events_per_thread
+std::vector<std::pair<uint32_t, const char*>> retired_threads;
+uint32_t next_tid = 0;
+thread_local ThreadBuffer* thread_buffer = nullptr;
+thread_local bool thread_retired = false; // Set once this thread's buffer is handed back
+
+void snapshot(const ThreadBuffer& buffer, std::vector<Event>& out, bool writer_active = true);
+
+// Hands the calling thread's buffer back when the thread exits (a pool may be joined long
+// before the exit dump). Runs on that thread: zones recorded later in its teardown (other
+// thread_local or static destructors) are dropped instead of touching the freed buffer.
+void retireThread(ThreadBuffer* buffer) {
+    thread_buffer = nullptr;
+    thread_retired = true;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto it = std::find_if(registry.begin(), registry.end(), [buffer](const auto& live) { return live.get() == buffer; });
+    if (it == registry.end()) return;
+    if (buffer->slots) {
+        std::vector<Event> events;
+        snapshot(*buffer, events, false); // Its writer is this thread: nothing is dropped
+        retired_events.insert(retired_events.end(), events.begin(), events.end());
+        if (retired_events.size() > events_per_thread) {
+            retired_events.erase(retired_events.begin(), retired_events.begin() + static_cast<std::ptrdiff_t>(retired_events.size() - events_per_thread));
+        }
+        if (buffer->head.load(std::memory_order_relaxed) > 0) retired_threads.emplace_back(buffer->tid, buffer->name.load(std::memory_order_relaxed));
+        if (buffer->capacity == events_per_thread) free_rings.push_back(std::move(buffer->slots));
+    }
+    registry.erase(it);
+}
+
+struct ThreadExit {
+    ThreadBuffer* buffer = nullptr;
+    ~ThreadExit() {
+        if (buffer) retireThread(buffer);
+    }
+};
+thread_local ThreadExit thread_exit;
+
+ThreadBuffer* registerThread() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry.push_back(std::make_unique<ThreadBuffer>());
+    registry.back()->tid = ++next_tid;
+    thread_buffer = registry.back().get();
+    thread_exit.buffer = thread_buffer;
+    return thread_buffer;
+}
+
+// Null once the thread has retired its buffer
+ThreadBuffer* localBuffer() {
+    if (thread_buffer) return thread_buffer;
+    return thread_retired ? nullptr : registerThread();
+}
+
+void allocateRing(ThreadBuffer& buffer) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    buffer.capacity = events_per_thread;
+    if (!free_rings.empty()) {
+        buffer.slots = std::move(free_rings.back());
+        free_rings.pop_back();
+    } else {
+        buffer.slots.reset(new Slot[buffer.capacity]);
+    }
+}
+
+// Consistent snapshot of one ring without stopping its writer
+// (registry_mutex held: the ring itself does not change under it)
+void snapshot(const ThreadBuffer& buffer, std::vector<Event>& out, bool writer_active) {
+    if (!buffer.slots) return;
+    const uint64_t capacity = buffer.capacity;
+    uint64_t end = buffer.head.load(std::memory_order_acquire);
+    uint64_t begin = end > capacity ? end - capacity : 0;
+    size_t first = out.size();
+    for (uint64_t i = begin; i < end; ++i) {
+        const Slot& slot = buffer.slots[i % capacity];
+        out.push_back({slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+                       slot.duration.load(std::memory_order_relaxed), slot.value.load(std::memory_order_relaxed), buffer.tid});
+    }
+    // Slots the writer reached again while we copied hold newer events: drop them. That
+    // includes slot now_head, which record() fills before it publishes now_head + 1.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t now_head = buffer.head.load(std::memory_order_relaxed) + (writer_active ? 1 : 0);
+    uint64_t overwritten = now_head > capacity ? now_head - capacity : 0;
+    if (overwritten > begin) {
+        size_t drop = static_cast<size_t>(std::min(overwritten - begin, end - begin));
+        out.erase(out.begin() + static_cast<std::ptrdiff_t>(first), out.begin() + static_cast<std::ptrdiff_t>(first + drop));
+    }
+}
+
+void writeString(std::FILE* file, const char* text) {
+    std::fputc('"', file);
+    for (const char* c = text ? text : "?"; *c; ++c) {
+        if (*c == '"' || *c == '\\') std::fputc('\\', file);
+        if (static_cast<unsigned char>(*c) >= 0x20) std::fputc(*c, file);
+    }
+    std::fputc('"', file);
+}
+
+} // namespace
+
+bool Trace::isCompiledIn() {
+    return true;
+}
+
+void Trace::record(const char* name, uint64_t start_ns, uint64_t end_ns, int64_t value) {
+    ThreadBuffer* local = localBuffer();
+    if (!local) return;
+    ThreadBuffer& buffer = *local;
+    if (!buffer.slots) allocateRing(buffer);
+    uint64_t index = buffer.head.load(std::memory_order_relaxed); // Only this thread writes it
+    // Orders the previous head store before the slot stores, so a snapshot that sees any of
+    // them also sees head >= index
+    std::atomic_thread_fence(std::memory_order_release);
+    Slot& slot = buffer.slots[index % buffer.capacity];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start_ns, std::memory_order_relaxed);
+    slot.duration.store(end_ns - start_ns, std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    buffer.head.store(index + 1, std::memory_order_release);
+}
+
+void Trace::setThreadName(const char* name) {
+    if (ThreadBuffer* buffer = localBuffer()) buffer->name.store(name, std::memory_order_relaxed);
+}
+
+void Trace::setEventsPerThread(size_t events) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    events_per_thread = std::max<size_t>(events, 1);
+    free_rings.clear(); // Wrong size now
+    if (retired_events.size() > events_per_thread) {
+        retired_events.erase(retired_events.begin(), retired_events.begin() + static_cast<std::ptrdiff_t>(retired_events.size() - events_per_thread));
+    }
+}
+
+bool Trace::dump(const std::string& path, size_t* events_written) {
+    std::vector<Event> events;
+    std::vector<std::pair<uint32_t, const char*>> threads;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        events.assign(retired_events.begin(), retired_events.end());
+        threads = retired_threads;
+        for (const auto& buffer : registry) {
+            snapshot(*buffer, events);
+            threads.emplace_back(buffer->tid, buffer->name.load(std::memory_order_relaxed));
+        }
+    }
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Error: Cannot create trace file " << path << std::endl;
+        return false;
+    }
+    uint64_t origin = UINT64_MAX;
+    for (const Event& event : events) origin = std::min(origin, event.start);
+
+    // Timestamps in microseconds since the earliest buffered event
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+    bool first = true;
+    for (const auto& [tid, name] : threads) {
+        std::fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", tid);
+        if (name) {
+            writeString(file, name);
+        } else {
+            std::fprintf(file, "\"thread %u\"", tid);
+        }
+        std::fputs("}}", file);
+        first = false;
+    }
+    for (const Event& event : events) {
+        std::fputs(first ? "{\"ph\":\"X\",\"name\":" : ",\n{\"ph\":\"X\",\"name\":", file);
+        writeString(file, event.name);
+        std::fprintf(file, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", event.tid, (event.start - origin) * 1e-3, event.duration * 1e-3);
+        if (event.value != NO_VALUE) std::fprintf(file, ",\"args\":{\"value\":%lld}", static_cast<long long>(event.value));
+        std::fputc('}', file);
+        first = false;
+    }
+    std::fputs("\n]}\n", file);
+    bool ok = std::ferror(file) == 0;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        std::cerr << "Error: Failed writing trace file " << path << std::endl;
+        return false;
+    }
+    if (events_written) *events_written = events.size();
+    return true;
+}
+
+#else // Tracing compiled out
+
+bool Trace::isCompiledIn() {
+    return false;
+}
+
+void Trace::record(const char*, uint64_t, uint64_t, int64_t) {}
+
+void Trace::setThreadName(const char*) {}
+
+void Trace::setEventsPerThread(size_t) {}
+
+bool Trace::dump(const std::string& path, size_t* events_written) {
+    if (events_written) *events_written = 0;
+    std::cerr << "Error: Cannot write " << path << ": tracing is not compiled in (configure with -DFLIGHTSIM_ENABLE_TRACE=ON)" << std::endl;
+    return false;
+}
+
+#endif // FLIGHTSIM_TRACE
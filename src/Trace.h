@@ -0,0 +1,74 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Scoped trace zones for offline analysis of long runs, written as Chrome trace JSON
+// (chrome://tracing, ui.perfetto.dev).
+//
+// Compiled in only with -DFLIGHTSIM_ENABLE_TRACE=ON (defines FLIGHTSIM_TRACE); otherwise the
+// FS_TRACE_* macros expand to nothing and dump() just reports that tracing is unavailable.
+//
+// Each thread records into its own fixed ring of completed zones (setEventsPerThread, default
+// DEFAULT_EVENTS_PER_THREAD), allocated on its first zone: no locks, no allocation after that.
+// A full ring overwrites its oldest events, so a soak run keeps its most recent history. When a
+// thread exits, its events move to a shared store of the same capacity (most recent kept) and
+// its ring is reused by the next thread that records. dump() may run while other threads keep
+// recording: events overwritten during the copy are detected and left out.
+//
+//   FS_TRACE_ZONE("Terrain::draw");          // Until the end of the enclosing block
+//   FS_TRACE_ZONE_VALUE("Terrain level", l); // Same, with an integer shown as args.value
+//   FS_TRACE_THREAD("TileManager worker");   // Name the calling thread in the trace
+class Trace {
+public:
+    static constexpr size_t DEFAULT_EVENTS_PER_THREAD = size_t(1) << 17; // 4 MB per recording thread
+    static constexpr int64_t NO_VALUE = INT64_MIN;
+
+    static bool isCompiledIn();
+
+    // Write every thread's buffered events to `path`. Returns false (and logs) on failure or
+    // when tracing is compiled out. `events_written` receives the event count.
+    static bool dump(const std::string& path, size_t* events_written = nullptr);
+
+    static void setThreadName(const char* name); // String literal (kept by pointer)
+
+    // Ring capacity for threads that record their first zone from now on (at least 1)
+    static void setEventsPerThread(size_t events);
+
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Append one completed zone to the calling thread's ring
+    static void record(const char* name, uint64_t start_ns, uint64_t end_ns, int64_t value);
+
+    class Zone {
+    public:
+        explicit Zone(const char* zone_name, int64_t zone_value = NO_VALUE) : name(zone_name), value(zone_value), start(now()) {}
+        ~Zone() { record(name, start, now(), value); }
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+    private:
+        const char* name;
+        int64_t value;
+        uint64_t start;
+    };
+};
+
+#define FS_TRACE_CONCAT_INNER(a, b) a##b
+#define FS_TRACE_CONCAT(a, b) FS_TRACE_CONCAT_INNER(a, b)
+
+#ifdef FLIGHTSIM_TRACE
+#define FS_TRACE_ZONE(name) Trace::Zone FS_TRACE_CONCAT(fs_trace_zone_, __LINE__)(name)
+#define FS_TRACE_ZONE_VALUE(name, value) Trace::Zone FS_TRACE_CONCAT(fs_trace_zone_, __LINE__)(name, static_cast<int64_t>(value))
+#define FS_TRACE_THREAD(name) Trace::setThreadName(name)
+#else
+#define FS_TRACE_ZONE(name) ((void)0)
+#define FS_TRACE_ZONE_VALUE(name, value) ((void)0)
+#define FS_TRACE_THREAD(name) ((void)0)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,308 @@
+#include "TrimSolver.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char TRIM_MAGIC[4] = {'F', 'S', 'T', 'R'};
+const uint32_t TRIM_VERSION = 1;
+
+// Unknown bounds: throttle, pitch (rad), elevator
+const glm::vec3 UNKNOWN_MIN(0.0f, glm::radians(-30.0f), -1.0f);
+const glm::vec3 UNKNOWN_MAX(1.0f, glm::radians(30.0f), 1.0f);
+const glm::vec3 MAX_NEWTON_STEP(0.2f, glm::radians(5.0f), 0.2f);
+const glm::vec3 JACOBIAN_DELTA(1e-3f, 1e-3f, 1e-3f);
+
+// Pitch acceleration (rad/s^2) is weighted so it counts like ~0.1 m/s^2 of linear acceleration
+const float PITCH_RESIDUAL_WEIGHT = 10.0f;
+
+// Perturbation sizes for the Jacobians, chosen well above float resolution at flight
+// speeds (velocity ~1e2 m/s, unit quaternion components)
+const float DELTA_POSITION = 1.0f;     // m (only altitude matters, through air density)
+const float DELTA_VELOCITY = 0.05f;    // m/s
+const float DELTA_ATTITUDE = 1e-3f;    // rad
+const float DELTA_RATE = 1e-3f;        // rad/s
+const float DELTA_INPUT = 1e-3f;
+
+float weightedNorm(const glm::vec3& r) {
+    return std::sqrt(r.x * r.x + r.y * r.y + PITCH_RESIDUAL_WEIGHT * PITCH_RESIDUAL_WEIGHT * r.z * r.z);
+}
+
+// Solve J * x = b (3x3, column-major as glm) by Cramer's rule in double precision
+bool solve3(const glm::mat3& J, const glm::vec3& b, glm::vec3& x) {
+    auto at = [&J](int row, int col) { return static_cast<double>(J[col][row]); };
+    double det = at(0, 0) * (at(1, 1) * at(2, 2) - at(1, 2) * at(2, 1))
+               - at(0, 1) * (at(1, 0) * at(2, 2) - at(1, 2) * at(2, 0))
+               + at(0, 2) * (at(1, 0) * at(2, 1) - at(1, 1) * at(2, 0));
+    if (std::abs(det) < 1e-12) return false;
+    for (int c = 0; c < 3; ++c) {
+        double m[3][3];
+        for (int r = 0; r < 3; ++r) {
+            for (int k = 0; k < 3; ++k) m[r][k] = (k == c) ? b[r] : at(r, k);
+        }
+        double d = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+                 - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+                 + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+        x[c] = static_cast<float>(d / det);
+    }
+    return true;
+}
+
+// Small rotation (body frame) taking `from` to `to`
+glm::vec3 attitudeError(const glm::quat& from, const glm::quat& to) {
+    glm::quat d = glm::inverse(from) * to;
+    if (d.w < 0.0f) d = -d; // Shortest way round
+    return 2.0f * glm::vec3(d.x, d.y, d.z);
+}
+
+glm::quat applyAttitude(const glm::quat& q, const glm::vec3& small_rotation_body) {
+    float angle = glm::length(small_rotation_body);
+    if (angle < 1e-12f) return q;
+    return glm::normalize(q * glm::angleAxis(angle, small_rotation_body / angle));
+}
+
+} // namespace
+
+TrimSolver::TrimSolver(AircraftFactoryFn aircraft_factory) :
+    factory(std::move(aircraft_factory))
+{
+}
+
+TrimSolver::TrimSolver(AircraftFactoryFn aircraft_factory, Options solver_options) :
+    factory(std::move(aircraft_factory)),
+    options(solver_options)
+{
+}
+
+glm::quat TrimSolver::levelAttitude(float pitch_rad) {
+    // Body +X forward, +Y right, +Z down -> world +X, +Z, -Y; then pitch about the body right axis
+    glm::quat level = glm::angleAxis(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    return level * glm::angleAxis(pitch_rad, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+TrimSolver::State TrimSolver::stepFrom(Aircraft& aircraft, const State& state, const ControlInputs& controls) const {
+    aircraft.position_world = state.position;
+    aircraft.velocity_world = state.velocity;
+    aircraft.orientation_world = state.orientation;
+    aircraft.angular_velocity_body = state.angular_velocity;
+    aircraft.controls = controls;
+    aircraft.clearAccumulators();
+    aircraft.update(options.dt);
+    return {aircraft.position_world, aircraft.velocity_world, aircraft.orientation_world, aircraft.angular_velocity_body};
+}
+
+// Forward and vertical acceleration (world) and pitch acceleration (body) after one step
+glm::vec3 TrimSolver::trimResidual(Aircraft& aircraft, float speed, float altitude, const glm::vec3& unknowns) const {
+    State start{glm::vec3(0.0f, altitude, 0.0f), glm::vec3(speed, 0.0f, 0.0f), levelAttitude(unknowns.y), glm::vec3(0.0f)};
+    ControlInputs controls;
+    controls.throttle = unknowns.x;
+    controls.pitch = unknowns.z;
+    State next = stepFrom(aircraft, start, controls);
+
+    glm::vec3 acceleration = (next.velocity - start.velocity) / options.dt;
+    glm::vec3 angular_acceleration = (next.angular_velocity - start.angular_velocity) / options.dt;
+    return glm::vec3(acceleration.x, acceleration.y, angular_acceleration.y);
+}
+
+TrimPoint TrimSolver::solve(float speed, float altitude) const {
+    TrimPoint point;
+    point.speed = speed;
+    point.altitude = altitude;
+
+    std::unique_ptr<Aircraft> aircraft = factory();
+    if (!aircraft) return point;
+    aircraft->integrator = IntegratorType::SemiImplicitEuler; // Residuals assume v[k+1] = v[k] + a*dt
+
+    // --- Damped Newton iteration on (throttle, pitch, elevator) ---
+    glm::vec3 u(0.5f, glm::radians(2.0f), 0.0f);
+    glm::vec3 r = trimResidual(*aircraft, speed, altitude, u);
+    float norm = weightedNorm(r);
+
+    int iteration = 0;
+    for (; iteration < options.max_iterations && norm > options.tolerance; ++iteration) {
+        // Forward-difference Jacobian of the residual
+        glm::mat3 J(0.0f);
+        for (int c = 0; c < 3; ++c) {
+            glm::vec3 up = u;
+            float h = (up[c] + JACOBIAN_DELTA[c] > UNKNOWN_MAX[c]) ? -JACOBIAN_DELTA[c] : JACOBIAN_DELTA[c];
+            up[c] += h;
+            J[c] = (trimResidual(*aircraft, speed, altitude, up) - r) / h;
+        }
+
+        // Levenberg-Marquardt on the weighted residual: lambda = 0 is the plain Newton step,
+        // growing lambda bends it towards steepest descent when Newton overshoots or hits a bound
+        glm::mat3 Jw = J;
+        glm::vec3 rw = r;
+        for (int c = 0; c < 3; ++c) Jw[c].z *= PITCH_RESIDUAL_WEIGHT;
+        rw.z *= PITCH_RESIDUAL_WEIGHT;
+        glm::mat3 JtJ = glm::transpose(Jw) * Jw;
+        glm::vec3 gradient = glm::transpose(Jw) * rw;
+
+        bool improved = false;
+        for (float lambda = 0.0f; lambda < 1e6f && !improved; lambda = lambda == 0.0f ? 1e-3f : lambda * 10.0f) {
+            glm::mat3 damped = JtJ;
+            for (int d = 0; d < 3; ++d) damped[d][d] *= 1.0f + lambda;
+            glm::vec3 step;
+            if (!solve3(damped, -gradient, step)) continue;
+            step = glm::clamp(step, -MAX_NEWTON_STEP, MAX_NEWTON_STEP);
+
+            glm::vec3 candidate = glm::clamp(u + step, UNKNOWN_MIN, UNKNOWN_MAX);
+            glm::vec3 rc = trimResidual(*aircraft, speed, altitude, candidate);
+            float nc = weightedNorm(rc);
+            if (nc < norm) {
+                u = candidate;
+                r = rc;
+                norm = nc;
+                improved = true;
+            }
+        }
+        if (!improved) break; // Stalled at a bound or a local minimum: no trim with these controls
+    }
+
+    point.iterations = iteration;
+    point.throttle = u.x;
+    point.pitch = u.y;
+    point.elevator = u.z;
+    point.residual = norm;
+    point.converged = norm <= options.tolerance;
+
+    if (point.converged && options.linearize) linearize(*aircraft, point);
+    return point;
+}
+
+void TrimSolver::linearize(Aircraft& aircraft, TrimPoint& point) const {
+    constexpr int N = TrimPoint::STATE_COUNT;
+    constexpr int M = TrimPoint::INPUT_COUNT;
+
+    const State trim{glm::vec3(0.0f, point.altitude, 0.0f), glm::vec3(point.speed, 0.0f, 0.0f),
+                     levelAttitude(point.pitch), glm::vec3(0.0f)};
+    ControlInputs trim_controls;
+    trim_controls.throttle = point.throttle;
+    trim_controls.pitch = point.elevator;
+    const State nominal = stepFrom(aircraft, trim, trim_controls);
+
+    // Next-state deviation from the nominal step, as a 12-vector
+    auto deviation = [&nominal](const State& s, float out[N]) {
+        glm::vec3 dp = s.position - nominal.position;
+        glm::vec3 dv = s.velocity - nominal.velocity;
+        glm::vec3 da = attitudeError(nominal.orientation, s.orientation);
+        glm::vec3 dw = s.angular_velocity - nominal.angular_velocity;
+        for (int i = 0; i < 3; ++i) {
+            out[i] = dp[i]; out[3 + i] = dv[i]; out[6 + i] = da[i]; out[9 + i] = dw[i];
+        }
+    };
+
+    auto perturbState = [&trim](int index, float delta) {
+        State s = trim;
+        int axis = index % 3;
+        switch (index / 3) {
+            case 0: s.position[axis] += delta; break;
+            case 1: s.velocity[axis] += delta; break;
+            case 2: {
+                glm::vec3 rotation(0.0f);
+                rotation[axis] = delta;
+                s.orientation = applyAttitude(s.orientation, rotation);
+                break;
+            }
+            default: s.angular_velocity[axis] += delta; break;
+        }
+        return s;
+    };
+
+    const float state_delta[4] = {DELTA_POSITION, DELTA_VELOCITY, DELTA_ATTITUDE, DELTA_RATE};
+    float plus[N], minus[N];
+
+    // --- A: central differences over the state ---
+    for (int c = 0; c < N; ++c) {
+        float h = state_delta[c / 3];
+        deviation(stepFrom(aircraft, perturbState(c, h), trim_controls), plus);
+        deviation(stepFrom(aircraft, perturbState(c, -h), trim_controls), minus);
+        for (int r = 0; r < N; ++r) point.A[r * N + c] = (plus[r] - minus[r]) / (2.0f * h);
+    }
+
+    // Position rows: the step is x[k+1] = x[k] + dt * v[k+1]. At flight altitudes a float
+    // position cannot resolve dt-sized changes, so build the rows from the velocity rows.
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < N; ++c) {
+            point.A[r * N + c] = (c == r ? 1.0f : 0.0f) + options.dt * point.A[(3 + r) * N + c];
+        }
+    }
+
+    // --- B: central differences over the inputs ---
+    for (int c = 0; c < M; ++c) {
+        ControlInputs up = trim_controls, down = trim_controls;
+        float* up_axis[M] = {&up.throttle, &up.pitch, &up.roll, &up.yaw};
+        float* down_axis[M] = {&down.throttle, &down.pitch, &down.roll, &down.yaw};
+        *up_axis[c] += DELTA_INPUT;
+        *down_axis[c] -= DELTA_INPUT;
+        deviation(stepFrom(aircraft, trim, up), plus);
+        deviation(stepFrom(aircraft, trim, down), minus);
+        for (int r = 0; r < N; ++r) point.B[r * M + c] = (plus[r] - minus[r]) / (2.0f * DELTA_INPUT);
+    }
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < M; ++c) point.B[r * M + c] = options.dt * point.B[(3 + r) * M + c];
+    }
+}
+
+std::vector<TrimPoint> TrimSolver::solveGrid(const std::vector<float>& speeds, const std::vector<float>& altitudes, ThreadPool& pool) const {
+    std::vector<TrimPoint> points(speeds.size() * altitudes.size());
+    pool.parallelFor(points.size(), [&](size_t i) {
+        points[i] = solve(speeds[i / altitudes.size()], altitudes[i % altitudes.size()]);
+    });
+    return points;
+}
+
+// --- Output ---
+
+bool TrimSolver::writeCsv(const std::string& path, const std::vector<TrimPoint>& points) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Error: Failed to open trim output: " << path << std::endl;
+        return false;
+    }
+
+    constexpr int N = TrimPoint::STATE_COUNT;
+    constexpr int M = TrimPoint::INPUT_COUNT;
+    out << "speed_ms,altitude_m,converged,iterations,throttle,pitch_deg,elevator,residual";
+    for (int r = 0; r < N; ++r) for (int c = 0; c < N; ++c) out << ",A" << r << "_" << c;
+    for (int r = 0; r < N; ++r) for (int c = 0; c < M; ++c) out << ",B" << r << "_" << c;
+    out << "\n";
+
+    for (const auto& p : points) {
+        out << p.speed << ',' << p.altitude << ',' << p.converged << ',' << p.iterations << ','
+            << p.throttle << ',' << glm::degrees(p.pitch) << ',' << p.elevator << ',' << p.residual;
+        for (float a : p.A) out << ',' << a;
+        for (float b : p.B) out << ',' << b;
+        out << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool TrimSolver::writeBinary(const std::string& path, const std::vector<TrimPoint>& points, float dt) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Error: Failed to open trim output: " << path << std::endl;
+        return false;
+    }
+
+    uint32_t header[4] = {TRIM_VERSION, static_cast<uint32_t>(points.size()),
+                          static_cast<uint32_t>(TrimPoint::STATE_COUNT), static_cast<uint32_t>(TrimPoint::INPUT_COUNT)};
+    out.write(TRIM_MAGIC, 4);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(&dt), sizeof(float));
+
+    // Each record: speed, altitude, converged, iterations, throttle, pitch, elevator, residual, A, B (all f32)
+    std::vector<float> record;
+    for (const auto& p : points) {
+        record.assign({p.speed, p.altitude, p.converged ? 1.0f : 0.0f, static_cast<float>(p.iterations),
+                       p.throttle, p.pitch, p.elevator, p.residual});
+        record.insert(record.end(), p.A.begin(), p.A.end());
+        record.insert(record.end(), p.B.begin(), p.B.end());
+        out.write(reinterpret_cast<const char*>(record.data()), static_cast<std::streamsize>(record.size() * sizeof(float)));
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,84 @@
+#ifndef TRIM_SOLVER_H
+#define TRIM_SOLVER_H
+
+#include "Aircraft.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Trimmed straight-and-level flight at one (speed, altitude) and the discrete-time
+// linearization of Aircraft::update around it:  dx[k+1] = A dx[k] + B du[k]
+//   state  dx: position (3, world), velocity (3, world), attitude (3, small body-frame rotation),
+//              angular velocity (3, body)
+//   input  du: throttle, pitch, roll, yaw (ControlInputs order)
+struct TrimPoint {
+    static constexpr int STATE_COUNT = 12;
+    static constexpr int INPUT_COUNT = 4;
+
+    float speed = 0.0f;      // m/s (true airspeed, level)
+    float altitude = 0.0f;   // m
+    bool converged = false;
+    int iterations = 0;
+    float throttle = 0.0f;   // 0..1
+    float pitch = 0.0f;      // rad, nose-up attitude (= angle of attack in level flight)
+    float elevator = 0.0f;   // ControlInputs::pitch, -1..1
+    float residual = 0.0f;   // Weighted norm of the trim accelerations at the solution
+
+    std::array<float, STATE_COUNT * STATE_COUNT> A{}; // Row-major
+    std::array<float, STATE_COUNT * INPUT_COUNT> B{}; // Row-major
+};
+
+// Newton solver for throttle/pitch/elevator plus central-difference Jacobians.
+// Each evaluation builds its own Aircraft from the factory, so grid points are independent
+// and run in parallel on a ThreadPool.
+class TrimSolver {
+public:
+    using AircraftFactoryFn = std::function<std::unique_ptr<Aircraft>()>;
+
+    struct Options {
+        float dt = 1.0f / 120.0f;       // Step used for the residuals and the discrete A/B
+        int max_iterations = 50;
+        float tolerance = 1e-3f;        // Residual norm (m/s^2, with pitch acceleration weighted x10)
+        bool linearize = true;          // Compute A/B for converged points
+    };
+
+    explicit TrimSolver(AircraftFactoryFn factory);
+    TrimSolver(AircraftFactoryFn factory, Options options);
+
+    TrimPoint solve(float speed, float altitude) const;
+    // Every (speed, altitude) combination, speed-major order
+    std::vector<TrimPoint> solveGrid(const std::vector<float>& speeds, const std::vector<float>& altitudes, ThreadPool& pool) const;
+
+    // --- Output ---
+    static bool writeCsv(const std::string& path, const std::vector<TrimPoint>& points);
+    // "FSTR" | u32 version | u32 count | u32 states | u32 inputs | f32 dt | TrimPoint records (packed floats)
+    static bool writeBinary(const std::string& path, const std::vector<TrimPoint>& points, float dt);
+
+    // World orientation for wings-level flight heading along world +X, pitched nose-up by pitch_rad
+    static glm::quat levelAttitude(float pitch_rad);
+
+    const Options& getOptions() const { return options; }
+
+private:
+    AircraftFactoryFn factory;
+    Options options;
+
+    struct State {
+        glm::vec3 position;
+        glm::vec3 velocity;
+        glm::quat orientation;
+        glm::vec3 angular_velocity;
+    };
+
+    State stepFrom(Aircraft& aircraft, const State& state, const ControlInputs& controls) const;
+    glm::vec3 trimResidual(Aircraft& aircraft, float speed, float altitude, const glm::vec3& unknowns) const;
+    void linearize(Aircraft& aircraft, TrimPoint& point) const;
+};
+
+#endif // TRIM_SOLVER_H
@@ -1,36 +1,48 @@
 #include "Wing.h"
+#include "Trace.h"
 #include <cmath> // For std::asin
 #include <glm/gtx/vector_angle.hpp> // For angle (maybe not needed if using asin)
 #include <iostream> // For debug
 
-glm::vec3 Wing::calculateEffectiveNormal(float max_deflection_angle_deg) const {
-     if (flap_ratio <= 0.0f || std::abs(control_input) < 1e-6f) {
-         return base_normal_body; // No deflection
-     }
-
-     // Calculate deflection angle in radians
-     float deflection_rad = glm::radians(control_input * max_deflection_angle_deg);
-
-     // Determine the axis of rotation for the flap
+glm::vec3 Wing::getDeflectionAxisBody() const {
      // Assume flaps rotate around an axis parallel to the wing's leading/trailing edge
      // This axis is perpendicular to the normal and the span direction.
      // Guessing span direction is likely BODY_RIGHT or BODY_LEFT relative to normal.
      // If normal is UP, rotation axis is RIGHT. If normal is RIGHT (rudder), rotation axis is UP.
-     glm::vec3 rotation_axis;
      if (glm::abs(glm::dot(base_normal_body, PhysicsConfig::BODY_UP)) > 0.9f) {
          // Wing/Elevator (Normal is roughly Up/Down) - Rotate around Body Y (Right) axis
-         rotation_axis = PhysicsConfig::BODY_RIGHT;
+         return PhysicsConfig::BODY_RIGHT;
      } else if (glm::abs(glm::dot(base_normal_body, PhysicsConfig::BODY_RIGHT)) > 0.9f) {
           // Rudder (Normal is roughly Right/Left) - Rotate around Body Z (Up/Down)? Or X (Forward)? Let's assume Body UP (Z axis in OpenGL coords?)
           // This needs careful axis definition. If BODY_UP is (0,0,-1), need rotation axis perpendicular to RIGHT and UP. That's FORWARD (X).
           // Let's assume rotation around the axis most perpendicular to the normal and roughly "vertical" or "spanwise".
           // If normal is RIGHT, rotate around UP.
-           rotation_axis = PhysicsConfig::BODY_UP; // Check if BODY_UP is correct axis for rudder rotation
-     } else {
-         // Default guess: Perpendicular to normal and forward?
-         rotation_axis = glm::normalize(glm::cross(PhysicsConfig::BODY_FORWARD, base_normal_body));
+          return PhysicsConfig::BODY_UP; // Check if BODY_UP is correct axis for rudder rotation
+     }
+     // Default guess: Perpendicular to normal and forward?
+     return glm::normalize(glm::cross(PhysicsConfig::BODY_FORWARD, base_normal_body));
+}
+
+glm::vec3 Wing::getSpanAxisBody() const {
+    // What is span axis? If normal is UP, span is RIGHT. If normal is RIGHT (rudder), span is UP.
+    if (glm::abs(glm::dot(base_normal_body, PhysicsConfig::BODY_UP)) > 0.9f) {
+        return PhysicsConfig::BODY_RIGHT; // Wing/Elevator span
+    } else if (glm::abs(glm::dot(base_normal_body, PhysicsConfig::BODY_RIGHT)) > 0.9f) {
+        return PhysicsConfig::BODY_UP; // Rudder span (vertical)
+    }
+    return glm::normalize(glm::cross(base_normal_body, PhysicsConfig::BODY_FORWARD)); // Default guess
+}
+
+glm::vec3 Wing::calculateEffectiveNormal(float max_deflection_angle_deg) const {
+     if (flap_ratio <= 0.0f || std::abs(control_input) < 1e-6f) {
+         return base_normal_body; // No deflection
      }
 
+     // Calculate deflection angle in radians
+     float deflection_rad = glm::radians(control_input * max_deflection_angle_deg);
+
+     // Determine the axis of rotation for the flap
+     glm::vec3 rotation_axis = getDeflectionAxisBody();
 
      // Create rotation quaternion
      glm::quat deflection_rot = glm::angleAxis(deflection_rad, rotation_axis);
@@ -41,6 +53,7 @@ glm::vec3 Wing::calculateEffectiveNormal(float max_deflection_angle_deg) const {
 
 
 void Wing::applyForces(RigidBody* rigid_body, float max_deflection_angle_deg) const {
+    FS_TRACE_ZONE("Wing::applyForces");
     if (!rigid_body || area < 1e-6f) return;
 
     // 1. Calculate velocity of the wing's center of pressure in world space
@@ -123,14 +136,7 @@ void Wing::applyForces(RigidBody* rigid_body, float max_deflection_angle_deg) co
     // Can be found by: cross(cross(velocity_dir, normal), velocity_dir) -> normalized
     // Or simpler (from blog): Lift is perpendicular to drag_dir and the wing's span axis.
     // What is span axis? If normal is UP, span is RIGHT. If normal is RIGHT (rudder), span is UP.
-    glm::vec3 span_dir_body; // Wing's span direction in body coords
-     if (glm::abs(glm::dot(base_normal_body, PhysicsConfig::BODY_UP)) > 0.9f) {
-         span_dir_body = PhysicsConfig::BODY_RIGHT; // Wing/Elevator span
-     } else if (glm::abs(glm::dot(base_normal_body, PhysicsConfig::BODY_RIGHT)) > 0.9f) {
-         span_dir_body = PhysicsConfig::BODY_UP; // Rudder span (vertical)
-     } else {
-         span_dir_body = glm::normalize(glm::cross(base_normal_body, PhysicsConfig::BODY_FORWARD)); // Default guess
-     }
+    glm::vec3 span_dir_body = getSpanAxisBody(); // Wing's span direction in body coords
     glm::vec3 span_dir_world = rigid_body->bodyToWorldDir(span_dir_body);
     glm::vec3 lift_direction_world = glm::normalize(glm::cross(drag_direction_world, span_dir_world));
 
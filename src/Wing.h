@@ -64,10 +64,16 @@ public:
         control_input = std::clamp(input, -1.0f, 1.0f);
     }
 
-    // Calculate and apply aerodynamic forces to the rigid body
+    // Calculate and apply aerodynamic forces to the rigid body.
+    // Reference per-wing path; Aircraft evaluates all surfaces at once through AeroModel.
     void applyForces(RigidBody* rigid_body, float max_deflection_angle_deg = 20.0f) const;
 
-private:
+    // --- Geometry (depends only on base_normal_body) ---
+    // Axis the control surface hinges about (body space)
+    glm::vec3 getDeflectionAxisBody() const;
+    // Span direction (body space); lift is perpendicular to it and to the relative wind
+    glm::vec3 getSpanAxisBody() const;
+
     // Helper to calculate the effective normal vector based on control input
     glm::vec3 calculateEffectiveNormal(float max_deflection_angle_deg) const;
 };
@@ -0,0 +1,728 @@
+// Benchmark entry point for the physics code (no graphics context needed)
+#include "Aircraft.h"
+#include "AircraftFactory.h"
+#include "Atmosphere.h"
+#include "Heightfield.h"
+#include "TerrainConfig.h"
+#include "TerrainRaycaster.h"
+#include "RigidBody.h"
+#include "RigidBodyBatch.h"
+#include "PhysicsConfig.h"
+#include "SpatialHash.h"
+#include "TileManager.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Deterministic per-step forces so both paths see identical inputs
+struct ForceSample {
+    glm::vec3 force_world;
+    glm::vec3 torque_body;
+};
+
+std::vector<ForceSample> makeForces(size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> f(-2.0e5f, 2.0e5f);
+    std::uniform_real_distribution<float> t(-5.0e4f, 5.0e4f);
+    std::vector<ForceSample> forces(count);
+    for (auto& s : forces) {
+        s.force_world = glm::vec3(f(rng), f(rng), f(rng));
+        s.torque_body = glm::vec3(t(rng), t(rng), t(rng));
+    }
+    return forces;
+}
+
+std::vector<RigidBody> makeBodies(size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(-5000.0f, 5000.0f);
+    std::uniform_real_distribution<float> vel(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> ang(-1.0f, 1.0f);
+    std::vector<RigidBody> bodies(count);
+    for (auto& b : bodies) {
+        b.mass = PhysicsConfig::DEFAULT_MASS;
+        b.setInertiaTensor(PhysicsConfig::DEFAULT_INERTIA_TENSOR);
+        b.position_world = glm::vec3(pos(rng), 1000.0f + pos(rng) * 0.1f, pos(rng));
+        b.velocity_world = glm::vec3(vel(rng), vel(rng) * 0.1f, vel(rng));
+        b.orientation_world = glm::normalize(glm::quat(1.0f, ang(rng) * 0.3f, ang(rng) * 0.3f, ang(rng) * 0.3f));
+        b.angular_velocity_body = glm::vec3(ang(rng), ang(rng), ang(rng));
+    }
+    return bodies;
+}
+
+// --- Benchmark: RigidBody::update (virtual, AoS) vs RigidBodyBatch::integrate (SoA, SIMD) ---
+void benchRigidBodyBatch(size_t body_count, int steps) {
+    const float dt = 1.0f / 120.0f;
+    std::vector<ForceSample> forces = makeForces(body_count, 7);
+
+    // Scalar path: one virtual update per body
+    std::vector<RigidBody> scalar_bodies = makeBodies(body_count, 42);
+    std::vector<RigidBody*> scalar_ptrs;
+    for (auto& b : scalar_bodies) scalar_ptrs.push_back(&b);
+
+    auto t0 = Clock::now();
+    for (int s = 0; s < steps; ++s) {
+        for (size_t i = 0; i < body_count; ++i) {
+            RigidBody* body = scalar_ptrs[i];
+            body->addForceWorld(forces[i].force_world);
+            body->addTorqueBody(forces[i].torque_body);
+            body->update(dt);
+        }
+    }
+    double scalar_sec = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    // Batched path: state lives in the SoA store for the whole run
+    std::vector<RigidBody> batch_bodies = makeBodies(body_count, 42);
+    RigidBodyBatch batch;
+    batch.reserve(body_count);
+    for (const auto& b : batch_bodies) batch.add(b);
+
+    t0 = Clock::now();
+    for (int s = 0; s < steps; ++s) {
+        for (size_t i = 0; i < body_count; ++i) {
+            batch.force_x[i] += forces[i].force_world.x;
+            batch.force_y[i] += forces[i].force_world.y;
+            batch.force_z[i] += forces[i].force_world.z;
+            batch.torque_x[i] += forces[i].torque_body.x;
+            batch.torque_y[i] += forces[i].torque_body.y;
+            batch.torque_z[i] += forces[i].torque_body.z;
+        }
+        batch.integrate(dt);
+    }
+    double batch_sec = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    // Compare final state against the scalar path
+    float max_pos_err = 0.0f, max_rot_err = 0.0f;
+    for (size_t i = 0; i < body_count; ++i) {
+        batch.store(i, batch_bodies[i]);
+        max_pos_err = std::max(max_pos_err, glm::length(batch_bodies[i].position_world - scalar_bodies[i].position_world));
+        glm::quat dq = batch_bodies[i].orientation_world - scalar_bodies[i].orientation_world;
+        max_rot_err = std::max(max_rot_err, glm::length(dq));
+    }
+
+    double body_steps = static_cast<double>(body_count) * steps;
+    std::cout << "RigidBodyBatch [" << RigidBodyBatch::simdPath() << "] bodies=" << body_count << " steps=" << steps << "\n"
+              << "  scalar RigidBody::update : " << body_steps / scalar_sec / 1e6 << " M bodies/s\n"
+              << "  RigidBodyBatch::integrate: " << body_steps / batch_sec / 1e6 << " M bodies/s"
+              << " (x" << scalar_sec / batch_sec << ")\n"
+              << "  max |dpos| = " << max_pos_err << " m, max |dq| = " << max_rot_err << std::endl;
+}
+
+// --- Benchmark: integrator drift vs step size ---
+// Torque-free tumbling body under gravity: mechanical energy must be conserved, so any
+// energy error is integration error. Reports the largest dt that stays within tolerance.
+void benchIntegrators(double tolerance) {
+    const float sim_seconds = 20.0f;
+    const float step_sizes[] = {1.0f / 480.0f, 1.0f / 240.0f, 1.0f / 120.0f, 1.0f / 60.0f, 1.0f / 30.0f, 1.0f / 15.0f};
+    const IntegratorType types[] = {IntegratorType::SemiImplicitEuler, IntegratorType::ExponentialMap, IntegratorType::RK4};
+
+    std::cout << "Integrator drift (tumbling body, " << sim_seconds << " s, tolerance " << tolerance << ")\n";
+    for (IntegratorType type : types) {
+        float largest_stable = 0.0f;
+        for (float dt : step_sizes) {
+            RigidBody body;
+            body.mass = PhysicsConfig::DEFAULT_MASS;
+            body.setInertiaTensor(PhysicsConfig::DEFAULT_INERTIA_TENSOR);
+            body.position_world = glm::vec3(0.0f, 5000.0f, 0.0f);
+            body.velocity_world = glm::vec3(150.0f, 20.0f, 0.0f);
+            body.angular_velocity_body = glm::vec3(2.0f, 0.5f, 3.0f); // Near the unstable intermediate axis
+            body.integrator = type;
+            body.track_integrator_stats = true;
+
+            int steps = static_cast<int>(sim_seconds / dt);
+            auto t0 = Clock::now();
+            for (int s = 0; s < steps; ++s) body.update(dt);
+            double ns_per_step = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / steps;
+
+            const IntegratorStats& stats = body.getIntegratorStats();
+            bool stable = std::abs(stats.relativeEnergyError()) < tolerance && std::isfinite(stats.energy);
+            if (stable) largest_stable = std::max(largest_stable, dt);
+
+            std::cout << "  " << integratorName(type) << " dt=1/" << static_cast<int>(std::round(1.0f / dt))
+                      << "  rel.energy err=" << stats.relativeEnergyError()
+                      << "  max |q|-1=" << stats.max_quat_norm_error
+                      << "  " << ns_per_step << " ns/step" << (stable ? "" : "  (out of tolerance)") << "\n";
+        }
+        std::cout << "  -> " << integratorName(type) << " largest stable dt: ";
+        if (largest_stable > 0.0f) std::cout << "1/" << static_cast<int>(std::round(1.0f / largest_stable)) << " s\n";
+        else std::cout << "none\n";
+    }
+    std::cout << std::flush;
+}
+
+// --- Benchmark: per-Wing applyForces loop vs compiled AeroModel::evaluate ---
+void benchAeroModel(int evaluations) {
+    std::unique_ptr<Aircraft> aircraft = AircraftFactory::createDefaultAircraft();
+    const AeroModel& aero = aircraft->getAeroModel();
+
+    // Reference path uses the same per-wing max deflection the compiled model was baked with
+    const std::vector<float> max_deflection = aircraft->getMaxDeflections();
+
+    // Random flight states (attitude, wind, rates, controls)
+    std::vector<RigidBody> states = makeBodies(256, 11);
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    double legacy_ns = 0.0, compiled_ns = 0.0;
+    float max_force_err = 0.0f, max_torque_err = 0.0f;
+    volatile float sink = 0.0f;
+    for (const RigidBody& state : states) {
+        for (const auto& wing : aircraft->wings) wing->setControlInput(unit(rng));
+        aircraft->compileAeroModel(); // Picks up the control inputs
+
+        RigidBody reference = state;
+        auto t0 = Clock::now();
+        for (int e = 0; e < evaluations; ++e) {
+            reference.clearAccumulators();
+            for (size_t w = 0; w < aircraft->wings.size(); ++w) aircraft->wings[w]->applyForces(&reference, max_deflection[w]);
+            sink = sink + reference.getForceAccumulatorWorld().x;
+        }
+        legacy_ns += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+        AeroModel::Loads loads;
+        t0 = Clock::now();
+        for (int e = 0; e < evaluations; ++e) {
+            loads = aero.evaluate(state, Atmosphere::sample(state.position_world.y));
+            sink = sink + loads.force_world.x;
+        }
+        compiled_ns += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+        // Relative error against the reference load
+        glm::vec3 f_ref = reference.getForceAccumulatorWorld();
+        glm::vec3 t_ref = reference.getTorqueAccumulatorBody();
+        max_force_err = std::max(max_force_err, glm::length(loads.force_world - f_ref) / std::max(1.0f, glm::length(f_ref)));
+        max_torque_err = std::max(max_torque_err, glm::length(loads.torque_body - t_ref) / std::max(1.0f, glm::length(t_ref)));
+    }
+
+    double total = static_cast<double>(states.size()) * evaluations;
+    std::cout << "AeroModel (" << aero.size() << " surfaces)\n"
+              << "  Wing::applyForces loop: " << legacy_ns / total << " ns/eval\n"
+              << "  AeroModel::evaluate   : " << compiled_ns / total << " ns/eval"
+              << " (x" << legacy_ns / compiled_ns << ")\n"
+              << "  max relative error: force " << max_force_err << ", torque " << max_torque_err << std::endl;
+}
+
+// --- Benchmark: Airfoil lookup (lower_bound over source points vs uniform grid vs SIMD batch) ---
+glm::vec2 sampleSourcePoints(const std::vector<glm::vec3>& data, float alpha_deg) {
+    // The original Airfoil::sample: clamp, binary search, lerp
+    alpha_deg = std::clamp(alpha_deg, data.front().x, data.back().x);
+    auto it = std::lower_bound(data.begin(), data.end(), alpha_deg,
+                               [](const glm::vec3& point, float alpha) { return point.x < alpha; });
+    if (it == data.begin()) return {it->y, it->z};
+    if (it == data.end()) return {data.back().y, data.back().z};
+    const glm::vec3& p1 = *(it - 1);
+    const glm::vec3& p2 = *it;
+    if (std::abs(p2.x - p1.x) < 1e-6f) return {p1.y, p1.z};
+    float t = (alpha_deg - p1.x) / (p2.x - p1.x);
+    return {p1.y + t * (p2.y - p1.y), p1.z + t * (p2.z - p1.z)};
+}
+
+void benchAirfoil(size_t samples, int repeats) {
+    const Airfoil& airfoil = Aircraft::airfoilNACA2412();
+    const std::vector<glm::vec3>& source = airfoil.getSourcePoints();
+
+    // Mostly small angles (cruise), some post-stall
+    std::mt19937 rng(5);
+    std::normal_distribution<float> cruise(2.0f, 6.0f);
+    std::uniform_real_distribution<float> any(-180.0f, 180.0f);
+    std::vector<float> alpha(samples);
+    for (size_t i = 0; i < samples; ++i) alpha[i] = (i % 8 == 0) ? any(rng) : cruise(rng);
+
+    std::vector<float> cl_ref(samples), cd_ref(samples), cl(samples), cd(samples), cl_batch(samples), cd_batch(samples);
+
+    auto t0 = Clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t i = 0; i < samples; ++i) {
+            glm::vec2 c = sampleSourcePoints(source, alpha[i]);
+            cl_ref[i] = c.x; cd_ref[i] = c.y;
+        }
+    }
+    double search_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+    t0 = Clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t i = 0; i < samples; ++i) std::tie(cl[i], cd[i]) = airfoil.sample(alpha[i]);
+    }
+    double grid_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+    t0 = Clock::now();
+    for (int r = 0; r < repeats; ++r) airfoil.sampleBatch(alpha.data(), cl_batch.data(), cd_batch.data(), samples);
+    double batch_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+    float grid_err = 0.0f, batch_err = 0.0f;
+    for (size_t i = 0; i < samples; ++i) {
+        grid_err = std::max({grid_err, std::abs(cl[i] - cl_ref[i]), std::abs(cd[i] - cd_ref[i])});
+        batch_err = std::max({batch_err, std::abs(cl_batch[i] - cl[i]), std::abs(cd_batch[i] - cd[i])});
+    }
+
+    double total = static_cast<double>(samples) * repeats;
+    std::cout << "Airfoil sample [" << RigidBodyBatch::simdPath() << "] " << source.size() << " source points -> "
+              << airfoil.getAlphaCount() << " grid points @ " << airfoil.getAlphaStep() << " deg\n"
+              << "  lower_bound over points: " << search_ns / total << " ns/sample\n"
+              << "  uniform grid sample()  : " << grid_ns / total << " ns/sample (x" << search_ns / grid_ns << ")\n"
+              << "  sampleBatch()          : " << batch_ns / total << " ns/sample (x" << search_ns / batch_ns << ")\n"
+              << "  max |error| grid vs points: " << grid_err << ", batch vs grid: " << batch_err << std::endl;
+}
+
+// --- Benchmark: ISA atmosphere (layer equations vs table vs batched table) ---
+void benchAtmosphere(size_t count, int repeats) {
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> altitude(-500.0f, 20000.0f);
+    std::vector<float> altitudes(count);
+    for (auto& a : altitudes) a = altitude(rng);
+
+    std::vector<float> exact(count), tabulated(count), batched(count), legacy(count);
+    volatile float sink = 0.0f;
+
+    auto t0 = Clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t i = 0; i < count; ++i) exact[i] = Atmosphere::computeExact(altitudes[i]).density;
+    }
+    double exact_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+    t0 = Clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        // Previous density model: one exp per call
+        for (size_t i = 0; i < count; ++i) legacy[i] = 1.225f * std::exp(-altitudes[i] / 8500.0f);
+        sink = sink + legacy[0];
+    }
+    double legacy_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+    t0 = Clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t i = 0; i < count; ++i) tabulated[i] = Atmosphere::density(altitudes[i]);
+    }
+    double table_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+    t0 = Clock::now();
+    for (int r = 0; r < repeats; ++r) Atmosphere::sampleBatch(altitudes.data(), count, batched.data());
+    double batch_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+    float table_err = 0.0f, batch_err = 0.0f, legacy_err = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        table_err = std::max(table_err, std::abs(tabulated[i] - exact[i]) / exact[i]);
+        batch_err = std::max(batch_err, std::abs(batched[i] - tabulated[i]));
+        legacy_err = std::max(legacy_err, std::abs(legacy[i] - exact[i]) / exact[i]);
+    }
+
+    double total = static_cast<double>(count) * repeats;
+    std::cout << "Atmosphere density, " << count << " altitudes in [-500, 20000] m\n"
+              << "  ISA layer equations : " << exact_ns / total << " ns/query\n"
+              << "  exp() approximation : " << legacy_ns / total << " ns/query (max rel. error vs ISA " << legacy_err << ")\n"
+              << "  Atmosphere::density : " << table_ns / total << " ns/query (max rel. error " << table_err << ")\n"
+              << "  sampleBatch         : " << batch_ns / total << " ns/query (max |batch - density| " << batch_err << ")" << std::endl;
+}
+
+// The default terrain heightmap, or synthetic ridges when the assets are missing so the
+// terrain benchmarks still run. Returns true if the asset was loaded.
+bool loadBenchHeightfield(Heightfield& field) {
+    if (field.loadImage(TerrainConfig::HEIGHTMAP_PATH, TerrainConfig::WORLD_SIZE, TerrainConfig::MAX_HEIGHT)) return true;
+    const int size = 1024;
+    std::vector<float> heights(static_cast<size_t>(size) * size);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            heights[static_cast<size_t>(y) * size + x] = TerrainConfig::MAX_HEIGHT * 0.5f * (1.0f + std::sin(x * 0.02f) * std::cos(y * 0.03f));
+        }
+    }
+    field.setHeights(size, size, heights, TerrainConfig::WORLD_SIZE);
+    return false;
+}
+
+// --- Benchmark: terrain height queries (row-major reference vs tiled scalar vs batched) ---
+void benchHeightfield(size_t count, int repeats) {
+    const float world_size = TerrainConfig::WORLD_SIZE;
+    Heightfield field;
+    bool from_asset = loadBenchHeightfield(field);
+    const int size = field.getWidth();
+    const int rows = field.getHeight();
+
+    // Row-major copy for the reference path
+    std::vector<float> row_major(static_cast<size_t>(size) * rows);
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < size; ++x) row_major[static_cast<size_t>(y) * size + x] = field.texel(x, y);
+    }
+
+    // GL_LINEAR + CLAMP_TO_EDGE on a plain row-major array
+    auto reference = [&](float wx, float wz) {
+        float tx = std::clamp((wx / world_size + 0.5f) * size - 0.5f, 0.0f, static_cast<float>(size - 1));
+        float tz = std::clamp((wz / world_size + 0.5f) * rows - 0.5f, 0.0f, static_cast<float>(rows - 1));
+        int x0 = std::min(static_cast<int>(tx), size - 2), z0 = std::min(static_cast<int>(tz), rows - 2);
+        float fx = tx - x0, fz = tz - z0;
+        const float* r0 = &row_major[static_cast<size_t>(z0) * size + x0];
+        const float* r1 = r0 + size;
+        float h0 = r0[0] + fx * (r0[1] - r0[0]);
+        float h1 = r1[0] + fx * (r1[1] - r1[0]);
+        return h0 + fz * (h1 - h0);
+    };
+
+    std::vector<float> xs(count), zs(count), ref(count), scalar(count), batched(count);
+    std::vector<glm::vec3> normals(count);
+    std::cout << "Heightfield [" << RigidBodyBatch::simdPath() << "] " << field.getWidth() << "x" << rows
+              << (from_asset ? " (" + TerrainConfig::HEIGHTMAP_PATH + ")" : " (synthetic)") << ", " << count << " queries" << std::endl;
+
+    auto run = [&](const char* label) {
+        auto t0 = Clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            for (size_t i = 0; i < count; ++i) ref[i] = reference(xs[i], zs[i]);
+        }
+        double ref_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+        t0 = Clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            for (size_t i = 0; i < count; ++i) scalar[i] = field.height(xs[i], zs[i]);
+        }
+        double scalar_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+        t0 = Clock::now();
+        for (int r = 0; r < repeats; ++r) field.sampleBatch(xs.data(), zs.data(), count, batched.data());
+        double batch_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+        t0 = Clock::now();
+        for (int r = 0; r < repeats; ++r) field.sampleBatch(xs.data(), zs.data(), count, batched.data(), normals.data());
+        double normal_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+        float scalar_err = 0.0f, batch_err = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            scalar_err = std::max(scalar_err, std::abs(scalar[i] - ref[i]));
+            batch_err = std::max(batch_err, std::abs(batched[i] - ref[i]));
+        }
+
+        double total = static_cast<double>(count) * repeats;
+        std::cout << "  " << label << "\n"
+                  << "    row-major reference   : " << ref_ns / total << " ns/query\n"
+                  << "    tiled height()        : " << scalar_ns / total << " ns/query (x" << ref_ns / scalar_ns << ")\n"
+                  << "    sampleBatch()         : " << batch_ns / total << " ns/query (x" << ref_ns / batch_ns << ")\n"
+                  << "    sampleBatch() +normals: " << normal_ns / total << " ns/query\n"
+                  << "    max |error| vs reference: scalar " << scalar_err << " m, batch " << batch_err << " m" << std::endl;
+    };
+
+    // Whole map, slightly past the edges to exercise the clamp
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> coord(-0.55f * world_size, 0.55f * world_size);
+    for (size_t i = 0; i < count; ++i) { xs[i] = coord(rng); zs[i] = coord(rng); }
+    run("fleet spread over the whole map");
+
+    // Traffic clustered around an airfield (5 km box), stored in arrival order
+    std::normal_distribution<float> near(0.0f, 1500.0f);
+    for (size_t i = 0; i < count; ++i) { xs[i] = 3000.0f + near(rng); zs[i] = -2000.0f + near(rng); }
+    run("fleet clustered within ~5 km");
+}
+
+// --- Benchmark: terrain ray casts (min/max pyramid traversal vs fixed-step marching) ---
+// Returns false if the pyramid missed a contact the march found: it must never do that.
+bool benchTerrainRaycast(size_t count) {
+    const float world_size = TerrainConfig::WORLD_SIZE;
+    Heightfield field;
+    loadBenchHeightfield(field);
+    auto t0 = Clock::now();
+    TerrainRaycaster raycaster(field);
+    double build_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    const float step = world_size / static_cast<float>(field.getWidth()); // One texel
+
+    std::mt19937 rng(33);
+    std::uniform_real_distribution<float> coord(-0.45f * world_size, 0.45f * world_size);
+    std::uniform_real_distribution<float> agl(150.0f, 3000.0f);
+    std::uniform_real_distribution<float> offset(-8000.0f, 8000.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    auto airborne = [&](float x, float z) { return glm::vec3(x, field.height(x, z) + agl(rng), z); };
+
+    struct Scenario {
+        const char* name;
+        std::vector<TerrainRay> rays;
+    };
+    std::vector<Scenario> scenarios(3);
+    scenarios[0].name = "line of sight (pairs <= 11 km apart)";
+    scenarios[1].name = "radar altimeter (straight down)";
+    scenarios[2].name = "long shallow rays (up to 40 km)";
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 a = airborne(coord(rng), coord(rng));
+        glm::vec3 b = airborne(a.x + offset(rng), a.z + offset(rng));
+        scenarios[0].rays.push_back({a, b - a, glm::length(b - a)});
+        scenarios[1].rays.push_back({airborne(coord(rng), coord(rng)), glm::vec3(0.0f, -1.0f, 0.0f), 5000.0f});
+        scenarios[2].rays.push_back({airborne(coord(rng), coord(rng)), glm::vec3(unit(rng), -0.02f + 0.04f * unit(rng), unit(rng)), 40000.0f});
+    }
+
+    std::cout << "Terrain raycast, " << field.getWidth() << "x" << field.getHeight() << " heightfield, "
+              << raycaster.getLevelCount() << " pyramid levels built in " << build_ms << " ms, "
+              << count << " rays per scenario, marching step " << step << " m" << std::endl;
+    std::vector<TerrainRayHit> fast(count), marched(count);
+    size_t pyramid_missed_total = 0;
+    for (const auto& scenario : scenarios) {
+        t0 = Clock::now();
+        raycaster.raycastBatch(scenario.rays.data(), count, fast.data());
+        double fast_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+        t0 = Clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            const TerrainRay& r = scenario.rays[i];
+            marched[i] = raycaster.raymarch(r.origin, r.direction, r.max_distance, step);
+        }
+        double march_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+        // Marching can step over a ridge thinner than its step: it then misses or hits later.
+        // The pyramid is exact, so it must hit everything the march hits, no later than it.
+        size_t hits = 0, agree = 0, march_missed = 0, pyramid_missed = 0;
+        double distance_err = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            hits += fast[i].hit;
+            bool same = fast[i].hit == marched[i].hit;
+            float difference = same && fast[i].hit ? std::abs(fast[i].distance - marched[i].distance) : 0.0f;
+            if (same && difference < step) {
+                ++agree;
+                distance_err = std::max(distance_err, static_cast<double>(difference));
+            } else if (marched[i].hit && (!fast[i].hit || fast[i].distance > marched[i].distance)) {
+                ++pyramid_missed;
+            } else {
+                ++march_missed;
+            }
+        }
+        pyramid_missed_total += pyramid_missed;
+        double n = static_cast<double>(count);
+        std::cout << "  " << scenario.name << ": " << hits << " hits\n"
+                  << "    pyramid traversal: " << fast_ns / n << " ns/ray (" << 16.0e6 / (fast_ns / n) << " rays per 16 ms)\n"
+                  << "    fixed-step march : " << march_ns / n << " ns/ray (x" << march_ns / fast_ns << " slower)\n"
+                  << "    agreement " << 100.0 * agree / n << "% (march stepped over the first contact " << march_missed
+                  << "x, pyramid missed a contact the march found " << pyramid_missed << "x), max distance difference when agreeing "
+                  << distance_err << " m" << std::endl;
+    }
+    if (pyramid_missed_total > 0) {
+        std::cerr << "  FAIL: pyramid traversal missed " << pyramid_missed_total << " contacts found by the fixed-step march" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- Benchmark: SpatialHash broadphase vs brute-force pair/radius/nearest queries ---
+void benchBroadphase(size_t max_count, int steps) {
+    const float separation = 500.0f; // Proximity radius (and cell size)
+    const int rebuilds = std::max(1, std::min(steps, 50));
+    std::cout << "Broadphase, " << separation << " m proximity radius, bodies in 40 x 10 x 40 km" << std::endl;
+
+    for (size_t count : {max_count / 16, max_count / 4, max_count}) {
+        if (count < 2) continue;
+        std::mt19937 rng(41);
+        std::uniform_real_distribution<float> horizontal(-20000.0f, 20000.0f);
+        std::uniform_real_distribution<float> altitude(200.0f, 10000.0f);
+        std::uniform_real_distribution<float> speed(-250.0f, 250.0f);
+        std::vector<glm::vec3> positions(count), velocities(count);
+        for (size_t i = 0; i < count; ++i) {
+            positions[i] = glm::vec3(horizontal(rng), altitude(rng), horizontal(rng));
+            velocities[i] = glm::vec3(speed(rng), speed(rng) * 0.05f, speed(rng));
+        }
+
+        // Per step: move everything, rebuild, enumerate close pairs
+        SpatialHash hash(separation);
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        const float dt = 1.0f / 120.0f;
+        double build_ns = 0.0, pairs_ns = 0.0;
+        for (int r = 0; r < rebuilds; ++r) {
+            for (size_t i = 0; i < count; ++i) positions[i] += velocities[i] * dt;
+            auto t0 = Clock::now();
+            hash.build(positions.data(), count);
+            auto t1 = Clock::now();
+            hash.findPairs(separation, pairs);
+            auto t2 = Clock::now();
+            build_ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+            pairs_ns += std::chrono::duration<double, std::nano>(t2 - t1).count();
+        }
+
+        // Brute force over the final positions (skipped when it would take too long)
+        const bool brute = count <= 20000;
+        double brute_ns = 0.0;
+        size_t brute_pairs = 0;
+        if (brute) {
+            const float r2 = separation * separation;
+            auto t0 = Clock::now();
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t j = i + 1; j < count; ++j) {
+                    glm::vec3 d = positions[j] - positions[i];
+                    brute_pairs += glm::dot(d, d) <= r2;
+                }
+            }
+            brute_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        }
+
+        // Queries from every body: radius (5 km) and 8 nearest, checked against brute force on a subset
+        std::vector<uint32_t> found;
+        size_t radius_hits = 0;
+        auto t0 = Clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            found.clear();
+            hash.queryRadius(positions[i], 5000.0f, found);
+            radius_hits += found.size();
+        }
+        double radius_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+        t0 = Clock::now();
+        for (size_t i = 0; i < count; ++i) hash.nearest(positions[i], 8, found, 1.0e6f, static_cast<uint32_t>(i));
+        double nearest_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+        size_t nearest_ok = 0, checked = std::min<size_t>(count, 200);
+        std::vector<std::pair<float, uint32_t>> reference;
+        for (size_t i = 0; i < checked; ++i) {
+            hash.nearest(positions[i], 8, found, 1.0e6f, static_cast<uint32_t>(i));
+            reference.clear();
+            for (size_t j = 0; j < count; ++j) {
+                if (j == i) continue;
+                glm::vec3 d = positions[j] - positions[i];
+                reference.emplace_back(glm::dot(d, d), static_cast<uint32_t>(j));
+            }
+            size_t k = std::min<size_t>(8, reference.size());
+            std::partial_sort(reference.begin(), reference.begin() + k, reference.end());
+            bool same = found.size() == k;
+            for (size_t n = 0; same && n < k; ++n) {
+                glm::vec3 d = positions[found[n]] - positions[i];
+                same = glm::dot(d, d) == reference[n].first; // Ties may reorder indices, not distances
+            }
+            nearest_ok += same;
+        }
+
+        double n = static_cast<double>(count);
+        std::cout << "  " << count << " bodies:\n"
+                  << "    rebuild          : " << build_ns / rebuilds / n << " ns/body (" << build_ns / rebuilds / 1.0e6 << " ms/step)\n"
+                  << "    pairs (hash)     : " << pairs_ns / rebuilds / 1.0e6 << " ms/step, " << pairs.size() << " pairs\n";
+        if (brute) {
+            std::cout << "    pairs (O(N^2))   : " << brute_ns / 1.0e6 << " ms, " << brute_pairs << " pairs ("
+                      << (brute_pairs == pairs.size() ? "match" : "MISMATCH") << ", x" << brute_ns / (pairs_ns / rebuilds) << " slower)\n";
+        }
+        std::cout << "    radius 5 km      : " << radius_ns / n << " ns/query, " << radius_hits / n << " bodies/query\n"
+                  << "    8 nearest        : " << nearest_ns / n << " ns/query, " << nearest_ok << "/" << checked << " match brute force" << std::endl;
+    }
+}
+
+// --- Check: streamed tile placement ---
+// The anchor tile keeps its real ground width and every world point falls inside the tile
+// tileAt() names for it, at every zoom, with the tile one zoom finer being one of its children.
+bool checkTerrainPlacement() {
+    TileManager::Options options;
+    options.worker_count = 1;
+    TileManager tiles(options);
+    const TileKey& anchor = options.anchor;
+    const double anchor_size = tiles.getOptions().anchor_tile_size;
+    bool ok = std::abs(anchor_size - TileManager::groundTileSize(anchor)) < 1.0e-6 * anchor_size;
+
+    std::mt19937 rng(57);
+    const float half = static_cast<float>(anchor_size * 0.499);
+    std::uniform_real_distribution<float> coord(-half, half);
+    float worst = 0.0f; // Metres outside the tile's bounds
+    size_t checked = 0, misparented = 0;
+    for (int i = 0; i < 1000; ++i) {
+        float x = coord(rng), z = coord(rng);
+        TileKey parent;
+        for (int zoom = options.min_zoom; zoom <= options.max_zoom; ++zoom) {
+            TileKey key = tiles.tileAt(zoom, x, z);
+            glm::vec2 lo, hi;
+            tiles.tileBounds(key, lo, hi);
+            float outside = std::max({lo.x - x, x - hi.x, lo.y - z, z - hi.y, 0.0f});
+            worst = std::max(worst, outside / (hi.x - lo.x));
+            if (zoom > options.min_zoom && ((key.x >> 1) != parent.x || (key.y >> 1) != parent.y)) ++misparented;
+            parent = key;
+            ++checked;
+        }
+    }
+    ok = ok && worst < 1.0e-4f && misparented == 0;
+    std::cout << "Terrain placement: anchor " << anchor.z << "/" << anchor.x << "/" << anchor.y << " " << anchor_size / 1000.0
+              << " km wide, " << checked << " points x zoom, max " << worst << " tile widths outside, " << misparented
+              << " misparented" << (ok ? "" : "  FAIL") << std::endl;
+    return ok;
+}
+
+// --- Benchmark: terrain tile streaming (render-thread cost of TileManager::update) ---
+void benchTileStreaming(int frames) {
+    TileManager::Options options;
+    options.byte_budget = 48u << 20; // Room for the four sample tiles under the path, not for all six
+    TileManager tiles(options);
+    if (tiles.getAvailableCount() == 0) {
+        std::cout << "Tile streaming: no tiles under " << options.root << ", skipped" << std::endl;
+        return;
+    }
+    std::cout << "Tile streaming, " << tiles.getAvailableCount() << " tiles on disk, budget "
+              << (options.byte_budget >> 20) << " MB, " << options.worker_count << " workers, " << frames << " frames at 60 Hz" << std::endl;
+
+    // Descend from 20 km to 500 m over the north-west corner of the anchor tile (where the
+    // sample data has zoom 9-12), then cross to the south-east corner while climbing back
+    const float corner = static_cast<float>(tiles.getOptions().anchor_tile_size * 0.45);
+    std::vector<double> update_us;
+    update_us.reserve(static_cast<size_t>(frames));
+    auto frame_period = std::chrono::microseconds(16667);
+    auto next_frame = Clock::now();
+    size_t arrived = 0, evicted = 0;
+    std::vector<std::shared_ptr<const TerrainTile>> arrivals;
+    std::vector<TileKey> evictions;
+    for (int frame = 0; frame < frames; ++frame) {
+        float t = static_cast<float>(frame) / static_cast<float>(std::max(frames - 1, 1));
+        float descent = std::min(t * 2.0f, 1.0f), cross = std::max(t * 2.0f - 1.0f, 0.0f);
+        float altitude = 20000.0f - 19500.0f * descent + 19500.0f * cross;
+        float along = -corner + 2.0f * corner * cross;
+        glm::vec3 camera(along, altitude, -along);
+
+        auto t0 = Clock::now();
+        tiles.update(camera);
+        tiles.takeArrivals(arrivals);
+        tiles.takeEvictions(evictions);
+        update_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+        arrived += arrivals.size();
+        evicted += evictions.size();
+        arrivals.clear();
+        evictions.clear();
+
+        next_frame += frame_period;
+        std::this_thread::sleep_until(next_frame);
+    }
+    tiles.waitIdle();
+
+    std::vector<double> sorted = update_us;
+    std::sort(sorted.begin(), sorted.end());
+    double mean = 0.0;
+    for (double us : update_us) mean += us;
+    mean /= static_cast<double>(update_us.size());
+    TileManager::Stats stats = tiles.getStats();
+    std::cout << "  update(): mean " << mean << " us, p99 " << sorted[sorted.size() * 99 / 100] << " us, max " << sorted.back() << " us\n"
+              << "  decoded " << stats.loaded << " tiles (" << stats.failed << " failed) in " << stats.decode_ms << " ms of worker time"
+              << " (" << (stats.loaded ? stats.decode_ms / stats.loaded : 0.0) << " ms/tile)\n"
+              << "  arrivals " << arrived << ", evictions " << evicted << ", resident " << stats.resident_tiles << " tiles / "
+              << (stats.resident_bytes >> 20) << " MB" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string only;
+    size_t bodies = 4096;
+    int steps = 1000;
+    double tolerance = 1e-3;
+    bool failed = false; // A correctness check inside a benchmark failed
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--bench" && i + 1 < argc) only = argv[++i];
+        else if (arg == "--bodies" && i + 1 < argc) bodies = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--steps" && i + 1 < argc) steps = std::atoi(argv[++i]);
+        else if (arg == "--tolerance" && i + 1 < argc) tolerance = std::atof(argv[++i]);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--bench batch|integrators|aero|airfoil|atmosphere|terrain|raycast|broadphase|placement|tiles] [--bodies N] [--steps S] [--tolerance T]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (only.empty() || only == "batch") benchRigidBodyBatch(bodies, steps);
+    if (only.empty() || only == "integrators") benchIntegrators(tolerance);
+    if (only.empty() || only == "aero") benchAeroModel(steps);
+    if (only.empty() || only == "airfoil") benchAirfoil(bodies, steps);
+    if (only.empty() || only == "atmosphere") benchAtmosphere(bodies, steps);
+    if (only.empty() || only == "terrain") benchHeightfield(bodies, steps);
+    if (only.empty() || only == "raycast") failed |= !benchTerrainRaycast(bodies);
+    if (only.empty() || only == "broadphase") benchBroadphase(bodies * 4, steps);
+    if (only.empty() || only == "placement") failed |= !checkTerrainPlacement();
+    if (only.empty() || only == "tiles") benchTileStreaming(steps);
+    return failed ? 2 : 0;
+}
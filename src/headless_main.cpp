@@ -0,0 +1,748 @@
+// Headless entry point: runs the flight model without a window or GL context.
+// Usage: FlightSimHeadless <command> [options]
+#include "Aircraft.h"
+#include "AircraftFactory.h"
+#include "BakedTexture.h"
+#include "FlightScript.h"
+#include "GoldenTrajectory.h"
+#include "PhysicsScheduler.h"
+#include "Replay.h"
+#include "SweepRunner.h"
+#include "TerrainConfig.h"
+#include "TerrainPack.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include "TrimSolver.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct FlightResult {
+    unsigned seed = 0;
+    bool crashed = false;      // Touched the ground clamp
+    bool diverged = false;     // Non-finite state
+    float final_altitude = 0.0f;
+    float min_altitude = 0.0f;
+    float max_altitude = 0.0f;
+    float final_speed = 0.0f;  // m/s
+    float max_speed = 0.0f;
+    float max_rate = 0.0f;     // Peak |angular velocity| (rad/s)
+    double sim_seconds = 0.0;
+    double wall_seconds = 0.0;
+};
+
+FlightScript randomScript(unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    FlightScript s;
+    s.seed = seed;
+    s.initial_altitude = 500.0f + 2500.0f * unit(rng);
+    s.initial_speed = 120.0f + 100.0f * unit(rng);
+    s.throttle = 0.4f + 0.6f * unit(rng);
+    s.pitch_start = 2.0f + 8.0f * unit(rng);
+    s.pitch_duration = 0.5f + 2.0f * unit(rng);
+    s.pitch_amplitude = -0.5f + 1.0f * unit(rng);
+    s.roll_start = 5.0f + 20.0f * unit(rng);
+    s.roll_amplitude = -0.4f + 0.8f * unit(rng);
+    return s;
+}
+
+FlightResult runFlight(const FlightScript& script, float duration, float step_rate_hz, const std::string& record_path = "") {
+    FlightResult r;
+    r.seed = script.seed;
+
+    std::unique_ptr<Aircraft> aircraft = AircraftFactory::createDefaultAircraft();
+    aircraft->position_world.y = script.initial_altitude;
+    aircraft->velocity_world = glm::normalize(aircraft->velocity_world) * script.initial_speed;
+
+    PhysicsScheduler physics(step_rate_hz, 1);
+    physics.addBody(aircraft.get());
+    ReplayRecorder recorder;
+    if (!record_path.empty()) recorder.open(record_path, physics.getFixedDt());
+    physics.pre_step = [&](float dt) {
+        aircraft->controls = script.controlsAt(static_cast<float>(physics.getSimTime()));
+        recorder.recordStep(*aircraft, aircraft->controls, dt);
+    };
+
+    r.min_altitude = r.max_altitude = aircraft->getAltitude();
+    auto t0 = Clock::now();
+    const uint64_t steps = static_cast<uint64_t>(std::ceil(duration * step_rate_hz));
+    for (uint64_t s = 0; s < steps; ++s) {
+        physics.step();
+
+        float altitude = aircraft->getAltitude();
+        float speed = glm::length(aircraft->velocity_world);
+        if (!std::isfinite(altitude) || !std::isfinite(speed)) {
+            r.diverged = true;
+            break;
+        }
+        r.min_altitude = std::min(r.min_altitude, altitude);
+        r.max_altitude = std::max(r.max_altitude, altitude);
+        r.max_speed = std::max(r.max_speed, speed);
+        r.max_rate = std::max(r.max_rate, glm::length(aircraft->angular_velocity_body));
+        if (altitude <= 0.5f) r.crashed = true;
+    }
+    r.wall_seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    r.sim_seconds = physics.getSimTime();
+    r.final_altitude = aircraft->getAltitude();
+    r.final_speed = glm::length(aircraft->velocity_world);
+    return r;
+}
+
+// --- Summary statistics ---
+struct Summary {
+    double mean = 0.0, stddev = 0.0, min = 0.0, max = 0.0;
+};
+
+template <typename Getter>
+Summary summarize(const std::vector<FlightResult>& results, Getter get) {
+    Summary s;
+    size_t n = 0;
+    for (const auto& r : results) {
+        if (r.diverged) continue;
+        double v = get(r);
+        if (n == 0) s.min = s.max = v;
+        s.min = std::min(s.min, v);
+        s.max = std::max(s.max, v);
+        s.mean += v;
+        ++n;
+    }
+    if (n == 0) return s;
+    s.mean /= static_cast<double>(n);
+    for (const auto& r : results) {
+        if (r.diverged) continue;
+        double d = get(r) - s.mean;
+        s.stddev += d * d;
+    }
+    s.stddev = std::sqrt(s.stddev / static_cast<double>(n));
+    return s;
+}
+
+void printSummaryRow(std::ostream& out, const char* name, const Summary& s) {
+    out << "  " << std::left << std::setw(18) << name << std::right
+        << " mean=" << std::setw(10) << s.mean << " std=" << std::setw(10) << s.stddev
+        << " min=" << std::setw(10) << s.min << " max=" << std::setw(10) << s.max << "\n";
+}
+
+// --- Command: batch ---
+int runBatch(int argc, char** argv) {
+    size_t flights = 64;
+    float duration = 60.0f;
+    float hz = 120.0f;
+    size_t threads = 0;
+    unsigned seed = 1;
+    std::string csv_path;
+    std::string record_dir;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--flights" && i + 1 < argc) flights = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--duration" && i + 1 < argc) duration = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--hz" && i + 1 < argc) hz = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--threads" && i + 1 < argc) threads = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--seed" && i + 1 < argc) seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--csv" && i + 1 < argc) csv_path = argv[++i];
+        else if (arg == "--record-dir" && i + 1 < argc) record_dir = argv[++i];
+        else {
+            std::cerr << "Usage: batch [--flights N] [--duration S] [--hz H] [--threads T] [--seed S] [--csv FILE] [--record-dir DIR]" << std::endl;
+            return 1;
+        }
+    }
+
+    ThreadPool pool(threads);
+    std::vector<FlightResult> results(flights);
+
+    auto t0 = Clock::now();
+    pool.parallelFor(flights, [&](size_t i) {
+        unsigned flight_seed = seed + static_cast<unsigned>(i);
+        std::string record_path = record_dir.empty() ? "" : record_dir + "/flight_" + std::to_string(flight_seed) + ".fsr";
+        results[i] = runFlight(randomScript(flight_seed), duration, hz, record_path);
+    });
+    double wall = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    // --- Per-flight CSV ---
+    if (!csv_path.empty()) {
+        std::ofstream csv(csv_path);
+        if (!csv) {
+            std::cerr << "Error: could not open " << csv_path << " for writing" << std::endl;
+            return 1;
+        }
+        csv << "seed,crashed,diverged,final_altitude_m,min_altitude_m,max_altitude_m,final_speed_ms,max_speed_ms,max_rate_rads,sim_s,wall_s\n";
+        for (const auto& r : results) {
+            csv << r.seed << ',' << r.crashed << ',' << r.diverged << ',' << r.final_altitude << ','
+                << r.min_altitude << ',' << r.max_altitude << ',' << r.final_speed << ',' << r.max_speed << ','
+                << r.max_rate << ',' << r.sim_seconds << ',' << r.wall_seconds << '\n';
+        }
+    }
+
+    // --- Summary ---
+    size_t crashed = 0, diverged = 0;
+    double sim_total = 0.0;
+    for (const auto& r : results) {
+        crashed += r.crashed ? 1 : 0;
+        diverged += r.diverged ? 1 : 0;
+        sim_total += r.sim_seconds;
+    }
+
+    std::cout << "Batch: " << flights << " flights x " << duration << " s @ " << hz << " Hz on " << pool.size() << " threads\n";
+    printSummaryRow(std::cout, "final altitude m", summarize(results, [](const FlightResult& r) { return r.final_altitude; }));
+    printSummaryRow(std::cout, "min altitude m", summarize(results, [](const FlightResult& r) { return r.min_altitude; }));
+    printSummaryRow(std::cout, "final speed m/s", summarize(results, [](const FlightResult& r) { return r.final_speed; }));
+    printSummaryRow(std::cout, "max speed m/s", summarize(results, [](const FlightResult& r) { return r.max_speed; }));
+    printSummaryRow(std::cout, "max rate rad/s", summarize(results, [](const FlightResult& r) { return r.max_rate; }));
+    std::cout << "  crashed: " << crashed << "  diverged: " << diverged << "\n"
+              << "  simulated " << sim_total << " s in " << wall << " s wall"
+              << " (" << (wall > 0.0 ? sim_total / wall : 0.0) << "x real time)" << std::endl;
+    return 0;
+}
+
+// --- Command: replay ---
+// Plays a recording back, optionally seeking first, and checks that re-simulating
+// between consecutive keyframes reproduces the stored state bit for bit.
+int runReplay(int argc, char** argv) {
+    std::string path;
+    double seek_time = -1.0;
+    bool verify = false;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--seek" && i + 1 < argc) seek_time = std::atof(argv[++i]);
+        else if (arg == "--verify") verify = true;
+        else if (path.empty() && arg[0] != '-') path = arg;
+        else {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "Usage: replay <file.fsr> [--seek SECONDS] [--verify]" << std::endl;
+        return 1;
+    }
+
+    ReplayPlayer player;
+    if (!player.open(path)) return 1;
+    std::unique_ptr<Aircraft> aircraft = AircraftFactory::createDefaultAircraft();
+
+    // Ground contact must see the same surface as the recording session
+    Heightfield ground;
+    const HeightfieldSource& source = player.getGround();
+    if (source.hash != 0) {
+        if (source.path.empty()) {
+            std::cerr << "Error: " << path << " was flown over terrain that was not loaded from a file, cannot reproduce it" << std::endl;
+            return 1;
+        }
+        if (!ground.loadSource(source)) return 1;
+        aircraft->ground = &ground;
+    }
+
+    std::cout << "Replay " << path << ": " << player.getStepCount() << " steps, " << player.getDuration() << " s, "
+              << player.getKeyframeCount() << " keyframes every " << player.getKeyframeInterval() << " steps, ground: "
+              << (aircraft->ground ? source.path : "flat") << "\n";
+
+    if (seek_time >= 0.0) {
+        auto t0 = Clock::now();
+        uint64_t step = player.seek(*aircraft, seek_time);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::cout << "  seek " << seek_time << " s -> step " << step << " in " << ms << " ms\n";
+    } else {
+        while (player.step(*aircraft)) {}
+    }
+    std::cout << "  position (" << aircraft->position_world.x << ", " << aircraft->position_world.y << ", "
+              << aircraft->position_world.z << ")  speed " << glm::length(aircraft->velocity_world) << " m/s\n";
+
+    if (!verify) return 0;
+
+    size_t mismatches = 0;
+    for (size_t k = 1; k < player.getKeyframeCount(); ++k) {
+        ReplayKeyframe expected;
+        if (!player.readKeyframe(k, expected)) {
+            ++mismatches;
+            continue;
+        }
+        ReplayKeyframe previous;
+        player.readKeyframe(k - 1, previous);
+        player.seekStep(*aircraft, previous.step);
+        while (player.getCurrentStep() < expected.step && player.step(*aircraft)) {}
+
+        ReplayKeyframe actual = ReplayKeyframe::capture(*aircraft, player.getCurrentStep(), expected.sim_time);
+        bool same = actual.step == expected.step &&
+                    std::memcmp(&actual.position, &expected.position, sizeof(glm::vec3)) == 0 &&
+                    std::memcmp(&actual.orientation, &expected.orientation, sizeof(glm::quat)) == 0 &&
+                    std::memcmp(&actual.velocity, &expected.velocity, sizeof(glm::vec3)) == 0 &&
+                    std::memcmp(&actual.angular_velocity, &expected.angular_velocity, sizeof(glm::vec3)) == 0;
+        if (!same) {
+            if (mismatches == 0) std::cerr << "  first divergence at keyframe " << k << " (step " << expected.step << ")" << std::endl;
+            ++mismatches;
+        }
+    }
+    std::cout << "  verify: " << (player.getKeyframeCount() > 0 ? player.getKeyframeCount() - 1 : 0) << " keyframe spans, "
+              << mismatches << " mismatches" << std::endl;
+    return mismatches == 0 ? 0 : 2;
+}
+
+// --- Command: trim ---
+// "a:b:step" -> a, a+step, ... <= b (a single number gives one value)
+bool parseRange(const std::string& text, std::vector<float>& values) {
+    values.clear();
+    float first = 0.0f, last = 0.0f, step = 0.0f;
+    int fields = std::sscanf(text.c_str(), "%f:%f:%f", &first, &last, &step);
+    if (fields == 1) {
+        values.push_back(first);
+        return true;
+    }
+    if (fields != 3 || step <= 0.0f || last < first) return false;
+    int count = static_cast<int>(std::floor((last - first) / step + 1e-4f)) + 1;
+    for (int i = 0; i < count; ++i) values.push_back(first + step * static_cast<float>(i));
+    return true;
+}
+
+// Trims the default aircraft over a speed x altitude grid and writes the trim values
+// and discrete A/B matrices for each point.
+int runTrim(int argc, char** argv) {
+    std::vector<float> speeds = {120.0f, 150.0f, 180.0f, 210.0f, 240.0f};
+    std::vector<float> altitudes = {500.0f, 2000.0f, 5000.0f, 8000.0f};
+    std::string csv_path;
+    std::string bin_path;
+    size_t threads = 0;
+    TrimSolver::Options options;
+    bool ok = true;
+    for (int i = 0; i < argc && ok; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--speeds" && i + 1 < argc) ok = parseRange(argv[++i], speeds);
+        else if (arg == "--altitudes" && i + 1 < argc) ok = parseRange(argv[++i], altitudes);
+        else if (arg == "--hz" && i + 1 < argc) options.dt = 1.0f / static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--threads" && i + 1 < argc) threads = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--csv" && i + 1 < argc) csv_path = argv[++i];
+        else if (arg == "--bin" && i + 1 < argc) bin_path = argv[++i];
+        else if (arg == "--no-linearize") options.linearize = false;
+        else ok = false;
+    }
+    if (!ok || speeds.empty() || altitudes.empty() || !(options.dt > 0.0f)) {
+        std::cerr << "Usage: trim [--speeds A:B:STEP] [--altitudes A:B:STEP] [--hz H] [--threads T] [--csv FILE] [--bin FILE] [--no-linearize]" << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    TrimSolver solver([] { return AircraftFactory::createDefaultAircraft(); }, options);
+
+    auto t0 = Clock::now();
+    std::vector<TrimPoint> points = solver.solveGrid(speeds, altitudes, pool);
+    double wall = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    size_t converged = 0;
+    for (const auto& p : points) converged += p.converged ? 1 : 0;
+
+    std::cout << "Trimmed " << points.size() << " points (" << speeds.size() << " speeds x " << altitudes.size()
+              << " altitudes) on " << pool.size() << " threads in " << wall << " s: " << converged << " converged\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  " << std::setw(9) << "speed" << std::setw(10) << "altitude" << std::setw(10) << "throttle"
+              << std::setw(10) << "pitch" << std::setw(10) << "elevator" << std::setw(11) << "residual" << "  iters\n";
+    for (const auto& p : points) {
+        std::cout << "  " << std::setw(9) << p.speed << std::setw(10) << p.altitude << std::setw(10) << p.throttle
+                  << std::setw(10) << glm::degrees(p.pitch) << std::setw(10) << p.elevator << std::setw(11) << p.residual
+                  << "  " << p.iterations << (p.converged ? "" : "  (not converged)") << "\n";
+    }
+    std::cout << std::defaultfloat << std::flush;
+
+    if (!csv_path.empty() && !TrimSolver::writeCsv(csv_path, points)) return 1;
+    if (!bin_path.empty() && !TrimSolver::writeBinary(bin_path, points, options.dt)) return 1;
+    return 0;
+}
+
+// --- Command: sweep ---
+// Flies the default maneuver for every combination of the given airframe parameters and
+// prints the best configurations.
+int runSweep(int argc, char** argv) {
+    std::vector<SweepParameter> parameters;
+    SweepRunner::Options options;
+    size_t threads = 0;
+    size_t top = 10;
+    std::string csv_path;
+    bool ok = true;
+    for (int i = 0; i < argc && ok; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--param" && i + 1 < argc) {
+            SweepParameter p;
+            ok = SweepParameter::parse(argv[++i], p);
+            parameters.push_back(p);
+        }
+        else if (arg == "--samples" && i + 1 < argc) options.samples = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--seed" && i + 1 < argc) options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--duration" && i + 1 < argc) options.duration = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--hz" && i + 1 < argc) options.step_rate_hz = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--threads" && i + 1 < argc) threads = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--top" && i + 1 < argc) top = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--csv" && i + 1 < argc) csv_path = argv[++i];
+        else if (arg == "--list") {
+            for (const auto& name : AircraftConfig::parameterNames()) {
+                float value = 0.0f;
+                AircraftConfig{}.get(name, value);
+                std::cout << "  " << std::left << std::setw(16) << name << std::right << value << "\n";
+            }
+            return 0;
+        }
+        else ok = false;
+    }
+    if (!ok || parameters.empty()) {
+        std::cerr << "Usage: sweep --param NAME=MIN:MAX:STEPS [--param ...] [--samples N] [--seed S] [--duration S] [--hz H]\n"
+                  << "             [--threads T] [--top K] [--csv FILE] | --list" << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    SweepRunner sweep(AircraftConfig{}, parameters, options);
+    std::cout << "Sweeping " << sweep.size() << " configurations (" << (options.samples ? "sampled" : "grid")
+              << ") on " << pool.size() << " threads" << std::endl;
+
+    std::atomic<size_t> completed{0};
+    std::atomic<bool> done{false};
+    auto t0 = Clock::now();
+    // Progress about once a second, so long sweeps are visibly alive
+    std::thread reporter([&]() {
+        auto last = Clock::now();
+        while (!done.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (Clock::now() - last < std::chrono::seconds(1)) continue;
+            last = Clock::now();
+            std::cout << "  " << completed.load(std::memory_order_relaxed) << " / " << sweep.size() << std::endl;
+        }
+    });
+    std::vector<SweepResult> results;
+    try {
+        results = sweep.run(pool, &completed);
+    } catch (...) {
+        done = true;
+        reporter.join();
+        throw;
+    }
+    double wall = std::chrono::duration<double>(Clock::now() - t0).count();
+    done = true;
+    reporter.join();
+
+    SweepRunner::rank(results);
+    size_t failed = static_cast<size_t>(std::count_if(results.begin(), results.end(),
+                                                      [](const SweepResult& r) { return r.crashed || r.diverged; }));
+    double sim_total = static_cast<double>(sweep.size()) * options.duration;
+    std::cout << "Flew " << sweep.size() << " configurations in " << wall << " s ("
+              << (wall > 0.0 ? static_cast<double>(sweep.size()) / wall : 0.0) << " configs/s, up to "
+              << (wall > 0.0 ? sim_total / wall : 0.0) << "x real time); " << failed << " crashed or diverged\n";
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  " << std::setw(8) << "index" << std::setw(9) << "score" << std::setw(9) << "roll" << std::setw(9) << "climb"
+              << std::setw(9) << "settle" << std::setw(10) << "alt_loss";
+    for (const auto& p : parameters) std::cout << "  " << p.name;
+    std::cout << "\n";
+    for (size_t i = 0; i < std::min(top, results.size()); ++i) {
+        const SweepResult& r = results[i];
+        std::cout << "  " << std::setw(8) << r.index << std::setw(9) << r.score << std::setw(9) << r.roll_rate
+                  << std::setw(9) << r.climb_rate << std::setw(9) << r.pitch_settle_rms << std::setw(10) << r.altitude_loss;
+        AircraftConfig config = sweep.configAt(r.index);
+        for (const auto& p : parameters) {
+            float value = 0.0f;
+            config.get(p.name, value);
+            std::cout << "  " << value;
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::defaultfloat << std::flush;
+
+    if (!csv_path.empty() && !sweep.writeCsv(csv_path, results)) return 1;
+    return 0;
+}
+
+// --- Command: golden ---
+// record: fly the scripted maneuvers and store them as the reference trajectories
+// check : re-fly every stored maneuver with this build and compare against the reference
+int runGolden(int argc, char** argv) {
+    std::string mode = argc > 0 ? argv[0] : "";
+    std::string path = argc > 1 && argv[1][0] != '-' ? argv[1] : "";
+    std::vector<std::string> maneuvers;
+    float hz = 120.0f;
+    uint32_t interval = 12;
+    IntegratorType integrator = IntegratorType::SemiImplicitEuler;
+    GoldenTolerance tolerance;
+    std::string terrain_path;
+    bool exact = false;
+    bool ok = (mode == "record" || mode == "check") && !path.empty();
+    for (int i = 2; i < argc && ok; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--maneuver" && i + 1 < argc) maneuvers.push_back(argv[++i]);
+        else if (arg == "--hz" && i + 1 < argc) hz = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--interval" && i + 1 < argc) interval = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--integrator" && i + 1 < argc) {
+            std::string name = argv[++i];
+            ok = false;
+            for (IntegratorType type : {IntegratorType::SemiImplicitEuler, IntegratorType::ExponentialMap, IntegratorType::RK4}) {
+                if (name == integratorName(type)) {
+                    integrator = type;
+                    ok = true;
+                }
+            }
+        }
+        else if (arg == "--tol-position" && i + 1 < argc) tolerance.position = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--tol-velocity" && i + 1 < argc) tolerance.velocity = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--tol-attitude" && i + 1 < argc) tolerance.attitude = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--tol-rate" && i + 1 < argc) tolerance.angular_velocity = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--terrain" && i + 1 < argc) terrain_path = argv[++i];
+        else if (arg == "--exact") exact = true;
+        else ok = false;
+    }
+    if (!ok || hz <= 0.0f) {
+        std::cerr << "Usage: golden record <file.fsg> [--maneuver NAME]... [--hz HZ] [--interval STEPS]\n"
+                  << "                     [--integrator SemiImplicitEuler|ExponentialMap|RK4]\n"
+                  << "                     [--tol-position M] [--tol-velocity M/S] [--tol-attitude RAD] [--tol-rate RAD/S]\n"
+                  << "                     [--terrain HEIGHTMAP]  (fly over it, e.g. " << TerrainConfig::HEIGHTMAP_PATH << ")\n"
+                  << "       golden check <file.fsg> [--maneuver NAME]... [--exact]\n"
+                  << "Maneuvers:";
+        for (const auto& name : GoldenHarness::maneuverNames()) std::cerr << " " << name;
+        std::cerr << std::endl;
+        return 1;
+    }
+    auto selected = [&](const std::string& name) {
+        return maneuvers.empty() || std::find(maneuvers.begin(), maneuvers.end(), name) != maneuvers.end();
+    };
+
+    if (mode == "record") {
+        // The terrain's source and hash are stored with each trajectory; check reloads it
+        Heightfield ground;
+        if (!terrain_path.empty() && !ground.loadImage(terrain_path, TerrainConfig::WORLD_SIZE, TerrainConfig::MAX_HEIGHT)) return 1;
+        std::vector<GoldenTrajectory> trajectories;
+        for (const auto& name : GoldenHarness::maneuverNames()) {
+            if (!selected(name)) continue;
+            trajectories.push_back(GoldenHarness::fly(name, 1.0f / hz, interval, integrator, terrain_path.empty() ? nullptr : &ground));
+            trajectories.back().tolerance = tolerance;
+            const ReplayKeyframe& last = trajectories.back().samples.back();
+            std::cout << "  " << std::left << std::setw(8) << name << std::right << trajectories.back().step_count << " steps, final altitude "
+                      << last.position.y << " m, speed " << glm::length(last.velocity) << " m/s\n";
+        }
+        if (trajectories.empty()) {
+            std::cerr << "No maneuvers selected" << std::endl;
+            return 1;
+        }
+        if (!GoldenHarness::save(path, trajectories)) return 1;
+        std::cout << "Wrote " << trajectories.size() << " reference trajectories (" << integratorName(integrator) << ", "
+                  << hz << " Hz) to " << path << std::endl;
+        return 0;
+    }
+
+    std::vector<GoldenTrajectory> references;
+    if (!GoldenHarness::load(path, references)) return 1;
+    size_t failures = 0, checked = 0;
+    std::cout << std::left << std::setw(8) << "maneuver" << std::right;
+    for (int c = 0; c < GoldenComparison::CHANNEL_COUNT; ++c) std::cout << std::setw(18) << GoldenComparison::channelName(c);
+    std::cout << "  bit-exact\n";
+    for (const GoldenTrajectory& reference : references) {
+        if (!selected(reference.maneuver)) continue;
+        ++checked;
+        GoldenComparison result = GoldenHarness::check(reference);
+        bool pass = !result.structure_mismatch && result.within_tolerance && (!exact || result.bit_exact);
+        failures += !pass;
+
+        std::cout << std::left << std::setw(8) << reference.maneuver << std::right;
+        if (result.ground_unavailable) {
+            std::cout << "  terrain " << reference.ground.path << " not available  FAIL\n";
+            continue;
+        }
+        if (result.structure_mismatch) {
+            std::cout << "  step/sample counts differ from the reference  FAIL\n";
+            continue;
+        }
+        const float bounds[GoldenComparison::CHANNEL_COUNT] = {reference.tolerance.position, reference.tolerance.velocity,
+                                                               reference.tolerance.attitude, reference.tolerance.angular_velocity};
+        for (int c = 0; c < GoldenComparison::CHANNEL_COUNT; ++c) {
+            std::ostringstream cell;
+            cell << std::setprecision(3) << result.max_error[c] << (result.max_error[c] <= bounds[c] ? "" : "!")
+                 << "/" << bounds[c];
+            std::cout << std::setw(18) << cell.str();
+        }
+        if (result.bit_exact) std::cout << "  yes";
+        else std::cout << "  no (step " << result.first_divergent_step << ")";
+        std::cout << (pass ? "  ok" : "  FAIL") << "\n";
+    }
+    std::cout << checked << " maneuvers checked, " << failures << " failed (max error/bound per channel, ! = over bound)" << std::endl;
+    return failures == 0 && checked > 0 ? 0 : 2;
+}
+
+// --- Command: bake ---
+// Convert images into GPU-ready <image>.ftex files next to them (see BakedTexture.h); the viewer
+// picks those up instead of decoding the image. Up-to-date outputs are skipped unless --force.
+int runBake(int argc, char** argv) {
+    BakedTexture::BakeOptions options;
+    bool force = false;
+    bool ok = true;
+    std::vector<std::string> inputs;
+    for (int i = 0; i < argc && ok; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--bc1") options.bc1 = true;
+        else if (arg == "--no-mips") options.mipmaps = false;
+        else if (arg == "--force") force = true;
+        else if (!arg.empty() && arg[0] != '-') inputs.push_back(arg);
+        else ok = false;
+    }
+    if (!ok || inputs.empty()) {
+        std::cerr << "Usage: bake [--bc1] [--no-mips] [--force] <image> [<image> ...]" << std::endl;
+        return 1;
+    }
+
+    int failures = 0;
+    for (const std::string& input : inputs) {
+        std::string output = BakedTexture::pathFor(input);
+        if (!force && !BakedTexture::findFor(input).empty()) {
+            std::cout << output << " is up to date" << std::endl;
+            continue;
+        }
+        auto start = Clock::now();
+        if (!BakedTexture::bake(input, output, options)) {
+            ++failures;
+            continue;
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        BakedTexture baked;
+        if (!baked.open(output)) {
+            ++failures;
+            continue;
+        }
+        std::error_code ec;
+        auto source_bytes = std::filesystem::file_size(input, ec);
+        std::cout << output << ": " << baked.getWidth() << "x" << baked.getHeight() << ", " << baked.getLevelCount() << " levels, "
+                  << (baked.isCompressed() ? "BC1" : std::to_string(baked.getChannels()) + " x 8-bit") << ", "
+                  << baked.getFileSize() / 1024 << " KB (source " << (ec ? 0 : source_bytes / 1024) << " KB), "
+                  << std::fixed << std::setprecision(2) << seconds << " s" << std::defaultfloat << std::endl;
+    }
+    return failures == 0 ? 0 : 2;
+}
+
+// --- Command: pack-terrain ---
+// Decode a z/x/y terrain tile tree once into the single mapped file TileManager reads
+int runPackTerrain(int argc, char** argv) {
+    std::string root = "assets/textures/terrain/data/";
+    std::string output = "assets/textures/terrain/data.ftp";
+    TerrainPack::BuildOptions options;
+    bool ok = true;
+    for (int i = 0; i < argc && ok; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--root" && i + 1 < argc) root = argv[++i];
+        else if (arg == "--out" && i + 1 < argc) output = argv[++i];
+        else if (arg == "--float") options.float_heights = true;
+        else if (arg == "--encoded") options.height_source = TerrainHeightSource::Encoded;
+        else if (arg == "--8bit") options.height_source = TerrainHeightSource::Heightmap8;
+        else if (arg == "--height-step" && i + 1 < argc) options.height_step = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--min-zoom" && i + 1 < argc) options.min_zoom = std::atoi(argv[++i]);
+        else ok = false;
+    }
+    if (!ok) {
+        std::cerr << "Usage: pack-terrain [--root DIR] [--out FILE] [--float] [--encoded | --8bit] [--height-step METRES] [--min-zoom Z]" << std::endl;
+        return 1;
+    }
+
+    auto start = Clock::now();
+    TerrainPack::BuildReport report;
+    if (!TerrainPack::build(root, output, options, &report)) return 1;
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    TerrainPack pack;
+    if (!pack.open(output)) return 1;
+    std::cout << std::fixed << std::setprecision(1);
+    for (const TerrainPackEntry& entry : pack.getEntries()) {
+        std::cout << "  " << entry.z << "/" << entry.x << "/" << entry.y;
+        if (entry.hasHeights()) {
+            std::cout << "  heights " << entry.height_width << "x" << entry.height_height << " "
+                      << entry.min_height << " - " << entry.max_height << " m"
+                      << (entry.flags & TerrainPackEntry::HEIGHTS_REFINED ? " (refined)" : "")
+                      << (entry.flags & TerrainPackEntry::HEIGHTS_GENERATED ? " (generated)" : "")
+                      << (entry.flags & TerrainPackEntry::HEIGHTS_PARTIAL ? " (partial)" : "");
+        }
+        if (entry.normalmap.channels) std::cout << "  normalmap";
+        if (entry.texture.channels) std::cout << "  texture";
+        std::cout << "\n";
+    }
+    const char* source = pack.getHeightSource() == TerrainHeightSource::Encoded      ? "heightmap_encoded.png"
+                         : pack.getHeightSource() == TerrainHeightSource::Heightmap8 ? "8-bit heightmap.png"
+                                                                                     : "none";
+    std::cout << output << ": " << report.tiles << " tiles (" << report.tiles_with_heights << " with heights from " << source << ", "
+              << report.generated_tiles << " generated, " << report.refined_quadrants << " quadrants refined, max change " << report.max_refinement_change << " m), "
+              << report.file_bytes / (1024 * 1024) << " MB, " << std::setprecision(2) << seconds << " s" << std::defaultfloat << std::endl;
+    return 0;
+}
+
+void printUsage(const char* exe) {
+    std::cerr << "Usage: " << exe << " <command> [options]\n"
+              << "Commands:\n"
+              << "  batch   Run N randomized scripted flights across a thread pool and print summary statistics\n"
+              << "  replay  Play back a .fsr recording, seek, and verify determinism against its keyframes\n"
+              << "  trim    Trim the aircraft over a speed/altitude grid and linearize around each point\n"
+              << "  sweep   Fly a maneuver for every combination of airframe parameters and rank them\n"
+              << "  golden  Record reference maneuver trajectories, or check this build against them\n"
+              << "  bake    Convert images into GPU-ready .ftex textures (mip chain, optional BC1) next to them\n"
+              << "  pack-terrain  Decode the terrain tile tree into one indexed, memory-mappable height/image pack\n"
+              << "Options for every command:\n"
+              << "  --trace FILE  Write a Chrome trace (chrome://tracing, ui.perfetto.dev) on exit; needs FLIGHTSIM_ENABLE_TRACE\n"
+              << "  --trace-events N  Zones kept per recording thread (default " << Trace::DEFAULT_EVENTS_PER_THREAD << ")\n";
+}
+
+int runCommand(const std::string& command, int argc, char** argv) {
+    if (command == "batch") return runBatch(argc, argv);
+    if (command == "replay") return runReplay(argc, argv);
+    if (command == "trim") return runTrim(argc, argv);
+    if (command == "sweep") return runSweep(argc, argv);
+    if (command == "golden") return runGolden(argc, argv);
+    if (command == "bake") return runBake(argc, argv);
+    if (command == "pack-terrain") return runPackTerrain(argc, argv);
+    return -1; // Unknown command
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // --trace FILE and --trace-events N are taken out before the command sees its arguments
+    std::vector<char*> args;
+    std::string trace_path;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) trace_path = argv[++i];
+        else if (std::strcmp(argv[i], "--trace-events") == 0 && i + 1 < argc) Trace::setEventsPerThread(std::strtoull(argv[++i], nullptr, 10));
+        else args.push_back(argv[i]);
+    }
+    if (args.size() < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (!trace_path.empty() && !Trace::isCompiledIn()) {
+        std::cerr << "Error: --trace needs a build configured with -DFLIGHTSIM_ENABLE_TRACE=ON" << std::endl;
+        return 1;
+    }
+    FS_TRACE_THREAD("main");
+
+    int result = 1;
+    try {
+        result = runCommand(args[1], static_cast<int>(args.size()) - 2, args.data() + 2);
+    } catch (const std::exception& e) {
+        std::cerr << "FATAL ERROR: " << e.what() << std::endl;
+        result = 1;
+    }
+    if (result < 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    size_t events = 0;
+    if (!trace_path.empty()) {
+        if (!Trace::dump(trace_path, &events)) return 1;
+        std::cerr << "Trace: " << events << " events written to " << trace_path << std::endl;
+    }
+    return result;
+}
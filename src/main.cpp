@@ -1,53 +1,84 @@
 #include "Graphics.h"
 #include "Aircraft.h"
+#include "AircraftFactory.h"
+#include "AircraftRenderer.h"
 #include "Terrain.h"    // <-- Include Terrain
 #include "MiniMap.h"
 #include "Camera.h"
 #include "Input.h"
 #include "Shader.h"
 #include "PhysicsConfig.h" // For aircraft setup if needed here
+#include "PhysicsScheduler.h"
+#include "Replay.h"
+#include "AsyncTextureLoader.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <vector>
 #include <stdexcept> // Needed for try/catch
 
 void renderUI(const Aircraft& aircraft); // Forward declare
 
-int main() {
+int main(int argc, char** argv) {
+    // --- Command Line ---
+    // --record <file.fsr>: capture this session for deterministic replay (see FlightSimHeadless replay)
+    // --profile: start with the frame profiler shown (F3 toggles it)
+    // --trace <file.json>: Chrome trace written on exit (F4 writes one any time); needs FLIGHTSIM_ENABLE_TRACE
+    // --trace-events <N>: zones kept per recording thread (Trace::DEFAULT_EVENTS_PER_THREAD)
+    std::string recordPath;
+    std::string tracePath;
+    bool profile = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) recordPath = argv[++i];
+        else if (arg == "--profile") profile = true;
+        else if (arg == "--trace" && i + 1 < argc) tracePath = argv[++i];
+        else if (arg == "--trace-events" && i + 1 < argc) Trace::setEventsPerThread(std::strtoull(argv[++i], nullptr, 10));
+    }
+    if (!tracePath.empty() && !Trace::isCompiledIn()) {
+        std::cerr << "Warning: --trace ignored, this build has no tracing (configure with -DFLIGHTSIM_ENABLE_TRACE=ON)" << std::endl;
+        tracePath.clear();
+    }
+    FS_TRACE_THREAD("main");
+
     try { // Add a try-catch block for easier error handling during init
         // --- Initialization ---
         if (!Graphics::init(1600, 900, "Flight Simulator")) { // Use a good resolution
             std::cerr << "Failed to initialize Graphics!" << std::endl;
             return -1;
         }
+        Profiler::init("Flight Simulator");
+        Profiler::setEnabled(profile);
 
-        // --- Create Aircraft (as before) ---
-        Engine engine(PhysicsConfig::DEFAULT_THRUST);
-        std::vector<WingPtr> wings;
-        auto addWing = [&](const std::string& name, const glm::vec3& pos, float span, float chord, const Airfoil* foil, const glm::vec3& normal = PhysicsConfig::BODY_UP, float flapRatio = 0.0f) {
-            if (!foil) throw std::runtime_error("Null airfoil for " + name);
-            wings.push_back(std::make_unique<Wing>(name, pos, span, chord, foil, normal, flapRatio));
-        };
-        addWing("Left Wing",       PhysicsConfig::LEFT_WING_POS,      6.96f, 2.50f, &Aircraft::airfoil_naca2412);
-        addWing("Right Wing",      PhysicsConfig::RIGHT_WING_POS,     6.96f, 2.50f, &Aircraft::airfoil_naca2412);
-        addWing("Left Aileron",    PhysicsConfig::LEFT_AILERON_POS,   3.80f, 1.26f, &Aircraft::airfoil_naca0012, PhysicsConfig::BODY_UP, 1.0f);
-        addWing("Right Aileron",   PhysicsConfig::RIGHT_AILERON_POS,  3.80f, 1.26f, &Aircraft::airfoil_naca0012, PhysicsConfig::BODY_UP, 1.0f);
-        addWing("Elevator",        PhysicsConfig::ELEVATOR_POS,       6.54f, 2.70f, &Aircraft::airfoil_naca0012, PhysicsConfig::BODY_UP, 1.0f);
-        addWing("Rudder",          PhysicsConfig::RUDDER_POS,         5.31f, 3.10f, &Aircraft::airfoil_naca0012, PhysicsConfig::BODY_RIGHT, 1.0f);
-
-        Aircraft aircraft(
-            PhysicsConfig::DEFAULT_MASS,
-            PhysicsConfig::DEFAULT_INERTIA_TENSOR,
-            engine,
-            std::move(wings)
-        );
-        aircraft.position_world = glm::vec3(0.0f, 1000.0f, 0.0f);
-        aircraft.velocity_world = glm::vec3(180.0f, 0.0f, 0.0f);
-        aircraft.orientation_world = glm::quatLookAt(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        // --- Create Aircraft ---
+        std::unique_ptr<Aircraft> aircraftPtr = AircraftFactory::createDefaultAircraft();
+        Aircraft& aircraft = *aircraftPtr;
+        AircraftRenderer aircraftRenderer; // GL mesh for the aircraft (needs the context from Graphics::init)
 
 
         // --- Create Terrain ---
         Terrain terrain; // Instantiate the new terrain system
+        aircraft.ground = &terrain.getHeightfield(); // Contact with the rendered terrain, not y = 0
+        TileManager terrainTiles; // Streams z/x/y tiles Terrain draws beyond the heightfield square
+
+
+        // --- Physics Loop ---
+        // Fixed 120 Hz steps, at most 8 per frame; rendering interpolates between steps
+        PhysicsScheduler physics(120.0f, 8);
+        physics.addBody(&aircraft);
+
+        // Inputs are captured per fixed step; the recorder writes on its own thread.
+        // The heightfield's source goes in the header so playback flies over the same terrain.
+        ReplayRecorder recorder(120); // Keyframe once per simulated second
+        if (!recordPath.empty() && recorder.open(recordPath, physics.getFixedDt(), aircraft.ground)) {
+            std::cout << "Recording replay to " << recordPath << std::endl;
+        }
+        physics.pre_step = [&](float dt) {
+            recorder.recordStep(aircraft, aircraft.controls, dt);
+        };
 
 
         // --- Other Game Objects ---
@@ -61,21 +92,46 @@ int main() {
 
         // --- Main Loop ---
         while (!Graphics::shouldClose()) {
+            FS_TRACE_ZONE("frame");
+            Profiler::beginFrame();
+
             // --- Timing ---
             float currentFrame = static_cast<float>(glfwGetTime());
             deltaTime = currentFrame - lastFrame;
             lastFrame = currentFrame;
-            if (deltaTime > 0.1f) deltaTime = 0.1f;
-            if (deltaTime <= 0.0f) deltaTime = 0.0001f;
 
             // --- Input ---
-            Input::ProcessInput(Graphics::getWindow());
+            {
+                Profiler::CpuScope scope("input");
+                Input::ProcessInput(Graphics::getWindow());
+                if (Input::consumeKeyPress(GLFW_KEY_F3)) Profiler::toggle();
+                if (Input::consumeKeyPress(GLFW_KEY_F4) && Trace::isCompiledIn()) {
+                    std::string path = tracePath.empty() ? "trace.json" : tracePath;
+                    size_t events = 0;
+                    if (Trace::dump(path, &events)) std::cout << "Trace: " << events << " events written to " << path << std::endl;
+                }
+            }
 
             // --- Update ---
-            aircraft.update(deltaTime);
+            aircraft.controls = {Input::Throttle, Input::Pitch, Input::Roll, Input::Yaw};
+            {
+                // Scheduler clamps long frames and runs whole fixed steps only
+                Profiler::CpuScope scope("Aircraft::update");
+                physics.advance(deltaTime);
+            }
+            PhysicsScheduler::Pose aircraftPose = physics.getInterpolatedPose(&aircraft);
 
             // --- Camera Update ---
-            camera.Follow(aircraft.position_world, aircraft.orientation_world, 25.0f, 10.0f); // Adjusted follow
+            camera.Follow(aircraftPose.position, aircraftPose.orientation, 25.0f, 10.0f); // Adjusted follow
+
+            // --- Streaming ---
+            // Tiles and textures decode on worker threads; uploads are spread over frames within a time budget
+            {
+                Profiler::CpuScope scope("streaming");
+                terrainTiles.update(camera.Position);
+                terrain.updateTiles(terrainTiles);
+                Graphics::textureLoader->update();
+            }
 
             // --- Rendering ---
             Graphics::clear();
@@ -87,39 +143,72 @@ int main() {
 
             glm::mat4 view = camera.GetViewMatrix();
 
+            // --- Per-Frame Uniforms ---
+            // Uploaded once and shared by the terrain, basic and minimap programs
+            FrameData frame;
+            frame.view = view;
+            frame.projection = projection;
+            frame.view_projection = projection * view;
+            frame.screen_projection = glm::ortho(0.0f, (float)screenWidth, (float)screenHeight, 0.0f, -1.0f, 1.0f);
+            frame.camera_position = glm::vec4(camera.Position, 1.0f);
+            frame.sun_direction = glm::vec4(glm::normalize(glm::vec3(-0.4f, -0.8f, -0.2f)), 0.0f); // Example sun direction
+            frame.fog_color = glm::vec4(0.5f, 0.6f, 0.7f, 0.00005f); // Sky colour, very low density for objects
+            frame.fog_range = glm::vec4(1000.0f, 60000.0f, 0.0f, 0.0f);
+            if (screenWidth > 0 && screenHeight > 0) {
+                frame.viewport = glm::vec4((float)screenWidth, (float)screenHeight, 1.0f / screenWidth, 1.0f / screenHeight);
+            }
+            Graphics::setFrameData(frame);
+
             // --- Render Terrain ---
-            glm::vec3 sunDirection = glm::normalize(glm::vec3(-0.4f, -0.8f, -0.2f)); // Example sun direction
-            terrain.draw(camera, projection, sunDirection);
+            {
+                Profiler::CpuScope scope("Terrain::draw");
+                Profiler::GpuScope gpu("terrain");
+                terrain.draw(frame);
+            }
 
             // --- Render Aircraft ---
-            if (Graphics::basicShader) {
-                Graphics::basicShader->use();
-                Graphics::basicShader->setVec3("cameraPos", camera.Position);
-                Graphics::basicShader->setVec3("fogColor", glm::vec3(0.5f, 0.6f, 0.7f));
-                Graphics::basicShader->setFloat("fogDensity", 0.00005f); // Very low density
-                // Aircraft::render sets its own view/projection uniforms
-                aircraft.render(view, projection, camera.Position);
-                Graphics::basicShader->use(false);
+            {
+                Profiler::CpuScope scope("aircraft");
+                Profiler::GpuScope gpu("aircraft");
+                aircraftRenderer.render(aircraftPose.position, aircraftPose.orientation);
             }
 
             // --- Render 2D Overlays ---
             // Use terrain size or a large fixed value for minimap scale
-            miniMap.render(aircraft.position_world, aircraft.orientation_world, terrain.getTerrainSize());
+            {
+                Profiler::CpuScope scope("MiniMap::render");
+                Profiler::GpuScope gpu("minimap");
+                miniMap.render(aircraftPose.position, aircraftPose.orientation, terrain.getTerrainSize());
+            }
             renderUI(aircraft);
 
             // --- Swap Buffers & Poll Events ---
-            Graphics::swapBuffers();
+            {
+                // Includes vsync wait and any driver-side flush
+                Profiler::CpuScope scope("swap");
+                FS_TRACE_ZONE("swap");
+                Graphics::swapBuffers();
+            }
+            Profiler::endFrame();
         }
 
         // --- Cleanup ---
+        recorder.close(); // Writes the keyframe index
+        size_t traceEvents = 0;
+        if (!tracePath.empty() && Trace::dump(tracePath, &traceEvents)) {
+            std::cout << "Trace: " << traceEvents << " events written to " << tracePath << std::endl;
+        }
+        Profiler::cleanup();
         Graphics::cleanup(); // Handles basicShader etc.
 
     } catch (const std::exception& e) {
         std::cerr << "FATAL ERROR: " << e.what() << std::endl;
+        Profiler::cleanup();
         Graphics::cleanup(); // Attempt cleanup even on error
         return -1;
     } catch (...) {
          std::cerr << "FATAL UNKNOWN ERROR occurred." << std::endl;
+         Profiler::cleanup();
          Graphics::cleanup();
          return -1;
     }
@@ -129,4 +218,7 @@ int main() {
 }
 
 // ... renderUI function ...
-void renderUI(const Aircraft& aircraft) { /* ... placeholder ... */ }
+void renderUI(const Aircraft& aircraft) {
+    // Frame profiler (F3): graph and breakdown bars; the numbers are in the window title
+    Profiler::renderHud();
+}
@@ -0,0 +1,473 @@
+// Microbenchmarks for the flight-model hot path (no graphics context needed).
+// Each case is timed in isolation with an auto-calibrated iteration count; results are
+// reported as ns/op, allocations/op and ops/s, and optionally written as JSON so two
+// builds can be diffed.
+// Usage: FlightSimMicrobench [--filter TEXT] [--min-time S] [--repeats N] [--max-aircraft N] [--json PATH]
+#include "AeroModel.h"
+#include "Aircraft.h"
+#include "AircraftFactory.h"
+#include "Atmosphere.h"
+#include "PhysicsConfig.h"
+#include "PhysicsScheduler.h"
+#include "RigidBody.h"
+#include "RigidBodyBatch.h"
+#include "Wing.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// --- Allocation counting ---
+// Replacing the global operator new in this executable counts every heap allocation made by
+// the physics library while a case runs (relaxed atomics: one uncontended add per call).
+// Every replaceable form is covered (plain, nothrow, aligned), so 0 allocs/op means none.
+namespace {
+std::atomic<uint64_t> allocation_count{0};
+std::atomic<uint64_t> allocation_bytes{0};
+
+void* countedAllocNoThrow(std::size_t size, std::size_t alignment = 0) noexcept {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+#if defined(_MSC_VER)
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc needs a size that is a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void* countedAlloc(std::size_t size, std::size_t alignment = 0) {
+    if (void* p = countedAllocNoThrow(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void countedFree(void* p, std::size_t alignment = 0) noexcept {
+#if defined(_MSC_VER)
+    if (alignment > alignof(std::max_align_t)) {
+        _aligned_free(p);
+        return;
+    }
+#endif
+    (void)alignment;
+    std::free(p);
+}
+} // namespace
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAllocNoThrow(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAllocNoThrow(size); }
+void* operator new(std::size_t size, std::align_val_t al) { return countedAlloc(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return countedAlloc(size, static_cast<std::size_t>(al)); }
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return countedAllocNoThrow(size, static_cast<std::size_t>(al));
+}
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return countedAllocNoThrow(size, static_cast<std::size_t>(al));
+}
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t al) noexcept { countedFree(p, static_cast<std::size_t>(al)); }
+void operator delete[](void* p, std::align_val_t al) noexcept { countedFree(p, static_cast<std::size_t>(al)); }
+void operator delete(void* p, std::size_t, std::align_val_t al) noexcept { countedFree(p, static_cast<std::size_t>(al)); }
+void operator delete[](void* p, std::size_t, std::align_val_t al) noexcept { countedFree(p, static_cast<std::size_t>(al)); }
+void operator delete(void* p, std::align_val_t al, const std::nothrow_t&) noexcept { countedFree(p, static_cast<std::size_t>(al)); }
+void operator delete[](void* p, std::align_val_t al, const std::nothrow_t&) noexcept { countedFree(p, static_cast<std::size_t>(al)); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Results feed this so the optimizer cannot drop the measured work
+volatile float benchmark_sink = 0.0f;
+
+struct Options {
+    std::string filter;
+    double min_time = 0.2; // Seconds per timed repeat
+    int repeats = 5;
+    size_t max_aircraft = 64;
+    std::string json_path;
+};
+
+struct Result {
+    std::string name;
+    std::string unit;          // What one "op" is
+    uint64_t iterations = 0;   // Ops per timed repeat
+    double ns_per_op = 0.0;    // Median over repeats
+    double min_ns_per_op = 0.0;
+    double max_ns_per_op = 0.0;
+    double ops_per_second = 0.0;
+    double allocs_per_op = 0.0;
+    double bytes_per_op = 0.0;
+};
+
+class Suite {
+public:
+    explicit Suite(Options opts) : options(std::move(opts)) {}
+
+    // `body(n)` performs n iterations of ops_per_iteration ops each. Iterations double until one
+    // run takes min_time / 8, are then scaled to min_time, and the timed run is repeated; the
+    // median is reported.
+    void run(const std::string& name, const std::string& unit, const std::function<void(uint64_t)>& body,
+             uint64_t ops_per_iteration = 1) {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+
+        uint64_t n = 1;
+        double elapsed = 0.0;
+        for (;;) {
+            elapsed = timeOnce(body, n);
+            if (elapsed >= options.min_time / 8.0 || n >= (1ull << 40)) break;
+            n *= 2;
+        }
+        n = std::max<uint64_t>(1, static_cast<uint64_t>(static_cast<double>(n) * options.min_time / std::max(elapsed, 1e-9)));
+
+        const double ops = static_cast<double>(n * ops_per_iteration);
+        std::vector<double> samples;
+        uint64_t allocs = 0, bytes = 0;
+        for (int r = 0; r < options.repeats; ++r) {
+            uint64_t a0 = allocation_count.load(std::memory_order_relaxed);
+            uint64_t b0 = allocation_bytes.load(std::memory_order_relaxed);
+            samples.push_back(timeOnce(body, n) * 1.0e9 / ops);
+            allocs += allocation_count.load(std::memory_order_relaxed) - a0;
+            bytes += allocation_bytes.load(std::memory_order_relaxed) - b0;
+        }
+        std::sort(samples.begin(), samples.end());
+
+        Result result;
+        result.name = name;
+        result.unit = unit;
+        result.iterations = n * ops_per_iteration;
+        result.ns_per_op = samples[samples.size() / 2];
+        result.min_ns_per_op = samples.front();
+        result.max_ns_per_op = samples.back();
+        result.ops_per_second = 1.0e9 / result.ns_per_op;
+        double total_ops = ops * options.repeats;
+        result.allocs_per_op = static_cast<double>(allocs) / total_ops;
+        result.bytes_per_op = static_cast<double>(bytes) / total_ops;
+        print(result);
+        results.push_back(result);
+    }
+
+    const Options& getOptions() const { return options; }
+
+    bool writeJson(const std::string& path) const;
+
+private:
+    Options options;
+    std::vector<Result> results;
+
+    static double timeOnce(const std::function<void(uint64_t)>& body, uint64_t n) {
+        auto t0 = Clock::now();
+        body(n);
+        return std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+
+    static void print(const Result& r) {
+        std::cout << std::left << std::setw(40) << r.name << std::right << std::fixed
+                  << std::setw(12) << std::setprecision(1) << r.ns_per_op << " ns/op"
+                  << std::setw(10) << std::setprecision(3) << r.allocs_per_op << " allocs/op"
+                  << std::setw(14) << std::setprecision(0) << r.ops_per_second << " " << r.unit << "/s"
+                  << "  (min " << std::setprecision(1) << r.min_ns_per_op << ", max " << r.max_ns_per_op << ")"
+                  << std::defaultfloat << std::endl;
+    }
+};
+
+std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+bool Suite::writeJson(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+    }
+#if defined(__clang__)
+    const std::string compiler = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    const std::string compiler = std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    const std::string compiler = "msvc " + std::to_string(_MSC_VER);
+#else
+    const std::string compiler = "unknown";
+#endif
+#ifdef NDEBUG
+    const char* build = "release";
+#else
+    const char* build = "debug";
+#endif
+
+    file << std::setprecision(9);
+    file << "{\n"
+         << "  \"suite\": \"flightsim-microbench\",\n"
+         << "  \"compiler\": \"" << jsonEscape(compiler) << "\",\n"
+         << "  \"build\": \"" << build << "\",\n"
+         << "  \"simd\": \"" << RigidBodyBatch::simdPath() << "\",\n"
+         << "  \"min_time_s\": " << options.min_time << ",\n"
+         << "  \"repeats\": " << options.repeats << ",\n"
+         << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        file << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"unit\": \"" << jsonEscape(r.unit) << "\""
+             << ", \"iterations\": " << r.iterations
+             << ", \"ns_per_op\": " << r.ns_per_op
+             << ", \"min_ns_per_op\": " << r.min_ns_per_op
+             << ", \"max_ns_per_op\": " << r.max_ns_per_op
+             << ", \"ops_per_second\": " << r.ops_per_second
+             << ", \"allocs_per_op\": " << r.allocs_per_op
+             << ", \"bytes_per_op\": " << r.bytes_per_op << "}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n}\n";
+    return static_cast<bool>(file);
+}
+
+// Cruise state shared by the body/aircraft cases: 1000 m, 60 m/s along world +X, slight climb
+void setCruiseState(RigidBody& body) {
+    body.position_world = glm::vec3(0.0f, 1000.0f, 0.0f);
+    body.orientation_world = glm::angleAxis(glm::radians(3.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    body.velocity_world = glm::vec3(60.0f, 0.0f, 0.0f);
+    body.angular_velocity_body = glm::vec3(0.0f);
+}
+
+// Simulated time before a flying case restores the cruise state (keeps the aircraft off the
+// ground clamp however long the calibrated run gets; the reset is a few stores per 10 s)
+const uint64_t RESET_STEPS = 1200;
+
+// --- Cases: airfoil tables ---
+void benchAirfoil(Suite& suite) {
+    const Airfoil& foil = Aircraft::airfoilNACA2412();
+    const float lo = foil.getAlphaMin(), span = foil.getAlphaMax() - foil.getAlphaMin();
+
+    suite.run("airfoil.sample", "samples", [&](uint64_t n) {
+        float acc = 0.0f, alpha = lo, step = span / 997.0f;
+        for (uint64_t i = 0; i < n; ++i) {
+            float cl, cd;
+            std::tie(cl, cd) = foil.sample(alpha);
+            acc += cl + cd;
+            alpha += step;
+            if (alpha > lo + span) alpha = lo;
+        }
+        benchmark_sink = acc;
+    });
+
+    suite.run("airfoil.sample_reynolds_mach", "samples", [&](uint64_t n) {
+        const AtmosphereState air = Atmosphere::sample(1000.0f);
+        float acc = 0.0f, alpha = lo, step = span / 997.0f, speed = 40.0f;
+        for (uint64_t i = 0; i < n; ++i) {
+            float reynolds = air.density * speed * 1.5f / air.dynamic_viscosity;
+            float cl, cd;
+            std::tie(cl, cd) = foil.sample(alpha, reynolds, speed / air.speed_of_sound);
+            acc += cl + cd;
+            alpha += step;
+            if (alpha > lo + span) alpha = lo;
+            speed = speed > 120.0f ? 40.0f : speed + 0.37f;
+        }
+        benchmark_sink = acc;
+    });
+}
+
+// --- Cases: single wing ---
+void benchWing(Suite& suite) {
+    Wing wing("Bench Aileron", glm::vec3(-1.0f, 5.0f, 0.0f), 3.0f, 1.0f, &Aircraft::airfoilNACA0012(),
+              PhysicsConfig::BODY_UP, 1.0f);
+
+    suite.run("wing.calculate_effective_normal", "normals", [&](uint64_t n) {
+        float acc = 0.0f, input = -1.0f;
+        for (uint64_t i = 0; i < n; ++i) {
+            wing.control_input = input;
+            acc += wing.calculateEffectiveNormal(20.0f).y;
+            input = input > 1.0f ? -1.0f : input + 0.013f;
+        }
+        benchmark_sink = acc;
+    });
+
+    RigidBody body;
+    body.mass = PhysicsConfig::DEFAULT_MASS;
+    body.setInertiaTensor(PhysicsConfig::DEFAULT_INERTIA_TENSOR);
+    setCruiseState(body);
+    body.angular_velocity_body = glm::vec3(0.1f, 0.05f, 0.02f);
+
+    // What Aircraft runs: the wing compiled into a one-surface AeroModel, controls pushed
+    // each step, air sampled once per step
+    std::vector<std::unique_ptr<Wing>> wings;
+    wings.push_back(std::make_unique<Wing>(wing));
+    Wing& compiled_wing = *wings.front();
+    AeroModel model;
+    model.compile(wings, {20.0f});
+    const AtmosphereState air = Atmosphere::sample(body.position_world.y);
+    suite.run("wing.apply_forces", "wings", [&](uint64_t n) {
+        float input = -1.0f;
+        for (uint64_t i = 0; i < n; ++i) {
+            compiled_wing.control_input = input;
+            model.updateControls(wings);
+            AeroModel::Loads loads = model.evaluate(body, air);
+            body.addForceWorld(loads.force_world);
+            body.addTorqueBody(loads.torque_body);
+            input = input > 1.0f ? -1.0f : input + 0.013f;
+            if ((i & 1023) == 1023) body.clearAccumulators();
+        }
+        benchmark_sink = body.getForceAccumulatorWorld().y;
+        body.clearAccumulators();
+    });
+
+    // Per-wing path kept as the reference the compiled model is checked against
+    suite.run("wing.apply_forces.reference", "wings", [&](uint64_t n) {
+        float input = -1.0f;
+        for (uint64_t i = 0; i < n; ++i) {
+            wing.control_input = input;
+            wing.applyForces(&body);
+            input = input > 1.0f ? -1.0f : input + 0.013f;
+            if ((i & 1023) == 1023) body.clearAccumulators();
+        }
+        benchmark_sink = body.getForceAccumulatorWorld().y;
+        body.clearAccumulators();
+    });
+    wing.control_input = 0.0f;
+}
+
+// --- Cases: compiled aero model of the default aircraft (the per-step aerodynamics) ---
+void benchAeroModel(Suite& suite) {
+    std::unique_ptr<Aircraft> aircraft = AircraftFactory::createDefaultAircraft();
+    setCruiseState(*aircraft);
+    aircraft->angular_velocity_body = glm::vec3(0.1f, 0.05f, 0.02f);
+    const AeroModel& model = aircraft->getAeroModel();
+    const AtmosphereState air = Atmosphere::sample(aircraft->position_world.y);
+
+    // One op = one aircraft's surfaces evaluated; state is fixed, so this is the kernel alone
+    suite.run("aero.evaluate." + std::to_string(model.size()) + "_surfaces", "evaluations", [&](uint64_t n) {
+        float acc = 0.0f;
+        for (uint64_t i = 0; i < n; ++i) {
+            AeroModel::Loads loads = model.evaluate(*aircraft, air);
+            acc += loads.force_world.y;
+            aircraft->angular_velocity_body.x = -aircraft->angular_velocity_body.x; // Defeat hoisting
+        }
+        benchmark_sink = acc;
+    });
+}
+
+// --- Cases: rigid body integration (constant load, one case per integrator) ---
+void benchRigidBody(Suite& suite) {
+    for (IntegratorType type : {IntegratorType::SemiImplicitEuler, IntegratorType::ExponentialMap, IntegratorType::RK4}) {
+        RigidBody body;
+        body.mass = PhysicsConfig::DEFAULT_MASS;
+        body.setInertiaTensor(PhysicsConfig::DEFAULT_INERTIA_TENSOR);
+        body.integrator = type;
+        setCruiseState(body);
+        const float dt = 1.0f / 120.0f;
+
+        suite.run(std::string("rigidbody.update.") + integratorName(type), "steps", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                body.addForceWorld(glm::vec3(0.0f, body.mass * 9.81f, 0.0f)); // Hover: position stays bounded
+                body.addTorqueBody(glm::vec3(10.0f, -5.0f, 2.0f));
+                body.update(dt);
+                if (i % RESET_STEPS == RESET_STEPS - 1) setCruiseState(body);
+            }
+            benchmark_sink = body.position_world.y;
+        });
+    }
+}
+
+// --- Cases: full aircraft ---
+void benchAircraft(Suite& suite) {
+    const float dt = 1.0f / 120.0f;
+
+    for (IntegratorType type : {IntegratorType::SemiImplicitEuler, IntegratorType::RK4}) {
+        std::unique_ptr<Aircraft> aircraft = AircraftFactory::createDefaultAircraft();
+        aircraft->integrator = type;
+        setCruiseState(*aircraft);
+
+        suite.run(std::string("aircraft.update.") + integratorName(type), "steps", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                // Slow stick/throttle sweep so control surfaces actually move
+                float phase = static_cast<float>(i % RESET_STEPS) / RESET_STEPS;
+                aircraft->controls.throttle = 0.6f + 0.3f * phase;
+                aircraft->controls.pitch = 0.2f * (phase - 0.5f);
+                aircraft->controls.roll = 0.1f * (0.5f - phase);
+                aircraft->update(dt);
+                if (i % RESET_STEPS == RESET_STEPS - 1) setCruiseState(*aircraft);
+            }
+            benchmark_sink = aircraft->position_world.y;
+        });
+    }
+
+    // End to end: N aircraft stepped through the scheduler, as the application does
+    for (size_t count = 1; count <= suite.getOptions().max_aircraft; count *= 4) {
+        std::vector<std::unique_ptr<Aircraft>> fleet;
+        PhysicsScheduler scheduler(120.0f);
+        for (size_t a = 0; a < count; ++a) {
+            fleet.push_back(AircraftFactory::createDefaultAircraft());
+            setCruiseState(*fleet.back());
+            fleet.back()->position_world.z = 200.0f * static_cast<float>(a);
+            fleet.back()->controls.throttle = 0.7f;
+            scheduler.addBody(fleet.back().get());
+        }
+
+        // One op = one aircraft-step, so the per-op figures compare across fleet sizes
+        suite.run("scheduler.step." + std::to_string(count) + "_aircraft", "aircraft-steps", [&](uint64_t n) {
+            for (uint64_t s = 0; s < n; ++s) {
+                scheduler.step();
+                if (s % RESET_STEPS == RESET_STEPS - 1) {
+                    for (size_t a = 0; a < count; ++a) {
+                        setCruiseState(*fleet[a]);
+                        fleet[a]->position_world.z = 200.0f * static_cast<float>(a);
+                    }
+                }
+            }
+            benchmark_sink = fleet[0]->position_world.y;
+        }, count);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) options.filter = argv[++i];
+        else if (arg == "--min-time" && i + 1 < argc) options.min_time = std::max(1e-3, std::atof(argv[++i]));
+        else if (arg == "--repeats" && i + 1 < argc) options.repeats = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--max-aircraft" && i + 1 < argc) options.max_aircraft = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--json" && i + 1 < argc) options.json_path = argv[++i];
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter TEXT] [--min-time S] [--repeats N] [--max-aircraft N] [--json PATH]" << std::endl;
+            return 1;
+        }
+    }
+
+    Suite suite(options);
+    benchAirfoil(suite);
+    benchWing(suite);
+    benchAeroModel(suite);
+    benchRigidBody(suite);
+    benchAircraft(suite);
+
+    if (!options.json_path.empty()) {
+        if (!suite.writeJson(options.json_path)) return 1;
+        std::cout << "Wrote " << options.json_path << std::endl;
+    }
+    return 0;
+}